@@ -605,22 +605,16 @@ static bool isCodeObjectCompatibleWithDevice(std::string co_triple_target_id,
 
 // This will be moved to COMGR eventually
 hipError_t CodeObject::ExtractCodeObjectFromFile(
-    amd::Os::FileDesc fdesc, size_t fsize, const void** image,
-    const std::vector<std::string>& device_names,
-    std::vector<std::pair<const void*, size_t>>& code_objs, size_t foffset) {
-  if (!amd::Os::isValidFileDesc(fdesc)) {
-    return hipErrorFileNotFound;
-  }
-
-  // Map the file to memory, with offset 0.
-  // file will be unmapped in ModuleUnload
-  // const void* image = nullptr;
-  if (!amd::Os::MemoryMapFileDesc(fdesc, fsize, foffset, image)) {
+    const void* image, const std::vector<std::string>& device_names,
+    std::vector<std::pair<const void*, size_t>>& code_objs) {
+  // The file is mapped by the caller and unmapped in ModuleUnload, the code objects are views
+  // of the mapping
+  if (image == nullptr) {
     return hipErrorInvalidValue;
   }
 
   // retrieve code_objs{binary_image, binary_size} for devices
-  return extractCodeObjectFromFatBinary(*image, device_names, code_objs);
+  return extractCodeObjectFromFatBinary(image, device_names, code_objs);
 }
 
 // This will be moved to COMGR eventually
@@ -635,6 +629,41 @@ hipError_t CodeObject::ExtractCodeObjectFromMemory(
   return extractCodeObjectFromFatBinary(data, device_names, code_objs);
 }
 
+// ================================================================================================
+// Process wide index of the code object selection of uncompressed bundles. Libraries built for
+// the same offload targets carry bundles with the same entry IDs, so the selection is done once
+// per set of devices, entries and generic versions of the code objects and shared by all of them. Only bundles with hipv4 entries are
+// indexed, since older entry IDs don't identify the target and the code object is inspected.
+namespace {
+class BundleIndex {
+ public:
+  static BundleIndex& instance() {
+    static BundleIndex* index = new BundleIndex();
+    return *index;
+  }
+
+  // Returns the selected entry of every device
+  bool find(const std::string& key, std::vector<uint64_t>* entries) {
+    amd::ScopedLock lock(lock_);
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+      return false;
+    }
+    *entries = it->second;
+    return true;
+  }
+
+  void insert(const std::string& key, const std::vector<uint64_t>& entries) {
+    amd::ScopedLock lock(lock_);
+    index_.emplace(key, entries);
+  }
+
+ private:
+  amd::Monitor lock_;
+  std::unordered_map<std::string, std::vector<uint64_t>> index_;
+};
+}  // namespace
+
 // This will be moved to COMGR eventually
 hipError_t CodeObject::extractCodeObjectFromFatBinary(
     const void* data, const std::vector<std::string>& agent_triple_target_ids,
@@ -652,12 +681,57 @@ hipError_t CodeObject::extractCodeObjectFromFatBinary(
   }
 
   const auto obheader = reinterpret_cast<const __ClangOffloadBundleUncompressedHeader*>(data);
+
+  // Parse the header once, the key is the device targets followed by the bundle entry IDs and
+  // the generic versions
+  std::vector<const __ClangOffloadBundleInfo*> descs;
+  descs.reserve(obheader->numOfCodeObjects);
+  std::string key;
+  for (const auto& agent_triple_target_id : agent_triple_target_ids) {
+    key += agent_triple_target_id;
+    key += ';';
+  }
+  bool indexable = true;
+  const size_t hipv4_size = strlen(kOffloadKindHipv4_);
   const auto* desc = &obheader->desc[0];
-  size_t num_code_objs = code_objs.size();
   for (uint64_t i = 0; i < obheader->numOfCodeObjects; ++i,
                 desc = reinterpret_cast<const __ClangOffloadBundleInfo*>(
                     reinterpret_cast<uintptr_t>(&desc->bundleEntryId[0]) +
                     desc->bundleEntryIdSize)) {
+    descs.push_back(desc);
+    key += '|';
+    key.append(desc->bundleEntryId, desc->bundleEntryIdSize);
+    // The host entry has no code object
+    if (desc->size == 0) {
+      continue;
+    }
+    if (desc->bundleEntryIdSize < hipv4_size ||
+        strncmp(desc->bundleEntryId, kOffloadKindHipv4_, hipv4_size) != 0) {
+      indexable = false;
+    }
+    // The selection also depends on the generic version in the code object
+    const void* image =
+        reinterpret_cast<const void*>(reinterpret_cast<uintptr_t>(obheader) + desc->offset);
+    key += '#';
+    key += std::to_string(getGenericVersion(image));
+  }
+
+  std::vector<uint64_t> selected;
+  if (indexable && BundleIndex::instance().find(key, &selected)) {
+    for (size_t dev = 0; dev < selected.size(); ++dev) {
+      const auto* entry = descs[selected[dev]];
+      code_objs[dev] = std::make_pair(
+          reinterpret_cast<const void*>(reinterpret_cast<uintptr_t>(obheader) + entry->offset),
+          entry->size);
+    }
+    FatBinaryInfo::Stats().index_hits_.fetch_add(1, std::memory_order_relaxed);
+    return hipSuccess;
+  }
+  selected.resize(code_objs.size(), 0);
+
+  size_t num_code_objs = code_objs.size();
+  for (uint64_t i = 0; i < descs.size(); ++i) {
+    desc = descs[i];
     const void* image =
         reinterpret_cast<const void*>(reinterpret_cast<uintptr_t>(obheader) + desc->offset);
     const size_t image_size = desc->size;
@@ -683,10 +757,15 @@ hipError_t CodeObject::extractCodeObjectFromFatBinary(
         genericVersion)) {
         if (code_objs[dev].first == nullptr) --num_code_objs;
         code_objs[dev] = std::make_pair(image, image_size);
+        selected[dev] = i;
       }
     }
   }
   if (num_code_objs == 0) {
+    if (indexable) {
+      BundleIndex::instance().insert(key, selected);
+      FatBinaryInfo::Stats().index_misses_.fetch_add(1, std::memory_order_relaxed);
+    }
     return hipSuccess;
   } else {
     LogPrintfError("%s",
@@ -1277,9 +1356,13 @@ hipError_t StatCO::digestFatBinary(const void* data, FatBinaryInfo*& programs) {
     return hipSuccess;
   }
 
-  // Create a new fat binary object and extract the fat binary for all devices.
+  // Create a new fat binary object, the fat binary is extracted for all devices on the first
+  // use of its functions or variables, unless the lazy extraction is disabled.
   programs = new FatBinaryInfo(nullptr, data);
-  IHIP_RETURN_ONFAIL(programs->ExtractFatBinary(g_devices));
+  programs->DeferExtraction(g_devices);
+  if (!HIP_LAZY_FATBIN_EXTRACTION) {
+    IHIP_RETURN_ONFAIL(programs->ExtractDeferred());
+  }
 
   return hipSuccess;
 }
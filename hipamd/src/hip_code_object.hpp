@@ -48,11 +48,11 @@ class CodeObject {
                                 size_t binary_size);
   static hipError_t build_module(hipModule_t hmod, const std::vector<amd::Device*>& devices);
 
-  // Given an file desc and file size, extracts to code object for corresponding devices,
+  // Given the mapped file, extracts to code object for corresponding devices,
   // return code_objs{binary_ptr, binary_size}, which could be used to determine foffset
-  static hipError_t ExtractCodeObjectFromFile(amd::Os::FileDesc fdesc, size_t fsize,
-                    const void ** image, const std::vector<std::string>& device_names,
-                    std::vector<std::pair<const void*, size_t>>& code_objs, size_t foffset);
+  static hipError_t ExtractCodeObjectFromFile(const void* image,
+                    const std::vector<std::string>& device_names,
+                    std::vector<std::pair<const void*, size_t>>& code_objs);
 
   // Given an ptr to memory, extracts to code object for corresponding devices,
   // returns code_objs{binary_ptr, binary_size} and uniform resource indicator
@@ -24,6 +24,7 @@
 #include "hip_internal.hpp"
 #include "hip_mempool_impl.hpp"
 #include "hip_platform.hpp"
+#include "hip_graph_internal.hpp"
 
 #undef hipGetDeviceProperties
 #undef hipDeviceProp_t
@@ -143,6 +144,8 @@ void Device::AddSafeStream(Stream* event_stream, Stream* wait_stream) {
 
 // ================================================================================================
 void Device::Reset() {
+  // The cached executable graphs hold streams of the device
+  GraphExec::ClearInstantiateCache();
   {
     amd::ScopedLock lock(lock_);
     auto it = mem_pools_.begin();
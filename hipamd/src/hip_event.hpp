@@ -26,7 +26,7 @@
 
 // Internal structure for stream callback handler
 namespace hip {
-class StreamCallback {
+class StreamCallback : public amd::SlabObject {
 protected:
   void* userData_;
  public:
@@ -91,7 +91,7 @@ class EventMarker : public amd::Marker {
   }
 };
 
-class Event {
+class Event : public amd::SlabObject {
   /// capture stream where event is recorded
   hipStream_t captureStream_ = nullptr;
   /// Previous captured nodes before event record
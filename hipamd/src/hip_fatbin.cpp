@@ -39,7 +39,8 @@ FatBinaryDeviceInfo::~FatBinaryDeviceInfo() {
 
 FatBinaryInfo::FatBinaryInfo(const char* fname, const void* image) : fdesc_(amd::Os::FDescInit()),
                              fsize_(0), foffset_(0), image_(image), image_mapped_(false),
-                             uri_(std::string()) {
+                             uri_(std::string()), deferred_(false),
+                             deferred_status_(hipSuccess) {
 
   if (fname != nullptr) {
     fname_ = std::string(fname);
@@ -66,46 +67,24 @@ FatBinaryInfo::~FatBinaryInfo() {
     LogPrintfInfo("~FatBinaryInfo(%p) will delete binary_image_ %p", this, itemData);
     delete[] reinterpret_cast<const char*>(itemData);
   }
-  if (!HIP_USE_RUNTIME_UNBUNDLER) {
-    // Using COMGR Unbundler
-    if (ufd_ && amd::Os::isValidFileDesc(ufd_->fdesc_)) {
-      // Check for ufd_ != nullptr, since sometimes, we never create unique_file_desc.
-      if (ufd_->fsize_ && image_mapped_
-           && !amd::Os::MemoryUnmapFile(image_, ufd_->fsize_)) {
-        LogPrintfError("Cannot unmap file for fdesc: %d fsize: %d", ufd_->fdesc_, ufd_->fsize_);
-        assert(false);
-      }
-      if (!PlatformState::instance().CloseUniqueFileHandle(ufd_)) {
-        LogPrintfError("Cannot close file for fdesc: %d", ufd_->fdesc_);
-        assert(false);
-      }
+  // Both unbundlers map the files through the unique file handle
+  if (ufd_ && amd::Os::isValidFileDesc(ufd_->fdesc_)) {
+    // Check for ufd_ != nullptr, since sometimes, we never create unique_file_desc.
+    if (image_mapped_ && !PlatformState::instance().UnmapUniqueFile(ufd_)) {
+      LogPrintfError("Cannot unmap file for fdesc: %d fsize: %d", ufd_->fdesc_, ufd_->fsize_);
+      assert(false);
     }
-
-    fname_ = std::string();
-    fdesc_ = amd::Os::FDescInit();
-    fsize_ = 0;
-    image_ = nullptr;
-    uri_ = std::string();
-
-  } else {
-    // Using Runtime Unbundler
-    if (amd::Os::isValidFileDesc(fdesc_)) {
-      if (fsize_ && !amd::Os::MemoryUnmapFile(image_, fsize_)) {
-        LogPrintfError("Cannot unmap file for fdesc: %d fsize: %d", fdesc_, fsize_);
-        assert(false);
-      }
-      if (!amd::Os::CloseFileHandle(fdesc_)) {
-        LogPrintfError("Cannot close file for fdesc: %d", fdesc_);
-        assert(false);
-      }
+    if (!PlatformState::instance().CloseUniqueFileHandle(ufd_)) {
+      LogPrintfError("Cannot close file for fdesc: %d", ufd_->fdesc_);
+      assert(false);
     }
-
-    fname_ = std::string();
-    fdesc_ = amd::Os::FDescInit();
-    fsize_ = 0;
-    image_ = nullptr;
-    uri_ = std::string();
   }
+
+  fname_ = std::string();
+  fdesc_ = amd::Os::FDescInit();
+  fsize_ = 0;
+  image_ = nullptr;
+  uri_ = std::string();
 }
 
 void ListAllDeviceWithNoCOFromBundle(const std::unordered_map<std::string,
@@ -154,7 +133,8 @@ hipError_t FatBinaryInfo::ExtractFatBinaryUsingCOMGR(const std::vector<hip::Devi
 
     // If image_ is nullptr, then file path is passed via hipMod* APIs, so map the file.
     if (image_ == nullptr) {
-      if(!amd::Os::MemoryMapFileDesc(ufd_->fdesc_, ufd_->fsize_, foffset_, &image_)) {
+      image_ = PlatformState::instance().MapUniqueFile(ufd_);
+      if (image_ == nullptr) {
         LogError("Cannot map the file descriptor");
         PlatformState::instance().CloseUniqueFileHandle(ufd_);
         return hipErrorInvalidValue;
@@ -302,7 +282,7 @@ hipError_t FatBinaryInfo::ExtractFatBinaryUsingCOMGR(const std::vector<hip::Devi
   // Clean up file and memory resouces if hip_status failed for some reason.
   if (hip_status != hipSuccess && hip_status != hipErrorInvalidKernelFile) {
     if (image_mapped_) {
-      if (!amd::Os::MemoryUnmapFile(image_, ufd_->fsize_))
+      if (!PlatformState::instance().UnmapUniqueFile(ufd_))
         guarantee(false, "Cannot unmap the file");
 
       image_ = nullptr;
@@ -350,17 +330,26 @@ hipError_t FatBinaryInfo::ExtractFatBinary(const std::vector<hip::Device*>& devi
                   device_names, code_objs, uri_);
   } else if (fname_.size() > 0) {
     // We are given file name, get the file desc and file size
-    // Get File Handle & size of the file.
-    if (!amd::Os::GetFileHandle(fname_.c_str(), &fdesc_, &fsize_)) {
-      return hipErrorFileNotFound;
+    // Get File Handle & size of the file, the mapping is shared with other modules of the file.
+    if (ufd_ == nullptr) {
+      ufd_ = PlatformState::instance().GetUniqueFileHandle(fname_);
+      if (ufd_ == nullptr) {
+        return hipErrorFileNotFound;
+      }
     }
+    fdesc_ = ufd_->fdesc_;
+    fsize_ = ufd_->fsize_;
     if (fsize_ == 0) {
       return hipErrorInvalidImage;
     }
+    image_ = PlatformState::instance().MapUniqueFile(ufd_);
+    if (image_ == nullptr) {
+      return hipErrorInvalidValue;
+    }
+    image_mapped_ = true;
 
     // Extract the code object from file
-    hip_error = CodeObject::ExtractCodeObjectFromFile(fdesc_, fsize_, &image_,
-                device_names, code_objs, foffset_);
+    hip_error = CodeObject::ExtractCodeObjectFromFile(image_, device_names, code_objs);
   } else {
     return hipErrorInvalidValue;
   }
@@ -426,6 +415,53 @@ hipError_t FatBinaryInfo::ExtractFatBinary(const std::vector<hip::Device*>& devi
   return hipSuccess;
 }
 
+FatBinaryStats FatBinaryInfo::stats_;
+
+// ================================================================================================
+void FatBinaryStats::Print(const char* event) const {
+  ClPrint(amd::LOG_INFO, amd::LOG_CODE, "[fatbin] %s: %llu registered, "
+          "%llu extracted in %llu us, bundle index %llu hits %llu misses", event,
+          static_cast<unsigned long long>(registered_.load(std::memory_order_relaxed)),
+          static_cast<unsigned long long>(extracted_.load(std::memory_order_relaxed)),
+          static_cast<unsigned long long>(extract_time_.load(std::memory_order_relaxed) / 1000),
+          static_cast<unsigned long long>(index_hits_.load(std::memory_order_relaxed)),
+          static_cast<unsigned long long>(index_misses_.load(std::memory_order_relaxed)));
+}
+
+// ================================================================================================
+void FatBinaryInfo::DeferExtraction(const std::vector<hip::Device*>& devices) {
+  amd::ScopedLock lock(deferred_lock_);
+  deferred_devices_ = devices;
+  deferred_.store(true, std::memory_order_release);
+  stats_.registered_.fetch_add(1, std::memory_order_relaxed);
+}
+
+// ================================================================================================
+hipError_t FatBinaryInfo::ExtractDeferred() {
+  if (!deferred_.load(std::memory_order_acquire)) {
+    return deferred_status_;
+  }
+  amd::ScopedLock lock(deferred_lock_);
+  // Another thread could finish the extraction while this one was waiting
+  if (!deferred_.load(std::memory_order_relaxed)) {
+    return deferred_status_;
+  }
+  uint64_t start = amd::Os::timeNanos();
+  hipError_t status = ExtractFatBinary(deferred_devices_);
+  uint64_t elapsed = amd::Os::timeNanos() - start;
+  deferred_devices_.clear();
+  // Every later use of the fat binary reports a failed extraction
+  deferred_status_ = status;
+  deferred_.store(false, std::memory_order_release);
+
+  stats_.extracted_.fetch_add(1, std::memory_order_relaxed);
+  stats_.extract_time_.fetch_add(elapsed, std::memory_order_relaxed);
+  ClPrint(amd::LOG_INFO, amd::LOG_CODE, "[fatbin] Extracted %p in %llu us", image_,
+          static_cast<unsigned long long>(elapsed / 1000));
+  return status;
+}
+
+// ================================================================================================
 hipError_t FatBinaryInfo::AddDevProgram(const int device_id) {
   // Device Id bounds Check
   DeviceIdCheck(device_id);
@@ -437,6 +473,8 @@ hipError_t FatBinaryInfo::AddDevProgram(const int device_id) {
 
   // If fat binary was already added, skip this step and return success
   if (fbd_info->add_dev_prog_ == false) {
+    // Prefetch the code object of the device, the rest of the bundle isn't read
+    AdviseImage(fbd_info, amd::Os::MEM_ADVICE_WILLNEED);
     amd::Context* ctx = g_devices[device_id]->asContext();
     if (CL_SUCCESS != fbd_info->program_->addDeviceProgram(*ctx->devices()[0],
                                           fbd_info->binary_image_,
@@ -452,12 +490,16 @@ hipError_t FatBinaryInfo::AddDevProgram(const int device_id) {
 
 hipError_t FatBinaryInfo::BuildProgram(const int device_id) {
 
+  // Extract a static fat binary on the first use of its functions or variables
+  IHIP_RETURN_ONFAIL(ExtractDeferred());
+
   // Device Id Check and Add DeviceProgram if not added so far
   DeviceIdCheck(device_id);
   IHIP_RETURN_ONFAIL(AddDevProgram(device_id));
 
   // If Program was already built skip this step and return success
   FatBinaryDeviceInfo* fbd_info = fatbin_dev_info_[device_id];
+  bool built = false;
   if (fbd_info->prog_built_ == false) {
     if(CL_SUCCESS != fbd_info->program_->build(g_devices[device_id]->devices(),
                                                nullptr, nullptr, nullptr,
@@ -465,14 +507,41 @@ hipError_t FatBinaryInfo::BuildProgram(const int device_id) {
       return hipErrorNoBinaryForGpu;
     }
     fbd_info->prog_built_ = true;
+    built = true;
   }
 
   if (!fbd_info->program_->load()) {
     return hipErrorNoBinaryForGpu;
   }
+  if (built) {
+    // The code object is loaded to the device. The view stays valid, but its pages are
+    // dropped from the resident set and read from the file again on a later access.
+    AdviseImage(fbd_info, amd::Os::MEM_ADVICE_DONTNEED);
+  }
   return hipSuccess;
 }
 
+// ================================================================================================
+void FatBinaryInfo::AdviseImage(const FatBinaryDeviceInfo* fbd_info,
+                                amd::Os::MemAdvice advice) const {
+  // Only the file mappings of the runtime take hints, an image of the app may be anonymous memory
+  if (!image_mapped_ || (ufd_ == nullptr) || (fbd_info->binary_image_ == nullptr)) {
+    return;
+  }
+  // A decompressed code object lives in a heap buffer, the advice rounds the range out to whole
+  // pages and DONTNEED would zero it together with the neighbouring allocations
+  const char* begin = reinterpret_cast<const char*>(image_);
+  const char* code = reinterpret_cast<const char*>(fbd_info->binary_image_);
+  if ((code < begin) || (fbd_info->binary_size_ > ufd_->fsize_) ||
+      (static_cast<size_t>(code - begin) > ufd_->fsize_ - fbd_info->binary_size_)) {
+    return;
+  }
+  if (!amd::Os::adviseMemory(fbd_info->binary_image_, fbd_info->binary_size_, advice)) {
+    ClPrint(amd::LOG_INFO, amd::LOG_CODE, "[fatbin] Advice %d failed for %zu bytes of %s",
+            advice, fbd_info->binary_size_, fname_.c_str());
+  }
+}
+
 // ================================================================================================
 hipError_t FatBinaryInfo::ExtractFatBinaryUsingCOMGR(const void *data,
     const std::vector<hip::Device*>& devices) {
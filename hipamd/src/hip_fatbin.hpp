@@ -23,6 +23,8 @@ THE SOFTWARE.
 #ifndef HIP_FAT_BINARY_HPP
 #define HIP_FAT_BINARY_HPP
 
+#include <atomic>
+
 #include "hip/hip_runtime.h"
 #include "hip/hip_runtime_api.h"
 #include "hip_internal.hpp"
@@ -57,6 +59,17 @@ private:
 };
 
 
+// Startup counters of the static fat binaries, reported with AMD_LOG_MASK LOG_CODE
+struct FatBinaryStats {
+  std::atomic<uint64_t> registered_{0};    // Registered fat binaries
+  std::atomic<uint64_t> extracted_{0};     // Extracted fat binaries
+  std::atomic<uint64_t> extract_time_{0};  // Total extraction time in ns
+  std::atomic<uint64_t> index_hits_{0};    // Bundles resolved by the bundle index
+  std::atomic<uint64_t> index_misses_{0};  // Bundles added to the bundle index
+
+  void Print(const char* event) const;
+};
+
 // Fat Binary Info
 class FatBinaryInfo {
 public:
@@ -83,6 +96,15 @@ public:
   hipError_t ExtractFatBinaryUsingCOMGR(const void* data,
                                               const std::vector<hip::Device*>& devices);
   hipError_t ExtractFatBinary(const std::vector<hip::Device*>& devices);
+
+  // Defers the extraction of a static fat binary until ExtractDeferred(), which
+  // BuildProgram() calls on the first use of a function or variable
+  void DeferExtraction(const std::vector<hip::Device*>& devices);
+  // Runs the deferred extraction once, returns its result or hipSuccess if nothing is deferred
+  hipError_t ExtractDeferred();
+
+  static FatBinaryStats& Stats() { return stats_; }
+
   hipError_t AddDevProgram(const int device_id);
   hipError_t BuildProgram(const int device_id);
 
@@ -110,6 +132,9 @@ public:
   }
 
 private:
+  // Gives the access hint for the code object of the device if the runtime mapped the file
+  void AdviseImage(const FatBinaryDeviceInfo* fbd_info, amd::Os::MemAdvice advice) const;
+
   std::string fname_;        //!< File name
   amd::Os::FileDesc fdesc_;  //!< File descriptor
   size_t fsize_;             //!< Total file size
@@ -126,6 +151,13 @@ private:
   std::vector<FatBinaryDeviceInfo*> fatbin_dev_info_;
 
   std::shared_ptr<UniqueFD> ufd_; //!< Unique file descriptor
+
+  std::atomic<bool> deferred_;                  //!< The extraction is deferred
+  amd::Monitor deferred_lock_;                  //!< Serializes the deferred extraction
+  std::vector<hip::Device*> deferred_devices_;  //!< Devices of the deferred extraction
+  hipError_t deferred_status_;                  //!< The result of the deferred extraction
+
+  static FatBinaryStats stats_;
 };
 
 }; // namespace hip
@@ -1266,6 +1266,9 @@ hipError_t hipGraphExecMemcpyNodeSetParams1D(hipGraphExec_t hGraphExec, hipGraph
       src == nullptr || count == 0 || src == dst || n->GetType() != hipGraphNodeTypeMemcpy) {
     HIP_RETURN(hipErrorInvalidValue);
   }
+  if (reinterpret_cast<hip::GraphExec*>(hGraphExec)->IsOptimizedNode(n)) {
+    HIP_RETURN(hipErrorNotSupported);
+  }
   hip::GraphNode* clonedNode = reinterpret_cast<hip::GraphNode*>(
       reinterpret_cast<hip::GraphExec*>(hGraphExec)->GetClonedNode(n));
   if (clonedNode == nullptr) {
@@ -1374,12 +1377,19 @@ hipError_t ihipGraphInstantiate(hip::GraphExec** pGraphExec, hip::Graph* graph,
       }
     }
   }
+  // An equivalent destroyed graph skips the scheduling, the streams and the packet capture
+  *pGraphExec = hip::GraphExec::Reuse(graph, flags);
+  if (*pGraphExec != nullptr) {
+    graph->SetGraphInstantiated(true);
+    return hipSuccess;
+  }
   *pGraphExec = new hip::GraphExec(flags);
   if (*pGraphExec == nullptr) {
     return hipErrorOutOfMemory;
   }
   graph->clone(*pGraphExec, true);
-  (*pGraphExec)->ScheduleNodes();
+  (*pGraphExec)->Optimize(DEBUG_HIP_GRAPH_OPTIMIZE);
+  (*pGraphExec)->ScheduleNodes(static_cast<hip::GraphScheduler>(DEBUG_HIP_GRAPH_SCHEDULER));
   if (false == (*pGraphExec)->TopologicalOrder()) {
     return hipErrorInvalidValue;
   }
@@ -1475,7 +1485,9 @@ hipError_t hipGraphExecDestroy(hipGraphExec_t pGraphExec) {
     HIP_RETURN(hipErrorInvalidValue);
   }
   hip::GraphExec* ge = reinterpret_cast<hip::GraphExec*>(pGraphExec);
-  ge->release();
+  if (!ge->Recycle()) {
+    ge->release();
+  }
   HIP_RETURN(hipSuccess);
 }
 
@@ -1490,7 +1502,8 @@ hipError_t hipGraphLaunch_common(hip::GraphExec* graphExec, hipStream_t stream)
   if (graphExec == nullptr || !hip::GraphExec::isGraphExecValid(graphExec)) {
     return hipErrorInvalidValue;
   }
-  if (graphExec->clonedNodes_.empty()) {
+  // The optimization passes may drop the user nodes, so check the executable nodes
+  if (graphExec->GetNodes().empty()) {
     return hipSuccess;
   }
   if (!hip::isValid(stream)) {
@@ -1665,6 +1678,9 @@ hipError_t hipGraphExecMemcpyNodeSetParams(hipGraphExec_t hGraphExec, hipGraphNo
       ((pNodeParams->dstArray == 0) && (pNodeParams->dstPtr.ptr == nullptr))) {
     HIP_RETURN(hipErrorInvalidValue);
   }
+  if (reinterpret_cast<hip::GraphExec*>(hGraphExec)->IsOptimizedNode(n)) {
+    HIP_RETURN(hipErrorNotSupported);
+  }
   hip::GraphNode* clonedNode = reinterpret_cast<hip::GraphExec*>(hGraphExec)->GetClonedNode(n);
   if (clonedNode == nullptr) {
     HIP_RETURN(hipErrorInvalidValue);
@@ -1721,6 +1737,9 @@ hipError_t hipGraphExecMemsetNodeSetParams(hipGraphExec_t hGraphExec, hipGraphNo
   if (ihipGraphMemsetParams_validate(pNodeParams) != hipSuccess) {
     HIP_RETURN(hipErrorInvalidValue);
   }
+  if (reinterpret_cast<hip::GraphExec*>(hGraphExec)->IsOptimizedNode(n)) {
+    HIP_RETURN(hipErrorNotSupported);
+  }
   hip::GraphNode* clonedNode = reinterpret_cast<hip::GraphExec*>(hGraphExec)->GetClonedNode(n);
   if (clonedNode == nullptr) {
     HIP_RETURN(hipErrorInvalidValue);
@@ -1783,6 +1802,9 @@ hipError_t hipGraphExecKernelNodeSetParams(hipGraphExec_t hGraphExec, hipGraphNo
       pNodeParams == nullptr || pNodeParams->func == nullptr || n->GetType() != hipGraphNodeTypeKernel) {
     HIP_RETURN(hipErrorInvalidValue);
   }
+  if (reinterpret_cast<hip::GraphExec*>(hGraphExec)->IsOptimizedNode(n)) {
+    HIP_RETURN(hipErrorNotSupported);
+  }
   hip::GraphNode* clonedNode = reinterpret_cast<hip::GraphExec*>(hGraphExec)->GetClonedNode(n);
   if (clonedNode == nullptr) {
     HIP_RETURN(hipErrorInvalidValue);
@@ -1844,6 +1866,9 @@ hipError_t hipGraphExecChildGraphNodeSetParams(hipGraphExec_t hGraphExec, hipGra
     }
   }
 
+  if (reinterpret_cast<hip::GraphExec*>(hGraphExec)->IsOptimizedNode(n)) {
+    HIP_RETURN(hipErrorNotSupported);
+  }
   hip::GraphNode* clonedNode = reinterpret_cast<hip::GraphExec*>(hGraphExec)->GetClonedNode(n);
   if (clonedNode == nullptr) {
     HIP_RETURN(hipErrorInvalidValue);
@@ -2243,6 +2268,9 @@ hipError_t hipGraphExecMemcpyNodeSetParamsFromSymbol(hipGraphExec_t hGraphExec,
     HIP_RETURN(hipErrorInvalidValue);
   }
 
+  if (reinterpret_cast<hip::GraphExec*>(hGraphExec)->IsOptimizedNode(n)) {
+    HIP_RETURN(hipErrorNotSupported);
+  }
   hip::GraphNode* clonedNode = reinterpret_cast<hip::GraphExec*>(hGraphExec)->GetClonedNode(n);
   if (clonedNode == nullptr) {
     HIP_RETURN(hipErrorInvalidValue);
@@ -2326,6 +2354,9 @@ hipError_t hipGraphExecMemcpyNodeSetParamsToSymbol(hipGraphExec_t hGraphExec, hi
     HIP_RETURN(hipErrorInvalidValue);
   }
 
+  if (reinterpret_cast<hip::GraphExec*>(hGraphExec)->IsOptimizedNode(n)) {
+    HIP_RETURN(hipErrorNotSupported);
+  }
   hip::GraphNode* clonedNode = reinterpret_cast<hip::GraphExec*>(hGraphExec)->GetClonedNode(n);
   if (clonedNode == nullptr) {
     HIP_RETURN(hipErrorInvalidValue);
@@ -2394,6 +2425,10 @@ hipError_t hipGraphExecEventRecordNodeSetEvent(hipGraphExec_t hGraphExec, hipGra
       n->GetType() != hipGraphNodeTypeEventRecord) {
     HIP_RETURN(hipErrorInvalidValue);
   }
+  // The optimizer removed the event waits by the events at the instantiation
+  if (reinterpret_cast<hip::GraphExec*>(hGraphExec)->IsOptimized()) {
+    HIP_RETURN(hipErrorNotSupported);
+  }
   hip::GraphNode* clonedNode = reinterpret_cast<hip::GraphExec*>(hGraphExec)->GetClonedNode(n);
   if (clonedNode == nullptr) {
     HIP_RETURN(hipErrorInvalidValue);
@@ -2449,6 +2484,10 @@ hipError_t hipGraphExecEventWaitNodeSetEvent(hipGraphExec_t hGraphExec, hipGraph
       (n->GetType() != hipGraphNodeTypeWaitEvent) || n->GetType() != hipGraphNodeTypeWaitEvent) {
     HIP_RETURN(hipErrorInvalidValue);
   }
+  // The optimizer removed the event waits by the events at the instantiation
+  if (reinterpret_cast<hip::GraphExec*>(hGraphExec)->IsOptimized()) {
+    HIP_RETURN(hipErrorNotSupported);
+  }
   hip::GraphNode* clonedNode = reinterpret_cast<hip::GraphExec*>(hGraphExec)->GetClonedNode(n);
   if (clonedNode == nullptr) {
     HIP_RETURN(hipErrorInvalidValue);
@@ -2500,6 +2539,9 @@ hipError_t hipGraphExecHostNodeSetParams(hipGraphExec_t hGraphExec, hipGraphNode
       !hip::GraphNode::isNodeValid(n) || n->GetType() != hipGraphNodeTypeHost) {
     HIP_RETURN(hipErrorInvalidValue);
   }
+  if (reinterpret_cast<hip::GraphExec*>(hGraphExec)->IsOptimizedNode(n)) {
+    HIP_RETURN(hipErrorNotSupported);
+  }
   hip::GraphNode* clonedNode = reinterpret_cast<hip::GraphExec*>(hGraphExec)->GetClonedNode(n);
   if (clonedNode == nullptr) {
     HIP_RETURN(hipErrorInvalidValue);
@@ -2516,80 +2558,18 @@ hipError_t hipGraphExecUpdate(hipGraphExec_t hGraphExec, hipGraph_t hGraph,
       updateResult_out == nullptr) {
     HIP_RETURN(hipErrorInvalidValue);
   }
-
-  std::vector<hip::GraphNode*> newGraphNodes;
-  reinterpret_cast<hip::Graph*>(hGraph)->TopologicalOrder(newGraphNodes);
-  std::vector<hip::GraphNode*>& oldGraphExecNodes =
-      reinterpret_cast<hip::GraphExec*>(hGraphExec)->GetNodes();
-  if (newGraphNodes.size() != oldGraphExecNodes.size()) {
-    *updateResult_out = hipGraphExecUpdateErrorTopologyChanged;
+  // The nodes of an optimized graph don't match the nodes of the user graph
+  if (reinterpret_cast<hip::GraphExec*>(hGraphExec)->IsOptimized()) {
+    *updateResult_out = hipGraphExecUpdateErrorNotSupported;
     *hErrorNode_out = nullptr;
     HIP_RETURN(hipErrorGraphExecUpdateFailure);
   }
 
-  for (std::vector<hip::GraphNode*>::size_type i = 0; i != newGraphNodes.size(); i++) {
-    // Checks if all the node types are same before updating
-    if (newGraphNodes[i]->GetType() == oldGraphExecNodes[i]->GetType()) {
-      if (newGraphNodes[i]->GetType() != hipGraphNodeTypeHost &&
-          newGraphNodes[i]->GetType() != hipGraphNodeTypeEmpty) {
-        if (newGraphNodes[i]->GetParentGraph()->device_ !=
-            oldGraphExecNodes[i]->GetParentGraph()->device_) {
-          *updateResult_out = hipGraphExecUpdateErrorUnsupportedFunctionChange;
-          *hErrorNode_out = reinterpret_cast<hipGraphNode_t>(newGraphNodes[i]);
-          return hipErrorGraphExecUpdateFailure;
-        }
-      }
-
-      if (newGraphNodes[i]->GetType() == hipGraphNodeTypeMemcpy) {
-        // Checks if the memcpy node's parameters are same
-        const hip::GraphMemcpyNode* newMemcpyNode =
-            static_cast<hip::GraphMemcpyNode const*>(newGraphNodes[i]);
-        const hip::GraphMemcpyNode* oldMemcpyNode =
-            static_cast<hip::GraphMemcpyNode const*>(oldGraphExecNodes[i]);
-        hipMemcpyKind newKind, oldKind;
-        newKind = newMemcpyNode->GetMemcpyKind();
-        oldKind = oldMemcpyNode->GetMemcpyKind();
-        if (newKind != oldKind) {
-          *hErrorNode_out = reinterpret_cast<hipGraphNode_t>(newGraphNodes[i]);
-          *updateResult_out = hipGraphExecUpdateErrorParametersChanged;
-          HIP_RETURN(hipErrorGraphExecUpdateFailure);
-        }
-      }
-      // Checks if all the node's dependencies are same
-      const std::vector<hip::GraphNode*>& newGraphDependencies =
-                        newGraphNodes[i]->GetDependencies();
-      const std::vector<hip::GraphNode*>& oldGraphDependencies =
-                        oldGraphExecNodes[i]->GetDependencies();
-      if (newGraphDependencies.size() != oldGraphDependencies.size()) {
-        *hErrorNode_out = reinterpret_cast<hipGraphNode_t>(newGraphNodes[i]);
-        *updateResult_out = hipGraphExecUpdateErrorTopologyChanged;
-        HIP_RETURN(hipErrorGraphExecUpdateFailure);
-      }
-
-      hipError_t status = oldGraphExecNodes[i]->SetParams(newGraphNodes[i]);
-      if (status != hipSuccess) {
-        *hErrorNode_out = reinterpret_cast<hipGraphNode_t>(newGraphNodes[i]);
-        if (status == hipErrorInvalidDeviceFunction) {
-          *updateResult_out = hipGraphExecUpdateErrorUnsupportedFunctionChange;
-        } else if (status == hipErrorInvalidValue || status == hipErrorInvalidDevicePointer) {
-          *updateResult_out = hipGraphExecUpdateErrorParametersChanged;
-        } else {
-          *updateResult_out = hipGraphExecUpdateErrorNotSupported;
-        }
-        HIP_RETURN(hipErrorGraphExecUpdateFailure);
-      } else if (DEBUG_CLR_GRAPH_PACKET_CAPTURE && newGraphNodes[i]->GraphCaptureEnabled()) {
-        status =
-            reinterpret_cast<hip::GraphExec*>(hGraphExec)
-                ->UpdateAQLPacket(reinterpret_cast<hip::GraphKernelNode*>(oldGraphExecNodes[i]));
-      }
-    } else {
-      *hErrorNode_out = reinterpret_cast<hipGraphNode_t>(newGraphNodes[i]);
-      *updateResult_out = hipGraphExecUpdateErrorNodeTypeChanged;
-      HIP_RETURN(hipErrorGraphExecUpdateFailure);
-    }
-  }
-  *updateResult_out = hipGraphExecUpdateSuccess;
-  HIP_RETURN(hipSuccess);
+  hip::GraphNode* errorNode = nullptr;
+  hipError_t status = reinterpret_cast<hip::GraphExec*>(hGraphExec)->Update(
+      reinterpret_cast<hip::Graph*>(hGraph), &errorNode, updateResult_out);
+  *hErrorNode_out = reinterpret_cast<hipGraphNode_t>(errorNode);
+  HIP_RETURN(status);
 }
 
 // ================================================================================================
@@ -2925,6 +2905,9 @@ hipError_t hipGraphNodeSetEnabled(hipGraphExec_t hGraphExec, hipGraphNode_t hNod
       !hip::GraphNode::isNodeValid(node)) {
     HIP_RETURN(hipErrorInvalidValue);
   }
+  if (graphExec->IsOptimizedNode(node)) {
+    HIP_RETURN(hipErrorNotSupported);
+  }
   hip::GraphNode* clonedNode = graphExec->GetClonedNode(node);
   if (clonedNode == nullptr) {
     HIP_RETURN(hipErrorInvalidValue);
@@ -2947,6 +2930,9 @@ hipError_t hipGraphNodeGetEnabled(hipGraphExec_t hGraphExec, hipGraphNode_t hNod
       !hip::GraphExec::isGraphExecValid(graphExec) || !hip::GraphNode::isNodeValid(node)) {
     HIP_RETURN(hipErrorInvalidValue);
   }
+  if (graphExec->IsOptimizedNode(node)) {
+    HIP_RETURN(hipErrorNotSupported);
+  }
   hip::GraphNode* clonedNode = graphExec->GetClonedNode(node);
   if (clonedNode == nullptr) {
     HIP_RETURN(hipErrorInvalidValue);
@@ -3187,6 +3173,9 @@ hipError_t hipGraphExecExternalSemaphoresSignalNodeSetParams(hipGraphExec_t hGra
       n->GetType() != hipGraphNodeTypeExtSemaphoreSignal) {
     HIP_RETURN(hipErrorInvalidValue);
   }
+  if (graphExec->IsOptimizedNode(n)) {
+    HIP_RETURN(hipErrorNotSupported);
+  }
   hip::GraphNode* clonedNode = graphExec->GetClonedNode(n);
   if (clonedNode == nullptr) {
     HIP_RETURN(hipErrorInvalidValue);
@@ -3206,6 +3195,9 @@ hipError_t hipGraphExecExternalSemaphoresWaitNodeSetParams(hipGraphExec_t hGraph
       n->GetType() != hipGraphNodeTypeExtSemaphoreWait) {
     HIP_RETURN(hipErrorInvalidValue);
   }
+  if (graphExec->IsOptimizedNode(n)) {
+    HIP_RETURN(hipErrorNotSupported);
+  }
   hip::GraphNode* clonedNode = graphExec->GetClonedNode(n);
   if (clonedNode == nullptr) {
     HIP_RETURN(hipErrorInvalidValue);
@@ -3263,6 +3255,9 @@ hipError_t hipDrvGraphExecMemcpyNodeSetParams(hipGraphExec_t hGraphExec, hipGrap
        && (copyParams->dstDevice == nullptr))) {
     HIP_RETURN(hipErrorInvalidValue);
   }
+  if (reinterpret_cast<hip::GraphExec*>(hGraphExec)->IsOptimizedNode(n)) {
+    HIP_RETURN(hipErrorNotSupported);
+  }
   hip::GraphNode* clonedNode = reinterpret_cast<hip::GraphExec*>(hGraphExec)->GetClonedNode(n);
   if (clonedNode == nullptr) {
     HIP_RETURN(hipErrorInvalidValue);
@@ -3289,6 +3284,9 @@ hipError_t hipDrvGraphExecMemsetNodeSetParams(hipGraphExec_t hGraphExec, hipGrap
   if (ihipGraphMemsetParams_validate(&pmemsetParams) != hipSuccess) {
     HIP_RETURN(hipErrorInvalidValue);
   }
+  if (reinterpret_cast<hip::GraphExec*>(hGraphExec)->IsOptimizedNode(n)) {
+    HIP_RETURN(hipErrorNotSupported);
+  }
   hip::GraphNode* clonedNode = reinterpret_cast<hip::GraphExec*>(hGraphExec)->GetClonedNode(n);
   if (clonedNode == nullptr) {
     HIP_RETURN(hipErrorInvalidValue);
@@ -3383,11 +3381,19 @@ hipError_t hipGraphExecNodeSetParams(hipGraphExec_t graphExec, hipGraphNode_t no
       !hip::GraphNode::isNodeValid(n)) {
     HIP_RETURN(hipErrorInvalidValue);
   }
+  if (reinterpret_cast<hip::GraphExec*>(graphExec)->IsOptimizedNode(n)) {
+    HIP_RETURN(hipErrorNotSupported);
+  }
   hip::GraphNode* clonedNode = reinterpret_cast<hip::GraphNode*>(
       reinterpret_cast<hip::GraphExec*>(graphExec)->GetClonedNode(n));
   if (clonedNode == nullptr) {
     HIP_RETURN(hipErrorInvalidValue);
   }
+  if ((clonedNode->GetType() == hipGraphNodeTypeEventRecord ||
+       clonedNode->GetType() == hipGraphNodeTypeWaitEvent) &&
+      reinterpret_cast<hip::GraphExec*>(graphExec)->IsOptimized()) {
+    HIP_RETURN(hipErrorNotSupported);
+  }
 
   hipError_t status = ihipGraphNodeSetParams(clonedNode, nodeParams);
   if (status != hipSuccess) {
@@ -3467,6 +3473,9 @@ hipError_t hipGraphExecBatchMemOpNodeSetParams(hipGraphExec_t hGraphExec,
       !hip::GraphNode::isNodeValid(n) || nodeParams == nullptr) {
     HIP_RETURN(hipErrorInvalidValue);
   }
+  if (reinterpret_cast<hip::GraphExec*>(graphExec)->IsOptimizedNode(n)) {
+    HIP_RETURN(hipErrorNotSupported);
+  }
   hip::GraphNode* clonedNode = reinterpret_cast<hip::GraphExec*>(graphExec)->GetClonedNode(n);
   if (clonedNode == nullptr) {
     HIP_RETURN(hipErrorInvalidValue);
@@ -19,6 +19,7 @@
  THE SOFTWARE. */
 
 #include "hip_graph_internal.hpp"
+#include "utils/listscheduler.hpp"
 #include <queue>
 
 #define CASE_STRING(X, C)                                                                          \
@@ -48,6 +49,15 @@ const char* GetGraphNodeTypeString(uint32_t op) {
   };
   return case_string;
 };
+
+// Key of the instantiation cache: the structure of the graph and the instantiation options
+uint64_t InstantiateKey(const amd::GraphSignature& signature, uint64_t flags, int device) {
+  amd::GraphHash hash;
+  hash.add(signature.hash());
+  hash.add(flags);
+  hash.add(device);
+  return hash.value();
+}
 }
 
 namespace hip {
@@ -64,6 +74,9 @@ std::unordered_set<GraphExec*> GraphExec::graphExecSet_;
 // Guards global exec graph set
 // we have graphExec object as part of child graph and we need recursive lock
 amd::Monitor GraphExec::graphExecSetLock_(true);
+amd::HashPool<GraphExec*>* GraphExec::instantiateCache_ = nullptr;
+// Guards the instantiation cache
+amd::Monitor GraphExec::instantiateCacheLock_{};
 std::unordered_set<UserObject*> UserObject::ObjectSet_;
 // Guards global user object
 amd::Monitor UserObject::UserObjectLock_{};
@@ -206,13 +219,183 @@ void Graph::ScheduleOneNode(Node node, int stream_id) {
 }
 
 // ================================================================================================
-void Graph::ScheduleNodes() {
+bool Graph::ScheduleCriticalPath() {
+  // Estimated cost of a signal between streams in us
+  constexpr double kSignalCost = 5.0;
+  std::unordered_map<Node, size_t> index;
+  index.reserve(vertices_.size());
+  for (size_t i = 0; i < vertices_.size(); ++i) {
+    index[vertices_[i]] = i;
+  }
+  amd::ListScheduler scheduler(vertices_.size());
+  for (size_t i = 0; i < vertices_.size(); ++i) {
+    auto node = vertices_[i];
+    // Process child graph first, since its cost depends on the schedule
+    if (node->GetType() == hipGraphNodeTypeGraph) {
+      auto child = reinterpret_cast<hip::ChildGraphNode*>(node)->GetChildGraph();
+      child->ScheduleNodes(GraphScheduler::CriticalPath);
+      max_streams_ = std::max(max_streams_, child->max_streams_);
+      if (child->max_streams_ == 1) {
+        reinterpret_cast<hip::ChildGraphNode*>(node)->GraphExec::TopologicalOrder();
+      }
+    }
+    scheduler.setCost(i, node->Cost());
+    for (auto edge : node->GetEdges()) {
+      auto it = index.find(edge);
+      if (it == index.end()) {
+        return false;
+      }
+      scheduler.addEdge(i, it->second);
+    }
+  }
+  amd::ListScheduler::Result result;
+  if (!scheduler.schedule(DEBUG_HIP_FORCE_GRAPH_QUEUES, kSignalCost, &result)) {
+    return false;
+  }
+  max_streams_ = std::max(max_streams_, static_cast<int>(result.numQueues_));
+  schedule_length_ = result.makespan_;
+  schedule_order_.reserve(vertices_.size());
+  for (auto i : result.order_) {
+    auto node = vertices_[i];
+    node->stream_id_ = result.queue_[i];
+    // Root nodes on the parallel streams must wait for the launch stream
+    if ((node->GetDependencies().size() == 0) && (node->stream_id_ != 0) &&
+        (roots_[node->stream_id_] == nullptr)) {
+      roots_[node->stream_id_] = node;
+    }
+    schedule_order_.push_back(node);
+  }
+  ClPrint(amd::LOG_INFO, amd::LOG_CODE, "[hipGraph] Critical path schedule: %zu nodes, "
+          "%u streams, %zu cross stream edges, %.1f us", vertices_.size(), result.numQueues_,
+          result.crossEdges_, result.makespan_);
+  return true;
+}
+
+// ================================================================================================
+void Graph::Optimize(uint32_t passes) {
+  if ((passes == 0) || vertices_.empty()) {
+    return;
+  }
+  // Work on a copy, the removed nodes leave vertices_
+  const std::vector<Node> nodes = vertices_;
+  std::unordered_map<Node, size_t> index;
+  index.reserve(nodes.size());
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    index[nodes[i]] = i;
+  }
+  amd::GraphOptimizer optimizer(nodes.size());
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    nodes[i]->Describe(&optimizer.node(i));
+    for (auto edge : nodes[i]->GetEdges()) {
+      auto it = index.find(edge);
+      if (it == index.end()) {
+        return;
+      }
+      optimizer.addEdge(i, it->second);
+    }
+  }
+  amd::GraphOptimizer::Stats stats;
+  if (!optimizer.optimize(passes, &stats) || !stats.changed()) {
+    return;
+  }
+
+  // The removed nodes and the nodes that absorbed others don't match the user nodes anymore
+  std::unordered_set<Node> changed;
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    if (optimizer.removed(i)) {
+      changed.insert(nodes[i]);
+      size_t target = optimizer.mergedInto(i);
+      if (target != amd::GraphOptimizer::kNone) {
+        changed.insert(nodes[target]);
+      }
+    }
+  }
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    if (optimizer.removed(i)) {
+      continue;
+    }
+    if (changed.find(nodes[i]) != changed.end()) {
+      nodes[i]->Coalesce(optimizer.node(i));
+    }
+    const std::vector<size_t>& successors = optimizer.successors(i);
+    std::vector<Node> edges = nodes[i]->GetEdges();
+    for (auto edge : edges) {
+      if (std::none_of(successors.begin(), successors.end(),
+                       [&](size_t s) { return nodes[s] == edge; })) {
+        nodes[i]->RemoveEdgeDep(edge);
+      }
+    }
+    for (auto s : successors) {
+      if (std::find(edges.begin(), edges.end(), nodes[s]) == edges.end()) {
+        nodes[i]->AddEdgeDep(nodes[s]);
+      }
+    }
+  }
+  for (const auto& entry : clonedNodes_) {
+    if (changed.find(entry.second) != changed.end()) {
+      optimizedNodes_.insert(entry.first);
+    }
+  }
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    if (optimizer.removed(i)) {
+      RemoveNode(nodes[i]);
+    }
+  }
+  optimized_ = true;
+  ClPrint(amd::LOG_INFO, amd::LOG_CODE, "[hipGraph] Optimized %zu nodes, %zu edges: removed "
+          "%zu edges, %zu empty nodes, %zu event waits, coalesced %zu memsets, %zu memcpys",
+          stats.nodes_, stats.edges_, stats.edgesRemoved_, stats.emptyNodesRemoved_,
+          stats.eventNodesRemoved_, stats.memsetsCoalesced_, stats.memcpysCoalesced_);
+}
+
+// ================================================================================================
+void Graph::Sign(const std::vector<Node>& order, amd::GraphSignature* signature) {
+  std::unordered_map<Node, size_t> index;
+  index.reserve(order.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    index[order[i]] = i;
+  }
+  signature->reset(order.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    Node node = order[i];
+    amd::GraphHash hash;
+    hash.add(node->GetType());
+    if (node->GetType() != hipGraphNodeTypeHost && node->GetType() != hipGraphNodeTypeEmpty) {
+      hash.add(node->GetParentGraph()->device_);
+    }
+    node->HashStructure(&hash);
+    signature->setNode(i, hash.value());
+    for (auto dep : node->GetDependencies()) {
+      // A dependency outside of the order never matches another graph
+      auto it = index.find(dep);
+      signature->addDependency(i, (it != index.end()) ? it->second : order.size());
+    }
+  }
+  signature->finalize();
+}
+
+// ================================================================================================
+void Graph::ScheduleNodes(GraphScheduler scheduler) {
   for (auto node : vertices_) {
     node->stream_id_ = -1;
     node->signal_is_required_ = false;
   }
   memset(&roots_[0], 0, sizeof(Node) * roots_.size());
   max_streams_ = 0;
+  schedule_order_.clear();
+  schedule_length_ = 0;
+  if ((scheduler == GraphScheduler::CriticalPath) && !vertices_.empty()) {
+    if (ScheduleCriticalPath()) {
+      return;
+    }
+    // Fall back to the depth-first scheduler
+    for (auto node : vertices_) {
+      node->stream_id_ = -1;
+    }
+    memset(&roots_[0], 0, sizeof(Node) * roots_.size());
+    max_streams_ = 0;
+    schedule_order_.clear();
+  }
   // Start processing all nodes in the graph to find async executions.
   int stream_id = 0;
   for (auto node : vertices_) {
@@ -449,6 +632,233 @@ hipError_t GraphExec::UpdateAQLPacket(hip::GraphNode* node) {
   return hipSuccess;
 }
 
+// ================================================================================================
+hipError_t GraphExec::Update(Graph* graph, GraphNode** errorNode,
+                             hipGraphExecUpdateResult* result) {
+  const uint64_t start = amd::Os::timeNanos();
+  *errorNode = nullptr;
+  std::vector<Node> newNodes;
+  graph->TopologicalOrder(newNodes);
+  if (newNodes.size() != topoOrder_.size()) {
+    *result = hipGraphExecUpdateErrorTopologyChanged;
+    return hipErrorGraphExecUpdateFailure;
+  }
+
+  amd::GraphSignature signature;
+  Sign(newNodes, &signature);
+  return UpdateNodes(newNodes, signature, start, errorNode, result);
+}
+
+// ================================================================================================
+hipError_t GraphExec::UpdateNodes(const std::vector<Node>& newNodes,
+                                  const amd::GraphSignature& signature, uint64_t start,
+                                  GraphNode** errorNode, hipGraphExecUpdateResult* result) {
+  // The topology of the executable graph never changes, so its signature is built once
+  if (signature_.hash() == 0) {
+    Sign(topoOrder_, &signature_);
+  }
+  const size_t mismatch = signature_.mismatch(signature);
+  if (mismatch != newNodes.size()) {
+    Node newNode = newNodes[mismatch];
+    Node oldNode = topoOrder_[mismatch];
+    *errorNode = newNode;
+    if (newNode->GetType() != oldNode->GetType()) {
+      *result = hipGraphExecUpdateErrorNodeTypeChanged;
+    } else if (signature_.description(mismatch) == signature.description(mismatch)) {
+      *result = hipGraphExecUpdateErrorTopologyChanged;
+    } else if (newNode->GetParentGraph()->device_ != oldNode->GetParentGraph()->device_) {
+      *result = hipGraphExecUpdateErrorUnsupportedFunctionChange;
+    } else {
+      // The memcpy kind or class, or the structure of a child graph changed
+      *result = hipGraphExecUpdateErrorParametersChanged;
+    }
+    return hipErrorGraphExecUpdateFailure;
+  }
+  // SetParams(GraphNode*) casts the node to its own class, so don't rely on the hashes alone
+  // before a reused or updated graph is patched
+  for (size_t i = 0; i < newNodes.size(); ++i) {
+    if (!topoOrder_[i]->IsSameClass(newNodes[i])) {
+      *errorNode = newNodes[i];
+      *result = hipGraphExecUpdateErrorNodeTypeChanged;
+      return hipErrorGraphExecUpdateFailure;
+    }
+  }
+  const uint64_t verified = amd::Os::timeNanos();
+
+  // Only the nodes with changed parameters are updated and captured again
+  size_t patched = 0;
+  for (size_t i = 0; i < newNodes.size(); ++i) {
+    uint64_t hash = newNodes[i]->ParamHash();
+    if (hash != 0 && hash == topoOrder_[i]->GetParamHash()) {
+      continue;
+    }
+    hipError_t status = topoOrder_[i]->SetParams(newNodes[i]);
+    if (status != hipSuccess) {
+      topoOrder_[i]->SetParamHash(0);
+      *errorNode = newNodes[i];
+      if (status == hipErrorInvalidDeviceFunction) {
+        *result = hipGraphExecUpdateErrorUnsupportedFunctionChange;
+      } else if (status == hipErrorInvalidValue || status == hipErrorInvalidDevicePointer) {
+        *result = hipGraphExecUpdateErrorParametersChanged;
+      } else {
+        *result = hipGraphExecUpdateErrorNotSupported;
+      }
+      return hipErrorGraphExecUpdateFailure;
+    }
+    topoOrder_[i]->SetParamHash(hash);
+    ++patched;
+    if (DEBUG_CLR_GRAPH_PACKET_CAPTURE && newNodes[i]->GraphCaptureEnabled()) {
+      UpdateAQLPacket(topoOrder_[i]);
+    }
+  }
+  const uint64_t end = amd::Os::timeNanos();
+
+  updateStats_.updates_++;
+  updateStats_.patched_ += patched;
+  updateStats_.skipped_ += newNodes.size() - patched;
+  updateStats_.verifyNs_ += verified - start;
+  updateStats_.patchNs_ += end - verified;
+  ClPrint(amd::LOG_INFO, amd::LOG_CODE, "[hipGraph] Updated %zu of %zu nodes, verify %.1f us, "
+          "patch %.1f us", patched, newNodes.size(), (verified - start) / 1000.0,
+          (end - verified) / 1000.0);
+  *result = hipGraphExecUpdateSuccess;
+  return hipSuccess;
+}
+
+// ================================================================================================
+size_t GraphExec::Footprint() const {
+  // Estimated host memory of a node with its commands and packets and of a parallel stream
+  constexpr size_t kNodeSize = 1 * Ki;
+  constexpr size_t kStreamSize = 64 * Ki;
+  size_t size = topoOrder_.size() * kNodeSize + parallel_streams_.size() * kStreamSize;
+  if (kernArgManager_ != nullptr) {
+    size += kernArgManager_->PoolSize();
+  }
+  return size;
+}
+
+// ================================================================================================
+bool GraphExec::Recycle() {
+  // A graph with launches in flight, user objects, memory nodes, disabled nodes or kernel
+  // attributes can't be reused
+  if (DEBUG_HIP_GRAPH_INSTANTIATE_CACHE == 0 || IsOptimized() || referenceCount() != 1 ||
+      !graphUserObj_.empty()) {
+    return false;
+  }
+  // The tag prefers a cached graph with the same parameters, then no node is updated
+  amd::GraphHash tag;
+  for (auto node : topoOrder_) {
+    if (node->GetType() == hipGraphNodeTypeMemAlloc ||
+        node->GetType() == hipGraphNodeTypeMemFree || !node->IsHashComplete()) {
+      return false;
+    }
+    tag.add(node->GetParamHash());
+  }
+  if (signature_.hash() == 0) {
+    Sign(topoOrder_, &signature_);
+  }
+  const uint64_t key = InstantiateKey(signature_, flags_, instantiateDeviceId_);
+  {
+    // The cached graph is invalid for the application until it's reused
+    amd::ScopedLock lock(graphExecSetLock_);
+    graphExecSet_.erase(this);
+  }
+  std::vector<GraphExec*> evicted;
+  bool cached = false;
+  {
+    amd::ScopedLock lock(instantiateCacheLock_);
+    if (instantiateCache_ == nullptr) {
+      instantiateCache_ = new amd::HashPool<GraphExec*>(DEBUG_HIP_GRAPH_INSTANTIATE_CACHE * Mi);
+    }
+    cached = instantiateCache_->insert(key, tag.value(), Footprint(), this, &evicted);
+  }
+  for (auto exec : evicted) {
+    exec->release();
+  }
+  if (!cached) {
+    amd::ScopedLock lock(graphExecSetLock_);
+    graphExecSet_.insert(this);
+  }
+  return cached;
+}
+
+// ================================================================================================
+GraphExec* GraphExec::Reuse(Graph* graph, uint64_t flags) {
+  if (DEBUG_HIP_GRAPH_INSTANTIATE_CACHE == 0 || !graph->graphUserObj_.empty()) {
+    return nullptr;
+  }
+  const uint64_t start = amd::Os::timeNanos();
+  std::vector<Node> nodes;
+  if (!graph->TopologicalOrder(nodes)) {
+    return nullptr;
+  }
+  amd::GraphSignature signature;
+  Sign(nodes, &signature);
+  amd::GraphHash tag;
+  for (auto node : nodes) {
+    if (!node->IsHashComplete()) {
+      return nullptr;
+    }
+    tag.add(node->ParamHash());
+  }
+  const uint64_t key = InstantiateKey(signature, flags, hip::getCurrentDevice()->deviceId());
+  GraphExec* exec = nullptr;
+  amd::HashPool<GraphExec*>::Stats stats;
+  {
+    amd::ScopedLock lock(instantiateCacheLock_);
+    if (instantiateCache_ != nullptr) {
+      instantiateCache_->take(key, tag.value(), &exec);
+      stats = instantiateCache_->stats();
+    }
+  }
+  if (exec == nullptr) {
+    return nullptr;
+  }
+  // Patch the parameters, which differ from the cached graph
+  GraphNode* errorNode = nullptr;
+  hipGraphExecUpdateResult result;
+  if (exec->UpdateNodes(nodes, signature, start, &errorNode, &result) != hipSuccess) {
+    exec->release();
+    return nullptr;
+  }
+  // The user nodes map to the executable nodes at the same topological positions
+  exec->clonedNodes_.clear();
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    exec->clonedNodes_[nodes[i]] = exec->topoOrder_[i];
+  }
+  exec->pOriginalGraph_ = graph;
+  {
+    amd::ScopedLock lock(graphExecSetLock_);
+    graphExecSet_.insert(exec);
+  }
+  ClPrint(amd::LOG_INFO, amd::LOG_CODE, "[hipGraph] Reused executable graph %p, cache hits %llu "
+          "(%llu exact), misses %llu", exec, static_cast<unsigned long long>(stats.hits_),
+          static_cast<unsigned long long>(stats.exactHits_),
+          static_cast<unsigned long long>(stats.misses_));
+  return exec;
+}
+
+// ================================================================================================
+void GraphExec::ClearInstantiateCache() {
+  std::vector<GraphExec*> removed;
+  {
+    amd::ScopedLock lock(instantiateCacheLock_);
+    if (instantiateCache_ != nullptr) {
+      instantiateCache_->clear(&removed);
+    }
+  }
+  for (auto exec : removed) {
+    exec->release();
+  }
+}
+
+// ================================================================================================
+amd::HashPool<GraphExec*>::Stats GraphExec::GetInstantiateCacheStats() {
+  amd::ScopedLock lock(instantiateCacheLock_);
+  return (instantiateCache_ != nullptr) ? instantiateCache_->stats()
+                                        : amd::HashPool<GraphExec*>::Stats();
+}
+
 // ================================================================================================
 
 void GraphExec::DecrementRefCount(cl_event event, cl_int command_exec_status, void* user_data) {
@@ -575,19 +985,22 @@ bool Graph::RunOneNode(Node node, bool wait) {
     // Assign the launch ID of the submmitted node
     // This is also applied to childGraphs to prevent them from being reprocessed
     node->launch_id_ = current_id_++;
-    uint32_t i = 0;
-    // Execute the nodes in the edges list
-    for (auto edge: node->GetEdges()) {
-      // Don't wait in the nodes, executed on the same streams and if it has just one dependency
-      bool wait = ((i < DEBUG_HIP_FORCE_GRAPH_QUEUES) ||
-                   (edge->GetDependencies().size() > 1)) ? true : false;
-      // Execute the edge node
-      if (!RunOneNode(edge, wait)) {
-        return false;
+    // The critical path scheduler submits the nodes in the schedule order
+    if (schedule_order_.empty()) {
+      uint32_t i = 0;
+      // Execute the nodes in the edges list
+      for (auto edge: node->GetEdges()) {
+        // Don't wait in the nodes, executed on the same streams and if it has just one dependency
+        bool wait = ((i < DEBUG_HIP_FORCE_GRAPH_QUEUES) ||
+                     (edge->GetDependencies().size() > 1)) ? true : false;
+        // Execute the edge node
+        if (!RunOneNode(edge, wait)) {
+          return false;
+        }
+        i++;
       }
-      i++;
     }
-    if (i == 0) {
+    if (node->GetEdges().empty()) {
       // Add a leaf node into the list for a wait.
       // Always use the last node, since it's the latest for the particular queue
       leafs_[node->stream_id_] = node;
@@ -639,7 +1052,7 @@ bool Graph::RunNodes(
   }
 
   // Run all commands in the graph
-  for (auto node : vertices_) {
+  for (auto node : schedule_order_.empty() ? vertices_ : schedule_order_) {
     if (node->launch_id_ == -1) {
       if (!RunOneNode(node, true)) {
         return false;
@@ -34,6 +34,9 @@
 #include "hip_platform.hpp"
 #include "hip_mempool_impl.hpp"
 #include "hip_vm.hpp"
+#include "utils/graphoptimizer.hpp"
+#include "utils/graphhash.hpp"
+#include "utils/hashpool.hpp"
 
 typedef struct ihipExtKernelEvents {
   hipEvent_t startEvent_;
@@ -46,6 +49,12 @@ struct GraphNode;
 struct GraphExec;
 struct UserObject;
 typedef GraphNode* Node;
+
+//! Scheduling policies of graph nodes on the parallel streams
+enum class GraphScheduler : uint32_t {
+  DepthFirst = 0,   //!< Depth-first walk with a round-robin stream assignment
+  CriticalPath = 1  //!< List scheduling by the critical path, based on the node costs
+};
 struct UserObject : public amd::ReferenceCountedObject {
   typedef void (*UserCallbackDestructor)(void* data);
   static std::unordered_set<UserObject*> ObjectSet_;
@@ -163,6 +172,15 @@ class GraphKernelArgManager : public amd::ReferenceCountedObject, public amd::Gr
   // Allocate kernel arg pool for the given size.
   bool AllocGraphKernargPool(size_t pool_size);
 
+  // Returns the total size of the kernel arg pools.
+  size_t PoolSize() const {
+    size_t size = 0;
+    for (const auto& element : kernarg_graph_) {
+      size += element.kernarg_pool_size_;
+    }
+    return size;
+  }
+
   // Allocate kernel args from current chunck for given size and alignment.
   // If kernel arg pool is full allocate new chunck and alloc kern args from new pool.
   address AllocKernArg(size_t size, size_t alignment) override;
@@ -207,6 +225,8 @@ struct GraphNode : public hipGraphNodeDOTAttribute {
   static amd::Monitor WorkerThreadLock_;
   unsigned int isEnabled_;
   bool signal_is_required_ = false; //!< This node requires a signal on the command
+  double recorded_cost_ = 0;        //!< Recorded execution time in us, 0 if unknown
+  uint64_t param_hash_ = 0;         //!< Cached ParamHash() of an executable node, 0 if unknown
   std::vector<uint8_t *> gpuPackets_; //!< GPU Packet to enqueue during graph launch
   std::string capturedKernelName_;
   size_t alignedKernArgSize_ = 256;       //!< Aligned size required for kernel args
@@ -238,6 +258,7 @@ struct GraphNode : public hipGraphNodeDOTAttribute {
     amd::ScopedLock lock(nodeSetLock_);
     nodeSet_.insert(this);
     isEnabled_ = node.isEnabled_;
+    recorded_cost_ = node.recorded_cost_;
   }
 
   virtual ~GraphNode() {
@@ -428,6 +449,47 @@ struct GraphNode : public hipGraphNodeDOTAttribute {
   }
   unsigned int GetEnabled() const { return isEnabled_; }
   void SetEnabled(unsigned int isEnabled) { isEnabled_ = isEnabled; }
+  /// Estimated execution time of the node in us, used for the critical path scheduling
+  virtual double EstimateCost() const { return 2.0; }
+  /// Returns the recorded execution time if available, otherwise the estimation
+  double Cost() const { return (recorded_cost_ > 0) ? recorded_cost_ : EstimateCost(); }
+  /// Records the measured execution time in us for the next instantiation of the graph
+  void SetRecordedCost(double cost) { recorded_cost_ = cost; }
+  /// Describes the node to the graph optimizer, other nodes are never changed or removed
+  virtual void Describe(amd::GraphOptimizer::Node* desc) const {}
+  /// Applies the range of the coalesced nodes from the graph optimizer
+  virtual void Coalesce(const amd::GraphOptimizer::Node& desc) {}
+  /// Adds the node properties that hipGraphExecUpdate can't change to the structural hash
+  virtual void HashStructure(amd::GraphHash* hash) const {}
+  /// Subclasses of the nodes, which share the memcpy type
+  enum Subclass : uint32_t {
+    kSubclassNone = 0,
+    kSubclassMemcpy3D,
+    kSubclassMemcpy1D,
+    kSubclassMemcpyFromSymbol,
+    kSubclassMemcpyToSymbol,
+    kSubclassDrvMemcpy
+  };
+  /// Returns the concrete subclass of the node, if the node type has several
+  virtual Subclass GetSubclass() const { return kSubclassNone; }
+  /// Returns true if SetParams(GraphNode*) can take the parameters of the node
+  bool IsSameClass(const GraphNode* node) const {
+    return (GetType() == node->GetType()) && (GetSubclass() == node->GetSubclass());
+  }
+  /// Hash of the parameters applied by SetParams(GraphNode*), 0 if the node can't be hashed
+  virtual uint64_t ParamHash() const { return 0; }
+  /// Returns the cached parameter hash of an executable node
+  uint64_t GetParamHash() {
+    if (param_hash_ == 0) {
+      param_hash_ = ParamHash();
+    }
+    return param_hash_;
+  }
+  /// Updates the cached parameter hash, 0 invalidates it after a change of the parameters
+  void SetParamHash(uint64_t hash) { param_hash_ = hash; }
+  /// Returns true if the parameter hash covers all state of the node, which an instantiation
+  /// depends on. A disabled executable node can't be passed to another instantiation
+  virtual bool IsHashComplete() const { return isEnabled_ != 0; }
   // Returns true if capture is enabled for the current node.
   virtual bool GraphCaptureEnabled() {
     bool isGraphCapture = false;
@@ -485,6 +547,9 @@ struct Graph {
   //!< to reduce the stack pressure in recursion
   std::vector<Node> wait_order_;
   std::vector<hip::Stream*> streams_; //!< The list of streams, used in the execution
+  //!< Submission order of the critical path scheduler, empty for the depth-first scheduler
+  std::vector<Node> schedule_order_;
+  double schedule_length_ = 0;  //!< Estimated execution time of the scheduled graph in us
   int32_t current_id_ = 0;    //!< The current node ID in the graph execution sequence
   hip::Device* device_;       //!< HIP device object
   hip::MemoryPool* mem_pool_; //!< Memory pool, associated with this graph
@@ -492,6 +557,9 @@ struct Graph {
   bool graphInstantiated_;
   std::unordered_set<void*> memAllocNodePtrs_;
   std::unordered_map<Node, Node> clonedNodes_;
+  //!< The user nodes, which the optimization passes removed or coalesced with other nodes
+  std::unordered_set<Node> optimizedNodes_;
+  bool optimized_ = false;  //!< The optimization passes changed the graph
  public:
   Graph(hip::Device* device, const Graph* original = nullptr)
       : pOriginalGraph_(original)
@@ -614,7 +682,24 @@ struct Graph {
     );
 
   //! Schedules all nodes in the graph into different streams
-  void ScheduleNodes();
+  void ScheduleNodes(GraphScheduler scheduler = GraphScheduler::DepthFirst);
+
+  //! Schedules all nodes by the critical path. Returns false if scheduling failed
+  bool ScheduleCriticalPath();
+
+  //! Runs the graph optimization passes, a mask of amd::GraphOptimizer::Pass
+  void Optimize(uint32_t passes);
+
+  //! Returns true if the optimization passes changed the graph
+  bool IsOptimized() const { return optimized_; }
+
+  //! Returns true if the optimization passes removed the user node or coalesced it
+  bool IsOptimizedNode(Node node) const {
+    return optimizedNodes_.find(node) != optimizedNodes_.end();
+  }
+
+  //! Builds the structural signature of the nodes in a topological order
+  static void Sign(const std::vector<Node>& order, amd::GraphSignature* signature);
 
   //! Update streams for the graph execution
   void UpdateStreams(
@@ -737,8 +822,21 @@ struct GraphExec : public amd::ReferenceCountedObject, public Graph {
   int instantiateDeviceId_ = -1;
   bool hasHiddenHeap_ = false;  //!< Hidden heap indicator for Kernel node
   bool repeatLaunch_ = false;
+  amd::GraphSignature signature_;  //!< Structure of topoOrder_, built on the first update
+  //! Destroyed executable graphs, which can be reused by the instantiation
+  static amd::HashPool<GraphExec*>* instantiateCache_;
+  static amd::Monitor instantiateCacheLock_;
 
  public:
+  //! Statistics of hipGraphExecUpdate on this graph
+  struct UpdateStats {
+    uint64_t updates_ = 0;    //!< The number of successful updates
+    uint64_t patched_ = 0;    //!< Nodes updated with new parameters
+    uint64_t skipped_ = 0;    //!< Nodes with unchanged parameters
+    uint64_t verifyNs_ = 0;   //!< Time of the topology checks in ns
+    uint64_t patchNs_ = 0;    //!< Time of the parameter updates in ns
+  };
+
   GraphExec(uint64_t flags = 0)
       : ReferenceCountedObject(),
         Graph(hip::getCurrentDevice()),
@@ -765,11 +863,14 @@ struct GraphExec : public amd::ReferenceCountedObject, public Graph {
 
   Node GetClonedNode(Node node) {
     Node clonedNode;
-    if (clonedNodes_.find(node) == clonedNodes_.end()) {
+    // The executable nodes of the optimized user nodes may be released
+    if ((clonedNodes_.find(node) == clonedNodes_.end()) || IsOptimizedNode(node)) {
       return nullptr;
     } else {
       clonedNode = clonedNodes_[node];
     }
+    // The callers may change the parameters of the executable node
+    clonedNode->SetParamHash(0);
     return clonedNode;
   }
 
@@ -802,6 +903,27 @@ struct GraphExec : public amd::ReferenceCountedObject, public Graph {
   void GetKernelArgSizeForGraph(size_t& kernArgSizeForGraph);
   hipError_t EnqueueGraphWithSingleList(hip::Stream* hip_stream);
   bool TopologicalOrder() { return Graph::TopologicalOrder(topoOrder_); }
+  //! Updates the parameters from a graph with the same topology, see hipGraphExecUpdate
+  hipError_t Update(Graph* graph, GraphNode** errorNode, hipGraphExecUpdateResult* result);
+  const UpdateStats& GetUpdateStats() const { return updateStats_; }
+
+  //! Moves a destroyed graph to the instantiation cache, returns false if it can't be reused
+  bool Recycle();
+  //! Returns a cached executable graph updated to the graph, nullptr on a miss
+  static GraphExec* Reuse(Graph* graph, uint64_t flags);
+  //! Releases all cached executable graphs
+  static void ClearInstantiateCache();
+  //! Returns the hit and miss counters of the instantiation cache
+  static amd::HashPool<GraphExec*>::Stats GetInstantiateCacheStats();
+
+ private:
+  //! Updates the nodes from the nodes of a graph in the topological order
+  hipError_t UpdateNodes(const std::vector<Node>& newNodes, const amd::GraphSignature& signature,
+                         uint64_t start, GraphNode** errorNode, hipGraphExecUpdateResult* result);
+  //! Estimated host and device memory of the executable graph
+  size_t Footprint() const;
+
+  UpdateStats updateStats_;
 };
 
 struct ChildGraphNode : public GraphNode, public GraphExec {
@@ -823,6 +945,8 @@ struct ChildGraphNode : public GraphNode, public GraphExec {
 
   Graph* GetChildGraph() override { return this; }
 
+  double EstimateCost() const override { return std::max(schedule_length_, 2.0); }
+
   void SetGraphCaptureStatus(bool status) { graphCaptureStatus_ = status; }
 
   bool GetGraphCaptureStatus() { return graphCaptureStatus_; }
@@ -855,7 +979,14 @@ struct ChildGraphNode : public GraphNode, public GraphExec {
   hipError_t SetParams(const Graph* childGraph) {
     const std::vector<Node>& newNodes = childGraph->GetNodes();
     const std::vector<Node>& oldNodes = Graph::GetNodes();
+    if (newNodes.size() != oldNodes.size()) {
+      return hipErrorInvalidValue;
+    }
     for (std::vector<Node>::size_type i = 0; i != newNodes.size(); i++) {
+      // SetParams(GraphNode*) expects a node of its own class
+      if (!oldNodes[i]->IsSameClass(newNodes[i])) {
+        return hipErrorInvalidValue;
+      }
       hipError_t status = oldNodes[i]->SetParams(newNodes[i]);
       if (status != hipSuccess) {
         return status;
@@ -866,7 +997,26 @@ struct ChildGraphNode : public GraphNode, public GraphExec {
 
   hipError_t SetParams(GraphNode* node) override {
     const ChildGraphNode* childGraphNode = static_cast<ChildGraphNode const*>(node);
-    return SetParams((Graph*)this);
+    return SetParams(static_cast<const Graph*>(childGraphNode));
+  }
+
+  void HashStructure(amd::GraphHash* hash) const override {
+    // The node types, the memcpy kinds and the edges of the child graph
+    amd::GraphSignature signature;
+    Graph::Sign(Graph::GetNodes(), &signature);
+    hash->add(signature.hash());
+  }
+
+  uint64_t ParamHash() const override {
+    amd::GraphHash hash;
+    for (auto node : Graph::GetNodes()) {
+      uint64_t nodeHash = node->ParamHash();
+      if (nodeHash == 0) {
+        return 0;
+      }
+      hash.add(nodeHash);
+    }
+    return hash.value();
   }
 
   virtual std::string GetLabel(hipGraphDebugDotFlags flag) override {
@@ -886,6 +1036,7 @@ class GraphKernelNode : public GraphNode {
   ihipExtKernelEvents kernelEvents_;   //!< Events for Ext launch kernel
   bool hasHiddenHeap_;                 //!< Kernel has hidden heap(device side allocation)
   int coopKernel_;                     //!< Launch cooperative kernel
+  const amd::KernelSignature* signature_ = nullptr;  //!< Signature of the kernel params
 
  public:
   bool HasHiddenHeap() const { return hasHiddenHeap_; }
@@ -902,11 +1053,8 @@ class GraphKernelNode : public GraphNode {
       command->release();
       return;
     }
+    // The arguments were captured in the commands, no function lock is needed
     for (auto& command : commands_) {
-      hipFunction_t func = getFunc(kernelParams_, ihipGetDevice());
-      hip::DeviceFunc* function = hip::DeviceFunc::asFunction(func);
-      amd::Kernel* kernel = function->kernel();
-      amd::ScopedLock lock(function->dflock_);
       command->enqueue();
       command->release();
     }
@@ -1023,6 +1171,7 @@ class GraphKernelNode : public GraphNode {
     }
     const amd::KernelSignature& signature = kernel->signature();
     numParams_ = signature.numParameters();
+    signature_ = &signature;
 
     // Copy gridDim, blockDim, sharedMemBytes and func
     kernelParams_ = *pNodeParams;
@@ -1145,9 +1294,6 @@ class GraphKernelNode : public GraphNode {
     if (!func) {
       return hipErrorInvalidDeviceFunction;
     }
-    hip::DeviceFunc* function = hip::DeviceFunc::asFunction(func);
-    amd::Kernel* kernel = function->kernel();
-    amd::ScopedLock lock(function->dflock_);
     hipError_t status = validateKernelParams(&kernelParams_, func, devID);
     if (hipSuccess != status) {
       return status;
@@ -1186,6 +1332,15 @@ class GraphKernelNode : public GraphNode {
 
   void GetParams(hipKernelNodeParams* params) { *params = kernelParams_; }
 
+  double EstimateCost() const override {
+    // Launch overhead and roughly one us per 64K work-items
+    const dim3& grid = kernelParams_.gridDim;
+    const dim3& block = kernelParams_.blockDim;
+    double work_items = static_cast<double>(grid.x) * grid.y * grid.z *
+                        block.x * block.y * block.z;
+    return 4.0 + work_items / (64 * Ki);
+  }
+
   hipError_t SetParams(const hipKernelNodeParams* params) {
     hipFunction_t func = getFunc(kernelParams_, ihipGetDevice());
     if (!func) {
@@ -1272,6 +1427,10 @@ class GraphKernelNode : public GraphNode {
     }
     return hipSuccess;
   }
+  bool IsHashComplete() const override {
+    // The kernel attributes aren't hashed
+    return (kernelAttrInUse_ == 0) && GraphNode::IsHashComplete();
+  }
   hipError_t CopyAttr(const GraphKernelNode* srcNode) {
     if (kernelAttrInUse_ == 0 && srcNode->kernelAttrInUse_ == 0) {
       return hipSuccess;
@@ -1306,6 +1465,27 @@ class GraphKernelNode : public GraphNode {
     return SetParams(&kernelNode->kernelParams_);
   }
 
+  uint64_t ParamHash() const override {
+    amd::GraphHash hash;
+    hash.add(kernelParams_.func);
+    hash.add(kernelParams_.gridDim);
+    hash.add(kernelParams_.blockDim);
+    hash.add(kernelParams_.sharedMemBytes);
+    if (kernelParams_.kernelParams != nullptr) {
+      if (signature_ == nullptr) {
+        return 0;
+      }
+      for (uint32_t i = 0; i < numParams_; ++i) {
+        hash.add(kernelParams_.kernelParams[i], signature_->at(i).size_);
+      }
+    } else if (kernelParams_.extra != nullptr) {
+      size_t kernargs_size = *reinterpret_cast<size_t*>(kernelParams_.extra[3]);
+      hash.add(kernargs_size);
+      hash.add(kernelParams_.extra[1], kernargs_size);
+    }
+    return hash.value();
+  }
+
   static hipError_t validateKernelParams(const hipKernelNodeParams* pNodeParams,
                                          hipFunction_t func, int devId) {
     size_t globalWorkSizeX = static_cast<size_t>(pNodeParams->gridDim.x) * pNodeParams->blockDim.x;
@@ -1376,6 +1556,12 @@ class GraphMemcpyNode : public GraphNode {
     std::memcpy(params, &copyParams_, sizeof(hipMemcpy3DParms));
   }
 
+  double EstimateCost() const override {
+    // Copy overhead and the transfer at about 50GB/s
+    const hipExtent& extent = copyParams_.extent;
+    return 4.0 + static_cast<double>(extent.width) * extent.height * extent.depth / (50 * Ki);
+  }
+
   virtual hipMemcpyKind GetMemcpyKind() const { return copyParams_.kind; };
 
   hipError_t SetParams(const hipMemcpy3DParms* params) {
@@ -1391,6 +1577,23 @@ class GraphMemcpyNode : public GraphNode {
     const GraphMemcpyNode* memcpyNode = static_cast<GraphMemcpyNode const*>(node);
     return SetParams(&memcpyNode->copyParams_);
   }
+  Subclass GetSubclass() const override { return kSubclassMemcpy3D; }
+  void HashStructure(amd::GraphHash* hash) const override {
+    hash->add(GetSubclass());
+    hash->add(GetMemcpyKind());
+  }
+  uint64_t ParamHash() const override {
+    amd::GraphHash hash;
+    hash.add(copyParams_.srcArray);
+    hash.add(copyParams_.srcPos);
+    hash.add(copyParams_.srcPtr);
+    hash.add(copyParams_.dstArray);
+    hash.add(copyParams_.dstPos);
+    hash.add(copyParams_.dstPtr);
+    hash.add(copyParams_.extent);
+    hash.add(copyParams_.kind);
+    return hash.value();
+  }
   // ToDo: use this when commands are cloned and command params are to be updated
   hipError_t ValidateParams(const hipMemcpy3DParms* pNodeParams);
 
@@ -1513,6 +1716,30 @@ class GraphMemcpyNode1D : public GraphMemcpyNode {
     return new GraphMemcpyNode1D(static_cast<GraphMemcpyNode1D const&>(*this));
   }
 
+  Subclass GetSubclass() const override { return kSubclassMemcpy1D; }
+
+  double EstimateCost() const override { return 4.0 + static_cast<double>(count_) / (50 * Ki); }
+
+  void Describe(amd::GraphOptimizer::Node* desc) const override {
+    if (!isEnabled_) {
+      return;
+    }
+    size_t offset = 0;
+    desc->kind_ = amd::GraphOptimizer::Kind::Memcpy;
+    desc->dst_ = reinterpret_cast<uintptr_t>(dst_);
+    desc->src_ = reinterpret_cast<uintptr_t>(src_);
+    desc->size_ = count_;
+    desc->mode_ = static_cast<uint32_t>(kind_);
+    desc->dstRegion_ = getMemoryObject(dst_, offset);
+    desc->srcRegion_ = getMemoryObject(src_, offset);
+  }
+
+  void Coalesce(const amd::GraphOptimizer::Node& desc) override {
+    dst_ = reinterpret_cast<void*>(desc.dst_);
+    src_ = reinterpret_cast<const void*>(desc.src_);
+    count_ = desc.size_;
+  }
+
   virtual hipError_t CreateCommand(hip::Stream* stream) override {
     if ((kind_ == hipMemcpyHostToHost || kind_ == hipMemcpyDefault) && IsHtoHMemcpy(dst_, src_)) {
       return hipSuccess;
@@ -1621,6 +1848,14 @@ class GraphMemcpyNode1D : public GraphMemcpyNode {
     return SetParams(memcpy1DNode->dst_, memcpy1DNode->src_, memcpy1DNode->count_,
                      memcpy1DNode->kind_);
   }
+  uint64_t ParamHash() const override {
+    amd::GraphHash hash;
+    hash.add(dst_);
+    hash.add(src_);
+    hash.add(count_);
+    hash.add(kind_);
+    return hash.value();
+  }
   static hipError_t ValidateParams(void* dst, const void* src, size_t count, hipMemcpyKind kind);
   virtual std::string GetLabel(hipGraphDebugDotFlags flag) override {
     size_t sOffsetOrig = 0;
@@ -1704,11 +1939,16 @@ class GraphMemcpyNodeFromSymbol : public GraphMemcpyNode1D {
 
   ~GraphMemcpyNodeFromSymbol() {}
 
+  Subclass GetSubclass() const override { return kSubclassMemcpyFromSymbol; }
+
   GraphNode* clone() const override {
     return new GraphMemcpyNodeFromSymbol(
         static_cast<GraphMemcpyNodeFromSymbol const&>(*this));
   }
 
+  // The symbol is resolved at the command creation, so the copy isn't coalesced
+  void Describe(amd::GraphOptimizer::Node* desc) const override {}
+
   virtual hipError_t CreateCommand(hip::Stream* stream) override {
     hipError_t status = GraphNode::CreateCommand(stream);
     if (status != hipSuccess) {
@@ -1783,6 +2023,15 @@ class GraphMemcpyNodeFromSymbol : public GraphMemcpyNode1D {
     return SetParams(memcpyNode->dst_, memcpyNode->symbol_, memcpyNode->count_, memcpyNode->offset_,
                      memcpyNode->kind_);
   }
+  uint64_t ParamHash() const override {
+    amd::GraphHash hash;
+    hash.add(dst_);
+    hash.add(symbol_);
+    hash.add(count_);
+    hash.add(offset_);
+    hash.add(kind_);
+    return hash.value();
+  }
 };
 class GraphMemcpyNodeToSymbol : public GraphMemcpyNode1D {
   const void* symbol_;
@@ -1797,10 +2046,15 @@ class GraphMemcpyNodeToSymbol : public GraphMemcpyNode1D {
 
   ~GraphMemcpyNodeToSymbol() {}
 
+  Subclass GetSubclass() const override { return kSubclassMemcpyToSymbol; }
+
   GraphNode* clone() const override {
     return new GraphMemcpyNodeToSymbol(static_cast<GraphMemcpyNodeToSymbol const&>(*this));
   }
 
+  // The symbol is resolved at the command creation, so the copy isn't coalesced
+  void Describe(amd::GraphOptimizer::Node* desc) const override {}
+
   virtual hipError_t CreateCommand(hip::Stream* stream) override {
     hipError_t status = GraphNode::CreateCommand(stream);
     if (status != hipSuccess) {
@@ -1880,6 +2134,15 @@ class GraphMemcpyNodeToSymbol : public GraphMemcpyNode1D {
     return SetParams(memcpyNode->src_, memcpyNode->symbol_, memcpyNode->count_, memcpyNode->offset_,
                      memcpyNode->kind_);
   }
+  uint64_t ParamHash() const override {
+    amd::GraphHash hash;
+    hash.add(src_);
+    hash.add(symbol_);
+    hash.add(count_);
+    hash.add(offset_);
+    hash.add(kind_);
+    return hash.value();
+  }
 };
 class GraphMemsetNode : public GraphNode {
   hipMemsetParams memsetParams_;
@@ -1972,6 +2235,32 @@ class GraphMemsetNode : public GraphNode {
     std::memcpy(params, &memsetParams_, sizeof(hipMemsetParams));
   }
 
+  void Describe(amd::GraphOptimizer::Node* desc) const override {
+    // Only the enabled 1D fills can be coalesced
+    if (!isEnabled_ || memsetParams_.height != 1 || depth_ != 1) {
+      return;
+    }
+    size_t offset = 0;
+    desc->kind_ = amd::GraphOptimizer::Kind::Memset;
+    desc->dst_ = reinterpret_cast<uintptr_t>(memsetParams_.dst);
+    desc->size_ = memsetParams_.width * memsetParams_.elementSize;
+    desc->value_ = memsetParams_.value;
+    desc->elementSize_ = memsetParams_.elementSize;
+    desc->dstRegion_ = getMemoryObject(memsetParams_.dst, offset);
+  }
+
+  void Coalesce(const amd::GraphOptimizer::Node& desc) override {
+    memsetParams_.dst = reinterpret_cast<void*>(desc.dst_);
+    memsetParams_.width = desc.size_ / memsetParams_.elementSize;
+  }
+
+  double EstimateCost() const override {
+    // Fill overhead and the fill rate at about 500GB/s
+    double size = static_cast<double>(memsetParams_.width) * memsetParams_.height * depth_ *
+                  memsetParams_.elementSize;
+    return 2.0 + size / (500 * Ki);
+  }
+
   void GetParams(HIP_MEMSET_NODE_PARAMS* params) {
     params->dst = memsetParams_.dst;
     params->elementSize = memsetParams_.elementSize;
@@ -2067,6 +2356,18 @@ class GraphMemsetNode : public GraphNode {
     const GraphMemsetNode* memsetNode = static_cast<GraphMemsetNode const*>(node);
     return SetParams(&memsetNode->memsetParams_, false, memsetNode->depth_);
   }
+
+  uint64_t ParamHash() const override {
+    amd::GraphHash hash;
+    hash.add(memsetParams_.dst);
+    hash.add(memsetParams_.elementSize);
+    hash.add(memsetParams_.height);
+    hash.add(memsetParams_.pitch);
+    hash.add(memsetParams_.value);
+    hash.add(memsetParams_.width);
+    hash.add(depth_);
+    return hash.value();
+  }
 };
 
 class GraphEventRecordNode : public GraphNode {
@@ -2082,6 +2383,11 @@ class GraphEventRecordNode : public GraphNode {
     return new GraphEventRecordNode(static_cast<GraphEventRecordNode const&>(*this));
   }
 
+  void Describe(amd::GraphOptimizer::Node* desc) const override {
+    desc->kind_ = amd::GraphOptimizer::Kind::EventRecord;
+    desc->event_ = event_;
+  }
+
   hipError_t CreateCommand(hip::Stream* stream) override {
     hipError_t status = GraphNode::CreateCommand(stream);
     if (status != hipSuccess) {
@@ -2121,6 +2427,12 @@ class GraphEventRecordNode : public GraphNode {
         static_cast<GraphEventRecordNode const*>(node);
     return SetParams(eventRecordNode->event_);
   }
+
+  uint64_t ParamHash() const override {
+    amd::GraphHash hash;
+    hash.add(event_);
+    return hash.value();
+  }
 };
 
 class GraphEventWaitNode : public GraphNode {
@@ -2136,6 +2448,11 @@ class GraphEventWaitNode : public GraphNode {
     return new GraphEventWaitNode(static_cast<GraphEventWaitNode const&>(*this));
   }
 
+  void Describe(amd::GraphOptimizer::Node* desc) const override {
+    desc->kind_ = amd::GraphOptimizer::Kind::EventWait;
+    desc->event_ = event_;
+  }
+
   hipError_t CreateCommand(hip::Stream* stream) override {
     hipError_t status = GraphNode::CreateCommand(stream);
     if (status != hipSuccess) {
@@ -2174,6 +2491,12 @@ class GraphEventWaitNode : public GraphNode {
     const GraphEventWaitNode* eventWaitNode = static_cast<GraphEventWaitNode const*>(node);
     return SetParams(eventWaitNode->event_);
   }
+
+  uint64_t ParamHash() const override {
+    amd::GraphHash hash;
+    hash.add(event_);
+    return hash.value();
+  }
 };
 
 class GraphHostNode : public GraphNode {
@@ -2243,6 +2566,13 @@ class GraphHostNode : public GraphNode {
     const GraphHostNode* hostNode = static_cast<GraphHostNode const*>(node);
     return SetParams(&hostNode->NodeParams_);
   }
+
+  uint64_t ParamHash() const override {
+    amd::GraphHash hash;
+    hash.add(NodeParams_.fn);
+    hash.add(NodeParams_.userData);
+    return hash.value();
+  }
 };
 
 // ================================================================================================
@@ -2255,6 +2585,12 @@ class GraphEmptyNode : public GraphNode {
     return new GraphEmptyNode(static_cast<GraphEmptyNode const&>(*this));
   }
 
+  void Describe(amd::GraphOptimizer::Node* desc) const override {
+    desc->kind_ = amd::GraphOptimizer::Kind::Empty;
+  }
+
+  uint64_t ParamHash() const override { return amd::GraphHash().value(); }
+
   hipError_t CreateCommand(hip::Stream* stream) override {
     hipError_t status = GraphNode::CreateCommand(stream);
     if (status != hipSuccess) {
@@ -2540,6 +2876,9 @@ class GraphDrvMemcpyNode : public GraphNode {
     return new GraphDrvMemcpyNode(static_cast<GraphDrvMemcpyNode const&>(*this));
   }
 
+  Subclass GetSubclass() const override { return kSubclassDrvMemcpy; }
+  void HashStructure(amd::GraphHash* hash) const override { hash->add(GetSubclass()); }
+
   hipError_t CreateCommand(hip::Stream* stream) override {
     if(copyParams_.srcMemoryType == hipMemoryTypeHost &&
        copyParams_.dstMemoryType == hipMemoryTypeHost &&
@@ -51,5 +51,18 @@ const char* hipApiName(uint32_t id) { return hip_api_name(id); }
 
 extern "C" void hipRegisterTracerCallback(int (*function)(activity_domain_t domain,
                                                           uint32_t operation_id, void* data)) {
+  // The buffered records belong to the previous callback
+  amd::activity_prof::FlushActivity();
   amd::activity_prof::report_activity.store(function, std::memory_order_relaxed);
 }
+
+// Receives the buffered records in batches, instead of the per record callback
+extern "C" void hipRegisterTracerBatchCallback(void (*function)(activity_domain_t domain,
+                                                               const activity_record_t* records,
+                                                               size_t count)) {
+  amd::activity_prof::FlushActivity();
+  amd::activity_prof::report_activity_batch.store(function, std::memory_order_relaxed);
+}
+
+// Delivers the buffered records, which were reported so far
+extern "C" void hipFlushTracerActivity() { amd::activity_prof::FlushActivity(); }
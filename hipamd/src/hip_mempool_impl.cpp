@@ -155,6 +155,10 @@ void Heap::RemoveStream(Stream* stream) {
 // ================================================================================================
 void Heap::SetAccess(hip::Device* device, bool enable) {
   for (const auto& it : allocations_) {
+    if (it.first.second->parent() != nullptr) {
+      // Suballocated blocks share access with the slab
+      continue;
+    }
     auto peer_device = device->asContext()->devices()[0];
     device::Memory* mem = it.first.second->getDeviceMemory(*peer_device);
     if (mem != nullptr) {
@@ -172,47 +176,316 @@ void Heap::SetAccess(hip::Device* device, bool enable) {
 }
 
 // ================================================================================================
-void* MemoryPool::AllocateMemory(size_t size, Stream* stream, void* dptr) {
-  amd::ScopedLock lock(lock_pool_ops_);
+void SubAllocator::Init(size_t max_size) {
+  // All block sizes are multiples of the minimal size to keep the same alignment as a regular
+  // allocation
+  constexpr size_t kMinBlockSize = 256;
+  constexpr size_t kSlabSize = 2 * Mi;
+  classes_.init(kMinBlockSize, max_size, kSlabSize);
+  free_lists_.resize(classes_.count());
+  carving_.resize(classes_.count(), nullptr);
+}
 
-  void* dev_ptr = nullptr;
-  MemoryTimestamp ts;
-  amd::Memory* memory = free_heap_.FindMemory(size, stream, Opportunistic(), dptr, &ts);
-  if (memory == nullptr) {
-    if (Properties().maxSize != 0 && (max_total_size_ + size) > Properties().maxSize) {
+// ================================================================================================
+SubAllocator::Block* SubAllocator::Carve(uint32_t size_class) {
+  size_t block_size = classes_.size(size_class);
+  Slab* slab = carving_[size_class];
+  if ((slab == nullptr) || ((slab->carved_ + block_size) > slab->memory_->getSize())) {
+    amd::Memory* memory = nullptr;
+    size_t slab_size = classes_.slabSize(size_class);
+    void* dev_ptr = pool_->AllocateDeviceMemory(slab_size, &memory);
+    if (dev_ptr == nullptr) {
       return nullptr;
     }
-    amd::Context* context = device_->asContext();
-    const auto& dev_info = context->devices()[0]->info();
-    if (dev_info.maxMemAllocSize_ < size) {
+    // Hide the slab from pointer look-ups, since the first block has the same address
+    amd::MemObjMap::RemoveMemObj(dev_ptr);
+    slab = new Slab{memory, size_class, 0, 0, {}};
+    slabs_.push_back(slab);
+    carving_[size_class] = slab;
+    stats_.reserved_ += slab_size;
+    stats_.slabs_++;
+  }
+
+  amd::Memory* parent = slab->memory_;
+  amd::Memory* memory = new (parent->getContext())
+      amd::Buffer(*parent, parent->getMemFlags(), slab->carved_, block_size);
+  if (memory == nullptr) {
+    return nullptr;
+  }
+  if (!memory->create(nullptr)) {
+    memory->release();
+    return nullptr;
+  }
+  memory->getUserData().deviceId = parent->getUserData().deviceId;
+  // The block stays visible for pointer look-ups until the slab is released
+  amd::MemObjMap::AddMemObj(memory->getSvmPtr(), memory);
+
+  Block* block = new Block{memory, slab, size_class, 0, nullptr, 0, false, {}};
+  slab->carved_ += block_size;
+  slab->blocks_.push_back(block);
+  blocks_[memory] = block;
+  stats_.blocks_++;
+  return block;
+}
+
+// ================================================================================================
+amd::Memory* SubAllocator::Allocate(size_t size, Stream* stream, bool opportunistic,
+    MemoryTimestamp* ts) {
+  uint32_t size_class = classes_.classOf(size);
+  auto& lists = free_lists_[size_class];
+  Block* block = nullptr;
+
+  // The same stream can reuse a block without HIP event validation
+  auto it = (stream != nullptr) ? lists.find(stream) : lists.end();
+  if ((it != lists.end()) && !it->second.empty()) {
+    block = it->second.back();
+  } else {
+    // Limit the number of event checks for the blocks, freed on other streams
+    constexpr uint32_t kMaxSafeChecks = 16;
+    uint32_t checks = 0;
+    for (auto& list : lists) {
+      for (auto rit = list.second.rbegin(); rit != list.second.rend(); ++rit) {
+        if ((*rit)->ts_.IsSafeFind(stream, opportunistic)) {
+          block = *rit;
+          break;
+        }
+        if (++checks >= kMaxSafeChecks) {
+          break;
+        }
+      }
+      if ((block != nullptr) || (checks >= kMaxSafeChecks)) {
+        break;
+      }
+    }
+  }
+
+  if (block != nullptr) {
+    RemoveFromFreeList(block);
+    // Preserve event, since the logic could skip GPU wait on reuse
+    ts->event_ = block->ts_.event_;
+    block->ts_ = MemoryTimestamp();
+  } else {
+    block = Carve(size_class);
+    if (block == nullptr) {
       return nullptr;
     }
-    cl_svm_mem_flags flags = (state_.interprocess_) ? ROCCLR_MEM_INTERPROCESS : 0;
-    flags |= (state_.phys_mem_) ? ROCCLR_MEM_PHYMEM : 0;
-    dev_ptr = amd::SvmBuffer::malloc(*context, flags, size, dev_info.memBaseAddrAlign_, nullptr);
-    if (dev_ptr == nullptr) {
-      size_t free = 0, total =0;
-      hipError_t err = hipMemGetInfo(&free, &total);
-      if (err == hipSuccess) {
-        LogPrintfError("Allocation failed : Device memory : required :%zu | free :%zu | total :%zu",
-          size, free, total);
+  }
+  block->used_ = size;
+  block->busy_ = true;
+  block->slab_->busy_++;
+  stats_.used_ += size;
+  stats_.busy_ += classes_.size(size_class);
+  stats_.busy_blocks_++;
+  return block->memory_;
+}
+
+// ================================================================================================
+bool SubAllocator::Free(amd::Memory* memory, Stream* stream, const MemoryTimestamp& ts) {
+  auto it = blocks_.find(memory);
+  if (it == blocks_.end()) {
+    return false;
+  }
+  Block* block = it->second;
+  stats_.used_ -= block->used_;
+  stats_.busy_ -= classes_.size(block->class_);
+  stats_.busy_blocks_--;
+  block->slab_->busy_--;
+  block->busy_ = false;
+  block->used_ = 0;
+  block->ts_ = ts;
+  // Blocks, freed without a stream, are always validated with the timestamp on reuse
+  block->stream_ = stream;
+  auto& list = free_lists_[block->class_][stream];
+  block->index_ = list.size();
+  list.push_back(block);
+  return true;
+}
+
+// ================================================================================================
+void SubAllocator::RemoveFromFreeList(Block* block) {
+  auto& list = free_lists_[block->class_][block->stream_];
+  list[block->index_] = list.back();
+  list[block->index_]->index_ = block->index_;
+  list.pop_back();
+}
+
+// ================================================================================================
+void SubAllocator::ReleaseSlab(Slab* slab) {
+  for (auto block : slab->blocks_) {
+    if (block->busy_) {
+      stats_.used_ -= block->used_;
+      stats_.busy_ -= classes_.size(block->class_);
+      stats_.busy_blocks_--;
+    } else {
+      RemoveFromFreeList(block);
+    }
+    // Clear HIP event
+    block->ts_.SetEvent(nullptr);
+    amd::MemObjMap::RemoveMemObj(block->memory_->getSvmPtr());
+    blocks_.erase(block->memory_);
+    block->memory_->release();
+    delete block;
+  }
+  stats_.blocks_ -= slab->blocks_.size();
+  stats_.reserved_ -= slab->memory_->getSize();
+  stats_.slabs_--;
+  if (carving_[slab->class_] == slab) {
+    carving_[slab->class_] = nullptr;
+  }
+  // Restore the slab in the map, since the release path looks it up
+  void* dev_ptr = slab->memory_->getSvmPtr();
+  amd::MemObjMap::AddMemObj(dev_ptr, slab->memory_);
+  amd::SvmBuffer::free(slab->memory_->getContext(), dev_ptr);
+  delete slab;
+}
+
+// ================================================================================================
+void SubAllocator::ReleaseEmptySlabs(size_t min_bytes_to_hold, bool safe_release) {
+  for (auto it = slabs_.begin(); it != slabs_.end();) {
+    // Make sure the slabs are smaller than the minimum value to hold
+    if (stats_.reserved_ <= min_bytes_to_hold) {
+      return;
+    }
+    bool release = ((*it)->busy_ == 0);
+    for (auto block : (*it)->blocks_) {
+      if (!release) {
+        break;
       }
-      return nullptr;
+      // Safe release forces unconditional wait for memory
+      if (safe_release) {
+        block->ts_.Wait();
+      }
+      release = block->ts_.IsSafeRelease();
+    }
+    if (release) {
+      ReleaseSlab(*it);
+      it = slabs_.erase(it);
+    } else {
+      ++it;
     }
+  }
+}
 
-    size_t offset = 0;
-    memory = getMemoryObject(dev_ptr, offset);
-    // Saves the current device id so that it can be accessed later
-    memory->getUserData().deviceId = device_->deviceId();
+// ================================================================================================
+void SubAllocator::ReleaseAllMemory() {
+  for (auto slab : slabs_) {
+    ReleaseSlab(slab);
+  }
+  slabs_.clear();
+}
 
-    // Update access for the new allocation from other devices
-    for (const auto& it : access_map_) {
-      auto vdi_device = it.first->asContext()->devices()[0];
-      device::Memory* mem = memory->getDeviceMemory(*vdi_device);
-      if ((mem != nullptr) && (it.second != hipMemAccessFlagsProtNone)) {
-        vdi_device->allowPeerAccess(mem);
+// ================================================================================================
+void SubAllocator::RemoveStream(Stream* stream) {
+  for (auto& lists : free_lists_) {
+    for (auto& list : lists) {
+      for (auto block : list.second) {
+        block->ts_.safe_streams_.erase(stream);
+      }
+    }
+    // Move the blocks into the list without a stream, since the stream object can be reused
+    if (auto it = lists.find(stream); (stream != nullptr) && (it != lists.end())) {
+      FreeList blocks = std::move(it->second);
+      lists.erase(it);
+      auto& orphans = lists[nullptr];
+      for (auto block : blocks) {
+        block->stream_ = nullptr;
+        block->index_ = orphans.size();
+        orphans.push_back(block);
+      }
+    }
+  }
+}
+
+// ================================================================================================
+void SubAllocator::AddSafeStream(Stream* event_stream, Stream* wait_stream) {
+  for (auto& lists : free_lists_) {
+    for (auto& list : lists) {
+      for (auto block : list.second) {
+        block->ts_.AddSafeStream(event_stream, wait_stream);
+      }
+    }
+  }
+}
+
+// ================================================================================================
+void SubAllocator::SetAccess(hip::Device* device, bool enable) {
+  auto peer_device = device->asContext()->devices()[0];
+  for (auto slab : slabs_) {
+    device::Memory* mem = slab->memory_->getDeviceMemory(*peer_device);
+    if (mem != nullptr) {
+      if (!mem->getAllowedPeerAccess() && enable) {
+        // Enable p2p access for the specified device
+        peer_device->allowPeerAccess(mem);
         mem->setAllowedPeerAccess(true);
+      } else if (mem->getAllowedPeerAccess() && !enable) {
+        mem->setAllowedPeerAccess(false);
       }
+    } else {
+      LogError("Couldn't find device memory for P2P access");
+    }
+  }
+}
+
+// ================================================================================================
+void* MemoryPool::AllocateDeviceMemory(size_t size, amd::Memory** memory) {
+  if (Properties().maxSize != 0 && (max_total_size_ + size) > Properties().maxSize) {
+    return nullptr;
+  }
+  amd::Context* context = device_->asContext();
+  const auto& dev_info = context->devices()[0]->info();
+  if (dev_info.maxMemAllocSize_ < size) {
+    return nullptr;
+  }
+  cl_svm_mem_flags flags = (state_.interprocess_) ? ROCCLR_MEM_INTERPROCESS : 0;
+  flags |= (state_.phys_mem_) ? ROCCLR_MEM_PHYMEM : 0;
+  void* dev_ptr = amd::SvmBuffer::malloc(*context, flags, size, dev_info.memBaseAddrAlign_,
+                                         nullptr);
+  if (dev_ptr == nullptr) {
+    size_t free = 0, total =0;
+    hipError_t err = hipMemGetInfo(&free, &total);
+    if (err == hipSuccess) {
+      LogPrintfError("Allocation failed : Device memory : required :%zu | free :%zu | total :%zu",
+        size, free, total);
+    }
+    return nullptr;
+  }
+
+  size_t offset = 0;
+  *memory = getMemoryObject(dev_ptr, offset);
+  // Saves the current device id so that it can be accessed later
+  (*memory)->getUserData().deviceId = device_->deviceId();
+
+  // Update access for the new allocation from other devices
+  for (const auto& it : access_map_) {
+    auto vdi_device = it.first->asContext()->devices()[0];
+    device::Memory* mem = (*memory)->getDeviceMemory(*vdi_device);
+    if ((mem != nullptr) && (it.second != hipMemAccessFlagsProtNone)) {
+      vdi_device->allowPeerAccess(mem);
+      mem->setAllowedPeerAccess(true);
+    }
+  }
+  return dev_ptr;
+}
+
+// ================================================================================================
+void* MemoryPool::AllocateMemory(size_t size, Stream* stream, void* dptr) {
+  amd::ScopedLock lock(lock_pool_ops_);
+
+  void* dev_ptr = nullptr;
+  MemoryTimestamp ts;
+  amd::Memory* memory = nullptr;
+  if ((dptr == nullptr) && sub_alloc_.IsSubAllocation(size)) {
+    // Small allocations are carved from the slabs of the suballocator
+    memory = sub_alloc_.Allocate(size, stream, Opportunistic(), &ts);
+    if (memory == nullptr) {
+      return nullptr;
+    }
+    dev_ptr = memory->getSvmPtr();
+  } else if ((memory = free_heap_.FindMemory(size, stream, Opportunistic(), dptr, &ts)) ==
+             nullptr) {
+    dev_ptr = AllocateDeviceMemory(size, &memory);
+    if (dev_ptr == nullptr) {
+      return nullptr;
     }
   } else {
     dev_ptr = memory->getSvmPtr();
@@ -223,8 +496,7 @@ void* MemoryPool::AllocateMemory(size_t size, Stream* stream, void* dptr) {
   ts.AddSafeStream(stream);
   busy_heap_.AddMemory(memory, ts);
 
-  max_total_size_ = std::max(max_total_size_, busy_heap_.GetTotalSize() +
-                                                  free_heap_.GetTotalSize());
+  max_total_size_ = std::max(max_total_size_, ReservedSize());
   // Increment the reference counter on the pool
   retain();
 
@@ -299,7 +571,9 @@ bool MemoryPool::FreeMemory(amd::Memory* memory, Stream* stream, Event* event) {
       // Assume a safe release from hipFree() if stream is nullptr
       ts.SetEvent(nullptr);
     }
-    free_heap_.AddMemory(memory, ts);
+    if (!sub_alloc_.Free(memory, stream, ts)) {
+      free_heap_.AddMemory(memory, ts);
+    }
   }
 
   // Decrement the reference counter on the pool.
@@ -314,6 +588,17 @@ bool MemoryPool::FreeMemory(amd::Memory* memory, Stream* stream, Event* event) {
 void MemoryPool::ReleaseAllMemory() {
   constexpr bool kSafeRelease = true;
   free_heap_.ReleaseAllMemory(0, kSafeRelease);
+  // Busy blocks are released together with the slabs of the suballocator
+  std::vector<amd::Memory*> blocks;
+  for (const auto& it : busy_heap_.Allocations()) {
+    if (sub_alloc_.IsBlock(it.first.second)) {
+      blocks.push_back(it.first.second);
+    }
+  }
+  for (auto memory : blocks) {
+    busy_heap_.RemoveMemory(memory);
+  }
+  sub_alloc_.ReleaseAllMemory();
   busy_heap_.ReleaseAllMemory(0, kSafeRelease);
 }
 
@@ -322,6 +607,9 @@ void MemoryPool::ReleaseFreedMemory() {
   amd::ScopedLock lock(lock_pool_ops_);
 
   free_heap_.ReleaseAllMemory();
+  uint64_t threshold = free_heap_.GetReleaseThreshold();
+  uint64_t free_size = free_heap_.GetTotalSize();
+  sub_alloc_.ReleaseEmptySlabs((threshold > free_size) ? (threshold - free_size) : 0);
 }
 
 // ================================================================================================
@@ -329,6 +617,7 @@ void MemoryPool::RemoveStream(Stream* stream) {
   amd::ScopedLock lock(lock_pool_ops_);
 
   free_heap_.RemoveStream(stream);
+  sub_alloc_.RemoveStream(stream);
 }
 
 // ================================================================================================
@@ -336,6 +625,9 @@ void MemoryPool::TrimTo(size_t min_bytes_to_hold) {
   amd::ScopedLock lock(lock_pool_ops_);
 
   free_heap_.ReleaseAllMemory(min_bytes_to_hold);
+  uint64_t free_size = free_heap_.GetTotalSize();
+  sub_alloc_.ReleaseEmptySlabs((min_bytes_to_hold > free_size) ?
+                               (min_bytes_to_hold - free_size) : 0);
 }
 
 // ================================================================================================
@@ -411,7 +703,7 @@ hipError_t MemoryPool::GetAttribute(hipMemPoolAttr attr, void* value) {
       break;
     case hipMemPoolAttrReservedMemCurrent:
       // All allocate memory by the pool in OS
-      *reinterpret_cast<uint64_t*>(value) = busy_heap_.GetTotalSize() + free_heap_.GetTotalSize();
+      *reinterpret_cast<uint64_t*>(value) = ReservedSize();
       break;
     case hipMemPoolAttrReservedMemHigh:
       // High watermark of all allocated memory in OS, since the last reset
@@ -425,8 +717,34 @@ hipError_t MemoryPool::GetAttribute(hipMemPoolAttr attr, void* value) {
       // High watermark of all used memoryS, since the last reset
       *reinterpret_cast<uint64_t*>(value) = busy_heap_.GetMaxTotalSize();
       break;
-    default:
-      return hipErrorInvalidValue;
+    default: {
+      // Runtime specific suballocator statistics. Occupancy of the slabs is UsedMem/ReservedMem
+      // and the internal fragmentation is BusyMem - UsedMem
+      const auto& stats = sub_alloc_.GetStats();
+      switch (static_cast<uint32_t>(attr)) {
+        case kSubAllocAttrReservedMem:
+          *reinterpret_cast<uint64_t*>(value) = stats.reserved_;
+          break;
+        case kSubAllocAttrUsedMem:
+          *reinterpret_cast<uint64_t*>(value) = stats.used_;
+          break;
+        case kSubAllocAttrBusyMem:
+          *reinterpret_cast<uint64_t*>(value) = stats.busy_;
+          break;
+        case kSubAllocAttrSlabs:
+          *reinterpret_cast<uint64_t*>(value) = stats.slabs_;
+          break;
+        case kSubAllocAttrBlocks:
+          *reinterpret_cast<uint64_t*>(value) = stats.blocks_;
+          break;
+        case kSubAllocAttrBusyBlocks:
+          *reinterpret_cast<uint64_t*>(value) = stats.busy_blocks_;
+          break;
+        default:
+          return hipErrorInvalidValue;
+      }
+      break;
+    }
   }
   return hipSuccess;
 }
@@ -458,6 +776,7 @@ void MemoryPool::SetAccess(hip::Device* device, hipMemAccessFlags flags) {
     // Update device access on the both pools
     busy_heap_.SetAccess(device, enable_access);
     free_heap_.SetAccess(device, enable_access);
+    sub_alloc_.SetAccess(device, enable_access);
   }
 }
 
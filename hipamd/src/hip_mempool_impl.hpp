@@ -23,6 +23,7 @@
 #include <hip/hip_runtime.h>
 #include "hip_event.hpp"
 #include "hip_internal.hpp"
+#include "utils/sizeclasses.hpp"
 #include <unordered_map>
 #include <unordered_set>
 
@@ -177,12 +178,122 @@ private:
   hip::Device*  device_;    //!< Hip device the allocations will reside
 };
 
+class MemoryPool;
+
+/// Suballocator for small stream ordered allocations. Slabs, allocated from the device, are carved
+/// into blocks of segregated size classes, and each block keeps a persistent sub-buffer. Hence
+/// reuse of a block doesn't go to the backend allocator. Freed blocks are kept in per-stream
+/// free lists, so reuse on the same stream doesn't require HIP event validation.
+/// @note: The suballocator is protected by the pool lock
+class SubAllocator : public amd::EmbeddedObject {
+ public:
+  /// Suballocator statistics
+  struct Stats {
+    uint64_t reserved_ = 0;     //!< Bytes, allocated for all slabs
+    uint64_t used_ = 0;         //!< Bytes, requested by the active allocations
+    uint64_t busy_ = 0;         //!< Bytes in the busy blocks, includes the size class rounding
+    uint64_t slabs_ = 0;        //!< The number of allocated slabs
+    uint64_t blocks_ = 0;       //!< The number of carved blocks
+    uint64_t busy_blocks_ = 0;  //!< The number of busy blocks
+  };
+
+  SubAllocator(MemoryPool* pool): pool_(pool) {}
+  ~SubAllocator() {}
+
+  /// Builds the size classes for allocations up to max_size. 0 keeps the suballocator disabled
+  void Init(size_t max_size);
+
+  /// Returns true if the allocation size is served by the suballocator
+  bool IsSubAllocation(size_t size) const {
+    return classes_.contains(size);
+  }
+
+  /// Allocates a block for the specified size on the stream
+  amd::Memory* Allocate(size_t size, Stream* stream, bool opportunistic, MemoryTimestamp* ts);
+
+  /// Returns the block into the free list of the provided stream
+  bool Free(amd::Memory* memory, Stream* stream, const MemoryTimestamp& ts);
+
+  /// Checks if memory is a block of the suballocator
+  bool IsBlock(amd::Memory* memory) const { return blocks_.find(memory) != blocks_.end(); }
+
+  /// Releases slabs without busy blocks, until the threshold value is met
+  void ReleaseEmptySlabs(size_t min_bytes_to_hold, bool safe_release = false);
+
+  /// Releases all slabs. The busy blocks must be removed from the pool already
+  void ReleaseAllMemory();
+
+  /// Remove the provided stream from the free lists and the safe lists
+  void RemoveStream(Stream* stream);
+
+  /// Add a safe stream for quick looks-ups in all freed blocks
+  void AddSafeStream(Stream* event_stream, Stream* wait_stream);
+
+  /// Enables P2P access to the provided device
+  void SetAccess(hip::Device* device, bool enable);
+
+  /// Returns the suballocator statistics
+  const Stats& GetStats() const { return stats_; }
+
+ private:
+  SubAllocator() = delete;
+  SubAllocator(const SubAllocator&) = delete;
+  SubAllocator& operator=(const SubAllocator&) = delete;
+
+  struct Slab;
+  struct Block {
+    amd::Memory* memory_;   //!< Sub-buffer in the slab
+    Slab* slab_;            //!< The slab, which holds the block
+    uint32_t class_;        //!< Size class index
+    size_t used_;           //!< Requested size of the active allocation
+    Stream* stream_;        //!< The stream of the free list, which holds the block
+    size_t index_;          //!< Position in the free list
+    bool busy_;             //!< The block is allocated
+    MemoryTimestamp ts_;    //!< Timestamp of the freed block
+  };
+  struct Slab {
+    amd::Memory* memory_;           //!< Device allocation of the slab
+    uint32_t class_;                //!< Size class index
+    size_t carved_;                 //!< Offset of the first uncarved byte
+    uint32_t busy_;                 //!< The number of busy blocks
+    std::vector<Block*> blocks_;    //!< All carved blocks
+  };
+  typedef std::vector<Block*> FreeList;
+
+  /// Carves a new block from the current slab of the size class
+  Block* Carve(uint32_t size_class);
+
+  /// Removes the block from its free list
+  void RemoveFromFreeList(Block* block);
+
+  /// Releases the slab and all its blocks
+  void ReleaseSlab(Slab* slab);
+
+  MemoryPool* pool_;                    //!< The pool, which owns the suballocator
+  amd::SizeClasses classes_;            //!< Block sizes of all classes
+  std::vector<std::unordered_map<Stream*, FreeList>> free_lists_;  //!< Per class free lists
+  std::vector<Slab*> carving_;          //!< The slab for carving per class
+  std::vector<Slab*> slabs_;            //!< All slabs
+  std::unordered_map<amd::Memory*, Block*> blocks_;   //!< Map of all blocks
+  Stats stats_;                         //!< Suballocator statistics
+};
+
 /// Allocates memory in the pool on the specified stream and places the allocation into busy_heap_
 /// @note: the logic also will look in free_heap for possible reuse.
 /// hipMemPoolReuseAllowOpportunistic option will validate if HIP event,
 /// associated with memory is done, then reuse can be performed.
 class MemoryPool : public amd::ReferenceCountedObject {
  public:
+  /// Runtime specific attributes with the suballocator statistics, all values are uint64_t
+  enum SubAllocAttr {
+    kSubAllocAttrReservedMem = 0x1000,  //!< Bytes, allocated for the slabs
+    kSubAllocAttrUsedMem,               //!< Bytes, requested by the active suballocations
+    kSubAllocAttrBusyMem,               //!< Bytes in the busy blocks, includes class rounding
+    kSubAllocAttrSlabs,                 //!< The number of slabs
+    kSubAllocAttrBlocks,                //!< The number of carved blocks
+    kSubAllocAttrBusyBlocks             //!< The number of busy blocks
+  };
+
   struct SharedAccess {
     int device_id_;             //!< Device ID for access with a specified shared resource
     hipMemAccessFlags flags_;   //!< Flags which define access type
@@ -199,6 +310,7 @@ class MemoryPool : public amd::ReferenceCountedObject {
   MemoryPool(hip::Device* device, const hipMemPoolProps* props = nullptr, bool phys_mem = false)
       : busy_heap_(device),
         free_heap_(device),
+        sub_alloc_(this),
         lock_pool_ops_(true), /* Pool operations */
         device_(device),
         shared_(nullptr),
@@ -220,6 +332,10 @@ class MemoryPool : public amd::ReferenceCountedObject {
                      .reserved = {}};
     }
     state_.interprocess_ = properties_.handleTypes != hipMemHandleTypeNone;
+    if (!state_.interprocess_ && !state_.phys_mem_) {
+      // IPC and VM pools export or map whole allocations, so only regular pools suballocate
+      sub_alloc_.Init(HIP_MEM_POOL_SUBALLOC_MAX_SIZE * Ki);
+    }
   }
 
   virtual ~MemoryPool() {
@@ -264,6 +380,7 @@ class MemoryPool : public amd::ReferenceCountedObject {
     amd::ScopedLock lock(lock_pool_ops_);
     if (EventDependencies()) {
       free_heap_.AddSafeStream(event_stream, wait_stream);
+      sub_alloc_.AddSafeStream(event_stream, wait_stream);
     }
   }
 
@@ -305,12 +422,24 @@ class MemoryPool : public amd::ReferenceCountedObject {
   void SetGraphInUse() { state_.graph_in_use_ = true; }
 
  private:
+  friend class SubAllocator;
+
+  /// Allocates new device memory for the pool and enables access from other devices
+  void* AllocateDeviceMemory(size_t size, amd::Memory** memory);
+
+  /// Returns the size of all memory, reserved by the pool in OS
+  uint64_t ReservedSize() const {
+    return busy_heap_.GetTotalSize() - sub_alloc_.GetStats().busy_ +
+        free_heap_.GetTotalSize() + sub_alloc_.GetStats().reserved_;
+  }
+
   MemoryPool() = delete;
   MemoryPool(const MemoryPool&) = delete;
   MemoryPool& operator=(const MemoryPool&) = delete;
 
   Heap busy_heap_;    //!< Heap of busy allocations
   Heap free_heap_;    //!< Heap of freed allocations
+  SubAllocator sub_alloc_;  //!< Suballocator for small allocations
   union {
     struct {
       uint32_t event_dependencies_ : 1;     //!< Event dependencies tracking is enabled
@@ -379,6 +379,8 @@ hipError_t ihipLaunchKernelCommand(amd::Command*& command, hipFunction_t f,
     kernargs = reinterpret_cast<address>(extra[1]);
   }
 
+  // The arguments are staged directly in the memory of the command, so concurrent launches
+  // of the same function don't share any state and don't need the function lock
   if (DEBUG_HIP_KERNARG_COPY_OPT) {
     if (CL_SUCCESS != kernelCommand->AllocCaptureSetValidate(kernelParams, kernargs)) {
       kernelCommand->release();
@@ -386,17 +388,11 @@ hipError_t ihipLaunchKernelCommand(amd::Command*& command, hipFunction_t f,
     }
 
   } else {
-    for (size_t i = 0; i < kernel->signature().numParameters(); ++i) {
-      const amd::KernelParameterDescriptor& desc = kernel->signature().at(i);
-      if (kernelParams == nullptr) {
-        assert(kernargs != nullptr);
-        kernel->parameters().set(i, desc.size_, kernargs + desc.offset_,
-                                 desc.type_ == T_POINTER /*svmBound*/);
-      } else {
-        kernel->parameters().set(i, desc.size_, kernelParams[i],
-                                 desc.type_ == T_POINTER /*svmBound*/);
-      }
-    }
+    // The arguments are staged in the parameters of the kernel, shared by all launches
+    amd::ScopedLock lock(function->dflock_);
+    // Set the arguments with the fix-up plan of the signature
+    assert(kernelParams != nullptr || kernargs != nullptr);
+    kernel->parameters().setAll(kernelParams, kernargs);
 
     // Capture the kernel arguments
     if (CL_SUCCESS != kernelCommand->captureAndValidate()) {
@@ -427,7 +423,6 @@ hipError_t ihipModuleLaunchKernel(hipFunction_t f, uint32_t globalWorkSizeX,
   }
   hip::DeviceFunc* function = hip::DeviceFunc::asFunction(f);
   amd::Kernel* kernel = function->kernel();
-  amd::ScopedLock lock (DEBUG_HIP_KERNARG_COPY_OPT ? nullptr : &function->dflock_);
 
   hipError_t status = ihipLaunchKernel_validate(
       f, globalWorkSizeX, globalWorkSizeY, globalWorkSizeZ, blockDimX, blockDimY, blockDimZ,
@@ -742,6 +742,7 @@ void PlatformState::init() {
   for (auto& it : statCO_.functions_) {
     it.second->resize_dFunc(g_devices.size());
   }
+  hip::FatBinaryInfo::Stats().Print("init");
 }
 
 hipError_t PlatformState::loadModule(hipModule_t* module, const char* fname, const void* image) {
@@ -1001,6 +1002,40 @@ bool PlatformState::CloseUniqueFileHandle(const std::shared_ptr<UniqueFD>& ufd)
   return true;
 }
 
+const void* PlatformState::MapUniqueFile(const std::shared_ptr<UniqueFD>& ufd) {
+  amd::ScopedLock lock(ufd_lock_);
+
+  if (ufd->map_count_ == 0) {
+    uint64_t start = amd::Os::timeNanos();
+    if (!amd::Os::MemoryMapFileDesc(ufd->fdesc_, ufd->fsize_, 0, &ufd->image_)) {
+      ufd->image_ = nullptr;
+      return nullptr;
+    }
+    // A bundle has code objects for many targets, but only the code objects of the devices
+    // are read. Disable the read ahead, the code objects are prefetched before the build.
+    amd::Os::adviseMemory(ufd->image_, ufd->fsize_, amd::Os::MEM_ADVICE_RANDOM);
+    ClPrint(amd::LOG_INFO, amd::LOG_CODE, "Mapped %s, %zu bytes in %llu us",
+            ufd->fpath_.c_str(), ufd->fsize_,
+            static_cast<unsigned long long>((amd::Os::timeNanos() - start) / 1000));
+  }
+  ++ufd->map_count_;
+  return ufd->image_;
+}
+
+bool PlatformState::UnmapUniqueFile(const std::shared_ptr<UniqueFD>& ufd) {
+  amd::ScopedLock lock(ufd_lock_);
+
+  guarantee(ufd->map_count_ > 0, "File %s is not mapped", ufd->fpath_.c_str());
+  if (--ufd->map_count_ == 0) {
+    const void* image = ufd->image_;
+    ufd->image_ = nullptr;
+    if (!amd::Os::MemoryUnmapFile(image, ufd->fsize_)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 void* PlatformState::getDynamicLibraryHandle() {
   amd::ScopedLock lock(lock_);
 
@@ -39,6 +39,10 @@ struct UniqueFD {
   const std::string fpath_;        //!< File path of this unique file
   const amd::Os::FileDesc fdesc_;  //!< File Descriptor
   const size_t fsize_;             //!< File Size
+
+  // The read only mapping of the whole file, shared by all modules of the file
+  const void* image_ = nullptr;    //!< Mapped image
+  size_t map_count_ = 0;           //!< Number of users of the mapping
 };
 
 namespace hip {
@@ -109,6 +113,10 @@ class PlatformState {
 
   std::shared_ptr<UniqueFD> GetUniqueFileHandle(const std::string& file_path);
   bool CloseUniqueFileHandle(const std::shared_ptr<UniqueFD>& ufd);
+  // Maps the file on the first call, returns the shared mapping or nullptr on a failure
+  const void* MapUniqueFile(const std::shared_ptr<UniqueFD>& ufd);
+  // Unmaps the file after the last user of the mapping
+  bool UnmapUniqueFile(const std::shared_ptr<UniqueFD>& ufd);
 
   size_t UfdMapSize() const { return ufd_map_.size(); }
 
@@ -61,9 +61,25 @@ template <hip_api_id_t operation_id> class api_callbacks_spawner_t {
         trace_data_.phase_enter(operation_id, &trace_data_);
       }
     }
+
+    // The built-in trace, the commands of the call get its correlation id
+    if (amd::activity_prof::IsTracing()) {
+      traced_ = true;
+      if (!enabled_) {
+        trace_previous_id_ = amd::activity_prof::correlation_id;
+        amd::activity_prof::correlation_id = amd::activity_prof::NewCorrelationId();
+      }
+      trace_correlation_id_ = amd::activity_prof::correlation_id;
+      trace_begin_ = amd::Os::timeNanos();
+    }
   }
 
   ~api_callbacks_spawner_t() {
+    if (traced_) {
+      amd::activity_prof::TraceApi(hip_api_name(operation_id), trace_begin_,
+                                   trace_correlation_id_);
+      if (!enabled_) amd::activity_prof::correlation_id = trace_previous_id_;
+    }
     if (enabled_) {
       if (trace_data_.phase_exit != nullptr) trace_data_.phase_exit(operation_id, &trace_data_);
       amd::activity_prof::correlation_id = 0;
@@ -72,6 +88,10 @@ template <hip_api_id_t operation_id> class api_callbacks_spawner_t {
 
  private:
   bool enabled_{false};
+  bool traced_{false};
+  uint64_t trace_begin_{0};
+  activity_correlation_id_t trace_correlation_id_{0};
+  activity_correlation_id_t trace_previous_id_{0};
   union {
     hip_api_trace_data_t trace_data_;
   };
@@ -22,11 +22,38 @@
 #include "hip_internal.hpp"
 #include "hip_event.hpp"
 #include "thread/monitor.hpp"
+#include "utils/handletable.hpp"
 #include "hip_prof_api.h"
 #include <atomic>
 
 namespace hip {
 
+namespace {
+// The streams of all devices, validated without locks on every stream API call
+class StreamTable {
+ public:
+  static StreamTable& get() {
+    // Never destroyed, streams may be released after the static destructors
+    static StreamTable* table = new StreamTable();
+    return *table;
+  }
+  void Add(const Stream* stream) {
+    amd::ScopedLock lock(lock_);
+    handles_.insert(stream);
+  }
+  void Remove(const Stream* stream) {
+    amd::ScopedLock lock(lock_);
+    handles_.erase(stream);
+  }
+  bool Exists(const void* stream) const { return handles_.contains(stream); }
+
+ private:
+  StreamTable() : lock_("Stream table lock") {}
+  amd::Monitor lock_;                           // Serializes the updates
+  amd::ConcurrentHandleTable<Stream> handles_;  // The stream handles
+};
+}  // namespace
+
 // ================================================================================================
 Stream::Stream(hip::Device* dev, Priority p, unsigned int f, bool null_stream,
                const std::vector<uint32_t>& cuMask, hipStreamCaptureStatus captureStatus)
@@ -42,6 +69,7 @@ Stream::Stream(hip::Device* dev, Priority p, unsigned int f, bool null_stream,
       originStream_(false),
       captureID_(0) {
   device_->AddStream(this);
+  StreamTable::get().Add(this);
 }
 
 // ================================================================================================
@@ -73,6 +101,7 @@ bool Stream::Create() {
 
 // ================================================================================================
 void Stream::Destroy(hip::Stream* stream) {
+  StreamTable::get().Remove(stream);
   stream->device_->RemoveStream(stream);
   stream->release();
   stream = nullptr;
@@ -94,13 +123,7 @@ bool isValid(hipStream_t& stream) {
     getStreamPerThread(stream);
   }
 
-  hip::Stream* s = reinterpret_cast<hip::Stream*>(stream);
-  for (auto& device : g_devices) {
-    if (device->StreamExists(s)) {
-      return true;
-    }
-  }
-  return false;
+  return StreamTable::get().Exists(stream);
 }
 
 // ================================================================================================
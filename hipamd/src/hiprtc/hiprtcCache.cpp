@@ -0,0 +1,238 @@
+/*
+Copyright (c) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#include "hiprtcCache.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#if defined(_WIN32)
+#include <windows.h>
+#include <sys/utime.h>
+#else
+#include <dirent.h>
+#include <utime.h>
+#endif
+
+#include "os/os.hpp"
+#include "utils/debug.hpp"
+#include "utils/flags.hpp"
+
+namespace hiprtc {
+
+namespace {
+constexpr const char* kSuffix = ".hiprtc";
+
+// Lists the cache entries of the directory
+void ListEntries(const std::string& dir, std::vector<amd::CacheFile>* entries) {
+  const size_t suffix_len = strlen(kSuffix);
+  auto is_entry = [&](const std::string& name) {
+    return (name.size() > suffix_len) &&
+           (name.compare(name.size() - suffix_len, suffix_len, kSuffix) == 0);
+  };
+#if defined(_WIN32)
+  WIN32_FIND_DATAA data;
+  HANDLE handle = FindFirstFileA((dir + "\\*" + kSuffix).c_str(), &data);
+  if (handle == INVALID_HANDLE_VALUE) {
+    return;
+  }
+  do {
+    if (is_entry(data.cFileName)) {
+      ULARGE_INTEGER size, time;
+      size.LowPart = data.nFileSizeLow;
+      size.HighPart = data.nFileSizeHigh;
+      time.LowPart = data.ftLastWriteTime.dwLowDateTime;
+      time.HighPart = data.ftLastWriteTime.dwHighDateTime;
+      entries->push_back({dir + "\\" + data.cFileName, size.QuadPart,
+                          static_cast<int64_t>(time.QuadPart)});
+    }
+  } while (FindNextFileA(handle, &data));
+  FindClose(handle);
+#else
+  DIR* handle = opendir(dir.c_str());
+  if (handle == nullptr) {
+    return;
+  }
+  while (struct dirent* ent = readdir(handle)) {
+    if (!is_entry(ent->d_name)) {
+      continue;
+    }
+    std::string path = dir + "/" + ent->d_name;
+    struct stat st;
+    if (stat(path.c_str(), &st) == 0) {
+      entries->push_back({path, static_cast<uint64_t>(st.st_size),
+                          static_cast<int64_t>(st.st_mtime)});
+    }
+  }
+  closedir(handle);
+#endif
+}
+}  // namespace
+
+constexpr char CompileCache::kMagic[8];
+
+// ================================================================================================
+CompileCache* CompileCache::get() {
+  static CompileCache* cache = nullptr;
+  static std::once_flag once;
+  std::call_once(once, []() {
+    std::string dir = HIPRTC_CACHE_DIR;
+    if (dir.empty()) {
+      return;
+    }
+    while (dir.size() > 1 && dir.back() == amd::Os::fileSeparator()) {
+      dir.pop_back();
+    }
+    if (!amd::Os::pathExists(dir) && !amd::Os::createPath(dir) && !amd::Os::pathExists(dir)) {
+      LogPrintfError("hiprtc cache is disabled, unable to create %s", dir.c_str());
+      return;
+    }
+    cache = new CompileCache(dir, HIPRTC_CACHE_MAX_SIZE * Mi);
+  });
+  return cache;
+}
+
+// ================================================================================================
+CompileCache::CompileCache(const std::string& dir, size_t max_size)
+    : dir_(dir), max_size_(max_size), size_(0), scanned_(false) {}
+
+// ================================================================================================
+std::string CompileCache::path(const std::string& key) const {
+  return dir_ + amd::Os::fileSeparator() + key + kSuffix;
+}
+
+// ================================================================================================
+bool CompileCache::lookup(const std::string& key, std::string& log, std::vector<char>& binary) {
+  std::string file_name = path(key);
+  std::ifstream file(file_name, std::ios::binary | std::ios::ate);
+  if (!file.is_open()) {
+    return false;
+  }
+  const uint64_t file_size = file.tellg();
+  file.seekg(0);
+  Header header;
+  if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+      memcmp(header.magic_, kMagic, sizeof(kMagic)) != 0 ||
+      (header.log_size_ > file_size) || (header.binary_size_ > file_size) ||
+      (sizeof(header) + header.log_size_ + header.binary_size_ != file_size)) {
+    return false;
+  }
+  std::string cached_log(header.log_size_, '\0');
+  std::vector<char> cached_binary(header.binary_size_);
+  if (!file.read(&cached_log[0], cached_log.size()) ||
+      !file.read(cached_binary.data(), cached_binary.size())) {
+    return false;
+  }
+  CacheKey checksum;
+  checksum.add(cached_log);
+  checksum.add(cached_binary.data(), cached_binary.size());
+  if (checksum.value() != header.checksum_) {
+    LogPrintfInfo("Corrupted hiprtc cache entry %s", file_name.c_str());
+    return false;
+  }
+  file.close();
+  // Mark the entry as recently used
+#if defined(_WIN32)
+  _utime(file_name.c_str(), nullptr);
+#else
+  utime(file_name.c_str(), nullptr);
+#endif
+  log += cached_log;
+  binary.swap(cached_binary);
+  return true;
+}
+
+// ================================================================================================
+void CompileCache::store(const std::string& key, const std::string& log,
+                         const std::vector<char>& binary) {
+  Header header;
+  memcpy(header.magic_, kMagic, sizeof(kMagic));
+  header.log_size_ = log.size();
+  header.binary_size_ = binary.size();
+  CacheKey checksum;
+  checksum.add(log);
+  checksum.add(binary.data(), binary.size());
+  header.checksum_ = checksum.value();
+
+  // Write a private file and publish it with an atomic rename
+  std::string file_name = path(key);
+  std::string temp_name = file_name + "." + std::to_string(amd::Os::getProcessId()) + "." +
+      std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+  {
+    std::ofstream file(temp_name, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+      return;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(log.data(), log.size());
+    file.write(binary.data(), binary.size());
+    if (!file.good()) {
+      file.close();
+      std::remove(temp_name.c_str());
+      return;
+    }
+  }
+#if defined(_WIN32)
+  bool renamed = MoveFileExA(temp_name.c_str(), file_name.c_str(), MOVEFILE_REPLACE_EXISTING);
+#else
+  bool renamed = (std::rename(temp_name.c_str(), file_name.c_str()) == 0);
+#endif
+  if (!renamed) {
+    std::remove(temp_name.c_str());
+    return;
+  }
+
+  amd::ScopedLock lock(lock_);
+  if (!scanned_) {
+    std::vector<amd::CacheFile> entries;
+    ListEntries(dir_, &entries);
+    size_ = 0;
+    for (const auto& entry : entries) {
+      size_ += entry.size_;
+    }
+    scanned_ = true;
+  } else {
+    size_ += sizeof(header) + log.size() + binary.size();
+  }
+  if (size_ > max_size_) {
+    evict();
+  }
+}
+
+// ================================================================================================
+void CompileCache::evict() {
+  // Other processes may share the directory, so the size is refreshed from the entries
+  std::vector<amd::CacheFile> entries;
+  ListEntries(dir_, &entries);
+  size_ = amd::evictCacheFiles(&entries, max_size_, [](const amd::CacheFile& entry) {
+    return std::remove(entry.path_.c_str()) == 0;
+  });
+  LogPrintfInfo("hiprtc cache %s was trimmed to %zu bytes", dir_.c_str(), size_);
+}
+
+}  // namespace hiprtc
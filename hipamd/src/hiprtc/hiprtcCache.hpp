@@ -0,0 +1,75 @@
+/*
+Copyright (c) 2025 Advanced Micro Devices, Inc. All rights reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "top.hpp"
+#include "thread/monitor.hpp"
+#include "utils/filecache.hpp"
+
+namespace hiprtc {
+
+// Content key of a compilation, a 128 bit hash of all inputs
+typedef amd::ContentKey CacheKey;
+
+// Persistent, content addressed cache of compiled programs, enabled with HIPRTC_CACHE_DIR.
+// Every entry is one file, written to a temporary file and renamed, so concurrent processes
+// never see partial entries. A hit refreshes the modification time of the file and the
+// least recently used files are evicted when the cache exceeds HIPRTC_CACHE_MAX_SIZE.
+class CompileCache {
+ public:
+  // Returns the cache or nullptr if the cache is disabled
+  static CompileCache* get();
+
+  // Appends the build log and returns the binary of the key
+  bool lookup(const std::string& key, std::string& log, std::vector<char>& binary);
+
+  // Adds the compilation result of the key
+  void store(const std::string& key, const std::string& log, const std::vector<char>& binary);
+
+ private:
+  CompileCache(const std::string& dir, size_t max_size);
+
+  std::string path(const std::string& key) const;
+  // Removes the least recently used entries until the cache fits into the limit
+  void evict();
+
+  struct Header {
+    char magic_[8];       // kMagic
+    uint64_t log_size_;    // Size of the build log
+    uint64_t binary_size_; // Size of the binary, follows the log
+    uint64_t checksum_;    // Hash of the log and the binary
+  };
+  static constexpr char kMagic[8] = {'H', 'I', 'P', 'R', 'T', 'C', 'C', '1'};
+
+  std::string dir_;       // Cache directory
+  size_t max_size_;       // The size limit of the cache in bytes
+  amd::Monitor lock_;     // Protects the cache size
+  size_t size_;           // Estimated size of the cache directory
+  bool scanned_;          // size_ was initialized from the directory
+};
+
+}  // namespace hiprtc
@@ -34,6 +34,7 @@ THE SOFTWARE.
 namespace hiprtc {
 using namespace helpers;
 std::unordered_set<RTCLinkProgram*>RTCLinkProgram::linker_set_;
+amd::Monitor RTCLinkProgram::linker_set_lock_;
 
 std::vector<std::string> getLinkOptions(const LinkArguments& args) {
   std::vector<std::string> res;
@@ -225,6 +226,8 @@ bool RTCCompileProgram::addHeader(const std::string& source, const std::string&
   if (!addCodeObjData(compile_input_, vsource, name, AMD_COMGR_DATA_KIND_INCLUDE)) {
     return false;
   }
+  headers_key_.add(name);
+  headers_key_.add(source);
   return true;
 }
 
@@ -302,10 +305,48 @@ bool RTCCompileProgram::transformOptions(std::vector<std::string>& compile_optio
   return findIsa();
 }
 
-// HIPRTC Program lock
-amd::Monitor RTCProgram::lock_(true);
+// Returns the content key of the compilation or an empty string if it can't be cached
+std::string RTCCompileProgram::cacheKey(const std::vector<std::string>& compile_options) {
+  for (size_t i = 0; i < compile_options.size(); ++i) {
+    const std::string& option = compile_options[i];
+    // Headers from the file system aren't part of the key
+    if ((option.rfind("-I", 0) == 0) || (option.rfind("-isystem", 0) == 0) ||
+        (option.rfind("-idirafter", 0) == 0) || (option.rfind("--include-directory", 0) == 0)) {
+      return "";
+    }
+    if ((option == "-include") &&
+        ((i + 1 == compile_options.size()) || (compile_options[i + 1] != "hiprtc_runtime.h"))) {
+      return "";
+    }
+  }
+  size_t comgr_major = 0;
+  size_t comgr_minor = 0;
+  amd::Comgr::get_version(&comgr_major, &comgr_minor);
+
+  CacheKey key;
+  key.add(static_cast<uint64_t>(HIP_VERSION));
+  key.add(static_cast<uint64_t>(comgr_major));
+  key.add(static_cast<uint64_t>(comgr_minor));
+  key.add(isa_);
+  key.add(static_cast<uint64_t>(fgpu_rdc_));
+  key.add(static_cast<uint64_t>(compile_options.size()));
+  for (const auto& option : compile_options) {
+    key.add(option);
+  }
+  key.add(static_cast<uint64_t>(link_options_.size()));
+  for (const auto& option : link_options_) {
+    key.add(option);
+  }
+  key.add(__hipRTC_header, __hipRTC_header_size);
+  key.add(source_name_);
+  key.add(source_code_);
+  key.add(headers_key_.str());
+  return key.str();
+}
 
 bool RTCCompileProgram::compile(const std::vector<std::string>& options, bool fgpu_rdc) {
+  amd::ScopedLock lock(lock_);
+
   if (!addSource_impl()) {
     LogError("Error in hiprtc: unable to add source code");
     return false;
@@ -323,22 +364,32 @@ bool RTCCompileProgram::compile(const std::vector<std::string>& options, bool fg
     return false;
   }
 
-  if (fgpu_rdc_) {
-    if (!compileToBitCode(compile_input_, isa_, compileOpts, build_log_, LLVMBitcode_)) {
-      LogError("Error in hiprtc: unable to compile source to bitcode");
-      return false;
-    }
+  auto& compile_step_output = fgpu_rdc_ ? LLVMBitcode_ : executable_;
+  CompileCache* cache = CompileCache::get();
+  std::string key = (cache != nullptr) ? cacheKey(compileOpts) : "";
+  if (!key.empty() && cache->lookup(key, build_log_, compile_step_output)) {
+    LogPrintfInfo("hiprtc cache hit for %s, key %s", source_name_.c_str(), key.c_str());
   } else {
-    LogInfo("Using the new path of comgr");
-    if (!compileToExecutable(compile_input_, isa_, compileOpts, link_options_, build_log_,
-                             executable_)) {
-      LogError("Failing to compile to realloc");
-      return false;
+    const size_t log_start = build_log_.size();
+    if (fgpu_rdc_) {
+      if (!compileToBitCode(compile_input_, isa_, compileOpts, build_log_, LLVMBitcode_)) {
+        LogError("Error in hiprtc: unable to compile source to bitcode");
+        return false;
+      }
+    } else {
+      LogInfo("Using the new path of comgr");
+      if (!compileToExecutable(compile_input_, isa_, compileOpts, link_options_, build_log_,
+                               executable_)) {
+        LogError("Failing to compile to realloc");
+        return false;
+      }
+    }
+    if (!key.empty()) {
+      cache->store(key, build_log_.substr(log_start), compile_step_output);
     }
   }
 
   if (!mangled_names_.empty()) {
-    auto& compile_step_output = fgpu_rdc_ ? LLVMBitcode_ : executable_;
     if (!fillMangledNames(compile_step_output, mangled_names_, fgpu_rdc_)) {
       LogError("Error in hiprtc: unable to fill mangled names");
       return false;
@@ -381,6 +432,8 @@ bool RTCCompileProgram::trackMangledName(std::string& name) {
 }
 
 bool RTCCompileProgram::getMangledName(const char* name_expression, const char** loweredName) {
+  amd::ScopedLock lock(lock_);
+
   std::string strippedName = name_expression;
   stripNamedExpression(strippedName);
 
@@ -417,12 +470,12 @@ RTCLinkProgram::RTCLinkProgram(std::string name) : RTCProgram(name) {
   if (amd::Comgr::create_data_set(&link_input_) != AMD_COMGR_STATUS_SUCCESS) {
     crashWithMessage("Failed to allocate internal hiprtc structure");
   }
-  amd::ScopedLock lock(lock_);
+  amd::ScopedLock lock(linker_set_lock_);
   linker_set_.insert(this);
 }
 
 bool RTCLinkProgram::isLinkerValid(RTCLinkProgram* link_program) {
-  amd::ScopedLock lock(lock_);
+  amd::ScopedLock lock(linker_set_lock_);
   if (linker_set_.find(link_program) == linker_set_.end()) {
     return false;
   }
@@ -44,6 +44,7 @@ extern unsigned __hipRTC_header_size;
 }
 #endif
 
+#include "hiprtcCache.hpp"
 #include "hiprtcComgrHelper.hpp"
 
 namespace hiprtc {
@@ -72,7 +73,7 @@ template <typename T, typename... Args> inline std::string ToString(T first, Arg
 }  // namespace internal
 }  // namespace hiprtc
 
-// hiprtcInit lock
+// hiprtcInit lock, guards only the flag initialization. Programs compile in parallel
 static amd::Monitor g_hiprtcInitlock{};
 #define HIPRTC_INIT_API_INTERNAL(...)                                                              \
   amd::Thread* thread = amd::Thread::current();                                                    \
@@ -82,9 +83,11 @@ static amd::Monitor g_hiprtcInitlock{};
             " This may be due to insufficient memory.");                                           \
     HIPRTC_RETURN(HIPRTC_ERROR_INTERNAL_ERROR);                                                    \
   }                                                                                                \
-  amd::ScopedLock lock(g_hiprtcInitlock);                                                          \
-  if (!amd::Flag::init()) {                                                                        \
-    HIPRTC_RETURN(HIPRTC_ERROR_INTERNAL_ERROR);                                                    \
+  {                                                                                                \
+    amd::ScopedLock lock(g_hiprtcInitlock);                                                        \
+    if (!amd::Flag::init()) {                                                                      \
+      HIPRTC_RETURN(HIPRTC_ERROR_INTERNAL_ERROR);                                                  \
+    }                                                                                              \
   }
 
 #define HIPRTC_INIT_API(...)                                                                       \
@@ -115,7 +118,7 @@ struct Settings {
 class RTCProgram {
  protected:
   // Lock and control variables
-  static amd::Monitor lock_;
+  amd::Monitor lock_;  // Serializes the updates of the program, programs are independent
   static std::once_flag initialized_;
 
   RTCProgram(std::string name);
@@ -150,6 +153,8 @@ class RTCCompileProgram : public RTCProgram {
 
   bool fgpu_rdc_;
   std::vector<char> LLVMBitcode_;
+  CacheKey headers_key_;  // Names and contents of the added headers
+
 
   // Private Member functions
   bool addSource_impl();
@@ -158,6 +163,7 @@ class RTCCompileProgram : public RTCProgram {
   bool findExeOptions(const std::vector<std::string>& options,
                       std::vector<std::string>& exe_options);
   void AppendCompileOptions() { AppendOptions(HIPRTC_COMPILE_OPTIONS_APPEND, &compile_options_); }
+  std::string cacheKey(const std::vector<std::string>& compile_options);
 
   RTCCompileProgram() = delete;
   RTCCompileProgram(RTCCompileProgram&) = delete;
@@ -270,6 +276,7 @@ class RTCLinkProgram : public RTCProgram {
   amd_comgr_data_set_t link_input_;
   std::vector<std::string> link_options_;
   static std::unordered_set<RTCLinkProgram*> linker_set_;
+  static amd::Monitor linker_set_lock_;
 
   bool AddLinkerDataImpl(std::vector<char>& link_data, hiprtcJITInputType input_type,
                          std::string& link_file_name);
@@ -277,7 +284,7 @@ class RTCLinkProgram : public RTCProgram {
  public:
   RTCLinkProgram(std::string name);
   ~RTCLinkProgram() {
-    amd::ScopedLock lock(lock_);
+    amd::ScopedLock lock(linker_set_lock_);
     linker_set_.erase(this);
     amd::Comgr::destroy_data_set(link_input_);
   }
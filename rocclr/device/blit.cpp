@@ -577,11 +577,8 @@ bool HostBlitManager::fillBuffer(device::Memory& memory, const void* pattern, si
   }
 
   // Fill the buffer memory with a pattern
-  for (size_t i = 0; i < (fillSize / patternSize); i++) {
-    memcpy((reinterpret_cast<address>(fillMem) + offset),
-           (reinterpret_cast<const_address>(pattern)), patternSize);
-    offset += patternSize;
-  }
+  amd::SvmBuffer::memFill(reinterpret_cast<address>(fillMem) + offset, pattern, patternSize,
+                          fillSize / patternSize);
 
   // Unmap source and destination memory
   memory.cpuUnmap(vDev_);
@@ -645,15 +642,9 @@ bool HostBlitManager::fillImage(device::Memory& memory, const void* pattern,
     offset = offsetOrg + slice * devSlicePitch;
 
     for (size_t rows = 0; rows < size[1]; ++rows) {
-      size_t pixOffset = offset;
-
-      // Copy memory pixel by pixel
-      for (size_t column = 0; column < size[0]; ++column) {
-        memcpy((reinterpret_cast<address>(fillMem) + pixOffset),
-               (reinterpret_cast<const_address>(fillValue)), elementSize);
-        pixOffset += elementSize;
-      }
-
+      // Fill the row with the pixel value
+      amd::SvmBuffer::memFill(reinterpret_cast<address>(fillMem) + offset, fillValue,
+                              elementSize, size[0]);
       offset += devRowPitch;
     }
   }
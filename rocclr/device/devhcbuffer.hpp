@@ -0,0 +1,236 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#pragma once
+
+#include "top.hpp"
+#include "utils/util.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace amd {
+
+class Device;
+#if defined(__clang__)
+#if __has_feature(address_sanitizer)
+namespace device {
+class UriLocator;
+}
+#endif
+#endif
+
+/** \file Layout and host side protocol of the hostcall buffer, shared with the device.
+ *  It doesn't depend on the device layer, so the protocol can be exercised on the host.
+ */
+
+/** \brief Packet payload
+ *
+ *  Contains 64 slots of 8 ulongs each, one for each workitem in the
+ *  wave. A slot with index \c i contains valid data if the
+ *  corresponding bit in PacketHeader::activemask is set.
+ */
+struct Payload {
+  uint64_t slots[64][8];
+};
+
+/** Packet header */
+struct PacketHeader {
+  /** Tagged pointer to the next packet in an intrusive stack */
+  uint64_t next_;
+  /** Bitmask that represents payload slots with valid data */
+  uint64_t activemask_;
+  /** Service ID requested by the wave */
+  uint32_t service_;
+  /** Control bits.
+   *  \li 0: \c READY flag. Indicates packet awaiting a host response.
+   */
+  std::atomic<uint32_t> control_;
+};
+
+static_assert(std::is_standard_layout<PacketHeader>::value,
+              "the hostcall packet must be useable from other languages");
+
+/** Field offsets in the packet control field */
+enum ControlOffset {
+  CONTROL_OFFSET_READY_FLAG = 0,
+  CONTROL_OFFSET_RESERVED0 = 1,
+};
+
+/** Field widths in the packet control field */
+enum ControlWidth {
+  CONTROL_WIDTH_READY_FLAG = 1,
+  CONTROL_WIDTH_RESERVED0 = 31,
+};
+
+class MessageHandler;
+struct HostcallStats;
+
+/** \brief Shared buffer submitting hostcall requests.
+ *
+ *  Holds hostcall packets requested by all kernels executing on the
+ *  same device queue. Each hostcall buffer is associated with at most
+ *  one device queue.
+ *
+ *  Packets in the buffer are accessed using 64-bit tagged pointers to mitigate
+ *  the ABA problem in lock-free stacks. The index_mask is used to extract the
+ *  lower bits of the pointer, which form the index into the packet array. The
+ *  remaining higher bits define a tag that is incremented on every pop from a
+ *  stack.
+ */
+class HostcallBuffer {
+  /** Array of packet headers */
+  PacketHeader* headers_;
+  /** Array of packet payloads */
+  Payload* payloads_;
+  /** Signal used by kernels to indicate new work */
+  void* doorbell_;
+  /** Stack of free packets. Uses tagged pointers. */
+  uint64_t free_stack_;
+  /** Stack of ready packets. Uses tagged pointers */
+  std::atomic<uint64_t> ready_stack_;
+  /** Mask for accessing the packet index in the tagged pointer. */
+  uint64_t index_mask_;
+  /** Some services need a device**/
+  const  amd::Device* device_;
+
+  static uint32_t setControlField(uint32_t control, uint8_t offset, uint8_t width,
+                                  uint32_t value) {
+    uint32_t mask = ~(((1 << width) - 1) << offset);
+    control &= mask;
+    return control | (value << offset);
+  }
+
+  static uint32_t resetReadyFlag(uint32_t control) {
+    return setControlField(control, CONTROL_OFFSET_READY_FLAG, CONTROL_WIDTH_READY_FLAG, 0);
+  }
+
+  static uintptr_t getHeaderStart() {
+    return amd::alignUp(sizeof(HostcallBuffer), alignof(PacketHeader));
+  }
+
+  static uintptr_t getPayloadStart(uint32_t num_packets) {
+    auto header_start = getHeaderStart();
+    auto header_end = header_start + sizeof(PacketHeader) * num_packets;
+    return amd::alignUp(header_end, alignof(Payload));
+  }
+
+ public:
+  PacketHeader* getHeader(uint64_t ptr) const { return headers_ + (ptr & index_mask_); }
+  Payload* getPayload(uint64_t ptr) const { return payloads_ + (ptr & index_mask_); }
+
+  /** \brief Serve the ready packets in batches.
+   *  \param handler Called with the service, the active mask and the payload of a packet.
+   *  \param max_batches The max number of times the ready stack is grabbed.
+   *  \return The number of served packets.
+   *
+   *  The entire ready stack is grabbed at once and its top is set to 0. New requests
+   *  from the device continue pushing on the stack while the grabbed packets are served,
+   *  and they are grabbed as the next batch without waiting for the doorbell again.
+   */
+  template <typename Handler> uint32_t drainPackets(Handler&& handler, uint32_t max_batches) {
+    uint32_t count = 0;
+    for (uint32_t batch = 0; batch < max_batches; ++batch) {
+      uint64_t ready_stack = ready_stack_.exchange(0, std::memory_order_acquire);
+      if (!ready_stack) {
+        break;
+      }
+      // Each wave can submit at most one packet at a time. The ready stack cannot
+      // contain multiple packets from the same wave, so consuming ready packets in
+      // a latest-first order does not affect ordering of hostcall within a wave.
+      for (decltype(ready_stack) iter = ready_stack, next = 0; iter; iter = next) {
+        auto header = getHeader(iter);
+        // Remember the next packet pointer, because we will no longer own the
+        // current packet at the end of this loop.
+        next = header->next_;
+        handler(header->service_, header->activemask_, getPayload(iter));
+        header->control_.store(resetReadyFlag(header->control_), std::memory_order_release);
+        ++count;
+      }
+    }
+    return count;
+  }
+
+  uint32_t processPackets(MessageHandler& messages, HostcallStats& stats);
+
+  void initialize(uint32_t num_packets) {
+    auto base = reinterpret_cast<uint8_t*>(this);
+    headers_ = reinterpret_cast<PacketHeader*>((base + getHeaderStart()));
+    payloads_ = reinterpret_cast<Payload*>((base + getPayloadStart(num_packets)));
+    index_mask_ = getIndexMask(num_packets);
+
+    // The null pointer is identical to (uint64_t)0. When using tagged pointers,
+    // the tag and the index part of the array must never be zero at the same
+    // time. In the initialized free stack, headers[1].next points to headers[0],
+    // which has index 0. We initialize this pointer to have a tag of 1.
+    uint64_t next = index_mask_ + 1;
+
+    // Initialize the free stack.
+    headers_[0].next_ = 0;
+    for (uint32_t ii = 1; ii != num_packets; ++ii) {
+      headers_[ii].next_ = next;
+      next = ii;
+    }
+    free_stack_ = next;
+    ready_stack_ = 0;
+  }
+
+  void setDoorbell(void* doorbell) { doorbell_ = doorbell; };
+  void setDevice(const amd::Device* dptr) { device_ = dptr; };
+
+  static uint64_t getIndexMask(uint32_t num_packets) {
+    // The number of packets is at least equal to the maximum number of waves
+    // supported by the device. That means we do not need to account for the
+    // border cases where num_packets is zero or one.
+    assert(num_packets > 1);
+    if (!amd::isPowerOfTwo(num_packets)) {
+      num_packets = amd::nextPowerOfTwo(num_packets);
+    }
+    return num_packets - 1;
+  }
+
+  /** \brief Determine the buffer size to be allocated
+   *  \param num_packets Number of packets to be supported.
+   *  \return Required size, including any internal padding required for
+   *          the packets and their headers.
+   */
+  static size_t getBufferSize(uint32_t num_packets) {
+    size_t buffer_size = getPayloadStart(num_packets);
+    buffer_size += num_packets * sizeof(Payload);
+    return buffer_size;
+  }
+
+ #if defined(__clang__)
+ #if __has_feature(address_sanitizer)
+ private:
+  device::UriLocator* uri_locator;
+ public:
+  void setUriLocator(device::UriLocator* uri_l) { uri_locator = uri_l; };
+ #endif
+ #endif
+};
+
+static_assert(std::is_standard_layout<HostcallBuffer>::value,
+              "the hostcall buffer must be useable from other languages");
+
+}  // namespace amd
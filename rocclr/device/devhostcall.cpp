@@ -34,7 +34,10 @@
 
 #include <assert.h>
 #include <string.h>
+#include <map>
+#include <memory>
 #include <set>
+#include <vector>
 
 #if defined(__clang__)
 #if __has_feature(address_sanitizer)
@@ -44,24 +47,6 @@
 
 namespace amd {
 
-PacketHeader* HostcallBuffer::getHeader(uint64_t ptr) const {
-  return headers_ + (ptr & index_mask_);
-}
-
-Payload* HostcallBuffer::getPayload(uint64_t ptr) const {
-  return payloads_ + (ptr & index_mask_);
-}
-
-static uint32_t setControlField(uint32_t control, uint8_t offset, uint8_t width, uint32_t value) {
-  uint32_t mask = ~(((1 << width) - 1) << offset);
-  control &= mask;
-  return control | (value << offset);
-}
-
-static uint32_t resetReadyFlag(uint32_t control) {
-  return setControlField(control, CONTROL_OFFSET_READY_FLAG, CONTROL_WIDTH_READY_FLAG, 0);
-}
-
 /** \brief Signature for pointer accepted by the function call service.
  *  \param output Pointer to output arguments.
  *  \param input Pointer to input arguments.
@@ -123,29 +108,56 @@ static void handlePayload(MessageHandler& messages, uint32_t service, uint64_t*
   }
 }
 
-void HostcallBuffer::processPackets(MessageHandler& messages) {
-  // Grab the entire ready stack and set the top to 0. New requests from the
-  // device will continue pushing on the stack while we process the packets that
-  // we have grabbed.
-
-  uint64_t ready_stack = std::atomic_exchange_explicit(&ready_stack_, static_cast<uint64_t>(0), std::memory_order_acquire);
-  if (!ready_stack) {
-    return;
+/** \brief Counters of the hostcall services, owned by one service thread. */
+struct HostcallStats {
+  static constexpr uint32_t kMaxServices = 8;
+  uint64_t packets_[kMaxServices] = {};    //!< The number of packets
+  uint64_t workitems_[kMaxServices] = {};  //!< The number of served work-items
+  uint64_t time_[kMaxServices] = {};       //!< Total service time in ns
+  uint64_t maxTime_[kMaxServices] = {};    //!< The longest service time of a packet in ns
+  uint64_t wakeups_ = 0;                   //!< The number of doorbell wakeups
+
+  void record(uint32_t service, uint64_t workitems, uint64_t time) {
+    service = std::min(service, kMaxServices - 1);
+    ++packets_[service];
+    workitems_[service] += workitems;
+    time_[service] += time;
+    maxTime_[service] = std::max(maxTime_[service], time);
   }
 
-  // Each wave can submit at most one packet at a time. The ready stack cannot
-  // contain multiple packets from the same wave, so consuming ready packets in
-  // a latest-first order does not affect ordering of hostcall within a wave.
-  for (decltype(ready_stack) iter = ready_stack, next = 0; iter; iter = next) {
-    auto header = getHeader(iter);
-    // Remember the next packet pointer, because we will no longer own the
-    // current packet at the end of this loop.
-    next = header->next_;
+  void add(const HostcallStats& stats) {
+    for (uint32_t i = 0; i < kMaxServices; ++i) {
+      packets_[i] += stats.packets_[i];
+      workitems_[i] += stats.workitems_[i];
+      time_[i] += stats.time_[i];
+      maxTime_[i] = std::max(maxTime_[i], stats.maxTime_[i]);
+    }
+    wakeups_ += stats.wakeups_;
+  }
 
-    auto service = header->service_;
-    auto payload = getPayload(iter);
-    auto activemask = header->activemask_;
+  void print(uint32_t threads, uint64_t lifetime) const {
+    ClPrint(amd::LOG_INFO, amd::LOG_QUEUE,
+            "[hostcall] %u threads, %llu wakeups in %.3f s", threads,
+            static_cast<unsigned long long>(wakeups_), lifetime / 1e9);
+    for (uint32_t i = 0; i < kMaxServices; ++i) {
+      if (packets_[i] == 0) {
+        continue;
+      }
+      ClPrint(amd::LOG_INFO, amd::LOG_QUEUE,
+              "[hostcall] service %u: %llu packets, %llu work-items, %.0f packets/s, "
+              "avg %.1f us, max %.1f us per packet", i,
+              static_cast<unsigned long long>(packets_[i]),
+              static_cast<unsigned long long>(workitems_[i]),
+              packets_[i] * 1e9 / std::max<uint64_t>(lifetime, 1),
+              time_[i] / 1e3 / packets_[i], maxTime_[i] / 1e3);
+    }
+  }
+};
 
+uint32_t HostcallBuffer::processPackets(MessageHandler& messages, HostcallStats& stats) {
+  auto serve = [&](uint32_t service, uint64_t activemask, Payload* payload) {
+    uint64_t start = Os::timeNanos();
+    uint64_t workitems = amd::countBitsSet(activemask);
 #if defined(__clang__)
 #if __has_feature(address_sanitizer)
     if (service == SERVICE_SANITIZER) {
@@ -161,70 +173,31 @@ void HostcallBuffer::processPackets(MessageHandler& messages) {
       auto slot = payload->slots[wi];
       handlePayload(messages, service, slot, *device_);
     }
-
-    header->control_.store(resetReadyFlag(header->control_), std::memory_order_release);
-  }
-}
-
-static uintptr_t getHeaderStart() {
-  return amd::alignUp(sizeof(HostcallBuffer), alignof(PacketHeader));
-}
-
-static uintptr_t getPayloadStart(uint32_t num_packets) {
-  auto header_start = getHeaderStart();
-  auto header_end = header_start + sizeof(PacketHeader) * num_packets;
-  return amd::alignUp(header_end, alignof(Payload));
+    stats.record(service, workitems, Os::timeNanos() - start);
+  };
+  return drainPackets(serve, std::max(1u, DEBUG_CLR_HOSTCALL_BATCHES));
 }
 
 size_t getHostcallBufferSize(uint32_t num_packets) {
-  size_t buffer_size = getPayloadStart(num_packets);
-  buffer_size += num_packets * sizeof(Payload);
-  return buffer_size;
+  return HostcallBuffer::getBufferSize(num_packets);
 }
 
 uint32_t getHostcallBufferAlignment() { return alignof(Payload); }
 
-static uint64_t getIndexMask(uint32_t num_packets) {
-  // The number of packets is at least equal to the maximum number of waves
-  // supported by the device. That means we do not need to account for the
-  // border cases where num_packets is zero or one.
-  assert(num_packets > 1);
-  if (!amd::isPowerOfTwo(num_packets)) {
-    num_packets = amd::nextPowerOfTwo(num_packets);
-  }
-  return num_packets - 1;
-}
-
-void HostcallBuffer::initialize(uint32_t num_packets) {
-  auto base = reinterpret_cast<uint8_t*>(this);
-  headers_ = reinterpret_cast<PacketHeader*>((base + getHeaderStart()));
-  payloads_ = reinterpret_cast<Payload*>((base + getPayloadStart(num_packets)));
-  index_mask_ = getIndexMask(num_packets);
-
-  // The null pointer is identical to (uint64_t)0. When using tagged pointers,
-  // the tag and the index part of the array must never be zero at the same
-  // time. In the initialized free stack, headers[1].next points to headers[0],
-  // which has index 0. We initialize this pointer to have a tag of 1.
-  uint64_t next = index_mask_ + 1;
-
-  // Initialize the free stack.
-  headers_[0].next_ = 0;
-  for (uint32_t ii = 1; ii != num_packets; ++ii) {
-    headers_[ii].next_ = next;
-    next = ii;
-  }
-  free_stack_ = next;
-  ready_stack_ = 0;
-}
-
-/** \brief Manage a unique listener thread and its associated buffers.
+/** \brief Manage the hostcall service threads and their associated buffers.
+ *
+ *  The buffers are sharded across DEBUG_CLR_HOSTCALL_THREADS service threads. Every buffer
+ *  is served by one thread with its own message handler, so the packets of a wave are
+ *  always served in order. All threads wait on the same doorbell.
  */
 class HostcallListener {
-  std::set<HostcallBuffer*> buffers_;
+  class Thread;
+  //! Service thread of each buffer
+  std::map<HostcallBuffer*, Thread*> buffers_;
   device::Signal* doorbell_;
-  MessageHandler messages_;
   // Keep track of devices for which signal creation have already been done
   std::set<const amd::Device*> devices_;
+  uint64_t startTime_;
 #if defined(__clang__)
 #if __has_feature(address_sanitizer)
    device::UriLocator* urilocator = nullptr;
@@ -232,18 +205,27 @@ class HostcallListener {
 #endif
   class Thread : public amd::Thread {
    public:
-    Thread() : amd::Thread("Hostcall Listener Thread", CQ_THREAD_STACK_SIZE) {}
+    Thread() : amd::Thread("Hostcall Listener Thread", CQ_THREAD_STACK_SIZE),
+               lock_("Hostcall thread lock") {}
 
-    //! The hostcall listener thread entry point.
+    //! The hostcall service thread entry point.
     void run(void* data) {
       auto listener = reinterpret_cast<HostcallListener*>(data);
-      listener->consumePackets();
+      listener->consumePackets(this);
     }
-  } thread_;  //!< The hostcall listener thread.
 
-  void consumePackets();
+    amd::Monitor lock_;                  //!< Protects the buffers of the thread
+    std::set<HostcallBuffer*> buffers_;  //!< The buffers served by the thread
+    MessageHandler messages_;            //!< The partial messages of the buffers
+    HostcallStats stats_;                //!< Counters, updated by the thread only
+  };
+  std::vector<std::unique_ptr<Thread>> threads_;  //!< The hostcall service threads.
+
+  void consumePackets(Thread* thread);
 
  public:
+  HostcallListener() : doorbell_(nullptr), startTime_(Os::timeNanos()) {}
+
   /** \brief Add a buffer to the listener.
    *
    *  Behaviour is undefined if:
@@ -294,13 +276,14 @@ static struct Init {
     }
   }
 } kHostThreadActive;
-void HostcallListener::consumePackets() {
+void HostcallListener::consumePackets(Thread* thread) {
   uint64_t timeout = kTimeoutFloor;
   uint64_t signal_value = SIGNAL_INIT;
   kHostThreadActive.state = Init::State::kInit;
   while (true) {
     while (true) {
-      if (kHostThreadActive.state == Init::State::kDestroy) {
+      // Any service thread acknowledges the early exit, the others follow
+      if (kHostThreadActive.state >= Init::State::kDestroy) {
         kHostThreadActive.state = Init::State::kExit;
         return;
       }
@@ -321,12 +304,10 @@ void HostcallListener::consumePackets() {
       return;
     }
 
-    if (!idle()) {
-      amd::ScopedLock lock{listenerLock};
-
-      for (auto ii : buffers_) {
-        ii->processPackets(messages_);
-      }
+    amd::ScopedLock lock{thread->lock_};
+    ++thread->stats_.wakeups_;
+    for (auto ii : thread->buffers_) {
+      ii->processPackets(thread->messages_, thread->stats_);
     }
   }
 
@@ -334,15 +315,22 @@ void HostcallListener::consumePackets() {
 }
 
 void HostcallListener::terminate() {
-  if (thread_.state() >= Thread::FINISHED || amd::Os::isThreadAlive(thread_)) {
+  if (kHostThreadActive.state == Init::State::kInit) {
     kHostThreadActive.state = Init::State::kExit;
-    doorbell_->Reset(SIGNAL_DONE);
-
-    // FIXME_lmoriche: fix termination handshake
-    while (thread_.state() < Thread::FINISHED) {
-      amd::Os::yield();
+  }
+  doorbell_->Reset(SIGNAL_DONE);
+  HostcallStats stats;
+  for (auto& thread : threads_) {
+    if (thread->state() >= Thread::FINISHED || amd::Os::isThreadAlive(*thread)) {
+      // FIXME_lmoriche: fix termination handshake
+      while (thread->state() < Thread::FINISHED) {
+        amd::Os::yield();
+      }
     }
+    stats.add(thread->stats_);
   }
+  stats.print(threads_.size(), Os::timeNanos() - startTime_);
+  threads_.clear();
 
 #if defined(__clang__)
 #if __has_feature(address_sanitizer)
@@ -361,11 +349,24 @@ void HostcallListener::addBuffer(HostcallBuffer* buffer) {
   buffer->setUriLocator(urilocator);
 #endif
 #endif
-  buffers_.insert(buffer);
+  // Balance the buffers across the service threads
+  Thread* thread = threads_.front().get();
+  for (auto& it : threads_) {
+    if (it->buffers_.size() < thread->buffers_.size()) {
+      thread = it.get();
+    }
+  }
+  amd::ScopedLock lock(thread->lock_);
+  thread->buffers_.insert(buffer);
+  buffers_[buffer] = thread;
 }
 
 void HostcallListener::removeBuffer(HostcallBuffer* buffer) {
   assert(buffers_.count(buffer) != 0 && "unknown buffer");
+  Thread* thread = buffers_[buffer];
+  // The thread doesn't serve the buffer after the lock was released
+  amd::ScopedLock lock(thread->lock_);
+  thread->buffers_.erase(buffer);
   buffers_.erase(buffer);
 }
 
@@ -377,9 +378,17 @@ bool HostcallListener::initSignal(const amd::Device &dev) {
   urilocator = dev.createUriLocator();
 #endif
 #endif
-  // If the listener thread was not successfully initialized, clean
-  // everything up and bail out.
-  if (thread_.state() < Thread::INITIALIZED) {
+  const uint32_t num_threads = std::max(1u, DEBUG_CLR_HOSTCALL_THREADS);
+  for (uint32_t i = 0; i < num_threads; ++i) {
+    threads_.emplace_back(new Thread());
+    // If a service thread was not successfully initialized, clean
+    // everything up and bail out.
+    if (threads_.back()->state() < Thread::INITIALIZED) {
+      threads_.pop_back();
+      break;
+    }
+  }
+  if (threads_.empty()) {
     delete doorbell_;
     devices_.clear();
 #if defined(__clang__)
@@ -389,7 +398,9 @@ bool HostcallListener::initSignal(const amd::Device &dev) {
 #endif
     return false;
   }
-  thread_.start(this);
+  for (auto& thread : threads_) {
+    thread->start(this);
+  }
   return true;
 }
 
@@ -347,6 +347,8 @@ Memory* Device::p2p_stage_ = nullptr;
 std::shared_mutex MemObjMap::AllocatedLock_ ROCCLR_INIT_PRIORITY(101);
 std::map<uintptr_t, amd::Memory*> MemObjMap::MemObjMap_ ROCCLR_INIT_PRIORITY(101);
 std::map<uintptr_t, amd::Memory*> MemObjMap::VirtualMemObjMap_ ROCCLR_INIT_PRIORITY(101);
+ConcurrentRangeIndex<amd::Memory> MemObjMap::MemObjIndex_ ROCCLR_INIT_PRIORITY(101);
+ConcurrentRangeIndex<amd::Memory> MemObjMap::VirtualMemObjIndex_ ROCCLR_INIT_PRIORITY(101);
 
 void MemObjMap::AddMemObj(const void* k, amd::Memory* v) {
   std::unique_lock lock(AllocatedLock_);
@@ -354,6 +356,8 @@ void MemObjMap::AddMemObj(const void* k, amd::Memory* v) {
   if (!rval.second) {
     DevLogPrintfError("Memobj map already has an entry for ptr: 0x%x",
                       reinterpret_cast<uintptr_t>(k));
+  } else if (DEBUG_CLR_MEMOBJ_RANGE_INDEX) {
+    MemObjIndex_.insert(k, v->getSize(), v);
   }
 }
 
@@ -362,9 +366,23 @@ void MemObjMap::RemoveMemObj(const void* k) {
   auto rval = MemObjMap_.erase(reinterpret_cast<uintptr_t>(k));
   guarantee(rval == 1, "Memobj map does not have ptr: 0x%x",
                         reinterpret_cast<uintptr_t>(k));
+  MemObjIndex_.erase(k);
 }
 
 amd::Memory* MemObjMap::FindMemObj(const void* k, size_t* offset) {
+  if (DEBUG_CLR_MEMOBJ_RANGE_INDEX) {
+    // Lock-free fast path, falls back to the map only if the index can't decide
+    amd::Memory* mem = nullptr;
+    switch (MemObjIndex_.find(k, &mem, offset)) {
+      case ConcurrentRangeIndex<amd::Memory>::Lookup::Hit:
+        return mem;
+      case ConcurrentRangeIndex<amd::Memory>::Lookup::Miss:
+        return nullptr;
+      default:
+        break;
+    }
+  }
+
   std::shared_lock lock(AllocatedLock_);
   uintptr_t key = reinterpret_cast<uintptr_t>(k);
   auto it = MemObjMap_.upper_bound(key);
@@ -412,6 +430,7 @@ void MemObjMap::Purge(amd::Device* dev) {
     unsigned int flags = memObj->getMemFlags();
     const std::vector<Device*>& devices = memObj->getContext().devices();
     if (devices.size() == 1 && devices[0] == dev && !(flags & ROCCLR_MEM_INTERNAL_MEMORY)) {
+      MemObjIndex_.erase(reinterpret_cast<const void*>(it->first));
       memObj->release();
       it = MemObjMap_.erase(it);
     } else {
@@ -426,6 +445,8 @@ void MemObjMap::AddVirtualMemObj(const void* k, amd::Memory* v) {
   if (!rval.second) {
     DevLogPrintfError("Virtual Memobj map already has an entry for ptr: 0x%x",
                       reinterpret_cast<uintptr_t>(k));
+  } else if (DEBUG_CLR_MEMOBJ_RANGE_INDEX) {
+    VirtualMemObjIndex_.insert(k, v->getSize(), v);
   }
 }
 
@@ -434,9 +455,22 @@ void MemObjMap::RemoveVirtualMemObj(const void* k) {
   auto rval = VirtualMemObjMap_.erase(reinterpret_cast<uintptr_t>(k));
   guarantee(rval == 1, "Virtual Memobj map does not have ptr: 0x%x",
                        reinterpret_cast<uintptr_t>(k));
+  VirtualMemObjIndex_.erase(k);
 }
 
 amd::Memory* MemObjMap::FindVirtualMemObj(const void* k) {
+  if (DEBUG_CLR_MEMOBJ_RANGE_INDEX) {
+    amd::Memory* mem = nullptr;
+    switch (VirtualMemObjIndex_.find(k, &mem)) {
+      case ConcurrentRangeIndex<amd::Memory>::Lookup::Hit:
+        return mem;
+      case ConcurrentRangeIndex<amd::Memory>::Lookup::Miss:
+        return nullptr;
+      default:
+        break;
+    }
+  }
+
   std::shared_lock lock(AllocatedLock_);
   uintptr_t key = reinterpret_cast<uintptr_t>(k);
   auto it = VirtualMemObjMap_.upper_bound(key);
@@ -28,6 +28,7 @@
 #include "platform/object.hpp"
 #include "platform/memory.hpp"
 #include "utils/util.hpp"
+#include "utils/rangeindex.hpp"
 #include "amdocl/cl_kernel.h"
 #include "elf/elf.hpp"
 #include "appprofile.hpp"
@@ -1389,6 +1390,10 @@ class MemObjMap : public AllStatic {
   static std::map<uintptr_t, amd::Memory*> MemObjMap_;
   //!< the virtual mem object<->hostptr information container
   static std::map<uintptr_t, amd::Memory*> VirtualMemObjMap_;
+  //!< Lock-free range index in front of MemObjMap_
+  static ConcurrentRangeIndex<amd::Memory> MemObjIndex_;
+  //!< Lock-free range index in front of VirtualMemObjMap_
+  static ConcurrentRangeIndex<amd::Memory> VirtualMemObjIndex_;
   //!< Shared read/write lock
   static std::shared_mutex AllocatedLock_;
 };
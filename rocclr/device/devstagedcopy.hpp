@@ -0,0 +1,159 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#pragma once
+
+#include "top.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace amd {
+
+/*! \brief The DMA step of a staged copy.
+ *
+ *  A staged copy moves unpinned host memory through staging slots, which the DMA engine
+ *  can access. The device backends implement the engine with their copy queues, so the
+ *  pipeline can be exercised on the host with a memcpy engine.
+ */
+class StagedCopyEngine {
+ public:
+  virtual ~StagedCopyEngine() {}
+
+  //! Returns the staging memory of the slot, after the previous DMA of the slot completed
+  virtual address acquire(uint32_t slot, size_t size) = 0;
+
+  //! Submits an asynchronous DMA between the staging memory of the slot and the device
+  virtual bool submit(uint32_t slot, address staging, address device, size_t size,
+                      bool hostToDev) = 0;
+
+  //! Waits until the last DMA of the slot completed
+  virtual bool wait(uint32_t slot) = 0;
+};
+
+/*! \brief A pipelined copy between unpinned host memory and the device.
+ *
+ *  The copy is split into chunks, which rotate over the staging slots. The CPU copy of
+ *  one chunk overlaps the DMA of the previous chunks:
+ *  - Host to device: the chunk k + 1 is copied into its slot while the DMA of the chunk k
+ *    is in flight.
+ *  - Device to host: the DMA of the next chunks is submitted before the CPU copies out
+ *    the chunk k.
+ *  A chunk copy larger than Options::threadSize is split across helper threads.
+ */
+class StagedCopy {
+ public:
+  struct Options {
+    uint32_t slots = 2;                   //!< The number of staging slots
+    size_t chunkSize = 1024 * 1024;       //!< The max size of a chunk
+    uint32_t threads = 1;                 //!< The max number of threads of a CPU copy
+    size_t threadSize = 4 * 1024 * 1024;  //!< The min size of a CPU copy per thread
+  };
+
+  //! Copies unpinned host memory to the device
+  static bool copyToDevice(StagedCopyEngine& engine, const_address hostSrc, address dst,
+                           size_t size, const Options& options) {
+    const uint32_t slots = std::max(1u, options.slots);
+    for (size_t offset = 0; offset < size; offset += options.chunkSize) {
+      const size_t chunk = std::min(options.chunkSize, size - offset);
+      const uint32_t slot = static_cast<uint32_t>((offset / options.chunkSize) % slots);
+      address staging = engine.acquire(slot, chunk);
+      if (staging == nullptr) {
+        return false;
+      }
+      hostCopy(staging, hostSrc + offset, chunk, options);
+      if (!engine.submit(slot, staging, dst + offset, chunk, true)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  //! Copies device memory to unpinned host memory
+  static bool copyToHost(StagedCopyEngine& engine, const_address src, address hostDst,
+                         size_t size, const Options& options) {
+    const uint32_t slots = std::max(1u, options.slots);
+    const size_t chunks = (size + options.chunkSize - 1) / options.chunkSize;
+    std::vector<address> staging(std::min<size_t>(slots, chunks), nullptr);
+    auto submit = [&](size_t index) {
+      const size_t offset = index * options.chunkSize;
+      const size_t chunk = std::min(options.chunkSize, size - offset);
+      const uint32_t slot = static_cast<uint32_t>(index % slots);
+      if (staging[slot] == nullptr) {
+        staging[slot] = engine.acquire(slot, options.chunkSize);
+        if (staging[slot] == nullptr) {
+          return false;
+        }
+      }
+      return engine.submit(slot, staging[slot], const_cast<address>(src) + offset, chunk, false);
+    };
+
+    // Fill the pipeline, then copy out every chunk and reuse its slot for a later chunk
+    size_t submitted = 0;
+    bool status = true;
+    for (; status && submitted < staging.size(); ++submitted) {
+      status = submit(submitted);
+    }
+    for (size_t index = 0; status && index < chunks; ++index) {
+      const uint32_t slot = static_cast<uint32_t>(index % slots);
+      const size_t offset = index * options.chunkSize;
+      status = engine.wait(slot);
+      if (status) {
+        hostCopy(hostDst + offset, staging[slot], std::min(options.chunkSize, size - offset),
+                 options);
+        if (submitted < chunks) {
+          status = submit(submitted++);
+        }
+      }
+    }
+    if (!status) {
+      // The staging memory can't be released while a DMA is in flight
+      for (uint32_t slot = 0; slot < staging.size(); ++slot) {
+        engine.wait(slot);
+      }
+    }
+    return status;
+  }
+
+ private:
+  static void hostCopy(address dst, const_address src, size_t size, const Options& options) {
+    size_t threads = std::min<size_t>(options.threads,
+                                      size / std::max<size_t>(options.threadSize, 1));
+    if (threads <= 1) {
+      memcpy(dst, src, size);
+      return;
+    }
+    // Cache line aligned parts
+    size_t part = ((size + threads - 1) / threads + 63) & ~static_cast<size_t>(63);
+    std::vector<std::thread> helpers;
+    for (size_t offset = part; offset < size; offset += part) {
+      const size_t bytes = std::min(part, size - offset);
+      helpers.emplace_back([=]() { memcpy(dst + offset, src + offset, bytes); });
+    }
+    memcpy(dst, src, std::min(part, size));
+    for (auto& helper : helpers) {
+      helper.join();
+    }
+  }
+};
+
+}  // namespace amd
@@ -24,6 +24,7 @@
 #include "device/rocm/rocmemory.hpp"
 #include "device/rocm/rockernel.hpp"
 #include "device/rocm/rocsched.hpp"
+#include "device/devstagedcopy.hpp"
 #include "utils/debug.hpp"
 #include <algorithm>
 
@@ -622,65 +623,78 @@ bool DmaBlitManager::hsaCopyStaged(const_address hostSrc, address hostDst, size_
   // Stall GPU, sicne CPU copy is possible
   gpu().releaseGpuMemoryFence(hostToDev);
 
-  size_t totalSize = size;
-  size_t stagedCopyOffset = 0;
-  bool status = true;
-  Memory* xferBuf = nullptr;
-  address stagingBuffer = 0;
-  size_t maxStagedXferSize = dev().settings().stagedXferSize_;
-
-  if (!hostToDev) {
-    // Get static staging buffer as we need to wait until copy on GPU completes to copy
-    // it back to the unpinned buffer
-    xferBuf = &dev().xferRead().acquire();
-    stagingBuffer = xferBuf->getDeviceMemory();
-  }
-
-  // Allocate requested size of memory
-  while (totalSize > 0) {
-    size = std::min(totalSize, maxStagedXferSize);
-
-    hsa_agent_t srcAgent;
-    hsa_agent_t dstAgent;
-
-    // Copy data from Host to Device
-    if (hostToDev) {
-      hsa_agent_t srcAgent = dev().getCpuAgent();
-      hsa_agent_t dstAgent = dev().getBackendDevice();
-
-      // Get an address from managed staging buffer
-      stagingBuffer = gpu().Staging().Acquire(std::min(size, maxStagedXferSize));
+  //! SDMA copies between the staging buffers and the device memory
+  class DmaEngine : public amd::StagedCopyEngine {
+   public:
+    DmaEngine(const DmaBlitManager& blit, bool hostToDev, amd::CopyMetadata& copyMetadata,
+              uint32_t slots)
+        : blit_(blit), hostToDev_(hostToDev), copyMetadata_(copyMetadata),
+          xferBufs_(slots, nullptr), signals_(slots, nullptr) {}
+
+    ~DmaEngine() {
+      for (auto xferBuf : xferBufs_) {
+        if (xferBuf != nullptr) {
+          blit_.dev().xferRead().release(blit_.gpu(), *xferBuf);
+        }
+      }
+    }
 
-      address dst = hostDst + stagedCopyOffset;
-      memcpy(stagingBuffer, hostSrc + stagedCopyOffset, size);
-      ClPrint(amd::LOG_DEBUG, amd::LOG_COPY, "HSA Async Copy staged H2D");
-      status = rocrCopyBuffer(dst, dstAgent, stagingBuffer, srcAgent, size, copyMetadata);
-      if (!status) {
-        break;
+    address acquire(uint32_t slot, size_t size) override {
+      if (hostToDev_) {
+        // The managed staging buffer waits for the previous use of its memory
+        return blit_.gpu().Staging().Acquire(size);
       }
-    } else {
-      dstAgent = dev().getCpuAgent();
-      srcAgent = dev().getBackendDevice();
-
-      const_address src = static_cast<const_address>(hostSrc) + stagedCopyOffset;
-      ClPrint(amd::LOG_DEBUG, amd::LOG_COPY, "HSA Async Copy staged D2H");
-      status = rocrCopyBuffer(stagingBuffer, dstAgent, src, srcAgent, size, copyMetadata);
-      if (status) {
-        gpu().Barriers().WaitCurrent();
-        memcpy(hostDst + stagedCopyOffset, stagingBuffer, size);
-      } else {
-        break;
+      if (!wait(slot)) {
+        return nullptr;
       }
+      // Static staging buffers, the CPU copies the data back after the DMA completed
+      if (xferBufs_[slot] == nullptr) {
+        xferBufs_[slot] = &blit_.dev().xferRead().acquire();
+      }
+      return reinterpret_cast<address>(xferBufs_[slot]->getDeviceMemory());
     }
 
-    totalSize -= size;
-    stagedCopyOffset += size;
-  }
+    bool submit(uint32_t slot, address staging, address device, size_t size,
+                bool hostToDev) override {
+      hsa_agent_t cpuAgent = blit_.dev().getCpuAgent();
+      hsa_agent_t gpuAgent = blit_.dev().getBackendDevice();
+      bool status;
+      if (hostToDev) {
+        ClPrint(amd::LOG_DEBUG, amd::LOG_COPY, "HSA Async Copy staged H2D");
+        status = blit_.rocrCopyBuffer(device, gpuAgent, staging, cpuAgent, size, copyMetadata_);
+      } else {
+        ClPrint(amd::LOG_DEBUG, amd::LOG_COPY, "HSA Async Copy staged D2H");
+        status = blit_.rocrCopyBuffer(staging, cpuAgent, device, gpuAgent, size, copyMetadata_);
+      }
+      signals_[slot] = status ? blit_.gpu().Barriers().GetLastSignal() : nullptr;
+      return status;
+    }
 
-  if (!hostToDev) {
-    dev().xferRead().release(gpu(), *xferBuf);
-  }
+    bool wait(uint32_t slot) override {
+      if (signals_[slot] == nullptr) {
+        return true;
+      }
+      bool status = blit_.gpu().Barriers().WaitSignal(signals_[slot]);
+      signals_[slot] = nullptr;
+      return status;
+    }
 
+   private:
+    const DmaBlitManager& blit_;
+    bool hostToDev_;
+    amd::CopyMetadata& copyMetadata_;
+    std::vector<Memory*> xferBufs_;          //!< Staging buffers of the D2H slots
+    std::vector<ProfilingSignal*> signals_;  //!< The last DMA of every slot
+  };
+
+  amd::StagedCopy::Options options;
+  options.slots = std::max(1u, DEBUG_CLR_STAGED_COPY_SLOTS);
+  options.chunkSize = dev().settings().stagedXferSize_;
+  options.threads = std::max(1u, DEBUG_CLR_STAGED_COPY_THREADS);
+  DmaEngine engine(*this, hostToDev, copyMetadata, options.slots);
+  bool status = hostToDev
+      ? amd::StagedCopy::copyToDevice(engine, hostSrc, hostDst, size, options)
+      : amd::StagedCopy::copyToHost(engine, hostSrc, hostDst, size, options);
   if (!status) {
     return false;
   }
@@ -2589,7 +2603,12 @@ amd::Memory* DmaBlitManager::pinHostMemory(const void* hostMem, size_t pinSize,
   // Recalculate pin memory size
   pinAllocSize = amd::alignUp(pinSize + partial, PinnedMemoryAlignment);
 
-  amdMemory = gpu().findPinnedMem(tmpHost, pinAllocSize);
+  if (dev().PinnedCacheEnabled()) {
+    // Any cached range containing the host memory can be reused, the offset is from its base
+    amdMemory = dev().FindPinnedMem(hostMem, pinSize, &partial);
+  } else {
+    amdMemory = gpu().findPinnedMem(tmpHost, pinAllocSize);
+  }
 
   if (nullptr != amdMemory) {
     return amdMemory;
@@ -2610,6 +2629,7 @@ amd::Memory* DmaBlitManager::pinHostMemory(const void* hostMem, size_t pinSize,
   if (srcMemory == nullptr) {
     // Release all pinned memory and attempt pinning again
     gpu().releasePinnedMem();
+    dev().ReleasePinnedMem();
     srcMemory = dev().getRocMemory(amdMemory);
     if (srcMemory == nullptr) {
       // Release memory
@@ -2618,6 +2638,10 @@ amd::Memory* DmaBlitManager::pinHostMemory(const void* hostMem, size_t pinSize,
     }
   }
 
+  if (amdMemory != nullptr) {
+    dev().CachePinnedMem(amdMemory);
+  }
+
   return amdMemory;
 }
 
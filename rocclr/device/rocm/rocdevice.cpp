@@ -173,6 +173,7 @@ bool NullDevice::create(const amd::Isa &isa) {
 Device::Device(hsa_agent_t bkendDevice)
     : mapCacheOps_(nullptr)
     , mapCache_(nullptr)
+    , pinnedCache_(DEBUG_CLR_PINNED_CACHE_SIZE * Mi, PinnedMemoryAlignment)
     , bkendDevice_(bkendDevice)
     , pciDeviceId_(0)
     , gpuvm_segment_max_alloc_(0)
@@ -256,6 +257,17 @@ Device::~Device() {
   delete mapCache_;
   delete mapCacheOps_;
 
+  // Release cached pinned memory
+  ReleasePinnedMem();
+  if (PinnedCacheEnabled()) {
+    const auto& stats = pinnedCache_.stats();
+    ClPrint(amd::LOG_INFO, amd::LOG_MEM, "Pinned memory cache: %llu hits, %llu misses, "
+            "%llu evictions, %llu invalidations", static_cast<unsigned long long>(stats.hits_),
+            static_cast<unsigned long long>(stats.misses_),
+            static_cast<unsigned long long>(stats.evictions_),
+            static_cast<unsigned long long>(stats.invalidations_));
+  }
+
   if (nullptr != p2p_stage_) {
     p2p_stage_->release();
     p2p_stage_ = nullptr;
@@ -2071,6 +2083,70 @@ bool Device::addMapTarget(amd::Memory* memory) const {
   return true;
 }
 
+// ================================================================================================
+amd::Memory* Device::FindPinnedMem(const void* hostMem, size_t size, size_t* offset) const {
+  if (!PinnedCacheEnabled()) {
+    return nullptr;
+  }
+  amd::ScopedLock lk(pinnedCacheOps_);
+  amd::Memory* memory = nullptr;
+  uintptr_t base = 0;
+  if (!pinnedCache_.find(hostMem, size, &memory, &base)) {
+    return nullptr;
+  }
+  // The caller holds a reference, so an eviction can't destroy the buffer in use
+  memory->retain();
+  *offset = reinterpret_cast<uintptr_t>(hostMem) - base;
+  return memory;
+}
+
+// ================================================================================================
+void Device::CachePinnedMem(amd::Memory* memory) const {
+  if (!PinnedCacheEnabled()) {
+    return;
+  }
+  std::vector<amd::Memory*> removed;
+  {
+    amd::ScopedLock lk(pinnedCacheOps_);
+    memory->retain();
+    if (!pinnedCache_.insert(memory->getHostMem(), memory->getSize(), memory, &removed)) {
+      removed.push_back(memory);
+    }
+  }
+  // The release may unpin memory, so it's done outside of the lock
+  for (auto it : removed) {
+    it->release();
+  }
+}
+
+// ================================================================================================
+void Device::InvalidatePinnedMem(const void* hostMem, size_t size) const {
+  if (!PinnedCacheEnabled()) {
+    return;
+  }
+  std::vector<amd::Memory*> removed;
+  {
+    amd::ScopedLock lk(pinnedCacheOps_);
+    pinnedCache_.invalidate(hostMem, size, &removed);
+  }
+  for (auto it : removed) {
+    it->release();
+  }
+}
+
+// ================================================================================================
+void Device::ReleasePinnedMem() const {
+  std::vector<amd::Memory*> removed;
+  {
+    amd::ScopedLock lk(pinnedCacheOps_);
+    pinnedCache_.clear(&removed);
+  }
+  for (auto it : removed) {
+    it->release();
+  }
+}
+
+// ================================================================================================
 Memory* Device::getRocMemory(amd::Memory* mem) const {
   return static_cast<roc::Memory*>(mem->getDeviceMemory(*this));
 }
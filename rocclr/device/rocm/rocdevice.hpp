@@ -33,6 +33,7 @@
 #include "thread/thread.hpp"
 #include "thread/monitor.hpp"
 #include "utils/versions.hpp"
+#include "utils/rangecache.hpp"
 
 #include "device/rocm/rocsettings.hpp"
 #include "device/rocm/rocvirtual.hpp"
@@ -521,6 +522,21 @@ class Device : public NullDevice {
   //! Adds a map target to the cache
   bool addMapTarget(amd::Memory* memory) const;
 
+  //! Finds a cached pinned buffer containing the host range, returns it retained
+  amd::Memory* FindPinnedMem(const void* hostMem, size_t size, size_t* offset) const;
+
+  //! Adds a pinned buffer to the cache, the cache holds a reference
+  void CachePinnedMem(amd::Memory* memory) const;
+
+  //! Releases the cached pinned buffers overlapping the host range
+  void InvalidatePinnedMem(const void* hostMem, size_t size) const;
+
+  //! Releases all cached pinned buffers
+  void ReleasePinnedMem() const;
+
+  //! Returns true if the pinned host memory is cached across the virtual gpus
+  bool PinnedCacheEnabled() const { return pinnedCache_.budget() != 0; }
+
   //! Returns transfer buffer object
   XferBuffers& xferRead() const { return *xferRead_; }
 
@@ -621,6 +637,8 @@ class Device : public NullDevice {
 
   amd::Monitor* mapCacheOps_;            //!< Lock to serialise cache for the map resources
   std::vector<amd::Memory*>* mapCache_;  //!< Map cache info structure
+  mutable amd::Monitor pinnedCacheOps_;  //!< Lock to serialise the pinned memory cache
+  mutable amd::RangeCache<amd::Memory*> pinnedCache_;  //!< Pinned host memory cache
 
   bool populateOCLDeviceConstants();
   static bool isHsaInitialized_;
@@ -65,6 +65,16 @@ Memory::~Memory() {
     pinnedMemory_->release();
   }
 
+  // The freed or unregistered host range may be remapped, so the cached pins are stale.
+  // The internal objects, including the cached pinned buffers, are skipped
+  if ((owner() != nullptr) && (owner()->getVirtualDevice() == nullptr)) {
+    const void* hostMem = (owner()->getHostMem() != nullptr) ? owner()->getHostMem() :
+                                                                owner()->getSvmPtr();
+    if (hostMem != nullptr) {
+      dev().InvalidatePinnedMem(hostMem, owner()->getSize());
+    }
+  }
+
   dev().removeVACache(this);
   if (nullptr != mapMemory_) {
     mapMemory_->release();
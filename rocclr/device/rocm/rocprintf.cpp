@@ -131,13 +131,11 @@ int PrintfDbg::checkVectorSpecifier(const std::string& fmt, size_t startPos, siz
   return vectorSize;
 }
 
-static constexpr size_t ConstStr = 0xffffffff;
-static constexpr char Separator[] = ",\0";
+static constexpr char Separator[] = ",";
 
 size_t PrintfDbg::outputArgument(const std::string& fmt, bool printFloat, size_t size,
-                                 const void* argument) const {
-  // Serialize the output to the screen
-  // amd::ScopedLock k(dev().lockAsyncOps());
+                                 const void* argument) {
+  // The output is collected in output_ and written once per work-item
   size_t copiedBytes = size;
   // Print the string argument, using standard PrintfDbg()
   if (checkString(fmt.c_str())) {
@@ -145,12 +143,12 @@ size_t PrintfDbg::outputArgument(const std::string& fmt, bool printFloat, size_t
     copiedBytes = 0;
     //(null) should be printed
     if (*(reinterpret_cast<const unsigned char*>(argument)) == 0) {
-      amd::Os::printf(fmt.data(), 0);
+      output_.printf(fmt.data(), 0);
       // copiedBytes = strlen("(null)")
       copiedBytes = 6;
     } else {
       const unsigned char* argumentStr = reinterpret_cast<const unsigned char*>(argument);
-      amd::Os::printf(fmt.data(), argumentStr);
+      output_.printf(fmt.data(), argumentStr);
       // copiedBytes = strlen(argumentStr)
       while (argumentStr[copiedBytes++] != 0)
         ;
@@ -168,13 +166,13 @@ size_t PrintfDbg::outputArgument(const std::string& fmt, bool printFloat, size_t
     switch (size) {
       case 0: {
         const char* str = reinterpret_cast<const char*>(argument);
-        amd::Os::printf(fmt.data(), str);
+        output_.printf(fmt.data(), str);
         // Find the string length
         while (str[copiedBytes++] != 0)
           ;
       } break;
       case 1:
-        amd::Os::printf(fmt.data(), *(reinterpret_cast<const unsigned char*>(argument)));
+        output_.printf(fmt.data(), *(reinterpret_cast<const unsigned char*>(argument)));
         break;
       case 2:
       case 4:
@@ -192,20 +190,20 @@ size_t PrintfDbg::outputArgument(const std::string& fmt, bool printFloat, size_t
           float fSign = copysign(1.0, fArg);
           if (std::isinf(fArg) && !std::isnan(fArg)) {
             if (fSign < 0) {
-              amd::Os::printf(fmtF.data(), "-infinity");
+              output_.printf(fmtF.data(), "-infinity");
             } else {
-              amd::Os::printf(fmtF.data(), "infinity");
+              output_.printf(fmtF.data(), "infinity");
             }
           } else if (std::isnan(fArg)) {
             if (fSign < 0) {
-              amd::Os::printf(fmtF.data(), "-nan");
+              output_.printf(fmtF.data(), "-nan");
             } else {
-              amd::Os::printf(fmtF.data(), "nan");
+              output_.printf(fmtF.data(), "nan");
             }
           } else if (hlModifier) {
-            amd::Os::printf(hlFmt.data(), fArg);
+            output_.printf(hlFmt.data(), fArg);
           } else {
-            amd::Os::printf(fmt.data(), fArg);
+            output_.printf(fmt.data(), fArg);
           }
         } else {
           bool hhModifier = (strstr(fmt.c_str(), "hh") != nullptr);
@@ -217,13 +215,13 @@ size_t PrintfDbg::outputArgument(const std::string& fmt, bool printFloat, size_t
             // fmt should be updated not to contain "hh" modifier
             std::string hhFmt = fmt;
             hhFmt.erase(hhFmt.find_first_of("h"), 2);
-            amd::Os::printf(hhFmt.data(), *(reinterpret_cast<const unsigned char*>(argument)));
+            output_.printf(hhFmt.data(), *(reinterpret_cast<const unsigned char*>(argument)));
           } else if (hlModifier) {
-            amd::Os::printf(hlFmt.data(), size == 2 ?
+            output_.printf(hlFmt.data(), size == 2 ?
                 *(reinterpret_cast<const uint16_t *>(argument)):
                 *(reinterpret_cast<const uint32_t *>(argument)));
           } else {
-            amd::Os::printf(fmt.data(), size == 2 ?
+            output_.printf(fmt.data(), size == 2 ?
                 *(reinterpret_cast<const uint16_t *>(argument)):
                 *(reinterpret_cast<const uint32_t *>(argument)));
           }
@@ -232,38 +230,30 @@ size_t PrintfDbg::outputArgument(const std::string& fmt, bool printFloat, size_t
       case 8:
         if (printFloat) {
           if (hlModifier) {
-            amd::Os::printf(hlFmt.data(), *(reinterpret_cast<const double*>(argument)));
+            output_.printf(hlFmt.data(), *(reinterpret_cast<const double*>(argument)));
           } else {
-            amd::Os::printf(fmt.data(), *(reinterpret_cast<const double*>(argument)));
+            output_.printf(fmt.data(), *(reinterpret_cast<const double*>(argument)));
           }
         } else {
           std::string out = fmt;
           // Use 'll' for 64 bit printf
           out.insert((out.size() - 1), 1, 'l');
-          amd::Os::printf(out.data(), *(reinterpret_cast<const uint64_t*>(argument)));
+          output_.printf(out.data(), *(reinterpret_cast<const uint64_t*>(argument)));
         }
         break;
-      case ConstStr: {
-        const char* str = reinterpret_cast<const char*>(argument);
-        amd::Os::printf(fmt.data(), str);
-      } break;
       default:
-        amd::Os::printf("Error: Unsupported data size for PrintfDbg. %d bytes",
-                        static_cast<int>(size));
+        output_.printf("Error: Unsupported data size for PrintfDbg. %d bytes",
+                       static_cast<int>(size));
         return 0;
     }
   }
-  fflush(stdout);
   return copiedBytes;
 }
 
-void PrintfDbg::outputDbgBuffer(const device::PrintfInfo& info, const uint32_t* workitemData,
-                                size_t& i) const {
+void PrintfDbg::buildOutputPlan(const device::PrintfInfo& info, OutputPlan* plan) const {
   static const char* specifiers = "cdieEfgGaosuxXp";
   static const char* modifiers = "hl";
   static const char* special = "%n";
-  static const std::string sepStr = "%s";
-  const uint32_t* s = workitemData;
   size_t pos = 0;
 
   // Find the format string
@@ -271,13 +261,18 @@ void PrintfDbg::outputDbgBuffer(const device::PrintfInfo& info, const uint32_t*
   std::string fmt;
   size_t posStart, posEnd;
 
-  // Print all arguments
+  auto addLiteral = [plan](const std::string& text, int kind) {
+    if (!text.empty()) {
+      plan->steps_.push_back({text, std::string(), kind, 0, false});
+    }
+  };
+
   // Note: the following code walks through all arguments, provided by the
   // kernel and
   // finds the corresponding specifier in the format string.
   // Then it splits the original string into substrings with a single specifier
   // and
-  // uses standard PrintfDbg() to print each argument
+  // records a step to print each argument with standard printf()
   for (uint j = 0; j < info.arguments_.size(); ++j) {
     do {
       posStart = str.find_first_of("%", pos);
@@ -295,38 +290,35 @@ void PrintfDbg::outputDbgBuffer(const device::PrintfInfo& info, const uint32_t*
           fmt = str.substr(pos, posEnd - pos);
           fmt.erase(posStart - pos - 1, 1);
           pos = posStart = posEnd;
-          outputArgument(sepStr, false, ConstStr, fmt.data());
+          addLiteral(fmt, kLiteral);
           continue;
         }
         break;
       } else if (pos < str.length()) {
-        outputArgument(sepStr, false, ConstStr,
-                       str.substr(pos).data());
+        addLiteral(str.substr(pos), kLiteral);
       }
     } while (posStart != std::string::npos);
 
     if (posStart != std::string::npos) {
-      bool printFloat = false;
-      int vectorSize = 0;
+      OutputStep step = {std::string(), std::string(), static_cast<int>(j), 0, false};
       size_t idPos = 0;
 
       // Search for PrintfDbg specifier in the format string.
       // It will be a split point for the output
       posEnd = str.find_first_of(specifiers, posStart);
       if (posEnd == std::string::npos) {
-        pos = posStart = posEnd;
-        break;
+        return;
       }
       posEnd++;
 
       size_t curPos = posEnd;
-      vectorSize = checkVectorSpecifier(str, posStart, curPos);
+      step.vectorSize_ = checkVectorSpecifier(str, posStart, curPos);
 
       // Get substring from the last position to the current specifier
       fmt = str.substr(pos, posEnd - pos);
 
       // Readjust the string pointer if PrintfDbg outputs a vector
-      if (vectorSize != 0) {
+      if (step.vectorSize_ != 0) {
         size_t posVecSpec = fmt.length() - (curPos + 1);
         size_t posVecMod = fmt.find_first_of(modifiers, posVecSpec + 1);
         size_t posMod = str.find_first_of(modifiers, posStart);
@@ -336,57 +328,88 @@ void PrintfDbg::outputDbgBuffer(const device::PrintfInfo& info, const uint32_t*
           fmt = fmt.erase(posVecSpec, curPos);
         }
         idPos = posStart - pos - 1;
+        step.elementFmt_ = fmt.substr(idPos, fmt.size());
       }
       pos = posStart = posEnd;
 
       // Find out if the argument is a float
-      printFloat = checkFloat(fmt);
-
-      // Is it a scalar value?
-      if (vectorSize == 0) {
-        size_t length;
-        length = outputArgument(fmt, printFloat, info.arguments_[j], &s[i]);
-        if (0 == length) {
-          return;
-        }
-        i += amd::alignUp(length, sizeof(uint32_t)) / sizeof(uint32_t);
-      } else {
-        // 3-component vector's size is defined as 4 * size of each scalar
-        // component
-        size_t elemSize = info.arguments_[j] / (vectorSize == 3 ? 4 : vectorSize);
-        size_t k = i * sizeof(uint32_t);
-        std::string elementStr = fmt.substr(idPos, fmt.size());
-
-        // Print first element with full string
-        if (0 == outputArgument(fmt, printFloat, elemSize, &s[i])) {
-          return;
-        }
-
-        // Print other elemnts with separator if available
-        for (int e = 1; e < vectorSize; ++e) {
-          const char* t = reinterpret_cast<const char*>(s);
-
-          // Output the vector separator
-          outputArgument(sepStr, false, ConstStr, reinterpret_cast<const uint32_t*>(Separator));
-
-          // Output the next element
-          outputArgument(elementStr, printFloat, elemSize,
-                         reinterpret_cast<const uint32_t*>(&t[k + e * elemSize]));
-        }
-        i += (amd::alignUp(info.arguments_[j], sizeof(uint32_t))) / sizeof(uint32_t);
-      }
+      step.printFloat_ = checkFloat(fmt);
+      step.fmt_ = fmt;
+      plan->steps_.push_back(std::move(step));
     } else {
-      amd::Os::printf(
-          "Error: The arguments don't match the printf format string. "
-          "printf(%s)",
-          info.fmtString_.data());
+      addLiteral(std::string("Error: The arguments don't match the printf format string. "
+                             "printf(") + info.fmtString_.c_str() + ")", kError);
       return;
     }
   }
 
   if (pos != std::string::npos) {
-    fmt = str.substr(pos, str.size() - pos);
-    outputArgument(sepStr, false, ConstStr, reinterpret_cast<const uint32_t*>(fmt.data()));
+    addLiteral(str.substr(pos, str.size() - pos), kLiteral);
+  }
+}
+
+const PrintfDbg::OutputPlan& PrintfDbg::outputPlan(const device::PrintfInfo& info) {
+  auto it = plans_.find(info.fmtString_);
+  if ((it != plans_.end()) && (it->second.numArguments_ == info.arguments_.size())) {
+    return it->second;
+  }
+  if (plans_.size() >= amd::PrintfPlan::kMaxPlans) {
+    plans_.clear();
+  }
+  OutputPlan& plan = plans_[info.fmtString_];
+  plan.numArguments_ = info.arguments_.size();
+  plan.steps_.clear();
+  buildOutputPlan(info, &plan);
+  return plan;
+}
+
+void PrintfDbg::outputDbgBuffer(const device::PrintfInfo& info, const uint32_t* workitemData,
+                                size_t& i) {
+  const uint32_t* s = workitemData;
+
+  // Print all arguments with the output steps of the format string
+  for (const auto& step : outputPlan(info).steps_) {
+    if (step.arg_ < 0) {
+      output_.append(step.fmt_.data(), step.fmt_.size());
+      if (step.arg_ == kError) {
+        return;
+      }
+      continue;
+    }
+
+    size_t argSize = info.arguments_[step.arg_];
+    // Is it a scalar value?
+    if (step.vectorSize_ == 0) {
+      size_t length;
+      length = outputArgument(step.fmt_, step.printFloat_, argSize, &s[i]);
+      if (0 == length) {
+        return;
+      }
+      i += amd::alignUp(length, sizeof(uint32_t)) / sizeof(uint32_t);
+    } else {
+      // 3-component vector's size is defined as 4 * size of each scalar
+      // component
+      size_t elemSize = argSize / (step.vectorSize_ == 3 ? 4 : step.vectorSize_);
+      size_t k = i * sizeof(uint32_t);
+
+      // Print first element with full string
+      if (0 == outputArgument(step.fmt_, step.printFloat_, elemSize, &s[i])) {
+        return;
+      }
+
+      // Print other elemnts with separator if available
+      for (int e = 1; e < step.vectorSize_; ++e) {
+        const char* t = reinterpret_cast<const char*>(s);
+
+        // Output the vector separator
+        output_.append(Separator, 1);
+
+        // Output the next element
+        outputArgument(step.elementFmt_, step.printFloat_, elemSize,
+                       reinterpret_cast<const uint32_t*>(&t[k + e * elemSize]));
+      }
+      i += (amd::alignUp(argSize, sizeof(uint32_t))) / sizeof(uint32_t);
+    }
   }
 }
 
@@ -463,6 +486,8 @@ bool PrintfDbg::output(VirtualGPU& gpu, bool printfEnabled,
       if(!amd::populateFormatStringHashMap(printfInfo, StrMap))
         return false;
 
+      // The message buffer is reused, the format plans are cached by handlePrintfDelayed()
+      std::vector<uint8_t> PBuffer;
       while (sbt < offsetSize)
       {
         auto controlDword = *BufferForHIP++;
@@ -470,7 +495,6 @@ bool PrintfDbg::output(VirtualGPU& gpu, bool printfEnabled,
 
         uint64_t nextOffset  = controlDword >> 2;
 
-        std::vector<uint8_t> PBuffer;
         uint64_t BufferLen = 0;
         if (controlDword & 2U) {
           // Process the contsant format string case.
@@ -480,7 +504,7 @@ bool PrintfDbg::output(VirtualGPU& gpu, bool printfEnabled,
           // string followed by arguments. The format string is
           // obtained by querying StrMap populated before.
           auto ArgsLen = nextOffset - 12;
-          auto Str = StrMap[*PB++];
+          const auto& Str = StrMap[*PB++];
           auto StrLenWithNull = Str.size() + 1;
           BufferLen = ArgsLen + amd::alignUp(StrLenWithNull, sizeof(uint64_t));
           PBuffer.resize(BufferLen);
@@ -497,7 +521,7 @@ bool PrintfDbg::output(VirtualGPU& gpu, bool printfEnabled,
             // buffer
             BufferLen = nextOffset - /*ControlDWord*/4;
             PBuffer.resize(BufferLen);
-            memcpy(PBuffer.data(), BufferForHIP, nextOffset);
+            memcpy(PBuffer.data(), BufferForHIP, BufferLen);
         }
 
         // Handle printing
@@ -524,12 +548,15 @@ bool PrintfDbg::output(VirtualGPU& gpu, bool printfEnabled,
 
       size_t idx = 1;
       // There's something in the debug buffer
+      output_.clear();
       outputDbgBuffer(info, dbgBufferPtr, idx);
+      fwrite(output_.data(), 1, output_.size(), stdout);
 
       sbt += sb;
       dbgBufferPtr += sb / sizeof(uint32_t);
       sb = 0;
     }
+    fflush(stdout);
   }
 
   return true;
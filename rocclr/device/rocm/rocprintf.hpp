@@ -20,6 +20,12 @@
 
 #pragma once
 
+#include "utils/printfplan.hpp"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 /*! \addtogroup GPU GPU Device Implementation
  *  @{
  */
@@ -73,10 +79,29 @@ class PrintfDbg : public amd::HeapObject {
   address dbgBuffer() const { return dbgBuffer_; }
 
  protected:
+  //! A step of the output of a format string, a literal or an argument
+  struct OutputStep {
+    std::string fmt_;         //!< Literal text or the format of the argument
+    std::string elementFmt_;  //!< Format of the vector elements after the first one
+    int arg_;                 //!< Index of the argument, or kLiteral/kError for text
+    int vectorSize_;          //!< The number of vector elements, 0 for scalars
+    bool printFloat_;         //!< The argument is a float value
+  };
+  static constexpr int kLiteral = -1;  //!< The step outputs text
+  static constexpr int kError = -2;    //!< The step outputs an error and stops
+
+  //! The output steps of a format string, parsed once
+  struct OutputPlan {
+    size_t numArguments_ = 0;        //!< The number of the arguments of the format string
+    std::vector<OutputStep> steps_;  //!< Output steps
+  };
+
   address dbgBuffer_;      //!< Buffer to hold debug output
   size_t dbgBuffer_size_;  //!< Size of the debugger buffer
   FILE* dbgFile_;          //!< Debug file
   Device& gpuDevice_;      //!< GPU device object
+  std::unordered_map<std::string, OutputPlan> plans_;  //!< Plans of the format strings
+  amd::PrintfBuffer output_;  //!< Output of the current work-item
 
   //! Gets GPU device object
   Device& dev() const { return gpuDevice_; }
@@ -104,13 +129,22 @@ class PrintfDbg : public amd::HeapObject {
                         bool printFloat,          //!< Argument is a float value
                         size_t size,              //!< Argument's size
                         const void* argument      //!< Argument's location
-                        ) const;
+                        );
+
+  //! Splits the format string into the output steps
+  void buildOutputPlan(const device::PrintfInfo& info,  //!< printf info
+                       OutputPlan* plan                 //!< The output steps
+                       ) const;
+
+  //! Returns the cached output steps of the format string
+  const OutputPlan& outputPlan(const device::PrintfInfo& info  //!< printf info
+                               );
 
   //! Displays the PrintfDbg
   void outputDbgBuffer(const device::PrintfInfo& info,//!< printf info
                        const uint32_t* workitemData,  //!< The PrintfDbg dump buffer
                        size_t& i                      //!< index to the data in the buffer
-                       ) const;
+                       );
 
  private:
   //! Disable copy constructor
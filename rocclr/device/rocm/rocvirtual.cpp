@@ -250,18 +250,22 @@ bool HsaAmdSignalHandler(hsa_signal_value_t value, void* arg) {
 // ================================================================================================
 bool VirtualGPU::MemoryDependency::create(size_t numMemObj) {
   if (numMemObj > 0) {
-    // Allocate the array of memory objects for dependency tracking
-    memObjectsInQueue_ = new MemoryState[numMemObj];
-    if (nullptr == memObjectsInQueue_) {
-      return false;
-    }
-    memset(memObjectsInQueue_, 0, sizeof(MemoryState) * numMemObj);
+    kernelMemory_.reserve(numMemObj);
     maxMemObjectsInQueue_ = numMemObj;
   }
 
   return true;
 }
 
+// ================================================================================================
+void VirtualGPU::MemoryDependency::newKernel() {
+  // Objects of the previous kernel become busy for the new one
+  for (const auto& state : kernelMemory_) {
+    busyMemory_.insert(state.start_, state.end_, state.readOnly_);
+  }
+  kernelMemory_.clear();
+}
+
 // ================================================================================================
 void VirtualGPU::MemoryDependency::validate(VirtualGPU& gpu, const Memory* memory, bool readOnly) {
   bool flushL1Cache = false;
@@ -273,32 +277,17 @@ void VirtualGPU::MemoryDependency::validate(VirtualGPU& gpu, const Memory* memor
   }
 
   uint64_t curStart = reinterpret_cast<uint64_t>(memory->getDeviceMemory());
-  uint64_t curEnd = curStart + memory->size();
-
-  // Loop through all memory objects in the queue and find dependency
-  // @note don't include objects from the current kernel
-  for (size_t j = 0; j < endMemObjectsInQueue_; ++j) {
-    // Check if the queue already contains this mem object and
-    // GPU operations aren't readonly
-    uint64_t busyStart = memObjectsInQueue_[j].start_;
-    uint64_t busyEnd = memObjectsInQueue_[j].end_;
-
-    // Check if the start inside the busy region
-    if ((((curStart >= busyStart) && (curStart < busyEnd)) ||
-         // Check if the end inside the busy region
-         ((curEnd > busyStart) && (curEnd <= busyEnd)) ||
-         // Check if the start/end cover the busy region
-         ((curStart <= busyStart) && (curEnd >= busyEnd))) &&
-        // If the buys region was written or the current one is for write
-        (!memObjectsInQueue_[j].readOnly_ || !readOnly)) {
-      flushL1Cache = true;
-      break;
-    }
-  }
+  // Track empty objects as a single byte, so they still conflict with the busy regions
+  uint64_t curEnd = curStart + std::max<size_t>(memory->size(), 1);
 
   // Did we reach the limit?
   if (maxMemObjectsInQueue_ <= numMemObjectsInQueue_) {
     flushL1Cache = true;
+  } else {
+    // Find a dependency on the busy regions, if the busy region was written or
+    // the current one is for write
+    // @note objects from the current kernel aren't in the busy set
+    flushL1Cache = busyMemory_.conflicts(curStart, curEnd, readOnly);
   }
 
   if (flushL1Cache) {
@@ -313,46 +302,23 @@ void VirtualGPU::MemoryDependency::validate(VirtualGPU& gpu, const Memory* memor
   // Insert current memory object into the queue always,
   // since runtime calls flush before kernel execution and it has to keep
   // current kernel in tracking
-  memObjectsInQueue_[numMemObjectsInQueue_].start_ = curStart;
-  memObjectsInQueue_[numMemObjectsInQueue_].end_ = curEnd;
-  memObjectsInQueue_[numMemObjectsInQueue_].readOnly_ = readOnly;
+  kernelMemory_.push_back({curStart, curEnd, readOnly});
   numMemObjectsInQueue_++;
 }
 
 // ================================================================================================
 void VirtualGPU::MemoryDependency::clear(bool all) {
-  if (numMemObjectsInQueue_ > 0) {
-    if (all) {
-      endMemObjectsInQueue_ = numMemObjectsInQueue_;
-    }
-
-    // If the current launch didn't start from the beginning, then move the data
-    if (0 != endMemObjectsInQueue_) {
-      // Preserve all objects from the current kernel
-      size_t i, j;
-      for (i = 0, j = endMemObjectsInQueue_; j < numMemObjectsInQueue_; i++, j++) {
-        memObjectsInQueue_[i].start_ = memObjectsInQueue_[j].start_;
-        memObjectsInQueue_[i].end_ = memObjectsInQueue_[j].end_;
-        memObjectsInQueue_[i].readOnly_ = memObjectsInQueue_[j].readOnly_;
-      }
-    } else if (numMemObjectsInQueue_ >= maxMemObjectsInQueue_) {
-      // note: The array growth shouldn't occur under the normal conditions,
-      // but in a case when SVM path sends the amount of SVM ptrs over
-      // the max size of kernel arguments
-      MemoryState* ptr  = new MemoryState[maxMemObjectsInQueue_ << 1];
-      if (nullptr == ptr) {
-        numMemObjectsInQueue_ = 0;
-        return;
-      }
-      maxMemObjectsInQueue_ <<= 1;
-      memcpy(ptr, memObjectsInQueue_, sizeof(MemoryState) * numMemObjectsInQueue_);
-      delete[] memObjectsInQueue_;
-      memObjectsInQueue_= ptr;
-    }
-
-    numMemObjectsInQueue_ -= endMemObjectsInQueue_;
-    endMemObjectsInQueue_ = 0;
+  busyMemory_.clear();
+  if (all) {
+    kernelMemory_.clear();
+  } else if (kernelMemory_.size() >= maxMemObjectsInQueue_) {
+    // note: The limit growth shouldn't occur under the normal conditions,
+    // but in a case when SVM path sends the amount of SVM ptrs over
+    // the max size of kernel arguments
+    maxMemObjectsInQueue_ <<= 1;
   }
+  // Preserve all objects from the current kernel
+  numMemObjectsInQueue_ = kernelMemory_.size();
 }
 
 // ================================================================================================
@@ -3723,7 +3689,7 @@ void VirtualGPU::addPinnedMem(amd::Memory* mem) {
   //! @note: ROCr backend doesn't have per resource busy tracking, hence runtime has to wait
   //!        unconditionally, before it can release pinned memory
   releaseGpuMemoryFence();
-  if (!AMD_DIRECT_DISPATCH) {
+  if (!AMD_DIRECT_DISPATCH && !dev().PinnedCacheEnabled()) {
     if (nullptr == findPinnedMem(mem->getHostMem(), mem->getSize())) {
       if (pinnedMems_.size() > 7) {
         pinnedMems_.front()->release();
@@ -3734,6 +3700,7 @@ void VirtualGPU::addPinnedMem(amd::Memory* mem) {
       pinnedMems_.push_back(mem);
     }
   } else {
+    // The device cache holds its own reference for a later reuse
     mem->release();
   }
 }
@@ -24,6 +24,7 @@
 #include "rocdefs.hpp"
 #include "rocdevice.hpp"
 #include "utils/util.hpp"
+#include "utils/intervalset.hpp"
 #include "hsa/hsa.h"
 #include "hsa/hsa_ext_image.h"
 #include "hsa/hsa_ext_amd.h"
@@ -221,16 +222,13 @@ class VirtualGPU : public device::VirtualDevice {
   class MemoryDependency : public amd::EmbeddedObject {
    public:
     //! Default constructor
-    MemoryDependency()
-        : memObjectsInQueue_(nullptr), numMemObjectsInQueue_(0), maxMemObjectsInQueue_(0) {}
-
-    ~MemoryDependency() { delete[] memObjectsInQueue_; }
+    MemoryDependency() : numMemObjectsInQueue_(0), maxMemObjectsInQueue_(0) {}
 
     //! Creates memory dependecy structure
     bool create(size_t numMemObj);
 
     //! Notify the tracker about new kernel
-    void newKernel() { endMemObjectsInQueue_ = numMemObjectsInQueue_; }
+    void newKernel();
 
     //! Validates memory object on dependency
     void validate(VirtualGPU& gpu, const Memory* memory, bool readOnly);
@@ -248,10 +246,10 @@ class VirtualGPU : public device::VirtualDevice {
       bool readOnly_;   //! Current GPU state in the queue
     };
 
-    MemoryState* memObjectsInQueue_;  //!< Memory object state in the queue
-    size_t endMemObjectsInQueue_;     //!< End of mem objects in the queue
-    size_t numMemObjectsInQueue_;     //!< Number of mem objects in the queue
-    size_t maxMemObjectsInQueue_;     //!< Maximum number of mem objects in the queue
+    amd::AccessIntervalSet busyMemory_;       //!< Memory accessed by the previous kernels
+    std::vector<MemoryState> kernelMemory_;   //!< Memory accessed by the current kernel
+    size_t numMemObjectsInQueue_;             //!< Number of mem objects in the queue
+    size_t maxMemObjectsInQueue_;             //!< Maximum number of mem objects in the queue
   };
 
   class HwQueueTracker : public amd::EmbeddedObject {
@@ -292,6 +290,9 @@ class VirtualGPU : public device::VirtualDevice {
     //! Get the last active signal on the queue
     ProfilingSignal* GetLastSignal() const { return signal_list_[current_id_]; }
 
+    //! Wait for the signal of a previous submission
+    bool WaitSignal(ProfilingSignal* signal) { return CpuWaitForSignal(signal); }
+
     //! Clear external signals
     void ClearExternalSignals() { external_signals_.clear(); }
 
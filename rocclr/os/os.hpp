@@ -61,6 +61,8 @@ class Os : AllStatic {
 #endif
 
   enum MemProt { MEM_PROT_NONE = 0, MEM_PROT_READ, MEM_PROT_RW, MEM_PROT_RWX };
+  //! Access hints of a file mapping
+  enum MemAdvice { MEM_ADVICE_RANDOM = 0, MEM_ADVICE_WILLNEED, MEM_ADVICE_DONTNEED };
 
   class ThreadAffinityMask {
     friend class Os;
@@ -226,6 +228,8 @@ class Os : AllStatic {
   static bool uncommitMemory(void* addr, size_t size);
   //! Set the page protections for the given memory region.
   static bool protectMemory(void* addr, size_t size, MemProt prot);
+  //! Give the access hint for a range of a read only file mapping, it may be unaligned.
+  static bool adviseMemory(const void* addr, size_t size, MemAdvice advice);
 
   //! Allocate an aligned chunk of memory.
   static void* alignedMalloc(size_t size, size_t alignment);
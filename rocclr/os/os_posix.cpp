@@ -277,6 +277,15 @@ bool Os::protectMemory(void* addr, size_t size, MemProt prot) {
   return 0 == ::mprotect(addr, size, memProtToOsProt(prot));
 }
 
+bool Os::adviseMemory(const void* addr, size_t size, MemAdvice advice) {
+  static const int advices[] = {MADV_RANDOM, MADV_WILLNEED, MADV_DONTNEED};
+  address start = alignDown(reinterpret_cast<address>(const_cast<void*>(addr)), pageSize());
+  size = alignUp(reinterpret_cast<address>(const_cast<void*>(addr)) + size - start, pageSize());
+
+  // MADV_DONTNEED drops the pages of a shared file mapping, the next access reads them again
+  return 0 == ::madvise(start, size, advices[advice]);
+}
+
 uint64_t Os::hostTotalPhysicalMemory() {
   static uint64_t totalPhys = 0;
 
@@ -659,14 +668,14 @@ void Os::cpuid(int regs[4], int info) {
       "cpuid;"
       "xchgq %%rbx, %%rsi;"
       : "=a"(regs[0]), "=S"(regs[1]), "=c"(regs[2]), "=d"(regs[3])
-      : "a"(info));
+      : "a"(info), "c"(0));
 #else
   __asm__ __volatile__(
       "movl %%ebx, %%esi;"
       "cpuid;"
       "xchgl %%ebx, %%esi;"
       : "=a"(regs[0]), "=S"(regs[1]), "=c"(regs[2]), "=d"(regs[3])
-      : "a"(info));
+      : "a"(info), "c"(0));
 #endif
 }
 
@@ -176,6 +176,11 @@ bool Os::protectMemory(void* addr, size_t size, MemProt prot) {
   return VirtualProtect(addr, size, memProtToOsProt(prot), &OldProtect) != 0;
 }
 
+bool Os::adviseMemory(const void* addr, size_t size, MemAdvice advice) {
+  // The hints are optional, the memory manager of the view decides on its own
+  return true;
+}
+
 
 uint64_t Os::hostTotalPhysicalMemory() {
   static uint64_t totalPhys = 0;
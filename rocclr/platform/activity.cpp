@@ -22,12 +22,19 @@
 #include "platform/command.hpp"
 #include "platform/commandqueue.hpp"
 #include "platform/command_utils.hpp"
+#include "utils/recordbuffer.hpp"
+#include "utils/tracewriter.hpp"
 
+#include <algorithm>
 #include <atomic>
+#include <cstring>
+#include <string>
 
 namespace amd::activity_prof {
 
 decltype(report_activity) report_activity{nullptr};
+decltype(report_activity_batch) report_activity_batch{nullptr};
+decltype(trace_writer) trace_writer{nullptr};
 
 #if defined(__linux__)
 __thread activity_correlation_id_t correlation_id __attribute__((tls_model("initial-exec"))) = 0;
@@ -42,10 +49,143 @@ static inline size_t linearSize(const amd::Coord3D& size3d) {
   return size;
 }
 
+// Delivers a batch of the buffered records, one by one without a batch callback
+static void DeliverRecords(const activity_record_t* records, size_t count) {
+  if (auto batch = report_activity_batch.load(std::memory_order_relaxed)) {
+    batch(ACTIVITY_DOMAIN_HIP_OPS, records, count);
+  } else if (auto function = report_activity.load(std::memory_order_relaxed)) {
+    for (size_t i = 0; i < count; ++i) {
+      function(ACTIVITY_DOMAIN_HIP_OPS, records[i].op,
+               const_cast<activity_record_t*>(&records[i]));
+    }
+  }
+}
+
+// The buffer of the records, created with the first record after the flags are parsed
+static std::atomic<RecordBuffer<activity_record_t>*> activity_buffer{nullptr};
+
+// Returns the buffer of the records, nullptr if every record is reported immediately
+static RecordBuffer<activity_record_t>* ActivityBuffer() {
+  static RecordBuffer<activity_record_t>* buffer = []() -> RecordBuffer<activity_record_t>* {
+    if (DEBUG_CLR_ACTIVITY_BUFFER == 0) {
+      return nullptr;
+    }
+    RecordBuffer<activity_record_t>::Options options;
+    options.chunkRecords_ = DEBUG_CLR_ACTIVITY_BUFFER;
+    // The kernel names are copied into the chunk
+    options.chunkBytes_ = std::max<uint32_t>(DEBUG_CLR_ACTIVITY_BUFFER * 128, 64 * Ki);
+    options.flushMs_ = DEBUG_CLR_ACTIVITY_FLUSH_MS;
+    auto* buffer = new RecordBuffer<activity_record_t>(options, DeliverRecords);
+    activity_buffer.store(buffer, std::memory_order_release);
+    return buffer;
+  }();
+  return buffer;
+}
+
+void FlushActivity() {
+  auto* buffer = activity_buffer.load(std::memory_order_acquire);
+  if (buffer == nullptr) {
+    return;
+  }
+  buffer->flush();
+  auto stats = buffer->stats();
+  ClPrint(amd::LOG_INFO, amd::LOG_CMD,
+          "Activity buffer: %llu records in %llu batches, %llu stalls, %llu dropped",
+          static_cast<unsigned long long>(stats.delivered_),
+          static_cast<unsigned long long>(stats.batches_),
+          static_cast<unsigned long long>(stats.stalls_),
+          static_cast<unsigned long long>(stats.dropped_));
+}
+
+void StopActivity() {
+  auto* buffer = activity_buffer.load(std::memory_order_acquire);
+  if (buffer == nullptr) {
+    return;
+  }
+  // The delivery thread can't run into a profiler, which is unloaded after the runtime
+  buffer->stop();
+  FlushActivity();
+}
+
+// The file of the trace, closed with the trace
+static FILE* trace_file = nullptr;
+static std::atomic<activity_correlation_id_t> trace_correlation_id{0};
+static std::atomic<uint32_t> trace_thread_id{0};
+
+void InitTrace() {
+  if ((DEBUG_CLR_TRACE_FILE[0] == '\0') || IsTracing()) {
+    return;
+  }
+  std::string path = DEBUG_CLR_TRACE_FILE;
+  size_t pos = path.find("%p");
+  if (pos != std::string::npos) {
+    path.replace(pos, 2, std::to_string(Os::getProcessId()));
+  }
+  trace_file = fopen(path.c_str(), "w");
+  if (trace_file == nullptr) {
+    LogPrintfError("Unable to open the trace file %s", path.c_str());
+    return;
+  }
+  TraceWriter::Options options;
+  options.pid_ = Os::getProcessId();
+  trace_writer.store(new TraceWriter(trace_file, options), std::memory_order_release);
+  ClPrint(amd::LOG_INFO, amd::LOG_INIT, "Writing the trace to %s", path.c_str());
+}
+
+void CloseTrace() {
+  auto* writer = trace_writer.exchange(nullptr, std::memory_order_acq_rel);
+  if (writer == nullptr) {
+    return;
+  }
+  // The writer isn't destroyed, since a thread may still hold it. It ignores later events
+  writer->close();
+  auto stats = writer->stats();
+  ClPrint(amd::LOG_INFO, amd::LOG_INIT, "Trace: %llu events, %llu dropped",
+          static_cast<unsigned long long>(stats.events_),
+          static_cast<unsigned long long>(stats.dropped_));
+  fclose(trace_file);
+  trace_file = nullptr;
+}
+
+activity_correlation_id_t NewCorrelationId() {
+  return trace_correlation_id.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+void TraceApi(const char* name, uint64_t begin_ns, activity_correlation_id_t correlation_id) {
+  // Small ids of the host threads keep the tracks apart from the queues
+  thread_local uint32_t tid = trace_thread_id.fetch_add(1, std::memory_order_relaxed) + 1;
+  if (auto* writer = trace_writer.load(std::memory_order_acquire)) {
+    writer->api(name, tid, begin_ns, Os::timeNanos(), correlation_id);
+  }
+}
+
+// Adds a command to the trace
+static void TraceCommand(TraceWriter* writer, const activity_record_t& record) {
+  const char* category = "barrier";
+  const char* name = getOclCommandKindString(record.kind);
+  bool named = false;
+  uint64_t bytes = 0;
+  if (record.op == OP_ID_DISPATCH) {
+    category = "kernel";
+    if (record.kernel_name != nullptr) {
+      name = record.kernel_name;
+      named = true;
+    }
+  } else if (record.op == OP_ID_COPY) {
+    category = "copy";
+    bytes = record.bytes;
+  }
+  writer->command(name, named, category, record.device_id, record.queue_id, record.begin_ns,
+                  record.end_ns, record.correlation_id, bytes);
+}
+
 bool IsEnabled(OpId operation_id) {
-  if (operation_id < OP_ID_NUMBER)
+  if (operation_id < OP_ID_NUMBER) {
+    // The built-in trace needs the timestamps of all commands
+    if (IsTracing()) return true;
     if (auto report = report_activity.load(std::memory_order_relaxed))
       return report(ACTIVITY_DOMAIN_HIP_OPS, operation_id, nullptr) == 0;
+  }
   return false;
 }
 
@@ -59,7 +199,37 @@ void ReportActivity(const amd::Command& command) {
   }
 
   auto function = report_activity.load(std::memory_order_relaxed);
-  if (!function) return;
+  auto* writer = trace_writer.load(std::memory_order_acquire);
+  if (!function && (writer == nullptr)) return;
+  if (function && (writer != nullptr) &&
+      (function(ACTIVITY_DOMAIN_HIP_OPS, operation_id, nullptr) != 0)) {
+    // The trace enabled the profiling of the command, the profiler didn't
+    function = nullptr;
+  }
+
+  auto* buffer = ActivityBuffer();
+  auto report = [&](const activity_record_t& record) {
+    if (writer != nullptr) {
+      TraceCommand(writer, record);
+    }
+    if (!function) {
+      return;
+    }
+    if (buffer == nullptr) {
+      function(ACTIVITY_DOMAIN_HIP_OPS, operation_id, const_cast<activity_record_t*>(&record));
+      return;
+    }
+    // The kernel name may not outlive the command, so the buffer keeps a copy
+    const bool named = (operation_id == OP_ID_DISPATCH) && (record.kernel_name != nullptr);
+    const size_t size = named ? strlen(record.kernel_name) + 1 : 0;
+    buffer->append(size, [&](activity_record_t* copy, char* name) {
+      *copy = record;
+      if (named) {
+        memcpy(name, record.kernel_name, size);
+        copy->kernel_name = name;
+      }
+    });
+  };
 
   const auto* queue = command.queue();
   assert(queue != nullptr);
@@ -110,12 +280,12 @@ void ReportActivity(const amd::Command& command) {
       record.begin_ns = it.first;
       record.end_ns = it.second;
       record.kernel_name = kernel_names[i].c_str();
-      function(ACTIVITY_DOMAIN_HIP_OPS, operation_id, &record);
+      report(record);
     }
   } else {
       record.begin_ns = command.profilingInfo().start_;
       record.end_ns = command.profilingInfo().end_;
-      function(ACTIVITY_DOMAIN_HIP_OPS, operation_id, &record);
+      report(record);
   }
 }
 
@@ -30,6 +30,7 @@
 
 namespace amd {
 class Command;
+class TraceWriter;
 }  // namespace amd
 
 enum OpId { OP_ID_DISPATCH = 0, OP_ID_COPY = 1, OP_ID_BARRIER = 2, OP_ID_NUMBER = 3 };
@@ -41,6 +42,11 @@ namespace amd::activity_prof {
 extern std::atomic<int (*)(activity_domain_t domain, uint32_t operation_id, void* data)>
     report_activity;
 
+//! The batch callback of the buffered records, DEBUG_CLR_ACTIVITY_BUFFER
+extern std::atomic<void (*)(activity_domain_t domain, const activity_record_t* records,
+                            size_t count)>
+    report_activity_batch;
+
 #if defined(__linux__)
 extern __thread activity_correlation_id_t correlation_id __attribute__((tls_model("initial-exec")));
 #elif defined(_WIN32)
@@ -75,6 +81,24 @@ constexpr OpId OperationId(cl_command_type commandType) {
 
 bool IsEnabled(OpId operation_id);
 void ReportActivity(const amd::Command& command);
+//! Delivers the buffered records to the profiler
+void FlushActivity();
+//! Stops the periodic delivery and delivers the buffered records at the shutdown
+void StopActivity();
+
+//! The Chrome trace of DEBUG_CLR_TRACE_FILE, nullptr if the trace is disabled
+extern std::atomic<TraceWriter*> trace_writer;
+
+inline bool IsTracing() { return trace_writer.load(std::memory_order_relaxed) != nullptr; }
+
+void InitTrace();
+void CloseTrace();
+
+//! Returns a new correlation id of an API call, which the profiler doesn't track
+activity_correlation_id_t NewCorrelationId();
+
+//! Adds an API call, which started at \a begin_ns, to the trace
+void TraceApi(const char* name, uint64_t begin_ns, activity_correlation_id_t correlation_id);
 
 
 
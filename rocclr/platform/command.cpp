@@ -318,22 +318,31 @@ Command::Command(HostQueue& queue, cl_command_type type, const EventWaitList& ev
   }
 }
 
-SysmemPool<ComputeCommand>* Command::command_pool_ = new SysmemPool<ComputeCommand>;
 // ================================================================================================
-void Command::operator delete(void* ptr) {
-  if (DEBUG_CLR_SYSMEM_POOL) {
-    command_pool_->Free(ptr);
-  } else {
-    ::operator delete (ptr);
-  }
-}
+void Command::operator delete(void* ptr, size_t size) { SlabObject::operator delete(ptr, size); }
 
 // ================================================================================================
-void* Command::operator new(size_t size) {
-  if (DEBUG_CLR_SYSMEM_POOL) {
-    return command_pool_->Alloc(size);
-  } else {
-    return ::operator new (size);
+void* Command::operator new(size_t size) { return SlabObject::operator new(size); }
+
+// ================================================================================================
+void Command::ReportSysmemPool() {
+  if (!DEBUG_CLR_SYSMEM_POOL) {
+    return;
+  }
+  SlabAllocator::Stats stats[SlabAllocator::kNumClasses];
+  SlabAllocator::stats(stats);
+  for (const auto& stat : stats) {
+    if (stat.reserved_ == 0) {
+      continue;
+    }
+    const uint64_t live = stat.allocated_ - stat.freed_;
+    ClPrint(LOG_INFO, LOG_MEM, "Slab class %zu bytes: %llu allocations, %llu live, %llu reserved",
+            stat.size_, static_cast<unsigned long long>(stat.allocated_),
+            static_cast<unsigned long long>(live), static_cast<unsigned long long>(stat.reserved_));
+    if (live != 0) {
+      LogPrintfWarning("Unreleased objects of %zu bytes in the slab allocator: %llu",
+                       stat.size_, static_cast<unsigned long long>(live));
+    }
   }
 }
 
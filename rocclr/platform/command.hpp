@@ -261,7 +261,6 @@ class GraphKernelArgManager {
  */
 class Command : public Event {
  private:
-  static SysmemPool<ComputeCommand> *command_pool_;  //!< Pool of active commands
   HostQueue* queue_;               //!< The command queue this command is enqueue into
   Command* next_;                  //!< Next GPU command in the queue list
   Command* batch_head_ = nullptr;  //!< The head of the batch commands
@@ -310,13 +309,9 @@ class Command : public Event {
   }
 
  public:
-  //! Returns AQL buffer state
-  static void ReleaseSysmemPool() {
-    if (command_pool_ != nullptr) {
-      delete command_pool_;
-      command_pool_ = nullptr;
-    }
-  }
+  //! Logs the live objects of the slab allocator, the leaks at the runtime teardown
+  static void ReportSysmemPool();
+
   bool getPktCapturingState() const { return packetCapturing_; }
 
   //! Sets AQL capture state, aql packet to capture and where to copy kernArgs
@@ -347,9 +342,10 @@ class Command : public Event {
     return graphKernArgMgr_->AllocKernArg(size, alignment);
   }
 
-  //! Overload new/delete for fast commands allocation/destruction
+  //! Overload new/delete for fast commands allocation/destruction. The virtual destructor
+  //! passes the size of the most derived command to delete
   void* operator new(size_t size);
-  void operator delete(void* ptr);
+  void operator delete(void* ptr, size_t size);
 
   //! Return the queue this command is enqueued into.
   HostQueue* queue() const { return queue_; }
@@ -37,6 +37,9 @@ HostQueue::HostQueue(Context& context, Device& device, cl_command_queue_properti
                      uint queueRTCUs, Priority priority, const std::vector<uint32_t>& cuMask)
     : CommandQueue(context, device, props, device.info().queueProperties_, queueRTCUs,
                    priority, cuMask),
+      ring_((!AMD_DIRECT_DISPATCH && (DEBUG_CLR_HOST_QUEUE_RING_SIZE != 0))
+                ? new MpscRing<Command*>(DEBUG_CLR_HOST_QUEUE_RING_SIZE)
+                : nullptr),
       lastEnqueueCommand_(nullptr),
       head_(nullptr),
       tail_(nullptr),
@@ -115,6 +118,9 @@ bool HostQueue::terminate() {
         thread_.acceptingCommands_ = false;
         queueLock_.notify();
       }
+      if (ring_ != nullptr) {
+        parker_.unpark();
+      }
 
       // FIXME_lmoriche: fix termination handshake
       while (thread_.state() < Thread::FINISHED && Os::isThreadAlive(thread_)) {
@@ -193,16 +199,39 @@ void HostQueue::loop(device::VirtualDevice* virtualDevice) {
   // Create a command batch with all the commands present in the queue.
   Command* head = NULL;
   Command* tail = NULL;
+  // The commands taken from the ring at once
+  constexpr size_t kRingBatch = 32;
+  Command* ringBatch[kRingBatch];
+  size_t ringCount = 0;
+  size_t ringPos = 0;
   while (true) {
-    // Get one command from the queue
-    Command* command = queue_.dequeue();
-    if (command == NULL) {
-      ScopedLock sl(queueLock_);
-      while ((command = queue_.dequeue()) == NULL) {
-        if (!thread_.acceptingCommands_) {
-          return;
+    Command* command = NULL;
+    if (ring_ != nullptr) {
+      if (ringPos == ringCount) {
+        ringPos = 0;
+        // The commands, which this thread added to the full ring, follow the ring
+        while ((ringCount = ring_->dequeue(ringBatch, kRingBatch)) == 0 &&
+               (command = queue_.dequeue()) == NULL) {
+          if (!thread_.acceptingCommands_) {
+            return;
+          }
+          parker_.park([this]() { return !ring_->empty() || !thread_.acceptingCommands_; });
+        }
+      }
+      if (command == NULL) {
+        command = ringBatch[ringPos++];
+      }
+    } else {
+      // Get one command from the queue
+      command = queue_.dequeue();
+      if (command == NULL) {
+        ScopedLock sl(queueLock_);
+        while ((command = queue_.dequeue()) == NULL) {
+          if (!thread_.acceptingCommands_) {
+            return;
+          }
+          queueLock_.wait();
         }
-        queueLock_.wait();
       }
     }
 
@@ -266,7 +295,24 @@ void HostQueue::append(Command& command) {
   }
   command.retain();
   command.setStatus(CL_QUEUED);
-  queue_.enqueue(&command);
+  if (ring_ != nullptr) {
+    if (Thread::current() == &thread_) {
+      // Only the queue thread drains the ring, so it can't wait for the room. Its commands go to
+      // the unbounded queue if the ring is full, and stay there while the queue isn't empty
+      if (!queue_.empty() || !ring_->tryEnqueue(&command)) {
+        queue_.enqueue(&command);
+      }
+    } else {
+      // Back pressure, the command loop drains the ring
+      while (!ring_->tryEnqueue(&command)) {
+        parker_.unpark();
+        Os::yield();
+      }
+      parker_.unpark();
+    }
+  } else {
+    queue_.enqueue(&command);
+  }
   if (!IS_HIP) {
     return;
   }
@@ -297,7 +343,7 @@ void HostQueue::append(Command& command) {
 
 bool HostQueue::isEmpty() {
   // Get a snapshot of queue size
-  return queue_.empty();
+  return ((ring_ == nullptr) || ring_->empty()) && queue_.empty();
 }
 
 Command* HostQueue::getLastQueuedCommand(bool retain) {
@@ -31,6 +31,7 @@
 #include "thread/thread.hpp"
 #include "platform/object.hpp"
 #include "platform/command.hpp"
+#include "utils/mpscring.hpp"
 /*! \brief Holds commands that will be executed on a specific device.
  *
  *  \details A command queue is created on a specific device in
@@ -197,6 +198,11 @@ class HostQueue : public CommandQueue {
  private:
   ConcurrentLinkedQueue<Command*> queue_;  //!< The queue.
 
+  //! The bounded queue, replaces queue_ if valid. queue_ takes then the commands, which the
+  //! queue thread adds to the full ring
+  std::unique_ptr<MpscRing<Command*>> ring_;
+  Parker parker_;                             //!< Wakeup of the command loop with the ring
+
   Command* lastEnqueueCommand_;  //!< The last submitted command
 
   //! Await commands and execute them as they become ready.
@@ -226,6 +232,11 @@ class HostQueue : public CommandQueue {
 
   //! Signal to start processing the commands in the queue.
   void flush() {
+    if (ring_ != nullptr) {
+      // Signals only if the command loop is parked
+      parker_.unpark();
+      return;
+    }
     ScopedLock sl(queueLock_);
     queueLock_.notify();
   }
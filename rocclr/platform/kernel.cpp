@@ -70,15 +70,14 @@ bool KernelParameters::check() {
 size_t KernelParameters::localMemSize(size_t minDataTypeAlignment) const {
   size_t memSize = 0;
 
-  for (size_t i = 0; i < signature_.numParameters(); ++i) {
-    const KernelParameterDescriptor& desc = signature_.at(i);
-    if (desc.addressQualifier_ == CL_KERNEL_ARG_ADDRESS_LOCAL) {
-      if (desc.size_ == 8) {
+  for (const auto& slot : signature_.plan().slots()) {
+    if (slot.kind_ == ArgPlan::Local) {
+      if (slot.size_ == 8) {
         memSize = alignUp(memSize, minDataTypeAlignment) +
-          *reinterpret_cast<const uint64_t*>(values_ + desc.offset_);
+          *reinterpret_cast<const uint64_t*>(values_ + slot.offset_);
       } else {
         memSize = alignUp(memSize, minDataTypeAlignment) +
-          *reinterpret_cast<const uint32_t*>(values_ + desc.offset_);
+          *reinterpret_cast<const uint32_t*>(values_ + slot.offset_);
       }
     }
   }
@@ -96,8 +95,8 @@ address KernelParameters::alloc(device::VirtualDevice& vDev) {
   if (mem == nullptr) {
     mem = reinterpret_cast<address>(AlignedMemory::allocate(totalSize_ + execInfoSize,
                                                             PARAMETERS_MIN_ALIGNMENT));
-  } else {
-    deviceKernelArgs_ = true;
+  } else if (!deviceKernelArgs()) {
+    deviceKernelArgs_.store(true, std::memory_order_relaxed);
   }
 
   return mem;
@@ -105,71 +104,78 @@ address KernelParameters::alloc(device::VirtualDevice& vDev) {
 
 // =================================================================================================
 bool KernelParameters::captureAndSet(void** kernelParams, address kernArgs, address mem) {
+  const ArgPlan& plan = signature_.plan();
 
-  for (size_t idx = 0; idx < signature_.numParameters(); ++idx) {
-    KernelParameterDescriptor& desc = signature_.params()[idx];
-    void* value = nullptr;
+  // Copy the scalar arguments in bulk, only the slots of the plan need a conversion
+  if (kernelParams != nullptr) {
+    plan.copyFields(mem, kernelParams);
+  } else {
+    plan.copyRanges(mem, kernArgs);
+  }
+
+  amd::Memory** memories = reinterpret_cast<amd::Memory**>(mem + memoryObjOffset());
+  for (const auto& slot : plan.slots()) {
+    KernelParameterDescriptor& desc = signature_.params()[slot.index_];
+    const void* value = nullptr;
     if (kernelParams != nullptr) {
-      value = kernelParams[idx];
+      value = kernelParams[slot.index_];
     } else {
       value = kernArgs + desc.offset_;
     }
-    void* param = mem + desc.offset_;
-    uint32_t uint32_value = 0;
-    uint64_t uint64_value = 0;
-    Memory* memArg = nullptr;
-    amd::Memory** memories = reinterpret_cast<amd::Memory**>(mem + memoryObjOffset());
-    if (desc.type_ == T_POINTER && (desc.addressQualifier_ != CL_KERNEL_ARG_ADDRESS_LOCAL)) {
-      LP64_SWITCH(uint32_value, uint64_value) = *(LP64_SWITCH(uint32_t*, uint64_t*))value;
-      memArg = amd::MemObjMap::FindMemObj(*reinterpret_cast<const void* const*>(value));
-      memories[desc.info_.arrayIndex_] = memArg;
-      if (memArg != nullptr) {
-        memArg->retain();
-      }
-      desc.info_.rawPointer_ = true;
-    } else if (desc.type_ == T_SAMPLER) {
-      LogError("Cannot handle Sampler now");
-      return false;
-    } else if (desc.type_ == T_QUEUE) {
-      LogError("Cannot handle Queue now");
-      return false;
-    } else {
-      switch (desc.size_) {
-        case 4:
-          if (desc.addressQualifier_ == CL_KERNEL_ARG_ADDRESS_LOCAL) {
-            uint32_value = desc.size_;
-          } else {
-            uint32_value = *(static_cast<const uint32_t*>(value));
-          }
-          break;
-        case 8:
-          if (desc.addressQualifier_ == CL_KERNEL_ARG_ADDRESS_LOCAL) {
-            uint64_value = desc.size_;
-          } else {
-            uint64_value = *(static_cast<const uint64_t*>(value));
-          }
-          break;
-      }
-    }
-
-    switch (desc.size_) {
-      case sizeof(uint32_t):
-        *static_cast<uint32_t*>(param) = uint32_value;
-        break;
-      case sizeof(uint64_t):
-        *static_cast<uint64_t*>(param) = uint64_value;
+    address param = mem + desc.offset_;
+    switch (slot.kind_) {
+      case ArgPlan::Pointer: {
+        *reinterpret_cast<uintptr_t*>(param) = *static_cast<const uintptr_t*>(value);
+        Memory* memArg = amd::MemObjMap::FindMemObj(*static_cast<const void* const*>(value));
+        memories[desc.info_.arrayIndex_] = memArg;
+        if (memArg != nullptr) {
+          memArg->retain();
+        }
         break;
+      }
+      case ArgPlan::Sampler:
+        LogError("Cannot handle Sampler now");
+        return false;
+      case ArgPlan::Queue:
+        LogError("Cannot handle Queue now");
+        return false;
       default:
-        ::memcpy(param, value, desc.size_);
+        // The dynamic local memory size is set to the argument size
+        switch (desc.size_) {
+          case sizeof(uint32_t):
+            *reinterpret_cast<uint32_t*>(param) = desc.size_;
+            break;
+          case sizeof(uint64_t):
+            *reinterpret_cast<uint64_t*>(param) = desc.size_;
+            break;
+          default:
+            ::memcpy(param, value, desc.size_);
+            break;
+        }
         break;
     }
-    desc.info_.defined_ = true;
   }
-
-  execInfoOffset_ = totalSize_;
+  // The captured arguments are private to the command, the HIP signature and the parameters
+  // have all arguments defined since their construction
   return true;
 }
 
+void KernelParameters::setAll(void* const* kernelParams, const_address kernArgs) {
+  const ArgPlan& plan = signature_.plan();
+
+  if (kernelParams != nullptr) {
+    plan.copyFields(values_, kernelParams);
+  } else {
+    plan.copyRanges(values_, kernArgs);
+  }
+  for (const auto& slot : plan.slots()) {
+    const void* value = (kernelParams != nullptr) ? kernelParams[slot.index_]
+                                                  : kernArgs + slot.offset_;
+    set(slot.index_, slot.size_, value, slot.kind_ == ArgPlan::Pointer /*svmBound*/);
+  }
+  markDefined();
+}
+
 void KernelParameters::set(size_t index, size_t size, const void* value, bool svmBound) {
   KernelParameterDescriptor& desc = signature_.params()[index];
 
@@ -183,7 +189,10 @@ void KernelParameters::set(size_t index, size_t size, const void* value, bool sv
 
   if (desc.type_ == T_POINTER && (desc.addressQualifier_ != CL_KERNEL_ARG_ADDRESS_LOCAL)) {
     if (svmBound) {
-      desc.info_.rawPointer_ = true;
+      // HIP launches read the shared flag without a lock, it's set with the signature
+      if (!desc.info_.rawPointer_) {
+        desc.info_.rawPointer_ = true;
+      }
       LP64_SWITCH(uint32_value, uint64_value) = *(LP64_SWITCH(uint32_t*, uint64_t*))value;
       memoryObjects_[desc.info_.arrayIndex_] = amd::MemObjMap::FindMemObj(
         *reinterpret_cast<const void* const*>(value));
@@ -236,7 +245,9 @@ void KernelParameters::set(size_t index, size_t size, const void* value, bool sv
       break;
   }
 
-  desc.info_.defined_ = true;
+  if (!desc.info_.defined_) {
+    desc.info_.defined_ = true;
+  }
 }
 
 address KernelParameters::capture(device::VirtualDevice& vDev, uint64_t lclMemSize, int32_t* error) {
@@ -251,15 +262,16 @@ address KernelParameters::capture(device::VirtualDevice& vDev, uint64_t lclMemSi
   if (mem == nullptr) {
     mem = reinterpret_cast<address>(AlignedMemory::allocate(totalSize_ + execInfoSize,
                                                             PARAMETERS_MIN_ALIGNMENT));
-  } else {
-    deviceKernelArgs_ = true;
+  } else if (!deviceKernelArgs()) {
+    deviceKernelArgs_.store(true, std::memory_order_relaxed);
   }
 
   if (mem != nullptr) {
     ::memcpy(mem, values_, totalSize_);
 
-    for (size_t i = 0; i < signature_.numParameters(); ++i) {
-      const KernelParameterDescriptor& desc = signature_.at(i);
+    // Only the slots of the plan need a fix-up, the scalars are already in place
+    for (const auto& slot : signature_.plan().slots()) {
+      const KernelParameterDescriptor& desc = signature_.at(slot.index_);
       if (desc.type_ == T_POINTER && (desc.addressQualifier_ != CL_KERNEL_ARG_ADDRESS_LOCAL)) {
         Memory* memArg = memoryObjects_[desc.info_.arrayIndex_];
         if (memArg != nullptr) {
@@ -431,5 +443,30 @@ KernelSignature::KernelSignature(const std::vector<KernelParameterDescriptor>& p
     // 16 bytes is the current HW alignment for the arguments
     paramsSize_ = alignUp(paramsSize_, 16);
   }
+
+  // Build the fix-up plan of the OCL arguments, the hidden arguments are set by the device
+  for (uint32_t i = 0; i < std::min<size_t>(numParameters_, params_.size()); ++i) {
+    KernelParameterDescriptor& desc = params_[i];
+    if (IS_HIP) {
+      // HIP sets all arguments with every launch and the pointers are raw device addresses.
+      // The flags are set here, since concurrent launches share the signature
+      desc.info_.defined_ = true;
+      if (desc.type_ == T_POINTER && (desc.addressQualifier_ != CL_KERNEL_ARG_ADDRESS_LOCAL)) {
+        desc.info_.rawPointer_ = true;
+      }
+    }
+    ArgPlan::Kind kind = ArgPlan::Scalar;
+    if (desc.addressQualifier_ == CL_KERNEL_ARG_ADDRESS_LOCAL) {
+      kind = ArgPlan::Local;
+    } else if (desc.type_ == T_POINTER) {
+      kind = ArgPlan::Pointer;
+    } else if (desc.type_ == T_SAMPLER) {
+      kind = ArgPlan::Sampler;
+    } else if (desc.type_ == T_QUEUE) {
+      kind = ArgPlan::Queue;
+    }
+    plan_.add(i, desc.offset_, desc.size_, kind);
+  }
+  plan_.finalize();
 }
 }  // namespace amd
@@ -23,9 +23,11 @@
 
 #include "top.hpp"
 #include "platform/object.hpp"
+#include "utils/argplan.hpp"
 
 #include "amdocl/cl_kernel.h"
 
+#include <atomic>
 #include <vector>
 #include <cstdlib>  // for malloc
 #include <string>
@@ -60,6 +62,7 @@ class KernelSignature : public HeapObject {
   uint32_t  numSamplers_;   //!< The number of sampler objects used in the kernel
   uint32_t  numQueues_;     //!< The number of queue objects used in the kernel
   uint32_t  version_;       //!< The ABI version
+  ArgPlan   plan_;          //!< The fix-up plan of the arguments
 
  public:
   enum {
@@ -113,6 +116,9 @@ class KernelSignature : public HeapObject {
 
   const std::vector<KernelParameterDescriptor>& parameters() const
     { return params_; }
+
+  //! Returns the fix-up plan of the arguments, built with the signature
+  const ArgPlan& plan() const { return plan_; }
 };
 
 // @todo: look into a copy-on-write model instead of copy-on-read.
@@ -140,25 +146,36 @@ class KernelParameters : protected HeapObject {
     uint32_t validated_ : 1;        //!< True if all parameters are defined.
     uint32_t execNewVcop_ : 1;      //!< special new VCOP for kernel execution
     uint32_t execPfpaVcop_ : 1;     //!< special PFPA VCOP for kernel execution
-    uint32_t deviceKernelArgs_:1;   //!< Kernel arguments allocated on device
-    uint32_t unused : 28;           //!< unused
+    uint32_t unused : 29;           //!< unused
   };
+  //! Kernel arguments allocated on device, concurrent launches set it without a lock
+  std::atomic<bool> deviceKernelArgs_;
+
+  //! Mark all parameters as defined after they were set together.
+  void markDefined() {
+    if (!validated_) {
+      for (size_t i = 0; i < signature_.numParameters(); ++i) {
+        signature_.params()[i].info_.defined_ = true;
+      }
+      validated_ = 1;
+    }
+  }
 
  public:
   //! Construct a new instance of parameters for the given signature.
   KernelParameters(KernelSignature& signature)
       : signature_(signature),
-        execInfoOffset_(0),
         svmSystemPointersSupport_(FGS_DEFAULT),
         memoryObjects_(nullptr),
         samplerObjects_(nullptr),
         queueObjects_(nullptr),
-        validated_(0),
+        validated_(IS_HIP ? 1 : 0),
         execNewVcop_(0),
         execPfpaVcop_(0),
         deviceKernelArgs_(false) {
     totalSize_ = signature.paramsSize() + (signature.numMemories() +
         signature.numSamplers() + signature.numQueues()) * sizeof(void*);
+    execInfoOffset_ = totalSize_;
     values_ = reinterpret_cast<address>(this) + alignUp(sizeof(KernelParameters), PARAMETERS_MIN_ALIGNMENT);
     memoryObjOffset_ = signature_.paramsSize();
     memoryObjects_ = reinterpret_cast<amd::Memory**>(values_ + memoryObjOffset_);
@@ -202,6 +219,9 @@ class KernelParameters : protected HeapObject {
   //! Set the parameter at the given \a index to the value pointed by \a value
   // \a svmBound indicates that \a value is a SVM pointer.
   void set(size_t index, size_t size, const void* value, bool svmBound = false);
+  //! Set all parameters from the argument pointers or from the packed argument block,
+  // the pointers are SVM pointers.
+  void setAll(void* const* kernelParams, const_address kernArgs);
 
   //! Return true if the parameter at the given \a index is defined.
   bool test(size_t index) const { return signature_.at(index).info_.defined_; }
@@ -283,7 +303,7 @@ class KernelParameters : protected HeapObject {
   bool getExecPfpaVcop() const { return (execPfpaVcop_ == 1); }
 
   //! Returns true if arguemnts were allocated on device
-  bool deviceKernelArgs() const { return (deviceKernelArgs_ == 1); }
+  bool deviceKernelArgs() const { return deviceKernelArgs_.load(std::memory_order_relaxed); }
 
   //! Allocate memory for kernel arguments to be set.
   address alloc(device::VirtualDevice& vDev);
@@ -25,6 +25,7 @@
 #include "platform/object.hpp"
 #include "platform/memory.hpp"
 #include "device/device.hpp"
+#include "utils/patternfill.hpp"
 
 #include <atomic>
 
@@ -1567,12 +1568,20 @@ void SvmBuffer::free(const Context& context, void* ptr) {
   context.svmFree(ptr);
 }
 
+// ================================================================================================
 void SvmBuffer::memFill(void* dst, const void* src, size_t srcSize, size_t times) {
-  address dstAddress = reinterpret_cast<address>(dst);
-  const_address srcAddress = reinterpret_cast<const_address>(src);
-  for (size_t i = 0; i < times; i++) {
-    ::memcpy(dstAddress + i * srcSize, srcAddress, srcSize);
-  }
+  static const PatternFill::Options options = []() {
+    PatternFill::Options options;
+#if defined(ATI_ARCH_X86)
+    options.isa = PatternFill::detect(Os::cpuid, Os::xgetbv);
+#endif
+    options.nonTemporalSize = DEBUG_CLR_HOST_FILL_NONTEMPORAL_SIZE * Mi;
+    options.threads = std::max(1u, DEBUG_CLR_HOST_FILL_THREADS);
+    LogPrintfInfo("Host fills use %s stores, %u threads", PatternFill::name(options.isa),
+                  options.threads);
+    return options;
+  }();
+  PatternFill::fill(dst, src, srcSize, times, options);
 }
 
 // ================================================================================================
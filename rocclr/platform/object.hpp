@@ -27,6 +27,8 @@
 #include "os/alloc.hpp"
 #include "thread/monitor.hpp"
 #include "utils/util.hpp"
+#include "utils/flags.hpp"
+#include "utils/slaballocator.hpp"
 
 
 #define KHR_CL_TYPES_DO(F)                                                                         \
@@ -192,122 +194,23 @@ struct Coord3D {
   }
 };
 
-template <class T>
-class SysmemPool {
-public:
-  SysmemPool(): chunk_access_(true) /* Sysmem Pool Lock */ {}
-  ~SysmemPool() {
-    if (free_chunk_num_ != max_chunk_idx_) {
-      for (int i = 0; i < kActiveAllocSize; ++i) {
-        // Free any active chunks
-        if (active_allocs_[i] != nullptr) {
-          auto chunk = active_allocs_[i]->base_;
-          // Check if this chunk contains unreleased memory objects
-          if ((chunk->busy_ + chunk->free_) != kAllocChunkSize) {
-            LogPrintfError("Unreleased slots in sysmem pool %ld",
-              kAllocChunkSize - (chunk->busy_ + chunk->free_));
-          }
-          delete chunk;
-          free_chunk_num_++;
-        }
-      }
-      // Validate if sysmempool released all memory
-      if (free_chunk_num_ != max_chunk_idx_) {
-        LogPrintfError("Unreleased chunk in sysmem pool %ld",  max_chunk_idx_ - free_chunk_num_);
-      }
-    }
+/*! \brief For the small objects of every command, allocated from the slab allocator.
+ *
+ *  The class must have a virtual destructor, so delete gets the size of the most derived
+ *  object. DEBUG_CLR_SYSMEM_POOL can't change while the objects are alive.
+ */
+class SlabObject {
+ public:
+  void* operator new(size_t size) {
+    return DEBUG_CLR_SYSMEM_POOL ? SlabAllocator::allocate(size) : ::operator new(size);
   }
-  void* Alloc(size_t size) {
-    guarantee(size <= sizeof(T), "Bigger size than pool allows!");
-    size_t current = current_alloc_++;
-    auto idx = current / kAllocChunkSize;
-    while (idx >= max_chunk_idx_) {
-      ScopedLock lock(chunk_access_);
-      // Second check in a case of multiple waiters
-      if (idx == max_chunk_idx_) {
-        auto allocs = new MemoryObject[kAllocChunkSize];
-        // Save the base in the first slot of all allocations
-        allocs[0].base_ = new AllocChunk(allocs);
-        // Check if the overwritten chunk has still empty slots
-        if (active_allocs_[idx % kActiveAllocSize] != nullptr) {
-          auto stale = active_allocs_[idx % kActiveAllocSize]->base_;
-          if (stale->busy_ != kAllocChunkSize) {
-            // The pool contains the stale slots, hence make sure it's marked as free
-            auto freed = stale->free_ - stale->busy_;
-            if (freed == 0) {
-              delete stale;
-              free_chunk_num_++;
-            }
-          }
-        }
-        // Keep the chunk in the list of active chunks
-        active_allocs_[idx % kActiveAllocSize] = allocs;
-        max_chunk_idx_++;
-      } else if ((idx < max_chunk_idx_) && ((max_chunk_idx_ - idx) >= kActiveAllocSize)) {
-        // If a wait was very long, then drop the old slot and find a more recent one
-        current = current_alloc_++;
-        idx = current / kAllocChunkSize;
-      }
+  void operator delete(void* ptr, size_t size) {
+    if (DEBUG_CLR_SYSMEM_POOL) {
+      SlabAllocator::deallocate(ptr, size);
+    } else {
+      ::operator delete(ptr);
     }
-
-    // Find a slot in the active pool of allocations
-    auto chunk_idx = idx % kActiveAllocSize;
-    MemoryObject* obj = &active_allocs_[chunk_idx][current % kAllocChunkSize];
-    // Save the chunk allocation
-    obj->base_ = active_allocs_[chunk_idx]->base_;
-    obj->base_->busy_++;
-    return &obj->object_;
   }
-
-  void Free(void* ptr) {
-#if IS_WINDOWS
-    auto obj = reinterpret_cast<MemoryObject*>(
-      reinterpret_cast<address>(ptr) - offsetof(MemoryObject, object_));
-#else
-    auto obj = reinterpret_cast<MemoryObject*>(
-      reinterpret_cast<address>(ptr) - sizeof(AllocChunk*));
-#endif
-    auto freed = --obj->base_->free_;
-    // If it's the last slot in the chunk, then release memory
-    if (freed == 0) {
-      auto base = obj->base_;
-      {
-        // Make sure active chunks don't have a stale pointer
-        ScopedLock lock(chunk_access_);
-        for (int i = 0; i < kActiveAllocSize; ++i) {
-          if (base->allocs_ == active_allocs_[i]) {
-            active_allocs_[i] = nullptr;
-            break;
-          }
-        }
-      }
-      delete base;
-      free_chunk_num_++;
-    }
-  }
-
-private:
-  static constexpr size_t kAllocChunkSize = 2048;  //!< The total number of allocations in a chunk
-  static constexpr size_t kActiveAllocSize = 32;   //!< The number of active chunks
-  struct AllocChunk;
-  struct MemoryObject {
-    AllocChunk* base_;      //!< The chunk information for this memory object
-    T   object_;            //!< Allocated user object
-    MemoryObject() {}
-  };
-  struct AllocChunk {
-    MemoryObject* allocs_;        //! Array of allocations
-    std::atomic<uint32_t> busy_;  //! The number of commands still available for usage
-    std::atomic<uint32_t> free_;  //! The number of commands still available for usage
-    AllocChunk(MemoryObject* alloc): allocs_(alloc), busy_(0), free_(kAllocChunkSize) {}
-    ~AllocChunk() { delete [] allocs_; }
-  };
-
-  std::atomic<uint64_t> current_alloc_ = 0; //!< Current allocation, global index
-  std::atomic<size_t> max_chunk_idx_ = 0;   //!< Current max chunk index
-  size_t  free_chunk_num_ = 0;              //!< The number of freed chunks
-  amd::Monitor  chunk_access_;              //!< Lock for the chunk list access
-  MemoryObject* active_allocs_[kActiveAllocSize] = {}; //!< Active chunks for fast access
 };
 
 }  // namespace amd
@@ -26,6 +26,7 @@
 #include "utils/options.hpp"
 #include "platform/context.hpp"
 #include "platform/agent.hpp"
+#include "platform/activity.hpp"
 
 #include "platform/interop_gl.hpp"
 
@@ -80,6 +81,7 @@ bool Runtime::init() {
     return false;
   }
 
+  activity_prof::InitTrace();
   initialized_ = true;
   pid_ = amd::Os::getProcessId();
   return true;
@@ -90,14 +92,21 @@ void Runtime::tearDown() {
     return;
   }
 
+  if (DEBUG_CLR_MONITOR_PROFILE) {
+    Monitor::reportContention();
+  }
   Agent::tearDown();
+  activity_prof::StopActivity();
   Device::tearDown();
+  activity_prof::CloseTrace();
+  // The logs and the flags are still valid
+  Command::ReportSysmemPool();
   option::teardown();
+  log_shutdown();
   Flag::tearDown();
   if (outFile != stderr && outFile != nullptr) {
     fclose(outFile);
   }
-  Command::ReleaseSysmemPool();
   initialized_ = false;
 }
 
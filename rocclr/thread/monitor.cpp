@@ -22,6 +22,9 @@
 #include "thread/semaphore.hpp"
 #include "thread/thread.hpp"
 #include "utils/util.hpp"
+#include "utils/debug.hpp"
+#include "utils/lockprofiler.hpp"
+#include "os/os.hpp"
 
 #include <atomic>
 #include <cstring>
@@ -29,7 +32,33 @@
 #include <utility>
 
 namespace amd {
-MonitorBase::~MonitorBase() {}
+
+void Monitor::profiledLock(const char* file, int line) {
+  if (tryLock()) {
+    LockProfiler::record(this, file, line, 0);
+    return;
+  }
+  uint64_t start = Os::timeNanos();
+  dispatch([](auto* m) { return m->lock(); });
+  // A contended acquisition always counts as a wait
+  LockProfiler::record(this, file, line, std::max<uint64_t>(Os::timeNanos() - start, 1));
+}
+
+void Monitor::reportContention() {
+  constexpr size_t kMaxSites = 32;
+  LockProfiler::Profile profile = LockProfiler::collect();
+  ClPrint(LOG_INFO, LOG_LOCK, "Monitor contention profile, %zu call sites", profile.size());
+  for (size_t i = 0; i < std::min(profile.size(), kMaxSites); ++i) {
+    const LockProfiler::Site& site = profile[i].first;
+    const LockProfiler::Stats& stats = profile[i].second;
+    ClPrint(LOG_INFO, LOG_LOCK,
+            "  %p %s:%d acquired %llu, contended %llu, wait %.3f ms, max wait %.3f ms",
+            site.lock_, (site.file_ != nullptr) ? site.file_ : "?", site.line_,
+            static_cast<unsigned long long>(stats.acquisitions_),
+            static_cast<unsigned long long>(stats.contended_), stats.waitNs_ / 1e6,
+            stats.maxWaitNs_ / 1e6);
+  }
+}
 
 namespace legacy_monitor {
 
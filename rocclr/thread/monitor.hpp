@@ -25,12 +25,22 @@
 #include "utils/flags.hpp"
 #include "thread/semaphore.hpp"
 #include "thread/thread.hpp"
+#include "utils/futexlock.hpp"
 #include <condition_variable>
 #include <mutex>
 #include <atomic>
 #include <tuple>
 #include <utility>
 
+// The caller's source location, a default argument of the lock functions
+#if defined(__GNUC__) || defined(__clang__) || (defined(_MSC_VER) && _MSC_VER >= 1926)
+#define MONITOR_CALLER_FILE __builtin_FILE()
+#define MONITOR_CALLER_LINE __builtin_LINE()
+#else
+#define MONITOR_CALLER_FILE nullptr
+#define MONITOR_CALLER_LINE 0
+#endif
+
 namespace amd {
 
 /*! \addtogroup Threads
@@ -71,19 +81,8 @@ template <class T, class AllocClass = HeapObject> struct SimplyLinkedNode : publ
 
 }  // namespace details
 
-class MonitorBase {
-public:
-  virtual ~MonitorBase() = 0;
-  virtual bool tryLock() = 0;
-  virtual void lock() = 0;
-  virtual void unlock() = 0;
-  virtual void wait() = 0;
-  virtual void notify() = 0;
-  virtual void notifyAll() = 0;
-};
-
 namespace legacy_monitor {
-class Monitor final: public HeapObject, public MonitorBase {
+class Monitor final: public HeapObject {
   typedef details::SimplyLinkedNode<Semaphore*, StackObject> LinkedNode;
 
  private:
@@ -168,7 +167,7 @@ class Monitor final: public HeapObject, public MonitorBase {
 } // namespace legacy_monitor
 
 namespace mutex_monitor {
-class Monitor final: public HeapObject, public MonitorBase {
+class Monitor final: public HeapObject {
  public:
   explicit Monitor(bool recursive = false)
       : recursive_(recursive) {
@@ -239,35 +238,102 @@ class Monitor final: public HeapObject, public MonitorBase {
 };
 } // namespace mutex_monitor
 
-// Monitor API wrapper to user
+#if defined(__linux__)
+namespace futex_monitor {
+//! Futex lock with bounded adaptive spinning, see FutexLock
+class Monitor final : public HeapObject, public FutexLock {
+ public:
+  explicit Monitor(bool recursive = false) : FutexLock(recursive) {}
+};
+} // namespace futex_monitor
+#endif
+
+/*! \brief Monitor API wrapper to user.
+ *
+ *  The implementation is selected by the flags when the monitor is created, so the calls
+ *  dispatch on a predictable switch instead of a virtual call. Monitors created before
+ *  the flags are initialized use the legacy implementation. With DEBUG_CLR_MONITOR_PROFILE
+ *  lock() records the wait time of every acquisition by the caller's source location.
+ */
 class Monitor {
+  enum class Kind : uint32_t { Legacy, Mutex, Futex };
+
+  //! Calls the implementation
+  template <typename Call> inline auto dispatch(Call call) {
+    switch (kind_) {
+#if defined(__linux__)
+      case Kind::Futex: return call(futex_);
+#endif
+      case Kind::Mutex: return call(mutex_);
+      default: return call(legacy_);
+    }
+  }
+
 public:
   explicit Monitor(bool recursive = false) {
+#if defined(__linux__)
+    if (DEBUG_CLR_USE_FUTEX_IN_AMD_MONITOR) {
+      kind_ = Kind::Futex;
+      futex_ = new futex_monitor::Monitor(recursive);
+      return;
+    }
+#endif
     if (DEBUG_CLR_USE_STDMUTEX_IN_AMD_MONITOR) {
-      monitor_ = new mutex_monitor::Monitor(recursive);
+      kind_ = Kind::Mutex;
+      mutex_ = new mutex_monitor::Monitor(recursive);
     }
     else {
-      monitor_ = new legacy_monitor::Monitor(recursive);
+      kind_ = Kind::Legacy;
+      legacy_ = new legacy_monitor::Monitor(recursive);
+    }
+  }
+  inline ~Monitor() {
+    switch (kind_) {
+#if defined(__linux__)
+      case Kind::Futex: delete futex_; break;
+#endif
+      case Kind::Mutex: delete mutex_; break;
+      default: delete legacy_; break;
+    }
+  }
+  inline bool tryLock() { return dispatch([](auto* m) { return m->tryLock(); }); }
+  inline void lock(const char* file = MONITOR_CALLER_FILE, int line = MONITOR_CALLER_LINE) {
+    if (unlikely(DEBUG_CLR_MONITOR_PROFILE)) {
+      profiledLock(file, line);
+      return;
     }
+    return dispatch([](auto* m) { return m->lock(); });
   }
-  inline ~Monitor() { delete monitor_; };
-  inline bool tryLock() { return monitor_->tryLock(); }
-  inline void lock() { monitor_->lock(); }
-  inline void unlock() { monitor_->unlock(); }
-  inline void wait() { monitor_->wait(); }
-  inline void notify() { monitor_->notify(); }
-  inline void notifyAll() { monitor_->notifyAll(); }
+  inline void unlock() { return dispatch([](auto* m) { return m->unlock(); }); }
+  inline void wait() { return dispatch([](auto* m) { return m->wait(); }); }
+  inline void notify() { return dispatch([](auto* m) { return m->notify(); }); }
+  inline void notifyAll() { return dispatch([](auto* m) { return m->notifyAll(); }); }
+
+  //! Logs the contention profile of the monitors, the most contended call sites first
+  static void reportContention();
 
 private:
-  MonitorBase* monitor_;
+  //! lock() with the contention profiler
+  void profiledLock(const char* file, int line);
+
+  union {
+    legacy_monitor::Monitor* legacy_;
+    mutex_monitor::Monitor* mutex_;
+#if defined(__linux__)
+    futex_monitor::Monitor* futex_;
+#endif
+  };
+  Kind kind_;  //!< The implementation, fixed at creation
 };
 
 class ScopedLock : StackObject {
  public:
-  ScopedLock(Monitor& lock) : lock_(&lock) { lock_->lock(); }
+  ScopedLock(Monitor& lock, const char* file = MONITOR_CALLER_FILE,
+             int line = MONITOR_CALLER_LINE) : lock_(&lock) { lock_->lock(file, line); }
 
-  ScopedLock(Monitor* lock) : lock_(lock) {
-    if (lock_) lock_->lock();
+  ScopedLock(Monitor* lock, const char* file = MONITOR_CALLER_FILE,
+             int line = MONITOR_CALLER_LINE) : lock_(lock) {
+    if (lock_) lock_->lock(file, line);
   }
 
   ~ScopedLock() {
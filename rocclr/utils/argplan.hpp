@@ -0,0 +1,143 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+#ifndef ARGPLAN_HPP_
+#define ARGPLAN_HPP_
+
+#include "top.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+//! \addtogroup Utils
+
+namespace amd { /*@{*/
+
+/*! \brief Fix-up plan of the kernel arguments.
+ *
+ * The plan is built once per kernel signature. The scalar arguments are copied without
+ * looking at their descriptors, from a packed argument block as a few contiguous ranges or
+ * from an array of argument pointers as a list of fields. Only the arguments which need a
+ * conversion, the pointers, the dynamic local memory sizes, the samplers and the queues,
+ * are kept as slots for the caller.
+ */
+class ArgPlan {
+ public:
+  enum Kind : uint32_t { Scalar = 0, Pointer, Local, Sampler, Queue };
+
+  //! Scalar ranges separated by less padding than this are merged
+  static constexpr uint32_t kMaxGap = 16;
+
+  struct Field {
+    uint32_t index_;   //!< The argument index
+    uint32_t offset_;  //!< The offset in the argument block
+    uint32_t size_;    //!< The size of the argument
+  };
+
+  struct Range {
+    uint32_t offset_;  //!< The offset in the argument block
+    uint32_t size_;    //!< The size of the range
+  };
+
+  struct Slot {
+    uint32_t index_;   //!< The argument index
+    uint32_t offset_;  //!< The offset in the argument block
+    uint32_t size_;    //!< The size of the argument
+    Kind kind_;        //!< The conversion of the argument
+  };
+
+  //! Adds the argument, the arguments can be added in any order
+  void add(uint32_t index, uint32_t offset, uint32_t size, Kind kind) {
+    if (kind == Scalar) {
+      fields_.push_back({index, offset, size});
+    } else {
+      slots_.push_back({index, offset, size, kind});
+    }
+  }
+
+  //! Sorts the arguments by offset and merges the scalar ranges
+  void finalize() {
+    auto byOffset = [](const auto& a, const auto& b) { return a.offset_ < b.offset_; };
+    std::sort(fields_.begin(), fields_.end(), byOffset);
+    std::sort(slots_.begin(), slots_.end(), byOffset);
+    ranges_.clear();
+    auto slot = slots_.begin();
+    for (const auto& field : fields_) {
+      if (field.size_ == 0) {
+        continue;
+      }
+      // A slot between two fields ends the range, the caller writes it separately
+      bool split = false;
+      while ((slot != slots_.end()) && (slot->offset_ < field.offset_)) {
+        split = true;
+        ++slot;
+      }
+      uint32_t end = ranges_.empty() ? 0 : ranges_.back().offset_ + ranges_.back().size_;
+      if (!ranges_.empty() && !split && (field.offset_ <= end + kMaxGap)) {
+        ranges_.back().size_ = std::max(end, field.offset_ + field.size_) -
+            ranges_.back().offset_;
+      } else {
+        ranges_.push_back({field.offset_, field.size_});
+      }
+    }
+  }
+
+  const std::vector<Field>& fields() const { return fields_; }
+  const std::vector<Range>& ranges() const { return ranges_; }
+  const std::vector<Slot>& slots() const { return slots_; }
+
+  //! Copies the scalar arguments of a packed argument block with the same layout
+  void copyRanges(address dst, const_address src) const {
+    for (const auto& range : ranges_) {
+      ::memcpy(dst + range.offset_, src + range.offset_, range.size_);
+    }
+  }
+
+  //! Copies the scalar arguments of an array of argument pointers
+  void copyFields(address dst, void* const* args) const {
+    for (const auto& field : fields_) {
+      switch (field.size_) {
+        case sizeof(uint32_t):
+          ::memcpy(dst + field.offset_, args[field.index_], sizeof(uint32_t));
+          break;
+        case sizeof(uint64_t):
+          ::memcpy(dst + field.offset_, args[field.index_], sizeof(uint64_t));
+          break;
+        default:
+          ::memcpy(dst + field.offset_, args[field.index_], field.size_);
+          break;
+      }
+    }
+  }
+
+ private:
+  std::vector<Field> fields_;  //!< Scalar arguments, sorted by offset
+  std::vector<Range> ranges_;  //!< Merged scalar ranges of a packed argument block
+  std::vector<Slot> slots_;    //!< Arguments with a conversion, sorted by offset
+};
+
+/*@}*/
+
+}  // namespace amd
+
+#endif /*ARGPLAN_HPP_*/
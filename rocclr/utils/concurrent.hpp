@@ -25,7 +25,9 @@
 #include "os/alloc.hpp"
 
 #include <atomic>
+#include <mutex>
 #include <new>
+#include <vector>
 
 //! \addtogroup Utils
 
@@ -55,6 +57,148 @@ template <typename T, int N> struct TaggedPointerHelper {
   size_t tag() const { return reinterpret_cast<uintptr_t>(this) & TagMask; }
 };
 
+/*! \brief A fixed size node allocator with per-thread magazines.
+ *
+ * Every thread keeps a free list of nodes, allocations and frees are served from it
+ * without synchronization. A thread moves a magazine of nodes to the global depot when its
+ * list grows above two magazines, and takes one from the depot when the list is empty, so
+ * the nodes freed by the consumer of a queue return to the producers. The depot carves the
+ * nodes from slabs, which are never released. Thus the memory of a freed node stays valid
+ * for the lock-free readers, which may still load from it before they retry.
+ */
+template <size_t Size, size_t Align> class MagazineAllocator : public AllStatic {
+ public:
+  static constexpr size_t kMagazineSize = 64;  //!< The number of nodes in a magazine
+  static constexpr size_t kStride = (Size + Align - 1) / Align * Align;
+
+  //! Returns a node of Size bytes, aligned to Align
+  static void* allocate() {
+    Cache& cache = local();
+    if (cache.free_ == nullptr) {
+      cache.free_ = Depot::get().take();
+      if (cache.free_ == nullptr) {
+        return nullptr;
+      }
+      cache.count_ = kMagazineSize;
+    }
+    FreeNode* node = cache.free_;
+    cache.free_ = node->next_;
+    --cache.count_;
+    return node;
+  }
+
+  //! Returns a node of any thread to the free list of the current thread
+  static void deallocate(void* ptr) {
+    Cache& cache = local();
+    FreeNode* node = static_cast<FreeNode*>(ptr);
+    node->next_ = cache.free_;
+    cache.free_ = node;
+    if (++cache.count_ >= 2 * kMagazineSize) {
+      // Keep the most recently freed nodes, they are likely in the cache
+      FreeNode* last = cache.free_;
+      for (size_t i = 1; i < kMagazineSize; ++i) {
+        last = last->next_;
+      }
+      Depot::get().give(last->next_);
+      last->next_ = nullptr;
+      cache.count_ = kMagazineSize;
+    }
+  }
+
+ private:
+  struct FreeNode {
+    FreeNode* next_;
+  };
+
+  //! The free list of a thread
+  struct Cache {
+    FreeNode* free_ = nullptr;  //!< The free nodes
+    size_t count_ = 0;          //!< The number of free nodes
+
+    //! The nodes of an exiting thread go back to the depot
+    ~Cache() {
+      while (count_ > 0) {
+        FreeNode* magazine = free_;
+        FreeNode* last = free_;
+        size_t count = 1;
+        for (; (count < kMagazineSize) && (last->next_ != nullptr); ++count) {
+          last = last->next_;
+        }
+        free_ = last->next_;
+        last->next_ = nullptr;
+        count_ -= count;
+        Depot::get().give(magazine, count);
+      }
+    }
+  };
+
+  //! The global magazines, shared by all threads
+  class Depot {
+   public:
+    //! The depot is never destroyed, threads may exit after the static destructors
+    static Depot& get() {
+      static Depot* depot = new Depot();
+      return *depot;
+    }
+
+    //! Returns a null terminated list of kMagazineSize nodes
+    FreeNode* take() {
+      {
+        std::lock_guard<std::mutex> lock(lock_);
+        if (!magazines_.empty()) {
+          FreeNode* head = magazines_.back();
+          magazines_.pop_back();
+          return head;
+        }
+      }
+      address slab = reinterpret_cast<address>(
+          AlignedMemory::allocate(kMagazineSize * kStride, Align));
+      if (slab == nullptr) {
+        return nullptr;
+      }
+      FreeNode* head = nullptr;
+      for (size_t i = kMagazineSize; i > 0; --i) {
+        FreeNode* node = reinterpret_cast<FreeNode*>(slab + (i - 1) * kStride);
+        node->next_ = head;
+        head = node;
+      }
+      return head;
+    }
+
+    //! Adds a null terminated list of count nodes
+    void give(FreeNode* head, size_t count = kMagazineSize) {
+      std::lock_guard<std::mutex> lock(lock_);
+      if (count == kMagazineSize) {
+        magazines_.push_back(head);
+        return;
+      }
+      // The nodes of a partial magazine are collected until they fill a magazine
+      while (head != nullptr) {
+        FreeNode* next = head->next_;
+        head->next_ = loose_;
+        loose_ = head;
+        if (++looseCount_ == kMagazineSize) {
+          magazines_.push_back(loose_);
+          loose_ = nullptr;
+          looseCount_ = 0;
+        }
+        head = next;
+      }
+    }
+
+   private:
+    std::mutex lock_;                   //!< Serializes the magazine list
+    std::vector<FreeNode*> magazines_;  //!< Full magazines
+    FreeNode* loose_ = nullptr;         //!< The nodes of the partial magazines
+    size_t looseCount_ = 0;             //!< The number of loose nodes
+  };
+
+  static Cache& local() {
+    static thread_local Cache cache;
+    return cache;
+  }
+};
+
 }  // namespace details
 
 /*! \brief An unbounded thread-safe queue.
@@ -63,8 +207,8 @@ template <typename T, int N> struct TaggedPointerHelper {
  * "Simple, Fast, and Practical Non-Blocking and Blocking Concurrent Queue
  * Algorithms by Maged M. Michael and Michael L. Scott.".
  *
- * FIXME_lmoriche: Implement the new/delete operators for SimplyLinkedNode
- * using thread-local allocation buffers.
+ * The nodes come from the per-thread magazines of details::MagazineAllocator, so the
+ * submit path doesn't contend on malloc and free, and a dequeued node stays readable.
  */
 template <typename T, int N = 5> class ConcurrentLinkedQueue : public HeapObject {
   //! A simply-linked node
@@ -85,14 +229,14 @@ template <typename T, int N = 5> class ConcurrentLinkedQueue : public HeapObject
   std::atomic<typename Node::Ptr> head_;  //! Pointer to the oldest element.
   std::atomic<typename Node::Ptr> tail_;  //! Pointer to the most recent element.
 
+  typedef details::MagazineAllocator<sizeof(Node), 1 << N> NodeAllocator;
+
  private:
   //! \brief Allocate a free node.
-  static inline Node* allocNode() {
-    return new (AlignedMemory::allocate(sizeof(Node), 1 << N)) Node();
-  }
+  static inline Node* allocNode() { return new (NodeAllocator::allocate()) Node(); }
 
   //! \brief Return a node to the free list.
-  static inline void reclaimNode(Node* node) { AlignedMemory::deallocate(node); }
+  static inline void reclaimNode(Node* node) { NodeAllocator::deallocate(node); }
 
  public:
   //! \brief Initialize a new concurrent linked queue.
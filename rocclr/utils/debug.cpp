@@ -21,6 +21,7 @@
 #include "top.hpp"
 #include "utils/debug.hpp"
 #include "os/os.hpp"
+#include "utils/logbuffer.hpp"
 
 #if !defined(AMD_LOG_LEVEL)
 #include "utils/flags.hpp"
@@ -29,7 +30,14 @@
 #include <cstdlib>
 #include <cstdio>
 #include <cstdarg>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
 #include <thread>
+#include <vector>
 #include <sstream>
 #include <iomanip>
 #include <inttypes.h>
@@ -55,10 +63,336 @@ void truncate_log_file() {
   }
 }
 
+// ================================================================================================
+static void count_written(int size, size_t* written) {
+  if (written != nullptr && size > 0) {
+    *written += size;
+  }
+}
+
+// ================================================================================================
+static void write_message(LogLevel level, const char* file, int line, uint64_t timeUs,
+                          const char* pidtid, const char* message, bool hasDuration,
+                          uint64_t durationUs, size_t* written = nullptr) {
+  int size;
+  if (!hasDuration) {
+    size = fprintf(outFile, ":%d:%-25s:%-4d: %010" PRIu64 " us: %s %s\n", level, file, line,
+      timeUs, pidtid, message);
+  } else {
+    size = fprintf(outFile, ":%d:%-25s:%-4d: %010" PRIu64 " us: %s %s: duration: %" PRIu64
+      " us\n", level, file, line, timeUs, pidtid, message, durationUs);
+  }
+  count_written(size, written);
+}
+
+// ================================================================================================
+static std::string pid_tid() {
+  std::stringstream pidtid;
+  if (AMD_LOG_LEVEL >= 4) {
+    pidtid << "[pid:" << Os::getProcessId() << " tid: 0x" ;
+    pidtid << std::hex << std::setw(5) << std::this_thread::get_id() << "]";
+  }
+  return pidtid.str();
+}
+
+/*! \brief Asynchronous AMD_LOG writer, enabled with AMD_LOG_ASYNC.
+ *
+ * Every thread captures the raw arguments into its own LogRing, the formatting and
+ * the file writes happen in a background thread. A full ring drops the message and
+ * the writer reports the number of the dropped messages. The log file is rotated to
+ * "<file>.1" when it exceeds AMD_LOG_LEVEL_SIZE.
+ */
+class AsyncLogger {
+ public:
+  //! Returns the logger or nullptr if the asynchronous mode is off
+  static AsyncLogger* active() {
+    if (!AMD_LOG_ASYNC) {
+      return nullptr;
+    }
+    // Never destroyed, the exiting threads may still retire their rings
+    static AsyncLogger* logger = new AsyncLogger();
+    return logger->stopped_.load(std::memory_order_acquire) ? nullptr : logger;
+  }
+
+  //! Returns the logger if it was created, doesn't start it
+  static AsyncLogger* instance() { return instance_.load(std::memory_order_acquire); }
+
+  //! Queues the message, drops it if the ring of the thread is full. Returns false if the
+  //! caller has to write the message: the thread already released its ring at the exit or
+  //! the message doesn't fit a record
+  bool log(LogLevel level, const char* file, int line, uint64_t* start, const char* format,
+           va_list ap) {
+    ThreadRing* ring = threadRing();
+    if (ring == nullptr) {
+      return false;
+    }
+    uint64_t timeUs = Os::timeNanos() / 1000ULL;
+    LogRecord* record = ring->ring_.reserve();
+    if (record != nullptr) {
+      record->timeUs_ = timeUs;
+      record->file_ = file;
+      record->line_ = line;
+      record->level_ = level;
+      record->hasDuration_ = (start != nullptr) && (*start != 0);
+      record->durationUs_ = record->hasDuration_ ? timeUs - *start : 0;
+      if (!record->capture(format, ap)) {
+        return false;
+      }
+      ring->ring_.commit();
+      // Wake up the writer when the ring gets half full
+      if (ring->ring_.available() == ring->ring_.capacity() / 2) {
+        wakeup_.notify_one();
+      }
+    }
+    if (start != nullptr && *start == 0) {
+      *start = timeUs;
+    }
+    return true;
+  }
+
+  //! Writes all queued messages, then the message from the callback
+  template <typename F> void writeNow(F write) {
+    std::lock_guard<std::mutex> lock(writeLock_);
+    drain();
+    write(&written_);
+    fflush(outFile);
+  }
+
+  //! Writes all queued messages and stops the writer thread
+  void stop() {
+    {
+      std::lock_guard<std::mutex> lock(wakeupLock_);
+      stopped_.store(true, std::memory_order_release);
+    }
+    wakeup_.notify_one();
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+    std::lock_guard<std::mutex> lock(writeLock_);
+    drain();
+  }
+
+  //! Writes all queued messages if the writer isn't busy, used at the process exit
+  void tryFlush() {
+    std::unique_lock<std::mutex> lock(writeLock_, std::try_to_lock);
+    if (lock.owns_lock()) {
+      drain();
+    }
+  }
+
+ private:
+  struct ThreadRing {
+    ThreadRing(size_t capacity, std::string&& pidtid)
+      : ring_(capacity), pidtid_(std::move(pidtid)) {}
+    LogRing ring_;                        //!< Messages of the thread
+    std::string pidtid_;                  //!< Preformatted process and thread ids
+    std::atomic<bool> retired_{false};    //!< The thread exited
+  };
+
+  struct ThreadState {
+    ThreadRing* ring_;  //!< The ring of the thread
+    bool exited_;       //!< The exit hook retired the ring
+  };
+
+  //! Retires the ring of the thread on the thread exit. The writer thread releases it,
+  //! so the later messages of the thread, such as from the static destructors, are
+  //! written synchronously
+  struct ExitHook {
+    ~ExitHook() {
+      ThreadState& state = threadState();
+      if (state.ring_ != nullptr) {
+        state.ring_->retired_.store(true, std::memory_order_release);
+      }
+      state.ring_ = nullptr;
+      state.exited_ = true;
+    }
+  };
+
+  //! Trivially destructible, so it stays valid after the exit hook of the thread
+  static ThreadState& threadState() {
+    static thread_local ThreadState state = {nullptr, false};
+    return state;
+  }
+
+  AsyncLogger() {
+    if (outFile != stderr) {
+      fileName_ = std::string(AMD_LOG_LEVEL_FILE) + "_" + std::to_string(Os::getProcessId());
+      fseek(outFile, 0, SEEK_END);
+      long size = ftell(outFile);
+      written_ = (size > 0) ? size : 0;
+    }
+    thread_ = std::thread([this]() { run(); });
+    instance_.store(this, std::memory_order_release);
+  }
+
+  //! Returns the ring of the thread, nullptr after the thread exit
+  ThreadRing* threadRing() {
+    ThreadState& state = threadState();
+    if (state.ring_ == nullptr && !state.exited_) {
+      static thread_local ExitHook hook;
+      state.ring_ = new ThreadRing(AMD_LOG_ASYNC_BUFFER, pid_tid());
+      std::lock_guard<std::mutex> lock(registryLock_);
+      rings_.push_back(state.ring_);
+    }
+    return state.ring_;
+  }
+
+  void run() {
+    std::chrono::milliseconds interval(kMinInterval);
+    while (!stopped_.load(std::memory_order_acquire)) {
+      {
+        std::unique_lock<std::mutex> lock(wakeupLock_);
+        wakeup_.wait_for(lock, interval,
+                         [this]() { return stopped_.load(std::memory_order_relaxed); });
+      }
+      size_t count;
+      {
+        std::lock_guard<std::mutex> lock(writeLock_);
+        count = drain();
+      }
+      // Back off while the application doesn't log
+      interval = (count == 0) ? std::min(interval * 2, std::chrono::milliseconds(kMaxInterval))
+                              : std::chrono::milliseconds(kMinInterval);
+    }
+  }
+
+  //! Writes the queued messages in the timestamp order. Returns the number of messages
+  size_t drain() {
+    {
+      std::lock_guard<std::mutex> lock(registryLock_);
+      snapshot_ = rings_;
+    }
+    batch_.clear();
+    counts_.clear();
+    for (auto ring : snapshot_) {
+      // Check the retirement first, so the count includes the final messages
+      bool retired = ring->retired_.load(std::memory_order_acquire);
+      size_t count = ring->ring_.available();
+      for (size_t i = 0; i < count; ++i) {
+        batch_.push_back({&ring->ring_.peek(i), ring});
+      }
+      counts_.push_back({count, retired});
+    }
+    std::stable_sort(batch_.begin(), batch_.end(), [](const Entry& a, const Entry& b) {
+      return a.record_->timeUs_ < b.record_->timeUs_;
+    });
+    char message[4096];
+    for (const auto& entry : batch_) {
+      const LogRecord& record = *entry.record_;
+      record.format(message, sizeof(message));
+      write_message(static_cast<LogLevel>(record.level_), record.file_, record.line_,
+                    record.timeUs_, entry.ring_->pidtid_.c_str(), message, record.hasDuration_,
+                    record.durationUs_, &written_);
+      if (written_ > maxLogSize) {
+        rotate();
+      }
+    }
+
+    size_t dropped = droppedRetired_;
+    for (size_t i = 0; i < snapshot_.size(); ++i) {
+      ThreadRing* ring = snapshot_[i];
+      ring->ring_.pop(counts_[i].first);
+      dropped += ring->ring_.dropped();
+      if (counts_[i].second) {
+        droppedRetired_ += ring->ring_.dropped();
+        std::lock_guard<std::mutex> lock(registryLock_);
+        rings_.erase(std::find(rings_.begin(), rings_.end(), ring));
+        delete ring;
+      }
+    }
+    if (dropped > reportedDropped_) {
+      int size = fprintf(outFile, "Warning: AMD_LOG_ASYNC_BUFFER is full, dropped %zu messages, "
+                         "%zu in total\n", dropped - reportedDropped_, dropped);
+      written_ += (size > 0) ? size : 0;
+      reportedDropped_ = dropped;
+    }
+    if (!batch_.empty()) {
+      fflush(outFile);
+    }
+    return batch_.size();
+  }
+
+  //! Moves the log file to "<file>.1" and starts a new one. The stream is reopened in place,
+  //! because HSA runtime logging holds the same FILE pointer
+  void rotate() {
+    written_ = 0;
+    if (fileName_.empty()) {
+      return;
+    }
+    std::string backup = fileName_ + ".1";
+    fflush(outFile);
+    std::remove(backup.c_str());
+    std::rename(fileName_.c_str(), backup.c_str());
+    if (freopen(fileName_.c_str(), "w", outFile) == nullptr) {
+      outFile = stderr;
+      fileName_.clear();
+    }
+  }
+
+  static constexpr uint kMinInterval = 2;    //!< Writer poll interval in ms
+  static constexpr uint kMaxInterval = 64;   //!< Writer poll interval without messages in ms
+
+  struct Entry {
+    const LogRecord* record_;
+    ThreadRing* ring_;
+  };
+
+  std::mutex registryLock_;                //!< Protects the ring registry
+  std::vector<ThreadRing*> rings_;         //!< Rings of all threads which logged messages
+  std::mutex writeLock_;                   //!< Serializes the consumer and the file access
+  std::vector<ThreadRing*> snapshot_;      //!< Rings, drained in the current batch
+  std::vector<std::pair<size_t, bool>> counts_;  //!< Drained messages, retired flag per ring
+  std::vector<Entry> batch_;               //!< Messages of the current batch
+  size_t written_ = 0;                     //!< The size of the log file
+  size_t droppedRetired_ = 0;              //!< Dropped messages of the exited threads
+  size_t reportedDropped_ = 0;             //!< Dropped messages, reported in the log
+  std::string fileName_;                   //!< The log file name, empty for stderr
+  std::mutex wakeupLock_;
+  std::condition_variable wakeup_;         //!< Wakes up the writer thread
+  std::atomic<bool> stopped_{false};       //!< The writer thread was stopped
+  std::thread thread_;                     //!< The writer thread
+
+  static std::atomic<AsyncLogger*> instance_;  //!< The logger, if it was created
+};
+
+std::atomic<AsyncLogger*> AsyncLogger::instance_{nullptr};
+
+//! Flushes the asynchronous log at the process exit without the runtime teardown
+static struct AsyncLogExit {
+  ~AsyncLogExit() {
+    AsyncLogger* logger = AsyncLogger::instance();
+    if (logger != nullptr) {
+      logger->tryFlush();
+    }
+  }
+} asyncLogExit;
+
+// ================================================================================================
+void log_shutdown() {
+  AsyncLogger* logger = AsyncLogger::instance();
+  if (logger != nullptr) {
+    logger->stop();
+  }
+}
+
+// ================================================================================================
+//! Writes a message synchronously, after the queued asynchronous messages
+template <typename F> static void write_log(F write) {
+  AsyncLogger* logger = AsyncLogger::active();
+  if (logger != nullptr) {
+    logger->writeNow(write);
+  } else {
+    truncate_log_file();
+    write(nullptr);
+    fflush(outFile);
+  }
+}
+
 // ================================================================================================
 void report_warning(const char* message) {
-  truncate_log_file();
-  fprintf(outFile, "Warning: %s\n", message);
+  write_log([&](size_t* written) {
+    count_written(fprintf(outFile, "Warning: %s\n", message), written);
+  });
 }
 
 // ================================================================================================
@@ -66,9 +400,9 @@ void log_entry(LogLevel level, const char* file, int line, const char* message)
   if (level == LOG_NONE) {
     return;
   }
-  truncate_log_file();
-  fprintf(outFile, ":%d:%s:%d: %s\n", level, file, line, message);
-  fflush(outFile);
+  write_log([&](size_t* written) {
+    count_written(fprintf(outFile, ":%d:%s:%d: %s\n", level, file, line, message), written);
+  });
 }
 
 // ================================================================================================
@@ -86,63 +420,60 @@ void log_timestamped(LogLevel level, const char* file, int line, const char* mes
     return;
   }
 
-  truncate_log_file();
-  fprintf(outFile, ":% 2d:%15s:% 5d: (%010lld) us %s\n", level, file, line, time / 1000ULL,
-          message);
-  fflush(outFile);
+  write_log([&](size_t* written) {
+    count_written(fprintf(outFile, ":% 2d:%15s:% 5d: (%010lld) us %s\n", level, file, line,
+                          time / 1000ULL, message), written);
+  });
 }
 
+
 // ================================================================================================
-void log_printf(LogLevel level, const char* file, int line, const char* format, ...) {
-  va_list ap;
-  std::stringstream pidtid;
-  if (AMD_LOG_LEVEL >= 4) {
-    pidtid << "[pid:" << Os::getProcessId() << " tid: 0x" ;
-    pidtid << std::hex << std::setw(5) << std::this_thread::get_id() << "]";
+static void log_vprintf(LogLevel level, const char* file, int line, uint64_t* start,
+                        const char* format, va_list ap) {
+  AsyncLogger* logger = AsyncLogger::active();
+  // Errors go out immediately, the application may abort right after them
+  if (logger != nullptr && level > LOG_ERROR &&
+      logger->log(level, file, line, start, format, ap)) {
+    return;
   }
 
-  va_start(ap, format);
+  std::string pidtid = pid_tid();
   char message[4096];
   vsnprintf(message, sizeof(message), format, ap);
-  va_end(ap);
   uint64_t timeUs = Os::timeNanos() / 1000ULL;
+  bool hasDuration = (start != nullptr) && (*start != 0);
+  uint64_t durationUs = hasDuration ? timeUs - *start : 0;
 
-  truncate_log_file();
-
-  fprintf(outFile, ":%d:%-25s:%-4d: %010" PRIu64 " us: %s %s\n", level, file, line,
-    timeUs, pidtid.str().c_str(), message);
+  if (logger != nullptr) {
+    logger->writeNow([&](size_t* written) {
+      write_message(level, file, line, timeUs, pidtid.c_str(), message, hasDuration, durationUs,
+                    written);
+    });
+  } else {
+    truncate_log_file();
+    write_message(level, file, line, timeUs, pidtid.c_str(), message, hasDuration, durationUs);
+    fflush(outFile);
+  }
+  if (start != nullptr && *start == 0) {
+     *start = timeUs;
+  }
+}
 
-  fflush(outFile);
+// ================================================================================================
+void log_printf(LogLevel level, const char* file, int line, const char* format, ...) {
+  va_list ap;
+  va_start(ap, format);
+  log_vprintf(level, file, line, nullptr, format, ap);
+  va_end(ap);
 }
 
 // ================================================================================================
 void log_printf(LogLevel level, const char* file, int line, uint64_t* start,
                 const char* format, ...) {
   va_list ap;
-  std::stringstream pidtid;
-  if (AMD_LOG_LEVEL >= 4) {
-    pidtid << "[pid:" << Os::getProcessId() << " tid: 0x" ;
-    pidtid << std::hex << std::setw(5) << std::this_thread::get_id() << "]";
-  }
   va_start(ap, format);
-  char message[4096];
-  vsnprintf(message, sizeof(message), format, ap);
+  log_vprintf(level, file, line, start, format, ap);
   va_end(ap);
-  uint64_t timeUs = Os::timeNanos() / 1000ULL;
-
-  truncate_log_file();
-
-  if (start == 0 || *start == 0) {
-    fprintf(outFile, ":%d:%-25s:%-4d: %010" PRIu64 " us: %s %s\n", level, file, line,
-      timeUs, pidtid.str().c_str(), message);
-  } else {
-    fprintf(outFile, ":%d:%-25s:%-4d: %010" PRIu64 " us: %s %s: duration: %" PRIu64 " us\n",
-      level, file, line, timeUs, pidtid.str().c_str(), message, timeUs - *start);
-  }
-  fflush(outFile);
-  if (*start == 0) {
-     *start = timeUs;
-  }
 }
 
 }  // namespace amd
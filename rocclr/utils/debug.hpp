@@ -89,6 +89,9 @@ extern void log_timestamped(LogLevel level, const char* file, int line, const ch
 extern void log_printf(LogLevel level, const char* file, int line, const char* format, ...);
 extern void log_printf(LogLevel level, const char* file, int line, uint64_t *start, const char* format, ...);
 
+//! \brief Writes the queued AMD_LOG_ASYNC messages and stops the writer thread.
+extern void log_shutdown();
+
 /*@}*/} // namespace amd
 
 #if __INTEL_COMPILER
@@ -0,0 +1,150 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#ifndef FILECACHE_HPP_
+#define FILECACHE_HPP_
+
+#include "top.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+//! \addtogroup Utils
+
+namespace amd { /*@{*/
+
+/*! \brief The content key of a persistent cache, a 128 bit hash of all inputs.
+ *
+ * Every field is length prefixed, so the concatenation of the fields is unambiguous.
+ */
+class ContentKey {
+ public:
+  ContentKey() : h1_(0x9E3779B97F4A7C15ull), h2_(0xC2B2AE3D27D4EB4Full), size_(0) {}
+
+  //! Adds a field
+  void add(const void* data, size_t size) {
+    uint64_t length = size;
+    addBytes(reinterpret_cast<const uint8_t*>(&length), sizeof(length));
+    addBytes(reinterpret_cast<const uint8_t*>(data), size);
+    size_ += size;
+  }
+  void add(const std::string& str) { add(str.data(), str.size()); }
+  void add(uint64_t value) { add(&value, sizeof(value)); }
+
+  //! Returns the first 64 bits of the key
+  uint64_t value() const { return mix(h1_ ^ size_); }
+
+  //! Returns the key as 32 hex digits
+  std::string str() const {
+    uint64_t h1 = value();
+    uint64_t h2 = mix(h2_ + h1);
+    char buf[33];
+    snprintf(buf, sizeof(buf), "%016llx%016llx", static_cast<unsigned long long>(h1),
+             static_cast<unsigned long long>(h2));
+    return buf;
+  }
+
+ private:
+  static constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ull;
+  static constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+
+  static uint64_t rotl(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+  }
+
+  static uint64_t mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+  }
+
+  void addWord(uint64_t word) {
+    h1_ = rotl(h1_ ^ (word * kPrime1), 31) * kPrime2;
+    h2_ = rotl(h2_ ^ (word * kPrime2), 29) * kPrime1 + h1_;
+  }
+
+  void addBytes(const uint8_t* data, size_t size) {
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+      uint64_t word;
+      memcpy(&word, data + i, sizeof(word));
+      addWord(word);
+    }
+    if (i < size) {
+      uint64_t word = 0;
+      memcpy(&word, data + i, size - i);
+      addWord(word);
+    }
+  }
+
+  uint64_t h1_;
+  uint64_t h2_;
+  uint64_t size_;  //!< The total size of the fields
+};
+
+//! A file of a persistent cache
+struct CacheFile {
+  std::string path_;  //!< The path of the file
+  uint64_t size_;     //!< The file size
+  int64_t time_;      //!< The time of the last use
+};
+
+/*! \brief Evicts the least recently used files of a cache, which exceeds \a maxSize.
+ *
+ * The files are removed until the cache fits into 7/8 of the limit, which leaves some room
+ * to avoid an eviction on every store. \a remove(const CacheFile&) returns false if the
+ * file couldn't be removed, then the next one is tried. Sorts \a files by the time of the
+ * last use and returns the size of the remaining files.
+ */
+template <typename Remove>
+uint64_t evictCacheFiles(std::vector<CacheFile>* files, uint64_t maxSize, Remove&& remove) {
+  std::sort(files->begin(), files->end(),
+            [](const CacheFile& a, const CacheFile& b) { return a.time_ < b.time_; });
+  uint64_t size = 0;
+  for (const auto& file : *files) {
+    size += file.size_;
+  }
+  if (size <= maxSize) {
+    return size;
+  }
+  const uint64_t target = maxSize - maxSize / 8;
+  for (const auto& file : *files) {
+    if (size <= target) {
+      break;
+    }
+    if (remove(file)) {
+      size -= file.size_;
+    }
+  }
+  return size;
+}
+
+/*@}*/
+
+}  // namespace amd
+
+#endif /*FILECACHE_HPP_*/
@@ -32,6 +32,11 @@ release(cstring, AMD_LOG_LEVEL_FILE, "",                                      \
         "Set output file for AMD_LOG_LEVEL, Default is stderr")               \
 release(size_t, AMD_LOG_LEVEL_SIZE, 2048,                                     \
         "The max size of AMD_LOG generated in MB if printed to a file")       \
+release(bool, AMD_LOG_ASYNC, false,                                           \
+        "Format and write AMD_LOG messages in a background thread")           \
+release(uint, AMD_LOG_ASYNC_BUFFER, 1024,                                     \
+        "The number of queued AMD_LOG_ASYNC messages per thread, the rest "   \
+        "are dropped")                                                        \
 debug(uint, DEBUG_GPU_FLAGS, 0,                                               \
         "The debug options for GPU device")                                   \
 release(size_t, CQ_THREAD_STACK_SIZE, 256*Ki, /* @todo: that much! */         \
@@ -202,6 +207,8 @@ release(bool, HIP_MEM_POOL_SUPPORT, true,                                     \
         "Enables memory pool support in HIP")                                 \
 release(bool, HIP_MEM_POOL_USE_VM, true,                                      \
         "Enables memory pool support in HIP")                                 \
+release(size_t, HIP_MEM_POOL_SUBALLOC_MAX_SIZE, 0,                            \
+        "Max allocation size in KB, carved from slabs in mempools. 0 - off")  \
 release(bool, PAL_HIP_IPC_FLAG, true,                                         \
         "Enable interprocess flag for device allocation in PAL HIP")          \
 release(uint, PAL_FORCE_ASIC_REVISION, 0,                                     \
@@ -227,12 +234,36 @@ release(uint, DEBUG_CLR_LIMIT_BLIT_WG, 16,                                    \
         "Limit the number of workgroups in blit operations")                  \
 release(bool, DEBUG_CLR_BLIT_KERNARG_OPT, false,                              \
         "Enable blit kernel arguments optimization")                          \
+release(size_t, DEBUG_CLR_HOST_FILL_NONTEMPORAL_SIZE, 16,                     \
+        "Host fills of at least this size in MB bypass the CPU caches")       \
+release(uint, DEBUG_CLR_HOST_FILL_THREADS, 1,                                 \
+        "The max number of threads of a host fill larger than 64 MB")         \
+release(uint, DEBUG_CLR_HOSTCALL_THREADS, 1,                                  \
+        "The number of threads serving the hostcall buffers")                 \
+release(uint, DEBUG_CLR_HOSTCALL_BATCHES, 8,                                  \
+        "The max number of ready stacks a hostcall thread drains per wakeup") \
+release(uint, DEBUG_CLR_STAGED_COPY_SLOTS, 2,                                 \
+        "The number of staging buffers of a pipelined staged copy")           \
+release(uint, DEBUG_CLR_STAGED_COPY_THREADS, 1,                               \
+        "The max number of threads of a staged chunk copy, 4 MB per thread")  \
+release(size_t, DEBUG_CLR_PINNED_CACHE_SIZE, 0,                               \
+        "Budget in MB of the device pinned host memory cache, 0 disables it") \
+release(uint, DEBUG_CLR_HOST_QUEUE_RING_SIZE, 0,                              \
+        "Size of the bounded command ring of a queue thread, 0 disables it")  \
+release(uint, DEBUG_CLR_ACTIVITY_BUFFER, 0,                                   \
+        "Records per chunk of the buffered profiler activity, 0 disables it") \
+release(uint, DEBUG_CLR_ACTIVITY_FLUSH_MS, 10,                                \
+        "The delivery interval in ms of the buffered profiler activity")      \
+release(cstring, DEBUG_CLR_TRACE_FILE, "",                                    \
+        "Chrome trace file of the HIP calls and commands, %p is the pid")     \
 release(bool, ROC_SKIP_KERNEL_ARG_COPY, false,                                \
         "If true, then runtime can skip kernel arg copy")                     \
 release(bool, GPU_STREAMOPS_CP_WAIT, false,                                   \
         "Force the stream wait memory operation to wait on CP.")              \
 release(bool, HIP_USE_RUNTIME_UNBUNDLER, false,                               \
         "Force this to use Runtime code object unbundler.")                   \
+release(bool, HIP_LAZY_FATBIN_EXTRACTION, true,                               \
+        "Defer the extraction of static fat binaries until their first use")  \
 release(bool, HIPRTC_USE_RUNTIME_UNBUNDLER, false,                            \
         "Set this to true to force runtime unbundler in hiprtc.")             \
 release(size_t, HIP_INITIAL_DM_SIZE, 8 * Mi,                                  \
@@ -247,6 +278,10 @@ release(cstring, HIPRTC_COMPILE_OPTIONS_APPEND, "",                           \
         "Set compile options needed for hiprtc compilation")                  \
 release(cstring, HIPRTC_LINK_OPTIONS_APPEND, "",                              \
         "Set link options needed for hiprtc compilation")                     \
+release(cstring, HIPRTC_CACHE_DIR, "",                                        \
+        "Directory of the hiprtc compilation cache, empty disables the cache")\
+release(size_t, HIPRTC_CACHE_MAX_SIZE, 1024,                                  \
+        "The max size of the hiprtc compilation cache in MB")                 \
 release(bool, HIP_VMEM_MANAGE_SUPPORT, true,                                  \
         "Virtual Memory Management Support")                                  \
 release(bool, DEBUG_HIP_GRAPH_DOT_PRINT, false,                               \
@@ -255,23 +290,39 @@ release(bool, DEBUG_HIP_FORCE_ASYNC_QUEUE, false,                             \
         "Forces grpahs into async queue mode. DEBUG_HIP_FORCE_GRAPH_QUEUES must be 1") \
 release(uint, DEBUG_HIP_FORCE_GRAPH_QUEUES, 4,                                \
         "Forces the number of streams for the graph parallel execution")      \
+release(uint, DEBUG_HIP_GRAPH_SCHEDULER, 0,                                   \
+        "Graph scheduler for parallel streams at instantiation. "             \
+        "0 - depth-first, 1 - critical path")                                 \
+release(uint, DEBUG_HIP_GRAPH_OPTIMIZE, 0,                                    \
+        "Graph optimization passes at instantiation, a mask of "              \
+        "0x1 - transitive edges, 0x2 - empty nodes, "                         \
+        "0x4 - memset/memcpy coalescing, 0x8 - redundant event waits")        \
+release(size_t, DEBUG_HIP_GRAPH_INSTANTIATE_CACHE, 0,                         \
+        "Size in MB of the pool of destroyed executable graphs, reused to "   \
+        "instantiate equivalent graphs. 0 disables the pool")                 \
 release(bool, HIP_ALWAYS_USE_NEW_COMGR_UNBUNDLING_ACTION, false,              \
         "Force to always use new comgr unbundling action")                    \
 release(uint, DEBUG_HIP_BLOCK_SYNC, 50,                                       \
         "Blocks synchronization on CPU until the callback processing is done")\
 release(uint, DEBUG_CLR_MAX_BATCH_SIZE, 1000,                                 \
         "Forces the callback to clean-up CPU submission queue")               \
-release(bool, DEBUG_CLR_SYSMEM_POOL, false,                                   \
-        "Use sysmem pool implementation in runtime for amd commands")         \
+release(bool, DEBUG_CLR_SYSMEM_POOL, true,                                    \
+        "Use the slab allocator for the commands, HIP events and callbacks")  \
 release(bool, DEBUG_HIP_KERNARG_COPY_OPT, true,                               \
         "Enable/Disable multiple kern arg copies")                            \
 release(bool, DEBUG_CLR_USE_STDMUTEX_IN_AMD_MONITOR, false,                   \
         "Use std::mutex in amd::monitor")                                     \
+release(bool, DEBUG_CLR_USE_FUTEX_IN_AMD_MONITOR, false,                      \
+        "Use the futex lock with adaptive spinning in amd::Monitor")          \
+release(bool, DEBUG_CLR_MONITOR_PROFILE, false,                               \
+        "Profile amd::Monitor contention by call site, logged with LOG_LOCK") \
 release(bool, DEBUG_CLR_KERNARG_HDP_FLUSH_WA, false,                          \
         "Toggle kernel arg copy workaround")                                  \
 release(uint, DEBUG_HIP_7_PREVIEW, 0,                                         \
         "Enables specific backward incompatible changes support before 7.0,"  \
         "using the mask. By default the changes are disabled and is set to 0")\
+release(bool, DEBUG_CLR_MEMOBJ_RANGE_INDEX, true,                            \
+        "Use the lock-free range index for memory object pointer lookups")    \
 
 namespace amd {
 
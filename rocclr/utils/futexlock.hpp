@@ -0,0 +1,228 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#ifndef FUTEXLOCK_HPP_
+#define FUTEXLOCK_HPP_
+
+#include "top.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <thread>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(ATI_ARCH_X86)
+#include <immintrin.h>
+#endif
+
+//! \addtogroup Utils
+
+namespace amd { /*@{*/
+
+#if defined(__linux__)
+
+/*! \brief Compact futex lock with a condition, optionally recursive.
+ *
+ * The lock word is 0 when unlocked, 1 when locked and 2 when locked with possible
+ * sleepers, so an uncontended lock and unlock is a single atomic operation each and
+ * unlock() enters the kernel only if a thread may sleep. A contended lock() spins for a
+ * bounded number of iterations before it sleeps. The spin length adapts, it grows when
+ * the spin acquires the lock and shrinks when the thread has to sleep anyway.
+ *
+ * wait() sleeps on a separate sequence word, bumped by every notification. A waiter
+ * reads the sequence before it releases the lock, so a notification issued after the
+ * release is never lost. Wakeups may be spurious, as with a condition variable.
+ */
+class FutexLock {
+ public:
+  static constexpr uint32_t kMinSpins = 16;    //!< The min number of spin iterations
+  static constexpr uint32_t kMaxSpins = 1024;  //!< The max number of spin iterations
+
+  explicit FutexLock(bool recursive = false)
+      : state_(kUnlocked),
+        spins_(kMinSpins),
+        seq_(0),
+        waiters_(0),
+        owner_(nullptr),
+        count_(0),
+        recursive_(recursive) {}
+
+  //! Try to acquire the lock, return true if successful
+  bool tryLock() {
+    if (recursive_ && owner_.load(std::memory_order_relaxed) == self()) {
+      ++count_;
+      return true;
+    }
+    uint32_t state = kUnlocked;
+    if (!state_.compare_exchange_strong(state, kLocked, std::memory_order_acquire,
+                                        std::memory_order_relaxed)) {
+      return false;
+    }
+    setOwner();
+    return true;
+  }
+
+  //! Acquire the lock or suspend the calling thread
+  void lock() {
+    if (recursive_ && owner_.load(std::memory_order_relaxed) == self()) {
+      ++count_;
+      return;
+    }
+    uint32_t state = kUnlocked;
+    if (!state_.compare_exchange_strong(state, kLocked, std::memory_order_acquire,
+                                        std::memory_order_relaxed)) {
+      lockContended(state);
+    }
+    setOwner();
+  }
+
+  //! Release the lock and wake a single sleeping thread if any
+  void unlock() {
+    if (recursive_) {
+      assert(owner_.load(std::memory_order_relaxed) == self() && "invariant");
+      if (--count_ > 0) {
+        return;
+      }
+      owner_.store(nullptr, std::memory_order_relaxed);
+    }
+    if (state_.exchange(kUnlocked, std::memory_order_release) == kContended) {
+      futexWake(&state_, 1);
+    }
+  }
+
+  /*! \brief Give up the lock and go to sleep until notify()/notifyAll().
+   *
+   *  \note The lock must be owned before calling wait().
+   */
+  void wait() {
+    uint32_t seq = seq_.load();
+    waiters_.fetch_add(1);
+    uint32_t count = count_;
+    count_ = 1;
+    unlock();
+    futexWait(&seq_, seq);
+    waiters_.fetch_sub(1, std::memory_order_relaxed);
+    lock();
+    count_ = count;
+  }
+
+  //! Wake up a single thread waiting on this lock
+  void notify() {
+    seq_.fetch_add(1);
+    if (waiters_.load() != 0) {
+      futexWake(&seq_, 1);
+    }
+  }
+
+  //! Wake up all threads that are waiting on this lock
+  void notifyAll() {
+    seq_.fetch_add(1);
+    if (waiters_.load() != 0) {
+      futexWake(&seq_, INT32_MAX);
+    }
+  }
+
+  //! Returns true if the lock is owned, the caller is responsible for the memory ordering
+  bool isLocked() const { return state_.load(std::memory_order_relaxed) != kUnlocked; }
+
+ private:
+  static constexpr uint32_t kUnlocked = 0;   //!< Unlocked
+  static constexpr uint32_t kLocked = 1;     //!< Locked, no sleepers
+  static constexpr uint32_t kContended = 2;  //!< Locked, threads may sleep
+
+  //! The identity of the calling thread, the address of a thread local
+  static const void* self() {
+    static thread_local char tag;
+    return &tag;
+  }
+
+  void setOwner() {
+    if (recursive_) {
+      owner_.store(self(), std::memory_order_relaxed);
+    }
+    count_ = 1;
+  }
+
+  static void pause() {
+#if defined(ATI_ARCH_X86)
+    _mm_pause();
+#else
+    std::this_thread::yield();
+#endif
+  }
+
+  //! The slow path of lock(), \a state is the last observed lock word
+  void lockContended(uint32_t state) {
+    // Spin while the owner is likely to release the lock soon
+    const uint32_t spins = spins_.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < spins; ++i) {
+      pause();
+      state = state_.load(std::memory_order_relaxed);
+      if (state == kUnlocked &&
+          state_.compare_exchange_weak(state, kLocked, std::memory_order_acquire,
+                                       std::memory_order_relaxed)) {
+        spins_.store(std::min(spins * 2, kMaxSpins), std::memory_order_relaxed);
+        return;
+      }
+    }
+    spins_.store(std::max(spins / 2, kMinSpins), std::memory_order_relaxed);
+    // Mark the lock contended, the owner has to wake a sleeper on unlock()
+    if (state != kContended) {
+      state = state_.exchange(kContended, std::memory_order_acquire);
+    }
+    while (state != kUnlocked) {
+      futexWait(&state_, kContended);
+      state = state_.exchange(kContended, std::memory_order_acquire);
+    }
+  }
+
+  static void futexWait(std::atomic<uint32_t>* word, uint32_t value) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT_PRIVATE, value, nullptr,
+            nullptr, 0);
+  }
+
+  static void futexWake(std::atomic<uint32_t>* word, int count) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE_PRIVATE, count, nullptr,
+            nullptr, 0);
+  }
+
+  std::atomic<uint32_t> state_;     //!< The lock word
+  std::atomic<uint32_t> spins_;     //!< The current spin length of lock()
+  std::atomic<uint32_t> seq_;       //!< The condition word, bumped by every notification
+  std::atomic<uint32_t> waiters_;   //!< The number of threads in wait()
+  std::atomic<const void*> owner_;  //!< The owner thread of a recursive lock
+  uint32_t count_;                  //!< The number of times the owner acquired the lock
+  const bool recursive_;            //!< True if this is a recursive lock
+};
+
+#endif  // __linux__
+
+/*@}*/
+
+}  // namespace amd
+
+#endif /*FUTEXLOCK_HPP_*/
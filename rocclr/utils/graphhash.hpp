@@ -0,0 +1,171 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#ifndef GRAPHHASH_HPP_
+#define GRAPHHASH_HPP_
+
+#include "top.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+//! \addtogroup Utils
+
+namespace amd { /*@{*/
+
+/*! \brief Streaming 64-bit hash of graph node descriptions and parameters.
+ *
+ * Not a cryptographic hash, equal values mean equal inputs with a high probability.
+ * value() is never 0, so the callers can use 0 for an unknown hash.
+ */
+class GraphHash {
+ public:
+  GraphHash() : h_(kPrime2), size_(0) {}
+
+  void add(const void* data, size_t size) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+      uint64_t word;
+      memcpy(&word, bytes + i, sizeof(word));
+      addWord(word);
+    }
+    if (i < size) {
+      uint64_t word = 0;
+      memcpy(&word, bytes + i, size - i);
+      addWord(word);
+    }
+    size_ += size;
+  }
+
+  //! Adds a value of a trivially copyable type without padding
+  template <typename T> void add(const T& value) { add(&value, sizeof(T)); }
+
+  uint64_t value() const {
+    uint64_t h = mix(h_ ^ size_);
+    return (h == 0) ? 1 : h;
+  }
+
+  static uint64_t mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+  }
+
+ private:
+  static constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ull;
+  static constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+
+  void addWord(uint64_t word) {
+    h_ ^= word * kPrime1;
+    h_ = ((h_ << 31) | (h_ >> 33)) * kPrime2;
+  }
+
+  uint64_t h_;     //!< The hash state
+  uint64_t size_;  //!< The number of added bytes
+};
+
+/*! \brief Structural signature of a DAG of graph nodes in a topological order.
+ *
+ * Every node is described by a hash of its immutable properties (type, device and
+ * such) and by the topological positions of its dependencies. finalize() combines
+ * them into a structural hash per node, so two graphs have the same topology if the
+ * node hashes match at every position. The signature doesn't include the node
+ * parameters, the callers compare them separately to find the nodes to update.
+ */
+class GraphSignature {
+ public:
+  GraphSignature() : hash_(0) {}
+
+  //! Starts a new signature of \a size nodes
+  void reset(size_t size) {
+    nodes_.assign(size, Node());
+    hash_ = 0;
+  }
+
+  size_t size() const { return nodes_.size(); }
+
+  //! Sets the hash of the immutable description of the node
+  void setNode(size_t node, uint64_t description) { nodes_[node].description_ = description; }
+
+  //! Adds a dependency, \a dep is the topological position of the predecessor
+  void addDependency(size_t node, size_t dep) {
+    nodes_[node].deps_.push_back(static_cast<uint32_t>(dep));
+  }
+
+  //! Computes the structural hashes after all nodes and dependencies were added
+  void finalize() {
+    GraphHash graph;
+    graph.add(nodes_.size());
+    for (auto& node : nodes_) {
+      std::sort(node.deps_.begin(), node.deps_.end());
+      GraphHash hash;
+      hash.add(node.description_);
+      hash.add(node.deps_.size());
+      if (!node.deps_.empty()) {
+        hash.add(node.deps_.data(), node.deps_.size() * sizeof(node.deps_[0]));
+      }
+      node.structure_ = hash.value();
+      graph.add(node.structure_);
+    }
+    hash_ = graph.value();
+  }
+
+  //! The description hash of the node at the topological position
+  uint64_t description(size_t node) const { return nodes_[node].description_; }
+
+  //! The structural hash of the node at the topological position
+  uint64_t structure(size_t node) const { return nodes_[node].structure_; }
+
+  //! The structural hash of the whole graph
+  uint64_t hash() const { return hash_; }
+
+  //! Returns the first position with a different structure, size() if the graphs match
+  size_t mismatch(const GraphSignature& other) const {
+    const size_t count = std::min(size(), other.size());
+    for (size_t i = 0; i < count; ++i) {
+      if (nodes_[i].structure_ != other.nodes_[i].structure_) {
+        return i;
+      }
+    }
+    return (size() == other.size()) ? size() : count;
+  }
+
+ private:
+  struct Node {
+    uint64_t description_ = 0;   //!< Hash of the immutable node description
+    uint64_t structure_ = 0;     //!< Hash of the description and the dependencies
+    std::vector<uint32_t> deps_; //!< Topological positions of the dependencies
+  };
+
+  std::vector<Node> nodes_;  //!< Nodes in the topological order
+  uint64_t hash_;            //!< Structural hash of the graph
+};
+
+/*@}*/
+
+}  // namespace amd
+
+#endif /*GRAPHHASH_HPP_*/
@@ -0,0 +1,424 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#ifndef GRAPHOPTIMIZER_HPP_
+#define GRAPHOPTIMIZER_HPP_
+
+#include "top.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+//! \addtogroup Utils
+
+namespace amd { /*@{*/
+
+/*! \brief Optimization passes over a DAG of graph nodes before the scheduling.
+ *
+ * The caller describes every node and edge, runs the enabled passes and applies the
+ * result: the removed nodes, the new sizes of the coalesced nodes and the remaining
+ * edges. The passes are:
+ *  - EventNodes: removes an event wait node if every record node of the event in the
+ *    graph is its ancestor, the edges already order it. Record nodes are kept, the
+ *    event may be observed outside of the graph.
+ *  - EmptyNodes: removes an empty node if connecting its predecessors to its successors
+ *    doesn't add edges.
+ *  - TransitiveReduction: removes the edges implied by other paths.
+ *  - Coalescing: merges memset and 1D memcpy nodes on contiguous ranges of the same
+ *    allocation, if they are siblings with the same dependencies or form a chain.
+ * A node is never removed or changed unless the pass proves the result is equivalent.
+ */
+class GraphOptimizer {
+ public:
+  enum Pass : uint32_t {
+    TransitiveReduction = 0x1,
+    EmptyNodes = 0x2,
+    Coalescing = 0x4,
+    EventNodes = 0x8,
+    AllPasses = 0xF
+  };
+
+  enum class Kind : uint32_t { Other, Empty, Memset, Memcpy, EventRecord, EventWait };
+
+  //! The description of a node, the optimizer changes the size of the coalesced nodes
+  struct Node {
+    Kind kind_ = Kind::Other;
+    uintptr_t dst_ = 0;                //!< Memset and memcpy destination
+    uintptr_t src_ = 0;                //!< Memcpy source
+    size_t size_ = 0;                  //!< Memset and memcpy size in bytes
+    uint64_t value_ = 0;               //!< Memset value
+    uint32_t elementSize_ = 0;         //!< Memset element size
+    uint32_t mode_ = 0;                //!< Memcpy direction, equal for coalesced copies
+    const void* dstRegion_ = nullptr;  //!< The allocation of the destination
+    const void* srcRegion_ = nullptr;  //!< The allocation of the source
+    const void* event_ = nullptr;      //!< The event of a record or wait node
+  };
+
+  struct Stats {
+    size_t nodes_ = 0;              //!< The number of nodes before the optimization
+    size_t edges_ = 0;              //!< The number of edges before the optimization
+    size_t edgesRemoved_ = 0;       //!< Transitive edges removed
+    size_t emptyNodesRemoved_ = 0;  //!< Empty nodes removed
+    size_t eventNodesRemoved_ = 0;  //!< Event wait nodes removed
+    size_t memsetsCoalesced_ = 0;   //!< Memset nodes merged into another one
+    size_t memcpysCoalesced_ = 0;   //!< Memcpy nodes merged into another one
+
+    //! Returns true if the graph was changed
+    bool changed() const {
+      return (edgesRemoved_ + emptyNodesRemoved_ + eventNodesRemoved_ + memsetsCoalesced_ +
+              memcpysCoalesced_) != 0;
+    }
+  };
+
+  static constexpr size_t kNone = SIZE_MAX;
+  //! The max number of nodes for the transitive reduction, it keeps a bitset per node
+  static constexpr size_t kMaxReductionNodes = 8 * 1024;
+
+  explicit GraphOptimizer(size_t numNodes)
+      : nodes_(numNodes), succ_(numNodes), pred_(numNodes), removed_(numNodes, false),
+        mergedInto_(numNodes, kNone) {}
+
+  size_t size() const { return nodes_.size(); }
+
+  Node& node(size_t i) { return nodes_[i]; }
+  const Node& node(size_t i) const { return nodes_[i]; }
+
+  //! Adds a dependency, node "to" can't start until node "from" is done
+  void addEdge(size_t from, size_t to) { connect(from, to); }
+
+  //! Runs the enabled passes. Returns false and doesn't change the graph if it has a cycle
+  bool optimize(uint32_t passes, Stats* stats) {
+    *stats = Stats();
+    stats->nodes_ = size();
+    for (const auto& succ : succ_) {
+      stats->edges_ += succ.size();
+    }
+    std::vector<size_t> order;
+    if (!topologicalOrder(&order)) {
+      return false;
+    }
+    if (passes & EventNodes) {
+      removeEventWaits(stats);
+    }
+    if (passes & EmptyNodes) {
+      removeEmptyNodes(stats);
+    }
+    if (passes & TransitiveReduction) {
+      reduceEdges(stats);
+    }
+    if (passes & Coalescing) {
+      coalesce(stats);
+    }
+    return true;
+  }
+
+  //! Returns true if the node was removed or merged into another node
+  bool removed(size_t i) const { return removed_[i]; }
+
+  //! Returns the node that absorbed a coalesced node, kNone if the node wasn't coalesced
+  size_t mergedInto(size_t i) const {
+    size_t target = mergedInto_[i];
+    while ((target != kNone) && (mergedInto_[target] != kNone)) {
+      target = mergedInto_[target];
+    }
+    return target;
+  }
+
+  //! Returns the successors of a remaining node
+  const std::vector<size_t>& successors(size_t i) const { return succ_[i]; }
+
+  //! Returns the predecessors of a remaining node
+  const std::vector<size_t>& predecessors(size_t i) const { return pred_[i]; }
+
+ private:
+  bool connect(size_t from, size_t to) {
+    if (std::find(succ_[from].begin(), succ_[from].end(), to) != succ_[from].end()) {
+      return false;
+    }
+    succ_[from].push_back(to);
+    pred_[to].push_back(from);
+    return true;
+  }
+
+  void disconnect(size_t from, size_t to) {
+    succ_[from].erase(std::find(succ_[from].begin(), succ_[from].end(), to));
+    pred_[to].erase(std::find(pred_[to].begin(), pred_[to].end(), from));
+  }
+
+  //! Removes a node and connects its predecessors to its successors
+  void bypass(size_t i) {
+    std::vector<size_t> preds = pred_[i];
+    std::vector<size_t> succs = succ_[i];
+    for (auto p : preds) {
+      disconnect(p, i);
+    }
+    for (auto s : succs) {
+      disconnect(i, s);
+    }
+    for (auto p : preds) {
+      for (auto s : succs) {
+        connect(p, s);
+      }
+    }
+    removed_[i] = true;
+  }
+
+  //! Kahn's algorithm over the remaining nodes, returns false on a cycle
+  bool topologicalOrder(std::vector<size_t>* order) const {
+    std::vector<size_t> inDegree(size(), 0);
+    size_t live = 0;
+    for (size_t i = 0; i < size(); ++i) {
+      if (!removed_[i]) {
+        inDegree[i] = pred_[i].size();
+        ++live;
+        if (inDegree[i] == 0) {
+          order->push_back(i);
+        }
+      }
+    }
+    for (size_t head = 0; head < order->size(); ++head) {
+      for (auto s : succ_[(*order)[head]]) {
+        if (--inDegree[s] == 0) {
+          order->push_back(s);
+        }
+      }
+    }
+    return order->size() == live;
+  }
+
+  //! Returns true if there is a path from "from" to "to"
+  bool reachable(size_t from, size_t to, std::vector<uint32_t>* visited, uint32_t mark) const {
+    std::vector<size_t> stack(1, from);
+    (*visited)[from] = mark;
+    while (!stack.empty()) {
+      size_t i = stack.back();
+      stack.pop_back();
+      if (i == to) {
+        return true;
+      }
+      for (auto s : succ_[i]) {
+        if ((*visited)[s] != mark) {
+          (*visited)[s] = mark;
+          stack.push_back(s);
+        }
+      }
+    }
+    return false;
+  }
+
+  void removeEventWaits(Stats* stats) {
+    std::map<const void*, std::vector<size_t>> records;
+    for (size_t i = 0; i < size(); ++i) {
+      if (nodes_[i].kind_ == Kind::EventRecord) {
+        records[nodes_[i].event_].push_back(i);
+      }
+    }
+    std::vector<uint32_t> visited(size(), 0);
+    uint32_t mark = 0;
+    for (size_t i = 0; i < size(); ++i) {
+      if (nodes_[i].kind_ != Kind::EventWait) {
+        continue;
+      }
+      // Without a record in the graph the node waits for a record outside of the graph
+      auto it = records.find(nodes_[i].event_);
+      if (it == records.end()) {
+        continue;
+      }
+      bool ordered = true;
+      for (auto record : it->second) {
+        ordered = ordered && reachable(record, i, &visited, ++mark);
+      }
+      if (ordered) {
+        bypass(i);
+        ++stats->eventNodesRemoved_;
+      }
+    }
+  }
+
+  void removeEmptyNodes(Stats* stats) {
+    for (size_t i = 0; i < size(); ++i) {
+      if (removed_[i] || (nodes_[i].kind_ != Kind::Empty)) {
+        continue;
+      }
+      // A join of many predecessors and successors is cheaper than the product of edges
+      const size_t preds = pred_[i].size();
+      const size_t succs = succ_[i].size();
+      if (preds * succs <= preds + succs) {
+        bypass(i);
+        ++stats->emptyNodesRemoved_;
+      }
+    }
+  }
+
+  void reduceEdges(Stats* stats) {
+    std::vector<size_t> order;
+    topologicalOrder(&order);
+    if (order.size() > kMaxReductionNodes) {
+      return;
+    }
+    std::vector<size_t> rank(size(), 0);
+    for (size_t i = 0; i < order.size(); ++i) {
+      rank[order[i]] = i;
+    }
+    // reach[i] is the set of the descendants of node i, by the topological rank
+    const size_t words = (order.size() + 63) / 64;
+    std::vector<uint64_t> reach(order.size() * words, 0);
+    auto bit = [&](size_t r) { return uint64_t(1) << (r % 64); };
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+      const size_t i = *it;
+      uint64_t* acc = &reach[rank[i] * words];
+      std::vector<size_t> succs = succ_[i];
+      // A successor can be reached only from the successors before it in the order
+      std::sort(succs.begin(), succs.end(),
+                [&](size_t a, size_t b) { return rank[a] < rank[b]; });
+      for (auto s : succs) {
+        const size_t r = rank[s];
+        if (acc[r / 64] & bit(r)) {
+          disconnect(i, s);
+          ++stats->edgesRemoved_;
+          continue;
+        }
+        const uint64_t* sub = &reach[r * words];
+        for (size_t w = 0; w < words; ++w) {
+          acc[w] |= sub[w];
+        }
+        acc[r / 64] |= bit(r);
+      }
+    }
+  }
+
+  //! Returns the node covering the contiguous ranges of a and b, false if they can't merge
+  static bool mergeable(const Node& a, const Node& b, Node* merged) {
+    if ((a.kind_ != b.kind_) || (a.dstRegion_ != b.dstRegion_) || (a.size_ == 0) ||
+        (b.size_ == 0)) {
+      return false;
+    }
+    const Node& lo = (a.dst_ < b.dst_) ? a : b;
+    const Node& hi = (a.dst_ < b.dst_) ? b : a;
+    if (lo.dst_ + lo.size_ != hi.dst_) {
+      return false;
+    }
+    *merged = lo;
+    merged->size_ = lo.size_ + hi.size_;
+    switch (a.kind_) {
+      case Kind::Memset:
+        return (a.value_ == b.value_) && (a.elementSize_ == b.elementSize_);
+      case Kind::Memcpy:
+        // The copies run in any order, so the merged source can't overlap the destination
+        return (a.mode_ == b.mode_) && (a.srcRegion_ == b.srcRegion_) &&
+               (lo.src_ + lo.size_ == hi.src_) &&
+               ((merged->src_ + merged->size_ <= merged->dst_) ||
+                (merged->dst_ + merged->size_ <= merged->src_));
+      default:
+        return false;
+    }
+  }
+
+  //! Merges node b into node a, the edges of b move to a
+  void merge(size_t a, size_t b, const Node& merged, Stats* stats) {
+    std::vector<size_t> preds = pred_[b];
+    std::vector<size_t> succs = succ_[b];
+    for (auto p : preds) {
+      disconnect(p, b);
+    }
+    for (auto s : succs) {
+      disconnect(b, s);
+    }
+    for (auto p : preds) {
+      if (p != a) {
+        connect(p, a);
+      }
+    }
+    for (auto s : succs) {
+      connect(a, s);
+    }
+    nodes_[a] = merged;
+    removed_[b] = true;
+    mergedInto_[b] = a;
+    if (merged.kind_ == Kind::Memset) {
+      ++stats->memsetsCoalesced_;
+    } else {
+      ++stats->memcpysCoalesced_;
+    }
+  }
+
+  static bool coalescable(const Node& node) {
+    return (node.kind_ == Kind::Memset) || (node.kind_ == Kind::Memcpy);
+  }
+
+  void coalesce(Stats* stats) {
+    Node merged;
+    bool changed = true;
+    while (changed) {
+      changed = false;
+      // A chain a -> b, where b is the only successor of a and a the only predecessor of b
+      for (size_t a = 0; a < size(); ++a) {
+        while (!removed_[a] && coalescable(nodes_[a]) && (succ_[a].size() == 1)) {
+          const size_t b = succ_[a][0];
+          if ((pred_[b].size() != 1) || !mergeable(nodes_[a], nodes_[b], &merged)) {
+            break;
+          }
+          disconnect(a, b);
+          merge(a, b, merged, stats);
+          changed = true;
+        }
+      }
+      // Siblings with the same predecessors and successors
+      std::map<std::pair<std::vector<size_t>, std::vector<size_t>>, std::vector<size_t>> groups;
+      for (size_t i = 0; i < size(); ++i) {
+        if (!removed_[i] && coalescable(nodes_[i])) {
+          std::vector<size_t> preds = pred_[i];
+          std::vector<size_t> succs = succ_[i];
+          std::sort(preds.begin(), preds.end());
+          std::sort(succs.begin(), succs.end());
+          groups[std::make_pair(std::move(preds), std::move(succs))].push_back(i);
+        }
+      }
+      for (auto& group : groups) {
+        std::vector<size_t>& members = group.second;
+        std::sort(members.begin(), members.end(),
+                  [&](size_t a, size_t b) { return nodes_[a].dst_ < nodes_[b].dst_; });
+        for (size_t k = 1, a = members[0]; k < members.size(); ++k) {
+          const size_t b = members[k];
+          if (mergeable(nodes_[a], nodes_[b], &merged)) {
+            merge(a, b, merged, stats);
+            changed = true;
+          } else {
+            a = b;
+          }
+        }
+      }
+    }
+  }
+
+  std::vector<Node> nodes_;                 //!< The node descriptions
+  std::vector<std::vector<size_t>> succ_;   //!< The successors of every node
+  std::vector<std::vector<size_t>> pred_;   //!< The predecessors of every node
+  std::vector<bool> removed_;               //!< True for the removed and merged nodes
+  std::vector<size_t> mergedInto_;          //!< The node that absorbed a merged node
+};
+
+/*@}*/
+
+}  // namespace amd
+
+#endif /*GRAPHOPTIMIZER_HPP_*/
@@ -0,0 +1,207 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#ifndef HANDLETABLE_HPP_
+#define HANDLETABLE_HPP_
+
+#include "top.hpp"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+//! \addtogroup Utils
+
+namespace amd { /*@{*/
+
+/*! \brief A concurrent set of object handles.
+ *
+ * Validates the handles an application passes to the runtime. The handles are the
+ * object addresses, so the table never dereferences a key and a destroyed or foreign
+ * handle is simply not found.
+ *
+ * The table is open addressed with linear probing and is kept at most half full, so a
+ * lookup is a few atomic loads and compares without a lock. An erased slot becomes a
+ * tombstone until the table is rebuilt. Tables are type-stable: a replaced table is
+ * recycled by a later rebuild of the same capacity, but never freed until the handle
+ * table is destroyed. A sequence counter tells a reader which raced with the recycling
+ * to retry.
+ *
+ * Updates (insert/erase) must be serialized by the caller.
+ */
+template <typename T> class ConcurrentHandleTable {
+ public:
+  ConcurrentHandleTable() : live_(0), used_(0) {
+    tables_.emplace_back(new Table(kMinCapacity));
+    current_.store(tables_.back().get(), std::memory_order_release);
+  }
+
+  ConcurrentHandleTable(const ConcurrentHandleTable&) = delete;
+  ConcurrentHandleTable& operator=(const ConcurrentHandleTable&) = delete;
+
+  //! Adds a handle. Must be serialized with other updates.
+  void insert(const T* handle) {
+    const uintptr_t key = reinterpret_cast<uintptr_t>(handle);
+    if (key <= kTombstone || contains(handle)) {
+      return;
+    }
+    Table* table = current_.load(std::memory_order_relaxed);
+    if (2 * (used_ + 1) > table->capacity_) {
+      table = rebuild();
+    }
+    if (place(table, key)) {
+      ++used_;
+    }
+    ++live_;
+  }
+
+  //! Removes a handle. Must be serialized with other updates.
+  void erase(const T* handle) {
+    const uintptr_t key = reinterpret_cast<uintptr_t>(handle);
+    Table* table = current_.load(std::memory_order_relaxed);
+    for (size_t i = hash(key) & table->mask_;; i = (i + 1) & table->mask_) {
+      const uintptr_t value = table->slots_[i].load(std::memory_order_relaxed);
+      if (value == key) {
+        table->slots_[i].store(kTombstone, std::memory_order_release);
+        --live_;
+        return;
+      }
+      if (value == kEmpty) {
+        return;
+      }
+    }
+  }
+
+  //! Lock-free check if the handle is in the table
+  bool contains(const void* handle) const {
+    const uintptr_t key = reinterpret_cast<uintptr_t>(handle);
+    if (key <= kTombstone) {
+      return false;
+    }
+    while (true) {
+      const Table* table = current_.load(std::memory_order_acquire);
+      const uint64_t seq = table->seq_.load(std::memory_order_acquire);
+      if (seq & 1) {
+        continue;
+      }
+      bool found = false;
+      for (size_t i = hash(key) & table->mask_;; i = (i + 1) & table->mask_) {
+        const uintptr_t value = table->slots_[i].load(std::memory_order_acquire);
+        if (value == key || value == kEmpty) {
+          found = (value == key);
+          break;
+        }
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (seq == table->seq_.load(std::memory_order_relaxed)) {
+        return found;
+      }
+    }
+  }
+
+  //! The number of handles in the table
+  size_t size() const { return live_; }
+
+ private:
+  static constexpr uintptr_t kEmpty = 0;
+  static constexpr uintptr_t kTombstone = 1;
+  static constexpr size_t kMinCapacity = 64;
+
+  struct Table {
+    explicit Table(size_t capacity)
+        : capacity_(capacity), mask_(capacity - 1), slots_(new std::atomic<uintptr_t>[capacity]) {
+      for (size_t i = 0; i < capacity_; ++i) {
+        slots_[i].store(kEmpty, std::memory_order_relaxed);
+      }
+    }
+    const size_t capacity_;         //!< The number of slots, a power of 2
+    const size_t mask_;
+    std::atomic<uint64_t> seq_{0};  //!< Odd while the table is recycled
+    std::unique_ptr<std::atomic<uintptr_t>[]> slots_;
+  };
+
+  static size_t hash(uintptr_t key) {
+    // Objects are at least 8 bytes apart, Fibonacci hashing spreads the remaining bits
+    return static_cast<size_t>(((key >> 3) * 0x9E3779B97F4A7C15ull) >> 16);
+  }
+
+  //! Stores the key in the first free slot, returns true if the slot was never used
+  static bool place(Table* table, uintptr_t key) {
+    for (size_t i = hash(key) & table->mask_;; i = (i + 1) & table->mask_) {
+      const uintptr_t value = table->slots_[i].load(std::memory_order_relaxed);
+      if (value == kEmpty || value == kTombstone) {
+        table->slots_[i].store(key, std::memory_order_release);
+        return value == kEmpty;
+      }
+    }
+  }
+
+  //! Moves the live handles into a new table, sized for the growth and without tombstones
+  Table* rebuild() {
+    const Table* old = current_.load(std::memory_order_relaxed);
+    size_t capacity = kMinCapacity;
+    while (capacity < 4 * (live_ + 1)) {
+      capacity *= 2;
+    }
+    Table* table = nullptr;
+    for (auto& it : tables_) {
+      if (it.get() != old && it->capacity_ == capacity) {
+        table = it.get();
+        break;
+      }
+    }
+    if (table == nullptr) {
+      tables_.emplace_back(new Table(capacity));
+      table = tables_.back().get();
+    } else {
+      // Recycle a replaced table, readers which still use it will retry
+      const uint64_t seq = table->seq_.load(std::memory_order_relaxed);
+      table->seq_.store(seq + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      for (size_t i = 0; i < capacity; ++i) {
+        table->slots_[i].store(kEmpty, std::memory_order_relaxed);
+      }
+    }
+    used_ = 0;
+    for (size_t i = 0; i < old->capacity_; ++i) {
+      const uintptr_t value = old->slots_[i].load(std::memory_order_relaxed);
+      if (value > kTombstone) {
+        place(table, value);
+        ++used_;
+      }
+    }
+    if (table->seq_.load(std::memory_order_relaxed) & 1) {
+      table->seq_.fetch_add(1, std::memory_order_release);
+    }
+    current_.store(table, std::memory_order_release);
+    return table;
+  }
+
+  std::atomic<Table*> current_;                 //!< The table of the lookups
+  std::vector<std::unique_ptr<Table>> tables_;  //!< The current and the replaced tables
+  size_t live_;                                 //!< The number of handles
+  size_t used_;                                 //!< The number of handles and tombstones
+};
+
+/*@}*/
+
+}  // namespace amd
+
+#endif /*HANDLETABLE_HPP_*/
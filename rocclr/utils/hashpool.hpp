@@ -0,0 +1,157 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#ifndef HASHPOOL_HPP_
+#define HASHPOOL_HPP_
+
+#include "top.hpp"
+
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+//! \addtogroup Utils
+
+namespace amd { /*@{*/
+
+/*! \brief An LRU pool of reusable values keyed by 64-bit hashes.
+ *
+ * A key may have several values and take() moves one of them out of the pool. Every value
+ * has a tag, take() prefers a value with the requested tag and otherwise returns the most
+ * recently inserted value of the key. The total size of the values is bounded by a byte
+ * budget, the least recently inserted values are evicted first. The pool doesn't own the
+ * values, the removed values are returned to the caller, which releases them outside of
+ * its lock. The caller must serialize all calls.
+ */
+template <typename T> class HashPool {
+ public:
+  struct Stats {
+    uint64_t hits_ = 0;        //!< Lookups which found a value of the key
+    uint64_t exactHits_ = 0;   //!< Hits with the requested tag
+    uint64_t misses_ = 0;      //!< Lookups which didn't find a value
+    uint64_t evictions_ = 0;   //!< Values removed for the budget
+  };
+
+  explicit HashPool(size_t budget) : budget_(budget), size_(0) {}
+
+  //! Moves a value of the key out of the pool, preferably one with the tag
+  bool take(uint64_t key, uint64_t tag, T* value) {
+    auto it = keys_.find(key);
+    if (it == keys_.end()) {
+      ++stats_.misses_;
+      return false;
+    }
+    std::vector<Iterator>& entries = it->second;
+    size_t pick = entries.size() - 1;
+    for (size_t i = entries.size(); i-- > 0;) {
+      if (entries[i]->tag_ == tag) {
+        pick = i;
+        ++stats_.exactHits_;
+        break;
+      }
+    }
+    ++stats_.hits_;
+    Iterator entry = entries[pick];
+    *value = entry->value_;
+    size_ -= entry->size_;
+    entries.erase(entries.begin() + pick);
+    if (entries.empty()) {
+      keys_.erase(it);
+    }
+    lru_.erase(entry);
+    return true;
+  }
+
+  /*! \brief Inserts a value of \a size bytes.
+   *
+   * Returns false if the value exceeds the budget, then the caller keeps the value.
+   * Otherwise the least recently inserted values are removed for the budget and appended
+   * to \a removed.
+   */
+  bool insert(uint64_t key, uint64_t tag, size_t size, T value, std::vector<T>* removed) {
+    if (size > budget_) {
+      return false;
+    }
+    lru_.push_front(Entry{key, tag, size, value});
+    keys_[key].push_back(lru_.begin());
+    size_ += size;
+    while (size_ > budget_) {
+      ++stats_.evictions_;
+      evict(removed);
+    }
+    return true;
+  }
+
+  //! Removes all values and appends them to \a removed
+  void clear(std::vector<T>* removed) {
+    for (auto& entry : lru_) {
+      removed->push_back(entry.value_);
+    }
+    lru_.clear();
+    keys_.clear();
+    size_ = 0;
+  }
+
+  size_t size() const { return size_; }
+  size_t count() const { return lru_.size(); }
+  const Stats& stats() const { return stats_; }
+
+ private:
+  struct Entry {
+    uint64_t key_;  //!< Hash of the value
+    uint64_t tag_;  //!< Preferred match within the key
+    size_t size_;   //!< The size of the value in bytes
+    T value_;
+  };
+  typedef typename std::list<Entry>::iterator Iterator;
+
+  //! Removes the least recently inserted value
+  void evict(std::vector<T>* removed) {
+    Iterator entry = std::prev(lru_.end());
+    auto it = keys_.find(entry->key_);
+    std::vector<Iterator>& entries = it->second;
+    for (size_t i = 0; i < entries.size(); ++i) {
+      if (entries[i] == entry) {
+        entries.erase(entries.begin() + i);
+        break;
+      }
+    }
+    if (entries.empty()) {
+      keys_.erase(it);
+    }
+    size_ -= entry->size_;
+    removed->push_back(entry->value_);
+    lru_.erase(entry);
+  }
+
+  size_t budget_;  //!< The max total size of the values
+  size_t size_;    //!< The total size of the values
+  std::list<Entry> lru_;  //!< Values, the most recently inserted first
+  std::unordered_map<uint64_t, std::vector<Iterator>> keys_;  //!< Values of every key, oldest first
+  Stats stats_;
+};
+
+/*@}*/
+
+}  // namespace amd
+
+#endif /*HASHPOOL_HPP_*/
@@ -0,0 +1,151 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#ifndef INTERVALSET_HPP_
+#define INTERVALSET_HPP_
+
+#include "top.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+//! \addtogroup Utils
+
+namespace amd { /*@{*/
+
+/*! \brief A set of half-open [start, end) intervals.
+ *
+ * Intervals are kept sorted, disjoint and coalesced, so an overlap query is a
+ * binary search. Insertions are buffered and merged in one pass before the next
+ * query, which makes bulk updates O(n + k log k) and keeps the storage in two
+ * flat vectors that are reused across clear() calls.
+ */
+class IntervalSet {
+ public:
+  //! Adds [start, end) to the set
+  void insert(uint64_t start, uint64_t end) {
+    if (end > start) {
+      pending_.push_back({start, end});
+    }
+  }
+
+  //! Returns true if [start, end) overlaps any interval in the set
+  bool overlaps(uint64_t start, uint64_t end) const {
+    if (end <= start) {
+      return false;
+    }
+    normalize();
+    // Intervals are disjoint, so only the last one starting before end can overlap
+    auto it = std::lower_bound(intervals_.begin(), intervals_.end(), end,
+                               [](const Interval& i, uint64_t value) { return i.start_ < value; });
+    if (it == intervals_.begin()) {
+      return false;
+    }
+    return std::prev(it)->end_ > start;
+  }
+
+  void clear() {
+    intervals_.clear();
+    pending_.clear();
+  }
+
+  bool empty() const { return intervals_.empty() && pending_.empty(); }
+
+  //! Number of disjoint intervals
+  size_t size() const {
+    normalize();
+    return intervals_.size();
+  }
+
+ private:
+  struct Interval {
+    uint64_t start_;
+    uint64_t end_;
+  };
+
+  //! Merges the pending insertions into the sorted intervals
+  void normalize() const {
+    if (pending_.empty()) {
+      return;
+    }
+    std::sort(pending_.begin(), pending_.end(),
+              [](const Interval& a, const Interval& b) { return a.start_ < b.start_; });
+    merged_.clear();
+    merged_.reserve(intervals_.size() + pending_.size());
+    auto a = intervals_.begin();
+    auto b = pending_.begin();
+    while (a != intervals_.end() || b != pending_.end()) {
+      const Interval& next =
+          (b == pending_.end() || (a != intervals_.end() && a->start_ <= b->start_)) ? *a++
+                                                                                      : *b++;
+      // Coalesce overlapping and touching intervals
+      if (!merged_.empty() && next.start_ <= merged_.back().end_) {
+        merged_.back().end_ = std::max(merged_.back().end_, next.end_);
+      } else {
+        merged_.push_back(next);
+      }
+    }
+    intervals_.swap(merged_);
+    pending_.clear();
+  }
+
+  mutable std::vector<Interval> intervals_;  //!< Sorted, disjoint intervals
+  mutable std::vector<Interval> pending_;    //!< Insertions not merged yet
+  mutable std::vector<Interval> merged_;     //!< Scratch storage for the merge
+};
+
+/*! \brief Tracks read and written address ranges.
+ *
+ * An access conflicts with the tracked ranges if it writes memory which was
+ * accessed, or reads memory which was written.
+ */
+class AccessIntervalSet {
+ public:
+  //! Records an access to [start, end)
+  void insert(uint64_t start, uint64_t end, bool readOnly) {
+    accessed_.insert(start, end);
+    if (!readOnly) {
+      written_.insert(start, end);
+    }
+  }
+
+  //! Returns true if an access to [start, end) depends on the tracked accesses
+  bool conflicts(uint64_t start, uint64_t end, bool readOnly) const {
+    return readOnly ? written_.overlaps(start, end) : accessed_.overlaps(start, end);
+  }
+
+  void clear() {
+    accessed_.clear();
+    written_.clear();
+  }
+
+  bool empty() const { return accessed_.empty(); }
+
+ private:
+  IntervalSet accessed_;  //!< All the accessed ranges
+  IntervalSet written_;   //!< The ranges which were written
+};
+
+/*@}*/
+
+}  // namespace amd
+
+#endif /*INTERVALSET_HPP_*/
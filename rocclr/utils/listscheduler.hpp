@@ -0,0 +1,232 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#ifndef LISTSCHEDULER_HPP_
+#define LISTSCHEDULER_HPP_
+
+#include "top.hpp"
+
+#include <algorithm>
+#include <vector>
+
+//! \addtogroup Utils
+
+namespace amd { /*@{*/
+
+/*! \brief HEFT style list scheduler of a DAG on identical in-order queues.
+ *
+ * Nodes are prioritized by the upward rank, which is the longest path from the node
+ * to an exit, including a signal on every edge. In the priority order each node goes
+ * to the queue with the earliest finish time. A dependency on another queue costs a
+ * signal, so the scheduler keeps chains on one queue unless a split shortens the
+ * critical path. Queue 0 is the launch queue; the first node on any other queue waits
+ * for it with a signal.
+ */
+class ListScheduler {
+ public:
+  struct Result {
+    std::vector<uint32_t> queue_;  //!< Queue of every node
+    std::vector<size_t> order_;    //!< Submission order, a topological order of the nodes
+    double makespan_ = 0;          //!< Estimated finish time of the last node
+    uint32_t numQueues_ = 0;       //!< The number of used queues
+    size_t crossEdges_ = 0;        //!< The number of edges between different queues
+  };
+
+  explicit ListScheduler(size_t numNodes)
+      : cost_(numNodes, kMinCost), successors_(numNodes), predecessors_(numNodes) {}
+
+  //! Sets the estimated execution time of a node
+  void setCost(size_t node, double cost) { cost_[node] = std::max(cost, kMinCost); }
+
+  //! Adds a dependency, node "to" can't start until node "from" is done
+  void addEdge(size_t from, size_t to) {
+    successors_[from].push_back(to);
+    predecessors_[to].push_back(from);
+  }
+
+  size_t size() const { return cost_.size(); }
+
+  //! Schedules the graph on up to maxQueues queues. Returns false if the graph has a cycle
+  bool schedule(uint32_t maxQueues, double signalCost, Result* result) const {
+    std::vector<size_t> order;
+    if (!topologicalOrder(&order)) {
+      return false;
+    }
+    maxQueues = std::max(maxQueues, 1u);
+
+    // Upward ranks in the reverse topological order
+    std::vector<double> rank(size(), 0);
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+      double tail = 0;
+      for (auto succ : successors_[*it]) {
+        tail = std::max(tail, signalCost + rank[succ]);
+      }
+      rank[*it] = cost_[*it] + tail;
+    }
+    // A node always ranks above its successors, since the cost is positive. The topological
+    // position breaks ties between independent nodes deterministically
+    std::vector<size_t> position(size());
+    for (size_t i = 0; i < order.size(); ++i) {
+      position[order[i]] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+      return (rank[a] != rank[b]) ? (rank[a] > rank[b]) : (position[a] < position[b]);
+    });
+
+    result->queue_.assign(size(), 0);
+    result->numQueues_ = (size() > 0) ? 1 : 0;
+    result->makespan_ = 0;
+    std::vector<double> finish(size(), 0);
+    std::vector<double> available(maxQueues, 0);
+    for (auto node : order) {
+      uint32_t bestQueue = 0;
+      double bestFinish = 0;
+      size_t bestSignals = 0;
+      // All unused queues are identical, so only the first one is a candidate
+      uint32_t candidates = std::min(result->numQueues_ + 1, maxQueues);
+      for (uint32_t q = 0; q < candidates; ++q) {
+        size_t signals = 0;
+        double start = startTime(node, q, signalCost, result->queue_, finish, &signals);
+        double end = std::max(start, available[q]) + cost_[node];
+        if ((q == 0) || (end < bestFinish) || ((end == bestFinish) && (signals < bestSignals))) {
+          bestQueue = q;
+          bestFinish = end;
+          bestSignals = signals;
+        }
+      }
+      result->queue_[node] = bestQueue;
+      finish[node] = bestFinish;
+      available[bestQueue] = bestFinish;
+      result->numQueues_ = std::max(result->numQueues_, bestQueue + 1);
+      result->makespan_ = std::max(result->makespan_, bestFinish);
+    }
+    result->crossEdges_ = 0;
+    for (size_t i = 0; i < size(); ++i) {
+      for (auto succ : successors_[i]) {
+        result->crossEdges_ += (result->queue_[i] != result->queue_[succ]) ? 1 : 0;
+      }
+    }
+    result->order_.swap(order);
+    return true;
+  }
+
+  /*! \brief Estimates the makespan of a queue assignment.
+   *
+   * The nodes of every queue run in the provided submission order. By default it's
+   * the topological order of the node indices.
+   */
+  double evaluate(const std::vector<uint32_t>& queue, double signalCost,
+                  size_t* crossEdges = nullptr, const std::vector<size_t>* order = nullptr) const {
+    std::vector<size_t> topoOrder;
+    if (order == nullptr) {
+      if (!topologicalOrder(&topoOrder)) {
+        return 0;
+      }
+      order = &topoOrder;
+    }
+    uint32_t numQueues = 0;
+    for (auto q : queue) {
+      numQueues = std::max(numQueues, q + 1);
+    }
+    std::vector<double> finish(size(), 0);
+    std::vector<double> available(numQueues, 0);
+    double makespan = 0;
+    size_t signals = 0;
+    for (auto node : *order) {
+      uint32_t q = queue[node];
+      double start = std::max(startTime(node, q, signalCost, queue, finish, &signals),
+                              available[q]);
+      finish[node] = start + cost_[node];
+      available[q] = finish[node];
+      makespan = std::max(makespan, finish[node]);
+    }
+    if (crossEdges != nullptr) {
+      *crossEdges = signals;
+    }
+    return makespan;
+  }
+
+  //! Returns the length of the longest path, the lower bound of any schedule
+  double criticalPath() const {
+    std::vector<size_t> order;
+    if (!topologicalOrder(&order)) {
+      return 0;
+    }
+    std::vector<double> finish(size(), 0);
+    double length = 0;
+    for (auto node : order) {
+      double start = 0;
+      for (auto pred : predecessors_[node]) {
+        start = std::max(start, finish[pred]);
+      }
+      finish[node] = start + cost_[node];
+      length = std::max(length, finish[node]);
+    }
+    return length;
+  }
+
+ private:
+  static constexpr double kMinCost = 1e-3;  //!< Keeps the ranks strictly decreasing
+
+  //! Kahn's algorithm, the ready nodes are taken in the index order
+  bool topologicalOrder(std::vector<size_t>* order) const {
+    std::vector<size_t> inDegree(size());
+    for (size_t i = 0; i < size(); ++i) {
+      inDegree[i] = predecessors_[i].size();
+      if (inDegree[i] == 0) {
+        order->push_back(i);
+      }
+    }
+    for (size_t i = 0; i < order->size(); ++i) {
+      for (auto succ : successors_[(*order)[i]]) {
+        if (--inDegree[succ] == 0) {
+          order->push_back(succ);
+        }
+      }
+    }
+    return order->size() == size();
+  }
+
+  //! Returns the time when all dependencies of the node are visible on the queue
+  double startTime(size_t node, uint32_t q, double signalCost, const std::vector<uint32_t>& queue,
+                   const std::vector<double>& finish, size_t* signals) const {
+    // A root on a parallel queue waits for the launch queue
+    double start = (predecessors_[node].empty() && (q != 0)) ? signalCost : 0;
+    for (auto pred : predecessors_[node]) {
+      double ready = finish[pred];
+      if (queue[pred] != q) {
+        ready += signalCost;
+        ++*signals;
+      }
+      start = std::max(start, ready);
+    }
+    return start;
+  }
+
+  std::vector<double> cost_;                       //!< Estimated execution time of nodes
+  std::vector<std::vector<size_t>> successors_;    //!< Outgoing edges
+  std::vector<std::vector<size_t>> predecessors_;  //!< Incoming edges
+};
+
+/*@}*/
+
+}  // namespace amd
+
+#endif /*LISTSCHEDULER_HPP_*/
@@ -0,0 +1,211 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#ifndef LOCKPROFILER_HPP_
+#define LOCKPROFILER_HPP_
+
+#include "top.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+//! \addtogroup Utils
+
+namespace amd { /*@{*/
+
+/*! \brief Contention profile of the locks, per lock and call site.
+ *
+ * Every thread records its acquisitions in a thread local table, so the profiled locks
+ * don't share a cache line for the statistics. A table is guarded by its own mutex,
+ * taken by other threads only when the profile is collected. The table of an exiting
+ * thread is merged into the retired table, and the later acquisitions of the thread, such
+ * as in the static destructors, are recorded there directly. The statistics of a destroyed lock stay in
+ * the profile and a new lock at the same address continues them.
+ */
+class LockProfiler {
+ public:
+  //! A call site acquiring a lock
+  struct Site {
+    const void* lock_;  //!< The lock
+    const char* file_;  //!< The source file of the caller, may be nullptr
+    int line_;          //!< The source line of the caller
+
+    bool operator==(const Site& site) const {
+      return (lock_ == site.lock_) && (file_ == site.file_) && (line_ == site.line_);
+    }
+  };
+
+  struct Stats {
+    uint64_t acquisitions_ = 0;  //!< The number of acquisitions
+    uint64_t contended_ = 0;     //!< The number of acquisitions that had to wait
+    uint64_t waitNs_ = 0;        //!< The total wait time in ns
+    uint64_t maxWaitNs_ = 0;     //!< The longest wait in ns
+
+    void add(const Stats& stats) {
+      acquisitions_ += stats.acquisitions_;
+      contended_ += stats.contended_;
+      waitNs_ += stats.waitNs_;
+      maxWaitNs_ = std::max(maxWaitNs_, stats.maxWaitNs_);
+    }
+
+    void record(uint64_t waitNs) {
+      ++acquisitions_;
+      if (waitNs != 0) {
+        ++contended_;
+        waitNs_ += waitNs;
+        maxWaitNs_ = std::max(maxWaitNs_, waitNs);
+      }
+    }
+  };
+
+  typedef std::vector<std::pair<Site, Stats>> Profile;
+
+  //! Records an acquisition by the calling thread, \a waitNs is 0 if it didn't wait
+  static void record(const void* lock, const char* file, int line, uint64_t waitNs) {
+    ThreadTable* table = threadTable();
+    if (table == nullptr) {
+      // The thread exited
+      Registry& registry = instance();
+      std::lock_guard<std::mutex> guard(registry.lock_);
+      registry.retired_[Site{lock, file, line}].record(waitNs);
+      return;
+    }
+    std::lock_guard<std::mutex> guard(table->lock_);
+    table->stats_[Site{lock, file, line}].record(waitNs);
+  }
+
+  //! Returns the merged profile of all threads, sorted by the total wait time
+  static Profile collect() {
+    Registry& registry = instance();
+    std::lock_guard<std::mutex> guard(registry.lock_);
+    Table merged = registry.retired_;
+    for (ThreadTable* table : registry.threads_) {
+      std::lock_guard<std::mutex> tableGuard(table->lock_);
+      for (const auto& it : table->stats_) {
+        merged[it.first].add(it.second);
+      }
+    }
+    Profile profile(merged.begin(), merged.end());
+    std::sort(profile.begin(), profile.end(), [](const auto& a, const auto& b) {
+      return (a.second.waitNs_ != b.second.waitNs_)
+          ? (a.second.waitNs_ > b.second.waitNs_)
+          : (a.second.acquisitions_ > b.second.acquisitions_);
+    });
+    return profile;
+  }
+
+  //! Discards the recorded statistics
+  static void reset() {
+    Registry& registry = instance();
+    std::lock_guard<std::mutex> guard(registry.lock_);
+    registry.retired_.clear();
+    for (ThreadTable* table : registry.threads_) {
+      std::lock_guard<std::mutex> tableGuard(table->lock_);
+      table->stats_.clear();
+    }
+  }
+
+ private:
+  struct SiteHash {
+    size_t operator()(const Site& site) const {
+      size_t hash = std::hash<const void*>()(site.lock_);
+      hash ^= std::hash<const void*>()(site.file_) + 0x9E3779B9 + (hash << 6) + (hash >> 2);
+      hash ^= std::hash<int>()(site.line_) + 0x9E3779B9 + (hash << 6) + (hash >> 2);
+      return hash;
+    }
+  };
+
+  typedef std::unordered_map<Site, Stats, SiteHash> Table;
+
+  struct ThreadTable;
+
+  struct Registry {
+    std::mutex lock_;                    //!< Protects the lists
+    std::vector<ThreadTable*> threads_;  //!< The tables of the live threads
+    Table retired_;                      //!< The merged tables of the exited threads
+  };
+
+  struct ThreadTable {
+    ThreadTable() {
+      Registry& registry = instance();
+      std::lock_guard<std::mutex> guard(registry.lock_);
+      registry.threads_.push_back(this);
+    }
+    ~ThreadTable() {
+      Registry& registry = instance();
+      std::lock_guard<std::mutex> guard(registry.lock_);
+      for (const auto& it : stats_) {
+        registry.retired_[it.first].add(it.second);
+      }
+      registry.threads_.erase(
+          std::find(registry.threads_.begin(), registry.threads_.end(), this));
+    }
+    std::mutex lock_;  //!< Protects the statistics from the collection
+    Table stats_;      //!< The statistics of the thread
+  };
+
+  //! The registry is never destroyed, threads may exit after the static destructors
+  static Registry& instance() {
+    static Registry* registry = new Registry();
+    return *registry;
+  }
+
+  struct State {
+    ThreadTable* table_;  //!< The table of the thread
+    bool exited_;         //!< The exit hook retired the table
+  };
+
+  //! Retires the table at the thread exit
+  struct ExitHook {
+    ~ExitHook() {
+      State& state = LockProfiler::state();
+      delete state.table_;
+      state.table_ = nullptr;
+      state.exited_ = true;
+    }
+  };
+
+  //! Trivially destructible, so it stays valid after the exit hook of the thread
+  static State& state() {
+    static thread_local State state = {nullptr, false};
+    return state;
+  }
+
+  //! Returns the table of the thread, nullptr after the thread exit
+  static ThreadTable* threadTable() {
+    State& state = LockProfiler::state();
+    if (state.table_ == nullptr && !state.exited_) {
+      static thread_local ExitHook hook;
+      state.table_ = new ThreadTable();
+    }
+    return state.table_;
+  }
+};
+
+/*@}*/
+
+}  // namespace amd
+
+#endif /*LOCKPROFILER_HPP_*/
@@ -0,0 +1,422 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#ifndef LOGBUFFER_HPP_
+#define LOGBUFFER_HPP_
+
+#include "top.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+//! \addtogroup Utils
+
+namespace amd { /*@{*/
+
+/*! \brief A printf-style log message with the raw arguments.
+ *
+ * capture() copies the format string and the arguments without formatting, strings
+ * are copied into the local arena. format() produces the same text as vsnprintf()
+ * later, on another thread. Formats with unsupported conversions, too many arguments
+ * or long strings are formatted at capture time. A message, which doesn't fit the arena
+ * then, isn't captured and the caller formats it.
+ */
+class LogRecord {
+ public:
+  static constexpr size_t kMaxArgs = 12;     //!< The max number of captured arguments
+  static constexpr size_t kArenaSize = 344;  //!< The storage for the format and strings
+
+  uint64_t timeUs_;       //!< Timestamp of the message
+  uint64_t durationUs_;   //!< Duration, reported with the message
+  const char* file_;      //!< Source file, must be a string literal
+  int32_t line_;          //!< Source line
+  int32_t level_;         //!< Log level
+  bool hasDuration_;      //!< The message reports the duration
+
+  //! Captures the message. Returns false if the message doesn't fit the arena, the va_list
+  //! isn't consumed then
+  bool capture(const char* format, va_list ap) {
+    va_list copy;
+    va_copy(copy, ap);
+    preformatted_ = !captureArgs(format, copy);
+    va_end(copy);
+    if (!preformatted_) {
+      return true;
+    }
+    va_copy(copy, ap);
+    int len = vsnprintf(arena_, kArenaSize, format, copy);
+    va_end(copy);
+    return (len >= 0) && (static_cast<size_t>(len) < kArenaSize);
+  }
+
+  //! Formats the message into buf. Returns the length of the message, like snprintf()
+  size_t format(char* buf, size_t size) const {
+    if (size == 0) {
+      return 0;
+    }
+    size_t pos = 0;
+    if (preformatted_) {
+      pos = append(buf, size, pos, arena_, strnlen(arena_, kArenaSize));
+      buf[std::min(pos, size - 1)] = '\0';
+      return pos;
+    }
+    uint32_t arg = 0;
+    const char* p = arena_;
+    while (*p != '\0') {
+      const char* start = p;
+      while ((*p != '\0') && (*p != '%')) {
+        ++p;
+      }
+      pos = append(buf, size, pos, start, p - start);
+      if (*p == '\0') {
+        break;
+      }
+      if (p[1] == '%') {
+        pos = append(buf, size, pos, "%", 1);
+        p += 2;
+        continue;
+      }
+      // Rebuild the conversion with the captured values
+      char spec[48];
+      size_t len = 0;
+      spec[len++] = *p++;
+      while ((*p != '\0') && (strchr("-+ #0", *p) != nullptr)) {
+        spec[len++] = *p++;
+      }
+      p = field(p, spec, &len, &arg);
+      if (*p == '.') {
+        spec[len++] = *p++;
+        p = field(p, spec, &len, &arg);
+      }
+      parseLength(&p);
+      char conv = *p++;
+      const Arg& value = args_[arg++];
+      switch (type(conv)) {
+        case Type::Signed:
+        case Type::Unsigned:
+          spec[len++] = 'l';
+          spec[len++] = 'l';
+          spec[len++] = conv;
+          spec[len] = '\0';
+          pos = print(buf, size, pos, spec, value.u_);
+          break;
+        case Type::Char:
+          spec[len++] = conv;
+          spec[len] = '\0';
+          pos = print(buf, size, pos, spec, static_cast<int>(value.i_));
+          break;
+        case Type::Double:
+          spec[len++] = conv;
+          spec[len] = '\0';
+          pos = print(buf, size, pos, spec, value.d_);
+          break;
+        case Type::String:
+          spec[len++] = conv;
+          spec[len] = '\0';
+          pos = print(buf, size, pos, spec, arena_ + value.u_);
+          break;
+        case Type::Pointer:
+          spec[len++] = conv;
+          spec[len] = '\0';
+          pos = print(buf, size, pos, spec, value.p_);
+          break;
+        default:
+          break;
+      }
+    }
+    buf[std::min(pos, size - 1)] = '\0';
+    return pos;
+  }
+
+ private:
+  enum class Type : uint8_t { Invalid, Signed, Unsigned, Char, Double, String, Pointer };
+  enum class Length : uint8_t { None, HH, H, L, LL, J, Z, T, LD };
+
+  union Arg {
+    int64_t i_;
+    uint64_t u_;
+    double d_;
+    const void* p_;
+  };
+
+  static Type type(char conv) {
+    switch (conv) {
+      case 'd': case 'i':
+        return Type::Signed;
+      case 'u': case 'o': case 'x': case 'X':
+        return Type::Unsigned;
+      case 'c':
+        return Type::Char;
+      case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+        return Type::Double;
+      case 's':
+        return Type::String;
+      case 'p':
+        return Type::Pointer;
+      default:
+        return Type::Invalid;
+    }
+  }
+
+  static Length parseLength(const char** p) {
+    const char* s = *p;
+    Length length = Length::None;
+    switch (*s) {
+      case 'h':
+        length = (s[1] == 'h') ? Length::HH : Length::H;
+        break;
+      case 'l':
+        length = (s[1] == 'l') ? Length::LL : Length::L;
+        break;
+      case 'j':
+        length = Length::J;
+        break;
+      case 'z':
+        length = Length::Z;
+        break;
+      case 't':
+        length = Length::T;
+        break;
+      case 'L':
+        length = Length::LD;
+        break;
+      default:
+        break;
+    }
+    *p += ((length == Length::HH) || (length == Length::LL)) ? 2 :
+          ((length == Length::None) ? 0 : 1);
+    return length;
+  }
+
+  //! Skips a width or precision field and substitutes '*' with the captured value
+  const char* field(const char* p, char* spec, size_t* len, uint32_t* arg) const {
+    if (*p == '*') {
+      *len += snprintf(spec + *len, 12, "%d", static_cast<int>(args_[(*arg)++].i_));
+      return p + 1;
+    }
+    while ((*p >= '0') && (*p <= '9') && (*len < 40)) {
+      spec[(*len)++] = *p++;
+    }
+    return p;
+  }
+
+  //! Skips a width or precision field in the format and captures '*' values
+  bool skipField(const char** p, va_list ap) {
+    if (**p == '*') {
+      ++*p;
+      return push(static_cast<int64_t>(va_arg(ap, int)));
+    }
+    while ((**p >= '0') && (**p <= '9')) {
+      ++*p;
+    }
+    return true;
+  }
+
+  bool push(int64_t value) {
+    if (numArgs_ == kMaxArgs) {
+      return false;
+    }
+    args_[numArgs_++].i_ = value;
+    return true;
+  }
+
+  bool captureArgs(const char* format, va_list ap) {
+    numArgs_ = 0;
+    size_t used = strlen(format) + 1;
+    if (used > kArenaSize) {
+      return false;
+    }
+    memcpy(arena_, format, used);
+    for (const char* p = format; *p != '\0'; ++p) {
+      if (*p != '%') {
+        continue;
+      }
+      if (*++p == '%') {
+        continue;
+      }
+      while ((*p != '\0') && (strchr("-+ #0", *p) != nullptr)) {
+        ++p;
+      }
+      if (!skipField(&p, ap)) {
+        return false;
+      }
+      if (*p == '.') {
+        ++p;
+        if (!skipField(&p, ap)) {
+          return false;
+        }
+      }
+      Length length = parseLength(&p);
+      Arg value;
+      switch (type(*p)) {
+        case Type::Signed:
+          switch (length) {
+            case Length::None: value.i_ = va_arg(ap, int); break;
+            case Length::HH: value.i_ = static_cast<signed char>(va_arg(ap, int)); break;
+            case Length::H: value.i_ = static_cast<short>(va_arg(ap, int)); break;
+            case Length::L: value.i_ = va_arg(ap, long); break;
+            case Length::LL: value.i_ = va_arg(ap, long long); break;
+            case Length::J: value.i_ = va_arg(ap, intmax_t); break;
+            case Length::Z: value.i_ = static_cast<int64_t>(va_arg(ap, size_t)); break;
+            case Length::T: value.i_ = va_arg(ap, ptrdiff_t); break;
+            default: return false;
+          }
+          break;
+        case Type::Unsigned:
+          switch (length) {
+            case Length::None: value.u_ = va_arg(ap, unsigned int); break;
+            case Length::HH: value.u_ = static_cast<unsigned char>(va_arg(ap, int)); break;
+            case Length::H: value.u_ = static_cast<unsigned short>(va_arg(ap, int)); break;
+            case Length::L: value.u_ = va_arg(ap, unsigned long); break;
+            case Length::LL: value.u_ = va_arg(ap, unsigned long long); break;
+            case Length::J: value.u_ = va_arg(ap, uintmax_t); break;
+            case Length::Z: value.u_ = va_arg(ap, size_t); break;
+            case Length::T: value.u_ = static_cast<uint64_t>(va_arg(ap, ptrdiff_t)); break;
+            default: return false;
+          }
+          break;
+        case Type::Char:
+          if (length != Length::None) {
+            return false;
+          }
+          value.i_ = va_arg(ap, int);
+          break;
+        case Type::Double:
+          if (length == Length::LD) {
+            value.d_ = static_cast<double>(va_arg(ap, long double));
+          } else if ((length == Length::None) || (length == Length::L)) {
+            value.d_ = va_arg(ap, double);
+          } else {
+            return false;
+          }
+          break;
+        case Type::String: {
+          if (length != Length::None) {
+            return false;
+          }
+          const char* str = va_arg(ap, const char*);
+          if (str == nullptr) {
+            str = "(null)";
+          }
+          size_t len = strlen(str) + 1;
+          if (used + len > kArenaSize) {
+            return false;
+          }
+          memcpy(arena_ + used, str, len);
+          value.u_ = used;
+          used += len;
+          break;
+        }
+        case Type::Pointer:
+          value.p_ = va_arg(ap, void*);
+          break;
+        default:
+          // %n and unknown conversions
+          return false;
+      }
+      if (numArgs_ == kMaxArgs) {
+        return false;
+      }
+      args_[numArgs_++] = value;
+    }
+    return true;
+  }
+
+  static size_t append(char* buf, size_t size, size_t pos, const char* str, size_t len) {
+    if (pos + 1 < size) {
+      memcpy(buf + pos, str, std::min(len, size - 1 - pos));
+    }
+    return pos + len;
+  }
+
+  template <typename T>
+  static size_t print(char* buf, size_t size, size_t pos, const char* spec, T value) {
+    size_t room = (pos < size) ? size - pos : 0;
+    int len = snprintf((room > 0) ? buf + pos : nullptr, room, spec, value);
+    return pos + ((len > 0) ? len : 0);
+  }
+
+  Arg args_[kMaxArgs];      //!< Captured arguments
+  uint8_t numArgs_ = 0;     //!< The number of captured arguments
+  bool preformatted_ = false;  //!< The arena holds the formatted message
+  char arena_[kArenaSize];  //!< The format string, followed by the string arguments
+};
+
+/*! \brief Single producer, single consumer ring of log records.
+ *
+ * The producer never blocks. If the ring is full the message is dropped and counted.
+ */
+class LogRing {
+ public:
+  explicit LogRing(size_t capacity) : records_(std::max<size_t>(capacity, 2)) {}
+
+  //! Returns a free record or nullptr if the ring is full, producer only
+  LogRecord* reserve() {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) >= records_.size()) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    return &records_[head % records_.size()];
+  }
+
+  //! Publishes the reserved record, producer only
+  void commit() {
+    head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+  //! Returns the number of published records, consumer only
+  size_t available() const {
+    return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_relaxed);
+  }
+
+  //! Returns the published record at index from the oldest one, consumer only
+  const LogRecord& peek(size_t index) const {
+    return records_[(tail_.load(std::memory_order_relaxed) + index) % records_.size()];
+  }
+
+  //! Releases the oldest count records, consumer only
+  void pop(size_t count) {
+    tail_.store(tail_.load(std::memory_order_relaxed) + count, std::memory_order_release);
+  }
+
+  //! Returns the number of dropped messages
+  size_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+  size_t capacity() const { return records_.size(); }
+
+ private:
+  std::vector<LogRecord> records_;
+  alignas(64) std::atomic<size_t> head_{0};  //!< The next record for the producer
+  alignas(64) std::atomic<size_t> tail_{0};  //!< The oldest record for the consumer
+  std::atomic<size_t> dropped_{0};            //!< The number of dropped messages
+};
+
+/*@}*/
+
+}  // namespace amd
+
+#endif /*LOGBUFFER_HPP_*/
@@ -0,0 +1,231 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#ifndef MPSCRING_HPP_
+#define MPSCRING_HPP_
+
+#include "top.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+#if defined(ATI_ARCH_X86)
+#include <immintrin.h>
+#endif
+
+//! \addtogroup Utils
+
+namespace amd { /*@{*/
+
+/*! \brief A bounded multi-producer single-consumer ring.
+ *
+ * Every slot carries a sequence number. A producer claims a position with a CAS on the
+ * tail and publishes the slot with the sequence after the value, the consumer takes the
+ * published slots in order and hands them back with the sequence of the next lap.
+ * A producer can claim a slot before it publishes it, then the consumer stops at the slot
+ * until the producer is done.
+ */
+template <typename T> class MpscRing {
+ public:
+  //! The capacity is rounded up to a power of two
+  explicit MpscRing(size_t capacity) : head_(0), tail_(0) {
+    size_t size = 2;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    mask_ = size - 1;
+    slots_.reset(new Slot[size]);
+    for (size_t i = 0; i < size; ++i) {
+      slots_[i].seq_.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  size_t capacity() const { return mask_ + 1; }
+
+  //! Adds the value, returns false if the ring is full
+  bool tryEnqueue(T value) {
+    size_t pos = tail_.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;) {
+      slot = &slots_[pos & mask_];
+      size_t seq = slot->seq_.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        // The consumer didn't take the value of the previous lap yet
+        return false;
+      } else {
+        pos = tail_.load(std::memory_order_relaxed);
+      }
+    }
+    slot->value_ = value;
+    slot->seq_.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  //! Takes up to max values in order, must be called by the consumer only
+  size_t dequeue(T* values, size_t max) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    size_t count = 0;
+    for (; count < max; ++count, ++head) {
+      Slot& slot = slots_[head & mask_];
+      if (slot.seq_.load(std::memory_order_acquire) != head + 1) {
+        break;
+      }
+      values[count] = slot.value_;
+      slot.seq_.store(head + mask_ + 1, std::memory_order_release);
+    }
+    head_.store(head, std::memory_order_relaxed);
+    return count;
+  }
+
+  //! Returns true if the next value isn't published, a snapshot for other threads
+  bool empty() const {
+    size_t head = head_.load(std::memory_order_relaxed);
+    return slots_[head & mask_].seq_.load(std::memory_order_acquire) != head + 1;
+  }
+
+ private:
+  struct Slot {
+    std::atomic<size_t> seq_;  //!< The position + 1 when the value is published
+    T value_;
+  };
+
+  std::unique_ptr<Slot[]> slots_;         //!< The ring storage
+  size_t mask_;                           //!< The capacity - 1
+  alignas(64) std::atomic<size_t> head_;  //!< The next position of the consumer
+  alignas(64) std::atomic<size_t> tail_;  //!< The next position of the producers
+};
+
+/*! \brief Spin-then-park wakeup of a single consumer thread.
+ *
+ * The consumer spins on the ready condition before it parks on a futex. The spin length
+ * adapts, it grows when the spin finds work and shrinks when the consumer has to park.
+ * A producer signals only when the consumer announced it's parked, so the submission
+ * into a busy consumer costs a fence and a load. Both sides fence between the store of
+ * their own state and the load of the other one, so either the consumer sees the work
+ * or the producer sees the parked consumer.
+ */
+class Parker {
+ public:
+  static constexpr uint32_t kMinSpins = 64;     //!< The min number of spin iterations
+  static constexpr uint32_t kMaxSpins = 16384;  //!< The max number of spin iterations
+
+  Parker() : epoch_(0), parked_(false), spins_(kMinSpins), parks_(0), wakeups_(0) {}
+
+  //! Waits until ready() returns true, called by the consumer
+  template <typename Ready> void park(Ready ready) {
+    for (uint32_t i = 0; i < spins_; ++i) {
+      if (ready()) {
+        spins_ = std::min(spins_ * 2, kMaxSpins);
+        return;
+      }
+      pause();
+    }
+    spins_ = std::max(spins_ / 2, kMinSpins);
+    while (true) {
+      uint32_t epoch = epoch_.load(std::memory_order_acquire);
+      parked_.store(true, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (ready()) {
+        parked_.store(false, std::memory_order_relaxed);
+        return;
+      }
+      ++parks_;
+      wait(epoch);
+      parked_.store(false, std::memory_order_relaxed);
+    }
+  }
+
+  //! Wakes the consumer if it's parked, called after the work was published
+  void unpark() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (parked_.load(std::memory_order_relaxed)) {
+      epoch_.fetch_add(1, std::memory_order_release);
+      wakeups_.fetch_add(1, std::memory_order_relaxed);
+      wake();
+    }
+  }
+
+  //! The number of times the consumer parked
+  uint64_t parks() const { return parks_; }
+
+  //! The number of wakeup signals
+  uint64_t wakeups() const { return wakeups_.load(std::memory_order_relaxed); }
+
+ private:
+  static void pause() {
+#if defined(ATI_ARCH_X86)
+    _mm_pause();
+#else
+    std::this_thread::yield();
+#endif
+  }
+
+#if defined(__linux__)
+  void wait(uint32_t epoch) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch_), FUTEX_WAIT_PRIVATE, epoch,
+            nullptr, nullptr, 0);
+  }
+  void wake() {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch_), FUTEX_WAKE_PRIVATE, 1, nullptr,
+            nullptr, 0);
+  }
+#else
+  void wait(uint32_t epoch) {
+    std::unique_lock<std::mutex> lock(lock_);
+    cv_.wait(lock, [&]() { return epoch_.load(std::memory_order_acquire) != epoch; });
+  }
+  void wake() {
+    { std::lock_guard<std::mutex> lock(lock_); }
+    cv_.notify_one();
+  }
+
+  std::mutex lock_;             //!< Protects the condition variable
+  std::condition_variable cv_;  //!< The parked consumer waits on it
+#endif
+
+  std::atomic<uint32_t> epoch_;    //!< The futex word, bumped by every wakeup
+  std::atomic<bool> parked_;       //!< True while the consumer may sleep
+  uint32_t spins_;                 //!< The current spin length of the consumer
+  uint64_t parks_;                 //!< The number of parks, consumer only
+  std::atomic<uint64_t> wakeups_;  //!< The number of wakeup signals
+};
+
+/*@}*/
+
+}  // namespace amd
+
+#endif /*MPSCRING_HPP_*/
@@ -0,0 +1,291 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#ifndef PATTERNFILL_HPP_
+#define PATTERNFILL_HPP_
+
+#include "top.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#if defined(ATI_ARCH_X86)
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#define PATTERNFILL_TARGET(isa)
+#else
+#define PATTERNFILL_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+//! \addtogroup Utils
+
+namespace amd { /*@{*/
+
+/*! \brief Fills host memory with a repeated pattern.
+ *
+ * The pattern is expanded into a line, a multiple of the pattern size and of the widest
+ * vector register. The destination is aligned to the vector width and written with
+ * vector stores from the line, at the pattern phase of every store. The vector ISA is
+ * selected at runtime, fills above a threshold use non-temporal stores and very large
+ * fills can be split across threads. Patterns larger than kMaxLinePattern bytes are
+ * replicated by doubling the filled region.
+ */
+class PatternFill {
+ public:
+  enum Isa : uint32_t { Generic = 0, Sse2 = 1, Avx2 = 2, Avx512 = 3 };
+
+  static constexpr size_t kVectorAlign = 64;      //!< The widest vector register
+  static constexpr size_t kMaxLinePattern = 128;  //!< The max pattern size of the line
+
+  struct Options {
+    Isa isa = Generic;                   //!< Vector instructions of the stores
+    size_t nonTemporalSize = SIZE_MAX;   //!< Fills of at least this size bypass the caches
+    uint32_t threads = 1;                //!< The max number of threads
+    size_t threadSize = 64 * 1024 * 1024;  //!< The min size of the fill per thread
+  };
+
+  //! Returns the widest supported ISA with the cpuid and xgetbv functions of the OS
+  template <typename Cpuid, typename Xgetbv>
+  static Isa detect(Cpuid cpuid, Xgetbv xgetbv) {
+#if defined(ATI_ARCH_X86)
+    int regs[4];
+    cpuid(regs, 0);
+    const int maxLeaf = regs[0];
+    cpuid(regs, 1);
+    const bool sse2 = (regs[3] & (1 << 26)) != 0;
+    const bool osxsave = (regs[2] & (1 << 27)) != 0;
+    const bool avx = (regs[2] & (1 << 28)) != 0;
+    if (!sse2) {
+      return Generic;
+    }
+    if (!osxsave || !avx || (maxLeaf < 7)) {
+      return Sse2;
+    }
+    // The OS must save the YMM and ZMM state
+    const uint64_t xcr0 = xgetbv(0);
+    if ((xcr0 & 0x6) != 0x6) {
+      return Sse2;
+    }
+    cpuid(regs, 7);
+    const bool avx2 = (regs[1] & (1 << 5)) != 0;
+    const bool avx512f = (regs[1] & (1 << 16)) != 0;
+    if (avx512f && ((xcr0 & 0xE6) == 0xE6)) {
+      return Avx512;
+    }
+    return avx2 ? Avx2 : Sse2;
+#else
+    return Generic;
+#endif
+  }
+
+  static const char* name(Isa isa) {
+    static const char* names[] = {"generic", "SSE2", "AVX2", "AVX-512"};
+    return names[isa];
+  }
+
+  //! Writes \a count copies of the pattern to \a dst
+  static void fill(void* dst, const void* pattern, size_t patternSize, size_t count,
+                   const Options& options) {
+    const size_t size = patternSize * count;
+    if (size == 0) {
+      return;
+    }
+    address out = reinterpret_cast<address>(dst);
+    if (count == 1) {
+      memcpy(out, pattern, patternSize);
+      return;
+    }
+    if (patternSize > kMaxLinePattern) {
+      // Double the filled region, the reads hit the just written data
+      memcpy(out, pattern, patternSize);
+      for (size_t filled = patternSize; filled < size;) {
+        size_t chunk = std::min(filled, size - filled);
+        memcpy(out + filled, out, chunk);
+        filled += chunk;
+      }
+      return;
+    }
+
+    Line line(pattern, patternSize);
+    const bool nonTemporal = (size >= options.nonTemporalSize);
+    size_t threads = std::min<size_t>(options.threads,
+                                      size / std::max<size_t>(options.threadSize, 1));
+    if (threads <= 1) {
+      fillRange(out, size, line, options.isa, nonTemporal);
+      return;
+    }
+    // Every thread starts at a multiple of the line, so at the pattern phase 0
+    size_t chunk = (size + threads - 1) / threads;
+    chunk = ((chunk + line.size_ - 1) / line.size_) * line.size_;
+    std::vector<std::thread> workers;
+    for (size_t offset = chunk; offset < size; offset += chunk) {
+      workers.emplace_back(fillRange, out + offset, std::min(chunk, size - offset),
+                           std::cref(line), options.isa, nonTemporal);
+    }
+    fillRange(out, std::min(chunk, size), line, options.isa, nonTemporal);
+    for (auto& worker : workers) {
+      worker.join();
+    }
+  }
+
+ private:
+  //! The pattern repeated over a multiple of the pattern size and of kVectorAlign, followed
+  //! by kVectorAlign bytes of the repetition, so a vector load never wraps around
+  struct Line {
+    Line(const void* pattern, size_t patternSize) {
+      size_t a = patternSize;
+      size_t b = kVectorAlign;
+      while (b != 0) {
+        size_t t = a % b;
+        a = b;
+        b = t;
+      }
+      size_ = patternSize / a * kVectorAlign;
+      for (size_t i = 0; i < size_ + kVectorAlign; i += patternSize) {
+        memcpy(data_ + i, pattern, patternSize);
+      }
+    }
+    size_t size_;  //!< The size of the repetition
+    alignas(kVectorAlign) uint8_t data_[kMaxLinePattern * kVectorAlign + 2 * kVectorAlign];
+  };
+
+  static size_t width(Isa isa) {
+    switch (isa) {
+      case Sse2:
+        return 16;
+      case Avx2:
+        return 32;
+      case Avx512:
+        return 64;
+      default:
+        return 1;
+    }
+  }
+
+  //! Fills size bytes at the pattern phase 0
+  static void fillRange(address out, size_t size, const Line& line, Isa isa, bool nonTemporal) {
+    const size_t vector = width(isa);
+    size_t offset = 0;
+    size_t pos = 0;
+    if (vector > 1) {
+      // The head up to the vector alignment
+      offset = std::min(size, (vector - reinterpret_cast<uintptr_t>(out) % vector) % vector);
+      memcpy(out, line.data_, offset);
+      pos = offset;
+      size_t body = (size - offset) / vector * vector;
+#if defined(ATI_ARCH_X86)
+      switch (isa) {
+        case Sse2:
+          pos = storeSse2(out + offset, body, line, pos, nonTemporal);
+          break;
+        case Avx2:
+          pos = storeAvx2(out + offset, body, line, pos, nonTemporal);
+          break;
+        case Avx512:
+          pos = storeAvx512(out + offset, body, line, pos, nonTemporal);
+          break;
+        default:
+          break;
+      }
+#endif
+      offset += body;
+    }
+    // The generic path and the tail
+    while (offset < size) {
+      size_t chunk = std::min(size - offset, line.size_ - pos);
+      memcpy(out + offset, line.data_ + pos, chunk);
+      offset += chunk;
+      pos = 0;
+    }
+  }
+
+#if defined(ATI_ARCH_X86)
+  // Every store function writes the aligned body of the fill from the line position pos
+  // and returns the line position after the body
+  PATTERNFILL_TARGET("sse2")
+  static size_t storeSse2(address out, size_t size, const Line& line, size_t pos,
+                          bool nonTemporal) {
+    for (size_t i = 0; i < size; i += sizeof(__m128i)) {
+      __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(line.data_ + pos));
+      if (nonTemporal) {
+        _mm_stream_si128(reinterpret_cast<__m128i*>(out + i), value);
+      } else {
+        _mm_store_si128(reinterpret_cast<__m128i*>(out + i), value);
+      }
+      pos += sizeof(__m128i);
+      pos = (pos >= line.size_) ? pos - line.size_ : pos;
+    }
+    if (nonTemporal) {
+      _mm_sfence();
+    }
+    return pos;
+  }
+
+  PATTERNFILL_TARGET("avx2")
+  static size_t storeAvx2(address out, size_t size, const Line& line, size_t pos,
+                          bool nonTemporal) {
+    for (size_t i = 0; i < size; i += sizeof(__m256i)) {
+      __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(line.data_ + pos));
+      if (nonTemporal) {
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(out + i), value);
+      } else {
+        _mm256_store_si256(reinterpret_cast<__m256i*>(out + i), value);
+      }
+      pos += sizeof(__m256i);
+      pos = (pos >= line.size_) ? pos - line.size_ : pos;
+    }
+    if (nonTemporal) {
+      _mm_sfence();
+    }
+    _mm256_zeroupper();
+    return pos;
+  }
+
+  PATTERNFILL_TARGET("avx512f")
+  static size_t storeAvx512(address out, size_t size, const Line& line, size_t pos,
+                            bool nonTemporal) {
+    for (size_t i = 0; i < size; i += sizeof(__m512i)) {
+      __m512i value = _mm512_loadu_si512(line.data_ + pos);
+      if (nonTemporal) {
+        _mm512_stream_si512(reinterpret_cast<__m512i*>(out + i), value);
+      } else {
+        _mm512_store_si512(out + i, value);
+      }
+      pos += sizeof(__m512i);
+      pos = (pos >= line.size_) ? pos - line.size_ : pos;
+    }
+    if (nonTemporal) {
+      _mm_sfence();
+    }
+    _mm256_zeroupper();
+    return pos;
+  }
+#endif
+};
+
+/*@}*/
+
+}  // namespace amd
+
+#endif /*PATTERNFILL_HPP_*/
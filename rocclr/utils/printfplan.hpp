@@ -0,0 +1,284 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#ifndef PRINTFPLAN_HPP_
+#define PRINTFPLAN_HPP_
+
+#include "top.hpp"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+//! \addtogroup Utils
+
+namespace amd { /*@{*/
+
+/*! \brief Growable text buffer of the device printf output.
+ *
+ * A message is formatted into the buffer and written to the stream with one call.
+ * The storage is kept between messages.
+ */
+class PrintfBuffer {
+ public:
+  PrintfBuffer() : data_(256), size_(0) {}
+
+  void clear() { size_ = 0; }
+  const char* data() const { return data_.data(); }
+  size_t size() const { return size_; }
+
+  void append(const char* str, size_t size) {
+    reserve(size);
+    memcpy(data_.data() + size_, str, size);
+    size_ += size;
+  }
+
+  //! Appends formatted text, returns the vsnprintf() result
+  int printf(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int len = vprintf(format, args);
+    va_end(args);
+    return len;
+  }
+
+  int vprintf(const char* format, va_list args) {
+    va_list copy;
+    va_copy(copy, args);
+    size_t room = data_.size() - size_;
+    int len = vsnprintf(data_.data() + size_, room, format, copy);
+    va_end(copy);
+    if (len < 0) {
+      return len;
+    }
+    if (static_cast<size_t>(len) >= room) {
+      reserve(len + 1);
+      vsnprintf(data_.data() + size_, len + 1, format, args);
+    }
+    size_ += len;
+    return len;
+  }
+
+ private:
+  void reserve(size_t size) {
+    if (size_ + size > data_.size()) {
+      data_.resize(std::max(data_.size() * 2, size_ + size));
+    }
+  }
+
+  std::vector<char> data_;  //!< Storage, the text is not null terminated
+  size_t size_;             //!< The size of the text
+};
+
+/*! \brief Parsed format string of a hostcall printf message.
+ *
+ * The format string is split once into literal segments, each followed by a conversion
+ * specifier. format() consumes the message arguments with the plan, so the string isn't
+ * scanned again for every message. The message layout after the format string is:
+ *  - Each int/float/pointer argument occupies one uint64_t location.
+ *  - Each string argument is null terminated and padded to an 8 byte boundary.
+ *
+ * Limitations:
+ * - Behaviour is undefined with wide characters and strings.
+ * - %n specifier is ignored and the corresponding argument is skipped.
+ */
+class PrintfPlan {
+ public:
+  static constexpr size_t kMaxPlans = 1024;  //!< The max number of cached plans per thread
+
+  explicit PrintfPlan(std::string_view format) : format_(format) {
+    static constexpr char kConversions[] = "diouxXfFeEgGaAcspn";
+    Segment segment;
+    size_t point = 0;
+    while (true) {
+      size_t mark = point;
+      point = format_.find('%', point);
+      if (point == std::string::npos) {
+        segment.literal_.append(format_, mark, std::string::npos);
+        segments_.push_back(std::move(segment));
+        return;
+      }
+      segment.literal_.append(format_, mark, point - mark);
+      // '%%' is a part of the literal
+      if ((point + 1 < format_.size()) && (format_[point + 1] == '%')) {
+        segment.literal_ += '%';
+        point += 2;
+        continue;
+      }
+      // Undefined behaviour if there is no conversion specifier, the output stops
+      size_t conversion = format_.find_first_of(kConversions, point + 1);
+      if (conversion == std::string::npos) {
+        segments_.push_back(std::move(segment));
+        return;
+      }
+      segment.spec_.assign(format_, point, conversion + 1 - point);
+      segment.stars_ = std::count(segment.spec_.begin(), segment.spec_.end(), '*');
+      segment.kind_ = kindOf(format_[conversion]);
+      segments_.push_back(std::move(segment));
+      segment = Segment();
+      point = conversion + 1;
+    }
+  }
+
+  //! Returns the cached plan of the format string, the plan is valid until the next call
+  static const PrintfPlan& get(const char* format) {
+    thread_local std::unordered_map<std::string_view, std::unique_ptr<PrintfPlan>> plans;
+    std::string_view key(format);
+    auto it = plans.find(key);
+    if (it != plans.end()) {
+      return *it->second;
+    }
+    if (plans.size() >= kMaxPlans) {
+      plans.clear();
+    }
+    auto plan = std::make_unique<PrintfPlan>(key);
+    // The key refers to the copy of the format string in the plan
+    std::string_view owned(plan->format_);
+    return *plans.emplace(owned, std::move(plan)).first->second;
+  }
+
+  //! The number of uint64_t locations of the null terminated format string in a message
+  size_t formatWords() const { return (format_.size() + 1 + 7) / 8; }
+
+  //! The number of conversion specifiers
+  size_t numSpecs() const { return segments_.size() - 1; }
+
+  /*! \brief Formats the arguments into the buffer.
+   * \param ptr Start of the arguments after the format string.
+   * \param end One past the last element in the message.
+   * \return An integer that satisfies the POSIX return value for printf.
+   *
+   * The output stops when the arguments run out.
+   */
+  int format(PrintfBuffer* out, const uint64_t* ptr, const uint64_t* end) const {
+    int count = 0;
+    for (const auto& segment : segments_) {
+      out->append(segment.literal_.data(), segment.literal_.size());
+      count += static_cast<int>(segment.literal_.size());
+      if ((segment.kind_ == Kind::None) || (ptr >= end)) {
+        return count;
+      }
+      int len = 0;
+      ptr = consume(out, segment, ptr, end, &len);
+      if (len < 0) {
+        return len;
+      }
+      count += len;
+    }
+    return count;
+  }
+
+ private:
+  enum class Kind : uint8_t { None, Integer, FloatingPoint, Cstring, Pointer, Skip };
+
+  struct Segment {
+    std::string literal_;     //!< Text before the specifier
+    std::string spec_;        //!< Conversion specifier, passed to snprintf()
+    Kind kind_ = Kind::None;  //!< The argument type, None after the last literal
+    uint32_t stars_ = 0;      //!< The number of '*' width and precision arguments
+  };
+
+  static Kind kindOf(char conversion) {
+    switch (conversion) {
+      case 'd':
+      case 'i':
+      case 'o':
+      case 'u':
+      case 'x':
+      case 'X':
+      case 'c':
+        return Kind::Integer;
+      case 's':
+        return Kind::Cstring;
+      case 'p':
+        return Kind::Pointer;
+      case 'n':
+        return Kind::Skip;
+      default:
+        return Kind::FloatingPoint;
+    }
+  }
+
+  template <typename T>
+  static int print(PrintfBuffer* out, const Segment& segment, const uint64_t* stars, T value) {
+    switch (segment.stars_) {
+      case 0:
+        return out->printf(segment.spec_.c_str(), value);
+      case 1:
+        return out->printf(segment.spec_.c_str(), static_cast<int>(stars[0]), value);
+      default:
+        return out->printf(segment.spec_.c_str(), static_cast<int>(stars[0]),
+                           static_cast<int>(stars[1]), value);
+    }
+  }
+
+  //! Prints one specifier and returns the next argument
+  static const uint64_t* consume(PrintfBuffer* out, const Segment& segment, const uint64_t* ptr,
+                                 const uint64_t* end, int* len) {
+    // Undefined behaviour if there are not enough arguments or more than two stars
+    if ((segment.stars_ > 2) || (end - ptr < static_cast<ptrdiff_t>(segment.stars_ + 1))) {
+      return end;
+    }
+    const uint64_t* arg = ptr + segment.stars_;
+    switch (segment.kind_) {
+      case Kind::Integer:
+        *len = print(out, segment, ptr, arg[0]);
+        return arg + 1;
+      case Kind::FloatingPoint: {
+        double d;
+        memcpy(&d, arg, sizeof(d));
+        *len = print(out, segment, ptr, d);
+        return arg + 1;
+      }
+      case Kind::Cstring: {
+        // The device copies the whole string, independent of the precision
+        auto str = reinterpret_cast<const char*>(arg);
+        size_t room = (end - arg) * sizeof(uint64_t);
+        size_t size = strnlen(str, room);
+        if (size == room) {
+          return end;
+        }
+        *len = print(out, segment, ptr, str);
+        return arg + (size + 1 + 7) / 8;
+      }
+      case Kind::Pointer:
+        *len = print(out, segment, ptr, reinterpret_cast<void*>(arg[0]));
+        return arg + 1;
+      default:
+        return arg + 1;
+    }
+  }
+
+  std::string format_;             //!< The format string
+  std::vector<Segment> segments_;  //!< Segments, the last one has only a literal
+};
+
+/*@}*/
+
+}  // namespace amd
+
+#endif /*PRINTFPLAN_HPP_*/
@@ -0,0 +1,166 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#ifndef RANGECACHE_HPP_
+#define RANGECACHE_HPP_
+
+#include "top.hpp"
+
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <map>
+#include <vector>
+
+//! \addtogroup Utils
+
+namespace amd { /*@{*/
+
+/*! \brief An LRU cache of values keyed by page aligned address ranges.
+ *
+ * A lookup hits any cached range which contains the requested range. A range contained
+ * in a newly inserted one is dropped, so no cached range contains another. Then the ends
+ * grow with the starts and the only candidate for a lookup is the last range starting at
+ * or below the requested start, which makes every operation a map search.
+ *
+ * The total size of the ranges is bounded by a byte budget, the least recently used
+ * ranges are evicted first. The cache doesn't own the values, the removed values are
+ * returned to the caller, which releases them outside of its lock. The caller must
+ * serialize all calls.
+ */
+template <typename T> class RangeCache {
+ public:
+  struct Stats {
+    uint64_t hits_ = 0;           //!< Lookups which found a containing range
+    uint64_t misses_ = 0;         //!< Lookups which didn't find a range
+    uint64_t evictions_ = 0;      //!< Ranges removed for the budget or by a larger range
+    uint64_t invalidations_ = 0;  //!< Ranges removed by invalidate()
+  };
+
+  RangeCache(size_t budget, size_t pageSize) : budget_(budget), pageSize_(pageSize), size_(0) {}
+
+  //! Finds a range containing [start, start + size) and marks it as the most recently used
+  bool find(const void* start, size_t size, T* value, uintptr_t* base) {
+    const uintptr_t first = alignDown(reinterpret_cast<uintptr_t>(start));
+    const uintptr_t last = alignUp(reinterpret_cast<uintptr_t>(start) + size);
+    auto it = ranges_.upper_bound(first);
+    if ((it != ranges_.begin()) && (std::prev(it)->second.end_ >= last)) {
+      --it;
+      lru_.splice(lru_.begin(), lru_, it->second.lru_);
+      *value = it->second.value_;
+      *base = it->first;
+      ++stats_.hits_;
+      return true;
+    }
+    ++stats_.misses_;
+    return false;
+  }
+
+  /*! \brief Inserts the value of the page aligned range [start, start + size).
+   *
+   * Returns false if the range is already covered or exceeds the budget, then the caller
+   * keeps the value. Otherwise the contained and the least recently used ranges are
+   * removed and their values are appended to \a removed.
+   */
+  bool insert(const void* start, size_t size, T value, std::vector<T>* removed) {
+    const uintptr_t first = alignDown(reinterpret_cast<uintptr_t>(start));
+    const uintptr_t last = alignUp(reinterpret_cast<uintptr_t>(start) + size);
+    if ((last - first) > budget_) {
+      return false;
+    }
+    auto it = ranges_.upper_bound(first);
+    if ((it != ranges_.begin()) && (std::prev(it)->second.end_ >= last)) {
+      return false;
+    }
+    // The contained ranges start inside the new range and end before it
+    it = ranges_.lower_bound(first);
+    while ((it != ranges_.end()) && (it->first < last) && (it->second.end_ <= last)) {
+      ++stats_.evictions_;
+      it = erase(it, removed);
+    }
+    lru_.push_front(first);
+    ranges_.emplace(first, Range{last, value, lru_.begin()});
+    size_ += last - first;
+    while (size_ > budget_) {
+      ++stats_.evictions_;
+      erase(ranges_.find(lru_.back()), removed);
+    }
+    return true;
+  }
+
+  //! Removes all ranges overlapping [start, start + size), their values are appended
+  //! to \a removed
+  void invalidate(const void* start, size_t size, std::vector<T>* removed) {
+    const uintptr_t first = reinterpret_cast<uintptr_t>(start);
+    const uintptr_t last = first + size;
+    // The ends grow with the starts, so walk back from the last range starting before last
+    auto it = ranges_.lower_bound(last);
+    while ((it != ranges_.begin()) && (std::prev(it)->second.end_ > first)) {
+      ++stats_.invalidations_;
+      it = erase(std::prev(it), removed);
+    }
+  }
+
+  //! Removes all ranges, their values are appended to \a removed
+  void clear(std::vector<T>* removed) {
+    for (const auto& it : ranges_) {
+      removed->push_back(it.second.value_);
+    }
+    ranges_.clear();
+    lru_.clear();
+    size_ = 0;
+  }
+
+  size_t budget() const { return budget_; }
+  size_t size() const { return size_; }
+  size_t count() const { return ranges_.size(); }
+  const Stats& stats() const { return stats_; }
+
+ private:
+  struct Range {
+    uintptr_t end_;                               //!< The end of the range
+    T value_;                                     //!< The cached value
+    typename std::list<uintptr_t>::iterator lru_;  //!< The position in the LRU list
+  };
+
+  uintptr_t alignDown(uintptr_t value) const { return value - value % pageSize_; }
+  uintptr_t alignUp(uintptr_t value) const { return alignDown(value + pageSize_ - 1); }
+
+  typename std::map<uintptr_t, Range>::iterator erase(
+      typename std::map<uintptr_t, Range>::iterator it, std::vector<T>* removed) {
+    removed->push_back(it->second.value_);
+    size_ -= it->second.end_ - it->first;
+    lru_.erase(it->second.lru_);
+    return ranges_.erase(it);
+  }
+
+  const size_t budget_;                //!< The max total size of the ranges
+  const size_t pageSize_;              //!< The alignment of the ranges
+  size_t size_;                        //!< The total size of the ranges
+  std::map<uintptr_t, Range> ranges_;  //!< The ranges ordered by the start
+  std::list<uintptr_t> lru_;           //!< The range starts, most recently used first
+  Stats stats_;
+};
+
+/*@}*/
+
+}  // namespace amd
+
+#endif /*RANGECACHE_HPP_*/
@@ -0,0 +1,433 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#ifndef RANGEINDEX_HPP_
+#define RANGEINDEX_HPP_
+
+#include "top.hpp"
+
+#include <atomic>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <vector>
+
+//! \addtogroup Utils
+
+namespace amd { /*@{*/
+
+/*! \brief A concurrent address range index.
+ *
+ * Maps non-overlapping [base, base + size) ranges of the virtual address space
+ * to values. The index is a 3-level radix table over a 48-bit VA space with
+ * 4KB granules. A range is recorded in the highest level slot it fully covers,
+ * so large allocations only touch a handful of slots.
+ *
+ * Lookups are lock-free. Range records live in type-stable memory (they are
+ * recycled but never returned to the system until the index is destroyed) and
+ * are protected by a sequence counter, so a reader either sees a consistent
+ * snapshot of a live range or retries through the slow path. The radix nodes
+ * which become empty are unlinked and recycled the same way. A small per-thread
+ * lookaside cache of recent hits skips the radix walk for hot pointers.
+ *
+ * Updates (insert/erase) must be serialized by the caller. When more than one
+ * range touches a slot (partially covered granules, or overlapping ranges) the
+ * slot is marked as shared and find() reports Unknown, so the caller must
+ * fall back to its own authoritative container under its lock.
+ */
+template <typename T> class ConcurrentRangeIndex {
+ public:
+  //! Result of a lock-free lookup
+  enum class Lookup {
+    Miss,    //!< No range contains the key
+    Hit,     //!< A range containing the key was found
+    Unknown  //!< The index can't decide, the caller must use the slow path
+  };
+
+ private:
+  static constexpr uint kGranuleShift = 12;  //!< 4KB leaf granules
+  static constexpr uint kLevelBits = 12;     //!< 4096 slots per node
+  static constexpr uint kLevels = 3;         //!< Covers 48 bits of VA
+  static constexpr uint kVaBits = kGranuleShift + kLevelBits * kLevels;
+  static constexpr uint kSlots = 1u << kLevelBits;
+  static constexpr uint kLookasideSize = 4;  //!< Per-thread cache entries
+
+  //! Slot encoding
+  static constexpr uintptr_t kEmpty = 0;
+  static constexpr uintptr_t kChild = 0x1;   //!< Tag for a child node pointer
+  static constexpr uintptr_t kShared = 0x2;  //!< Slot is touched by several ranges
+  static constexpr uintptr_t kTagMask = 0x3;
+
+  //! A range record, protected by a sequence lock
+  struct Range {
+    std::atomic<uint64_t> seq_{0};  //!< Odd while the record is being written
+    std::atomic<uintptr_t> base_{0};
+    std::atomic<size_t> size_{0};
+    std::atomic<T*> value_{nullptr};
+    Range* nextFree_ = nullptr;     //!< Free list link, writer side only
+  };
+
+  //! A radix table node
+  struct Node {
+    std::atomic<uintptr_t> slots_[kSlots] = {};
+    uint used_ = 0;  //!< The number of non-empty slots, writer side only
+  };
+
+  //! A per-thread cached hit
+  struct LookasideEntry {
+    uint64_t owner_ = 0;  //!< Id of the index which produced the entry
+    const Range* range_ = nullptr;
+    uint64_t seq_ = 0;
+    uintptr_t base_ = 0;
+    size_t size_ = 0;
+    T* value_ = nullptr;
+  };
+
+  struct Lookaside {
+    LookasideEntry entries_[kLookasideSize];
+    uint next_ = 0;
+  };
+
+  const uint64_t id_;                                //!< Unique id for the lookaside cache
+  Node* root_;                                       //!< Top level radix node
+  std::map<uintptr_t, Range*> ranges_;               //!< Writer side view of the ranges
+  std::vector<std::unique_ptr<Range[]>> rangePool_;  //!< Type-stable range storage
+  Range* freeRanges_ = nullptr;                      //!< Recycled range records
+  std::vector<Node*> freeNodes_;                     //!< Recycled empty radix nodes
+  size_t numNodes_ = 1;                              //!< The allocated radix nodes
+
+  static constexpr uint kRangeBlockSize = 256;
+
+  //! Returns the number of VA bits covered by one slot at the given level
+  static constexpr uint slotShift(uint level) {
+    return kGranuleShift + kLevelBits * (kLevels - 1 - level);
+  }
+
+  static uint slotIndex(uintptr_t addr, uint level) {
+    return (addr >> slotShift(level)) & (kSlots - 1);
+  }
+
+  static uint64_t nextId() {
+    static std::atomic<uint64_t> id{0};
+    return ++id;
+  }
+
+  static Lookaside& lookaside() {
+    static thread_local Lookaside cache;
+    return cache;
+  }
+
+  //! Takes a consistent snapshot of a range record
+  static bool snapshot(const Range* range, uint64_t* seq, uintptr_t* base, size_t* size,
+                       T** value) {
+    uint64_t s1 = range->seq_.load(std::memory_order_acquire);
+    if (s1 & 1) {
+      return false;
+    }
+    *base = range->base_.load(std::memory_order_relaxed);
+    *size = range->size_.load(std::memory_order_relaxed);
+    *value = range->value_.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    *seq = s1;
+    return s1 == range->seq_.load(std::memory_order_relaxed);
+  }
+
+  //! Rewrites a range record under its sequence lock
+  static void publish(Range* range, uintptr_t base, size_t size, T* value) {
+    uint64_t seq = range->seq_.load(std::memory_order_relaxed);
+    range->seq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    range->base_.store(base, std::memory_order_relaxed);
+    range->size_.store(size, std::memory_order_relaxed);
+    range->value_.store(value, std::memory_order_relaxed);
+    range->seq_.store(seq + 2, std::memory_order_release);
+  }
+
+  Range* allocRange() {
+    if (freeRanges_ == nullptr) {
+      rangePool_.emplace_back(new Range[kRangeBlockSize]);
+      Range* block = rangePool_.back().get();
+      for (uint i = 0; i < kRangeBlockSize; ++i) {
+        block[i].nextFree_ = freeRanges_;
+        freeRanges_ = &block[i];
+      }
+    }
+    Range* range = freeRanges_;
+    freeRanges_ = range->nextFree_;
+    return range;
+  }
+
+  void freeRange(Range* range) {
+    // Invalidate the record for readers still holding it
+    publish(range, 0, 0, nullptr);
+    range->nextFree_ = freeRanges_;
+    freeRanges_ = range;
+  }
+
+  //! Returns an empty radix node
+  Node* allocNode() {
+    if (freeNodes_.empty()) {
+      ++numNodes_;
+      return new Node();
+    }
+    Node* node = freeNodes_.back();
+    freeNodes_.pop_back();
+    return node;
+  }
+
+  void insertRange(Node* node, uint level, uintptr_t nodeBase, uintptr_t begin, uintptr_t end,
+                   Range* range);
+  void eraseRange(Node* node, uint level, uintptr_t nodeBase, uintptr_t begin, uintptr_t end,
+                  const Range* range);
+  //! Re-evaluates a shared slot after a range was removed from ranges_
+  void resolveShared(std::atomic<uintptr_t>& slot, uint level, uintptr_t lo, uintptr_t hi);
+  static void destroyNode(Node* node, uint level);
+
+ public:
+  ConcurrentRangeIndex() : id_(nextId()), root_(new Node()) {}
+  ~ConcurrentRangeIndex() {
+    destroyNode(root_, 0);
+    for (auto node : freeNodes_) {
+      delete node;
+    }
+  }
+
+  ConcurrentRangeIndex(const ConcurrentRangeIndex&) = delete;
+  ConcurrentRangeIndex& operator=(const ConcurrentRangeIndex&) = delete;
+
+  //! Adds a range to the index. Must be serialized with other updates.
+  void insert(const void* base, size_t size, T* value);
+
+  //! Removes the range starting at base. Must be serialized with other updates.
+  void erase(const void* base);
+
+  //! Lock-free lookup of the range containing key
+  Lookup find(const void* key, T** value, size_t* offset = nullptr) const;
+
+  //! Returns the number of allocated radix nodes, in use or recycled
+  size_t numNodes() const { return numNodes_; }
+};
+
+/*@}*/
+
+template <typename T>
+void ConcurrentRangeIndex<T>::insertRange(Node* node, uint level, uintptr_t nodeBase,
+                                          uintptr_t begin, uintptr_t end, Range* range) {
+  const uint shift = slotShift(level);
+  const uint first = static_cast<uint>((begin - nodeBase) >> shift);
+  const uint last = static_cast<uint>((end - 1 - nodeBase) >> shift);
+  for (uint i = first; i <= last; ++i) {
+    std::atomic<uintptr_t>& slot = node->slots_[i];
+    const uintptr_t lo = nodeBase + (static_cast<uintptr_t>(i) << shift);
+    const uintptr_t hi = lo + (static_cast<uintptr_t>(1) << shift);
+    const uintptr_t value = slot.load(std::memory_order_relaxed);
+    if (value & kChild) {
+      insertRange(reinterpret_cast<Node*>(value & ~kTagMask), level + 1, lo,
+                  std::max(begin, lo), std::min(end, hi), range);
+    } else if (value == kShared) {
+      continue;
+    } else if ((begin <= lo && end >= hi) || (level == kLevels - 1)) {
+      slot.store((value == kEmpty) ? reinterpret_cast<uintptr_t>(range) : kShared,
+                 std::memory_order_release);
+    } else if (value == kEmpty) {
+      // Partially covered slot, build the child fully before it becomes visible
+      Node* child = allocNode();
+      insertRange(child, level + 1, lo, std::max(begin, lo), std::min(end, hi), range);
+      slot.store(reinterpret_cast<uintptr_t>(child) | kChild, std::memory_order_release);
+    } else {
+      // Overlaps a range that covers the whole slot
+      slot.store(kShared, std::memory_order_release);
+    }
+    if (value == kEmpty) {
+      ++node->used_;
+    }
+  }
+}
+
+template <typename T>
+void ConcurrentRangeIndex<T>::eraseRange(Node* node, uint level, uintptr_t nodeBase,
+                                         uintptr_t begin, uintptr_t end, const Range* range) {
+  const uint shift = slotShift(level);
+  const uint first = static_cast<uint>((begin - nodeBase) >> shift);
+  const uint last = static_cast<uint>((end - 1 - nodeBase) >> shift);
+  for (uint i = first; i <= last; ++i) {
+    std::atomic<uintptr_t>& slot = node->slots_[i];
+    const uintptr_t lo = nodeBase + (static_cast<uintptr_t>(i) << shift);
+    const uintptr_t hi = lo + (static_cast<uintptr_t>(1) << shift);
+    const uintptr_t value = slot.load(std::memory_order_relaxed);
+    if (value & kChild) {
+      Node* child = reinterpret_cast<Node*>(value & ~kTagMask);
+      eraseRange(child, level + 1, lo, std::max(begin, lo), std::min(end, hi), range);
+      if (child->used_ == 0) {
+        // Readers may still walk the child, so it's recycled, but not freed
+        slot.store(kEmpty, std::memory_order_release);
+        freeNodes_.push_back(child);
+      }
+    } else if (value == reinterpret_cast<uintptr_t>(range)) {
+      slot.store(kEmpty, std::memory_order_release);
+    } else if (value == kShared) {
+      resolveShared(slot, level, lo, hi);
+    }
+    if ((value != kEmpty) && (slot.load(std::memory_order_relaxed) == kEmpty)) {
+      --node->used_;
+    }
+  }
+}
+
+template <typename T>
+void ConcurrentRangeIndex<T>::resolveShared(std::atomic<uintptr_t>& slot, uint level,
+                                            uintptr_t lo, uintptr_t hi) {
+  // Find up to two ranges which still overlap [lo, hi)
+  Range* found = nullptr;
+  uint count = 0;
+  auto it = ranges_.upper_bound(lo);
+  if (it != ranges_.begin()) {
+    --it;
+  }
+  for (; it != ranges_.end() && it->first < hi && count < 2; ++it) {
+    uintptr_t rangeEnd = it->first + it->second->size_.load(std::memory_order_relaxed);
+    if (rangeEnd > lo) {
+      found = it->second;
+      ++count;
+    }
+  }
+  if (count == 0) {
+    slot.store(kEmpty, std::memory_order_release);
+  } else if (count == 1) {
+    uintptr_t base = found->base_.load(std::memory_order_relaxed);
+    uintptr_t rangeEnd = base + found->size_.load(std::memory_order_relaxed);
+    if ((level == kLevels - 1) || (base <= lo && rangeEnd >= hi)) {
+      slot.store(reinterpret_cast<uintptr_t>(found), std::memory_order_release);
+    }
+  }
+}
+
+template <typename T> void ConcurrentRangeIndex<T>::destroyNode(Node* node, uint level) {
+  for (uint i = 0; i < kSlots; ++i) {
+    uintptr_t value = node->slots_[i].load(std::memory_order_relaxed);
+    if (value & kChild) {
+      destroyNode(reinterpret_cast<Node*>(value & ~kTagMask), level + 1);
+    }
+  }
+  delete node;
+}
+
+template <typename T>
+void ConcurrentRangeIndex<T>::insert(const void* base, size_t size, T* value) {
+  uintptr_t begin = reinterpret_cast<uintptr_t>(base);
+  if (size == 0 || ranges_.find(begin) != ranges_.end()) {
+    return;
+  }
+  Range* range = allocRange();
+  publish(range, begin, size, value);
+  ranges_.insert({begin, range});
+
+  uintptr_t end = begin + size;
+  const uintptr_t limit = static_cast<uintptr_t>(1) << kVaBits;
+  if (begin < limit) {
+    insertRange(root_, 0, 0, begin, std::min(end, limit), range);
+  }
+}
+
+template <typename T> void ConcurrentRangeIndex<T>::erase(const void* base) {
+  auto it = ranges_.find(reinterpret_cast<uintptr_t>(base));
+  if (it == ranges_.end()) {
+    return;
+  }
+  Range* range = it->second;
+  ranges_.erase(it);
+
+  uintptr_t begin = range->base_.load(std::memory_order_relaxed);
+  uintptr_t end = begin + range->size_.load(std::memory_order_relaxed);
+  const uintptr_t limit = static_cast<uintptr_t>(1) << kVaBits;
+  if (begin < limit) {
+    eraseRange(root_, 0, 0, begin, std::min(end, limit), range);
+  }
+  freeRange(range);
+}
+
+template <typename T>
+typename ConcurrentRangeIndex<T>::Lookup ConcurrentRangeIndex<T>::find(const void* key,
+                                                                       T** value,
+                                                                       size_t* offset) const {
+  const uintptr_t addr = reinterpret_cast<uintptr_t>(key);
+  if ((addr >> kVaBits) != 0) {
+    return Lookup::Unknown;
+  }
+
+  // Check the recent hits of this thread first
+  Lookaside& cache = lookaside();
+  for (const auto& entry : cache.entries_) {
+    if (entry.owner_ == id_ && (addr - entry.base_) < entry.size_ &&
+        entry.range_->seq_.load(std::memory_order_acquire) == entry.seq_) {
+      *value = entry.value_;
+      if (offset != nullptr) {
+        *offset = addr - entry.base_;
+      }
+      return Lookup::Hit;
+    }
+  }
+
+  const Node* node = root_;
+  for (uint level = 0; level < kLevels; ++level) {
+    const uintptr_t slot = node->slots_[slotIndex(addr, level)].load(std::memory_order_acquire);
+    if (slot == kEmpty) {
+      return Lookup::Miss;
+    }
+    if (slot == kShared) {
+      return Lookup::Unknown;
+    }
+    if (slot & kChild) {
+      node = reinterpret_cast<const Node*>(slot & ~kTagMask);
+      continue;
+    }
+
+    const Range* range = reinterpret_cast<const Range*>(slot);
+    uint64_t seq;
+    uintptr_t base;
+    size_t size;
+    T* found;
+    // A torn snapshot or a key outside the range means the record was recycled
+    // (or the granule is only partially covered), so let the caller decide
+    if (!snapshot(range, &seq, &base, &size, &found) || (addr - base) >= size) {
+      return Lookup::Unknown;
+    }
+
+    LookasideEntry& entry = cache.entries_[cache.next_];
+    cache.next_ = (cache.next_ + 1) % kLookasideSize;
+    entry.owner_ = id_;
+    entry.range_ = range;
+    entry.seq_ = seq;
+    entry.base_ = base;
+    entry.size_ = size;
+    entry.value_ = found;
+
+    *value = found;
+    if (offset != nullptr) {
+      *offset = addr - base;
+    }
+    return Lookup::Hit;
+  }
+  return Lookup::Unknown;
+}
+
+}  // namespace amd
+
+#endif /*RANGEINDEX_HPP_*/
@@ -0,0 +1,310 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+#ifndef RECORDBUFFER_HPP_
+#define RECORDBUFFER_HPP_
+
+#include "top.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//! \addtogroup Utils
+
+namespace amd { /*@{*/
+
+/*! \brief Per-thread buffers of records, delivered in batches.
+ *
+ * Every producer thread appends the records to its own chunk without a lock, a record is
+ * published with a release store of the chunk count. The lock is taken only when a thread
+ * exchanges a full chunk. flush() delivers the published records of every chunk as one
+ * batch per chunk and recycles the full chunks, which were delivered. It runs on the
+ * delivery thread every flushMs_ milliseconds, on the producer when all chunks are in use
+ * and on demand. A record, which doesn't find a chunk after the inline flush, is dropped.
+ * The records of a thread are delivered in order.
+ *
+ * A record can reserve extra bytes in the chunk, for example a copy of a string, which the
+ * record refers to. The extra data stays valid until the batch is delivered.
+ */
+template <typename T> class RecordBuffer {
+ public:
+  struct Options {
+    uint32_t chunkRecords_ = 1024;      //!< The number of records per chunk
+    uint32_t chunkBytes_ = 64 * 1024;   //!< The size of the extra data per chunk
+    uint32_t maxChunks_ = 64;           //!< The max number of chunks of all threads
+    uint32_t flushMs_ = 0;              //!< The delivery interval, 0 without a thread
+  };
+
+  struct Stats {
+    uint64_t delivered_;  //!< The number of delivered records
+    uint64_t batches_;    //!< The number of delivered batches
+    uint64_t stalls_;     //!< The number of inline flushes without a free chunk
+    uint64_t dropped_;    //!< The number of dropped records
+    uint64_t chunks_;     //!< The number of allocated chunks
+  };
+
+  //! The callback of a batch of records
+  using Deliver = std::function<void(const T* records, size_t count)>;
+
+  RecordBuffer(const Options& options, Deliver deliver)
+      : state_(std::make_shared<State>(options, std::move(deliver))), stop_(false) {
+    if (options.flushMs_ != 0) {
+      thread_ = std::thread([this]() { run(); });
+    }
+  }
+
+  //! Stops the delivery thread and delivers the remaining records
+  ~RecordBuffer() {
+    stop();
+    state_->flush();
+  }
+
+  //! Stops the delivery thread, the records are delivered only with flush() afterwards
+  void stop() {
+    if (thread_.joinable()) {
+      {
+        std::lock_guard<std::mutex> lock(threadLock_);
+        stop_ = true;
+      }
+      wakeup_.notify_one();
+      thread_.join();
+    }
+  }
+
+  /*! \brief Appends a record.
+   *
+   * \a fill initializes the record and the extra data with the signature
+   * fill(T* record, char* extra), extra is nullptr if \a extraBytes is 0.
+   * Returns false if the record was dropped.
+   */
+  template <typename Fill> bool append(size_t extraBytes, Fill&& fill) {
+    Holder& holder = current();
+    if (holder.state_ != state_) {
+      // The thread appended to another buffer before
+      holder.release();
+      holder.state_ = state_;
+    }
+    Chunk* chunk = holder.chunk_;
+    uint32_t count = (chunk != nullptr) ? chunk->count_.load(std::memory_order_relaxed) : 0;
+    if ((chunk == nullptr) || (count == state_->options_.chunkRecords_) ||
+        (chunk->extraUsed_ + extraBytes > state_->options_.chunkBytes_)) {
+      chunk = state_->exchange(chunk, extraBytes);
+      holder.chunk_ = chunk;
+      if (chunk == nullptr) {
+        state_->dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+      count = 0;
+    }
+    char* extra = nullptr;
+    if (extraBytes != 0) {
+      extra = chunk->extra_.get() + chunk->extraUsed_;
+      chunk->extraUsed_ += static_cast<uint32_t>(extraBytes);
+    }
+    fill(&chunk->records_[count], extra);
+    chunk->count_.store(count + 1, std::memory_order_release);
+    return true;
+  }
+
+  //! Delivers all published records
+  void flush() { state_->flush(); }
+
+  Stats stats() const {
+    return {state_->delivered_.load(std::memory_order_relaxed),
+            state_->batches_.load(std::memory_order_relaxed),
+            state_->stalls_.load(std::memory_order_relaxed),
+            state_->dropped_.load(std::memory_order_relaxed),
+            state_->chunks_.load(std::memory_order_relaxed)};
+  }
+
+ private:
+  struct Chunk {
+    explicit Chunk(const Options& options)
+        : records_(new T[options.chunkRecords_]),
+          extra_(new char[options.chunkBytes_]),
+          count_(0),
+          extraUsed_(0),
+          consumed_(0),
+          retired_(false) {}
+
+    std::unique_ptr<T[]> records_;   //!< The records
+    std::unique_ptr<char[]> extra_;  //!< The extra data of the records
+    std::atomic<uint32_t> count_;    //!< The number of published records
+    uint32_t extraUsed_;             //!< The used extra bytes, owned by the producer
+    uint32_t consumed_;              //!< The number of delivered records, owned by flush()
+    bool retired_;                   //!< The producer released the chunk, under lock_
+  };
+
+  //! The chunks, shared with the thread holders, which can outlive the buffer
+  struct State {
+    State(const Options& options, Deliver deliver)
+        : options_(options),
+          deliver_(std::move(deliver)),
+          delivered_(0),
+          batches_(0),
+          stalls_(0),
+          dropped_(0),
+          chunks_(0) {}
+
+    //! Retires the chunk of the thread and returns a new chunk or nullptr
+    Chunk* exchange(Chunk* chunk, size_t extraBytes) {
+      if (extraBytes > options_.chunkBytes_) {
+        retire(chunk);
+        return nullptr;
+      }
+      std::unique_lock<std::mutex> lock(lock_);
+      if (chunk != nullptr) {
+        chunk->retired_ = true;
+      }
+      chunk = take();
+      if (chunk == nullptr) {
+        // Backpressure, deliver on the producer to recycle the retired chunks
+        lock.unlock();
+        stalls_.fetch_add(1, std::memory_order_relaxed);
+        flush();
+        lock.lock();
+        chunk = take();
+      }
+      return chunk;
+    }
+
+    void retire(Chunk* chunk) {
+      if (chunk != nullptr) {
+        std::lock_guard<std::mutex> lock(lock_);
+        chunk->retired_ = true;
+      }
+    }
+
+    //! Returns a free or a new chunk, under lock_
+    Chunk* take() {
+      Chunk* chunk = nullptr;
+      if (!free_.empty()) {
+        chunk = free_.back();
+        free_.pop_back();
+      } else if (all_.size() < options_.maxChunks_) {
+        all_.emplace_back(new Chunk(options_));
+        chunks_.fetch_add(1, std::memory_order_relaxed);
+        chunk = all_.back().get();
+      } else {
+        return nullptr;
+      }
+      used_.push_back(chunk);
+      return chunk;
+    }
+
+    void flush() {
+      std::lock_guard<std::mutex> flushLock(flushLock_);
+      {
+        std::lock_guard<std::mutex> lock(lock_);
+        snapshot_ = used_;
+      }
+      for (Chunk* chunk : snapshot_) {
+        const uint32_t count = chunk->count_.load(std::memory_order_acquire);
+        if (count > chunk->consumed_) {
+          deliver_(&chunk->records_[chunk->consumed_], count - chunk->consumed_);
+          delivered_.fetch_add(count - chunk->consumed_, std::memory_order_relaxed);
+          batches_.fetch_add(1, std::memory_order_relaxed);
+          chunk->consumed_ = count;
+        }
+      }
+      // Only flush() recycles the chunks, so the snapshot stays valid. The used chunks stay
+      // in the order of take(), so the records of a thread are delivered in order
+      std::lock_guard<std::mutex> lock(lock_);
+      size_t kept = 0;
+      for (Chunk* chunk : used_) {
+        if (chunk->retired_ &&
+            (chunk->consumed_ == chunk->count_.load(std::memory_order_relaxed))) {
+          chunk->count_.store(0, std::memory_order_relaxed);
+          chunk->extraUsed_ = 0;
+          chunk->consumed_ = 0;
+          chunk->retired_ = false;
+          free_.push_back(chunk);
+        } else {
+          used_[kept++] = chunk;
+        }
+      }
+      used_.resize(kept);
+    }
+
+    const Options options_;
+    Deliver deliver_;
+    std::mutex lock_;                          //!< Protects the chunk lists
+    std::mutex flushLock_;                     //!< Serializes the delivery
+    std::vector<std::unique_ptr<Chunk>> all_;  //!< All allocated chunks
+    std::vector<Chunk*> used_;                 //!< The chunks of the threads and retired ones
+    std::vector<Chunk*> free_;                 //!< The recycled chunks
+    std::vector<Chunk*> snapshot_;             //!< The chunks of the current flush()
+    std::atomic<uint64_t> delivered_;
+    std::atomic<uint64_t> batches_;
+    std::atomic<uint64_t> stalls_;
+    std::atomic<uint64_t> dropped_;
+    std::atomic<uint64_t> chunks_;
+  };
+
+  //! The chunk of a thread, retired at the thread exit
+  struct Holder {
+    ~Holder() { release(); }
+    void release() {
+      if (state_ != nullptr) {
+        state_->retire(chunk_);
+      }
+      state_.reset();
+      chunk_ = nullptr;
+    }
+    std::shared_ptr<State> state_;
+    Chunk* chunk_ = nullptr;
+  };
+
+  static Holder& current() {
+    thread_local Holder holder;
+    return holder;
+  }
+
+  void run() {
+    const auto interval = std::chrono::milliseconds(state_->options_.flushMs_);
+    std::unique_lock<std::mutex> lock(threadLock_);
+    while (!stop_) {
+      wakeup_.wait_for(lock, interval, [this]() { return stop_; });
+      lock.unlock();
+      state_->flush();
+      lock.lock();
+    }
+  }
+
+  std::shared_ptr<State> state_;
+  std::thread thread_;                //!< The delivery thread
+  std::mutex threadLock_;
+  std::condition_variable wakeup_;
+  bool stop_;
+};
+
+/*@}*/
+
+}  // namespace amd
+
+#endif /*RECORDBUFFER_HPP_*/
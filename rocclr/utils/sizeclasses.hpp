@@ -0,0 +1,89 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#ifndef SIZECLASSES_HPP_
+#define SIZECLASSES_HPP_
+
+#include "top.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+//! \addtogroup Utils
+
+namespace amd { /*@{*/
+
+/*! \brief The segregated size classes of a slab suballocator.
+ *
+ * There are up to 4 classes per power of two from the minimal block size up to the maximal
+ * size. The steps between the classes are never smaller than the minimal size, so a request
+ * above 4 minimal sizes is rounded up by less than 25%. All block sizes are multiples of the
+ * minimal size, hence the blocks, carved back to back from an aligned slab, keep the
+ * alignment of the minimal size. The blocks of a class are reused as a whole and never
+ * split or coalesced. A slab holds at least kMinBlocksPerSlab blocks.
+ */
+class SizeClasses {
+ public:
+  static constexpr size_t kClassesPerPow2 = 4;     //!< Classes per power of two
+  static constexpr size_t kMinBlocksPerSlab = 8;   //!< Minimal blocks of a slab
+
+  //! Builds the classes for the allocations up to \a maxSize, 0 leaves the table empty
+  void init(size_t minSize, size_t maxSize, size_t slabSize) {
+    sizes_.clear();
+    slabSize_ = slabSize;
+    for (size_t pow2 = minSize; pow2 <= maxSize; pow2 <<= 1) {
+      const size_t step = std::max(pow2 / kClassesPerPow2, minSize);
+      for (size_t size = pow2; (size < 2 * pow2) && (size <= maxSize); size += step) {
+        sizes_.push_back(size);
+      }
+    }
+  }
+
+  //! Returns true if \a size is served by a class
+  bool contains(size_t size) const { return !sizes_.empty() && (size <= sizes_.back()); }
+
+  //! Returns the number of classes
+  uint32_t count() const { return static_cast<uint32_t>(sizes_.size()); }
+
+  //! Returns the smallest class, which fits \a size
+  uint32_t classOf(size_t size) const {
+    return static_cast<uint32_t>(std::lower_bound(sizes_.begin(), sizes_.end(), size) -
+                                 sizes_.begin());
+  }
+
+  //! Returns the block size of a class
+  size_t size(uint32_t index) const { return sizes_[index]; }
+
+  //! Returns the size of a new slab of a class
+  size_t slabSize(uint32_t index) const {
+    return std::max(slabSize_, sizes_[index] * kMinBlocksPerSlab);
+  }
+
+ private:
+  std::vector<size_t> sizes_;  //!< Block sizes of all classes in ascending order
+  size_t slabSize_ = 0;        //!< The default slab size
+};
+
+/*@}*/
+
+}  // namespace amd
+
+#endif /*SIZECLASSES_HPP_*/
@@ -0,0 +1,335 @@
+/* Copyright (c) 2010 - 2021 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+#ifndef SLABALLOCATOR_HPP_
+#define SLABALLOCATOR_HPP_
+
+#include "top.hpp"
+#include "os/alloc.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <vector>
+
+//! \addtogroup Utils
+
+namespace amd { /*@{*/
+
+/*! \brief A size class allocator of small runtime objects with per-thread magazines.
+ *
+ * The sizes up to kMaxSize are rounded up to a size class, 64 byte steps up to 1 KB and
+ * 256 byte steps above. Every thread keeps a free list per class, the allocations and frees
+ * are served from it without atomic read-modify-write operations. A thread moves a
+ * magazine of objects to the depot of the class when its list grows above two magazines,
+ * and takes one from the depot when the list is empty. So an object can be freed on any
+ * thread: the objects freed on a completion thread return to the submitting threads. The
+ * depot carves the objects from slabs, which are never released. The per-thread counters
+ * give the number of live objects per class, which shows the occupancy and the leaks.
+ * Larger objects go to the global operator new.
+ */
+class SlabAllocator : public AllStatic {
+ public:
+  static constexpr size_t kAlign = 64;              //!< The alignment of all objects
+  static constexpr size_t kMaxSize = 4 * 1024;      //!< The largest size class
+  static constexpr size_t kMagazineBytes = 16 * 1024;  //!< The target size of a magazine
+  static constexpr size_t kNumClasses = 16 + (kMaxSize - 1024) / 256;
+
+  //! The statistics of a size class
+  struct Stats {
+    size_t size_;         //!< The object size of the class
+    uint64_t allocated_;  //!< The number of allocations
+    uint64_t freed_;      //!< The number of frees
+    uint64_t reserved_;   //!< The number of objects carved from the slabs
+  };
+
+  //! Returns the size class of a size up to kMaxSize
+  static size_t classOf(size_t size) {
+    return (size <= 1024) ? ((std::max<size_t>(size, 1) - 1) / 64)
+                          : (16 + (size - 1024 - 1) / 256);
+  }
+
+  //! Returns the object size of a class
+  static size_t classSize(size_t index) {
+    return (index < 16) ? ((index + 1) * 64) : (1024 + (index - 15) * 256);
+  }
+
+  static void* allocate(size_t size) {
+    if (size > kMaxSize) {
+      return ::operator new(size);
+    }
+    const size_t index = classOf(size);
+    Caches* caches = Caches::local();
+    if (caches == nullptr) {
+      return allocateExited(index);
+    }
+    Cache& cache = caches->cache_[index];
+    if (cache.free_ == nullptr) {
+      cache.count_ = depot(index).take(&cache.free_);
+      if (cache.free_ == nullptr) {
+        throw std::bad_alloc();
+      }
+    }
+    FreeNode* node = cache.free_;
+    cache.free_ = node->next_;
+    --cache.count_;
+    cache.allocated_.store(cache.allocated_.load(std::memory_order_relaxed) + 1,
+                           std::memory_order_relaxed);
+    return node;
+  }
+
+  //! Frees an object of any thread, \a size must match the allocation
+  static void deallocate(void* ptr, size_t size) {
+    if (ptr == nullptr) {
+      return;
+    }
+    if (size > kMaxSize) {
+      ::operator delete(ptr);
+      return;
+    }
+    const size_t index = classOf(size);
+    FreeNode* node = static_cast<FreeNode*>(ptr);
+    Caches* caches = Caches::local();
+    if (caches == nullptr) {
+      // The thread exit hook ran, the object goes straight to the depot
+      node->next_ = nullptr;
+      depot(index).retire(node, 0, 1);
+      return;
+    }
+    Cache& cache = caches->cache_[index];
+    node->next_ = cache.free_;
+    cache.free_ = node;
+    cache.freed_.store(cache.freed_.load(std::memory_order_relaxed) + 1,
+                       std::memory_order_relaxed);
+    const size_t magazine = magazineSize(index);
+    if (++cache.count_ >= 2 * magazine) {
+      // Keep the most recently freed objects, they are likely in the cache
+      FreeNode* last = cache.free_;
+      for (size_t i = 1; i < magazine; ++i) {
+        last = last->next_;
+      }
+      depot(index).give(last->next_);
+      last->next_ = nullptr;
+      cache.count_ = magazine;
+    }
+  }
+
+  //! Returns the statistics of all classes, the counters of the running threads are read
+  //! without a synchronization with their allocations
+  static void stats(Stats (&out)[kNumClasses]) {
+    for (size_t i = 0; i < kNumClasses; ++i) {
+      Depot& d = depot(i);
+      std::lock_guard<std::mutex> lock(d.lock_);
+      out[i] = {classSize(i), d.allocated_, d.freed_, d.reserved_};
+    }
+    Registry& registry = Registry::get();
+    std::lock_guard<std::mutex> lock(registry.lock_);
+    for (const Caches* caches : registry.threads_) {
+      for (size_t i = 0; i < kNumClasses; ++i) {
+        out[i].allocated_ += caches->cache_[i].allocated_.load(std::memory_order_relaxed);
+        out[i].freed_ += caches->cache_[i].freed_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+ private:
+  struct FreeNode {
+    FreeNode* next_;
+  };
+
+  //! The number of objects in a magazine of the class
+  static size_t magazineSize(size_t index) {
+    return std::min<size_t>(64, std::max<size_t>(8, kMagazineBytes / classSize(index)));
+  }
+
+  //! Allocates an object in the destructors of an exiting thread, after its caches were freed
+  static void* allocateExited(size_t index) {
+    FreeNode* head = nullptr;
+    depot(index).take(&head);
+    if (head == nullptr) {
+      throw std::bad_alloc();
+    }
+    depot(index).retire(head->next_, 1, 0);
+    return head;
+  }
+
+  //! The free list of a class in a thread
+  struct Cache {
+    FreeNode* free_ = nullptr;                //!< The free objects
+    size_t count_ = 0;                        //!< The number of free objects
+    std::atomic<uint64_t> allocated_{0};      //!< Written by the owner only
+    std::atomic<uint64_t> freed_{0};          //!< Written by the owner only
+  };
+
+  //! The free lists of a thread
+  struct Caches {
+    Caches() { Registry::get().add(this); }
+
+    //! The objects and the counters of an exiting thread go to the depots
+    ~Caches() {
+      Registry::get().remove(this);
+      for (size_t i = 0; i < kNumClasses; ++i) {
+        Cache& cache = cache_[i];
+        depot(i).retire(cache.free_, cache.allocated_.load(std::memory_order_relaxed),
+                        cache.freed_.load(std::memory_order_relaxed));
+        cache.free_ = nullptr;
+        cache.count_ = 0;
+      }
+    }
+
+    //! Returns the caches of the thread, null after the thread exit hook ran. The thread local
+    //! state is trivially destructible, so it stays valid for the destructors of the other
+    //! thread local objects and, on the main thread, for the static destructors
+    static Caches* local() {
+      State& state = Caches::state();
+      if (state.caches_ == nullptr && !state.exited_) {
+        static thread_local ExitHook hook;
+        state.caches_ = new Caches();
+      }
+      return state.caches_;
+    }
+
+    Cache cache_[kNumClasses];
+
+   private:
+    struct State {
+      Caches* caches_;  //!< The caches of the thread
+      bool exited_;     //!< The exit hook released the caches
+    };
+
+    //! Releases the caches at the thread exit
+    struct ExitHook {
+      ~ExitHook() {
+        State& state = Caches::state();
+        delete state.caches_;
+        state.caches_ = nullptr;
+        state.exited_ = true;
+      }
+    };
+
+    static State& state() {
+      static thread_local State state = {nullptr, false};
+      return state;
+    }
+  };
+
+  //! The running threads of the statistics
+  struct Registry {
+    static Registry& get() {
+      static Registry* registry = new Registry();
+      return *registry;
+    }
+    void add(const Caches* caches) {
+      std::lock_guard<std::mutex> lock(lock_);
+      threads_.push_back(caches);
+    }
+    void remove(const Caches* caches) {
+      std::lock_guard<std::mutex> lock(lock_);
+      threads_.erase(std::find(threads_.begin(), threads_.end(), caches));
+    }
+    std::mutex lock_;
+    std::vector<const Caches*> threads_;
+  };
+
+  //! The magazines of a class, shared by all threads
+  struct Depot {
+    //! Returns a null terminated list of objects and its length
+    size_t take(FreeNode** head) {
+      const size_t magazine = magazineSize(index_);
+      {
+        std::lock_guard<std::mutex> lock(lock_);
+        if (!magazines_.empty()) {
+          *head = magazines_.back();
+          magazines_.pop_back();
+          return magazine;
+        }
+      }
+      const size_t size = classSize(index_);
+      address slab = reinterpret_cast<address>(AlignedMemory::allocate(magazine * size, kAlign));
+      *head = nullptr;
+      if (slab == nullptr) {
+        return 0;
+      }
+      for (size_t i = magazine; i > 0; --i) {
+        FreeNode* node = reinterpret_cast<FreeNode*>(slab + (i - 1) * size);
+        node->next_ = *head;
+        *head = node;
+      }
+      std::lock_guard<std::mutex> lock(lock_);
+      reserved_ += magazine;
+      return magazine;
+    }
+
+    //! Adds a null terminated list of a full magazine
+    void give(FreeNode* head) {
+      std::lock_guard<std::mutex> lock(lock_);
+      magazines_.push_back(head);
+    }
+
+    //! Adds the objects and the counters of an exiting thread
+    void retire(FreeNode* head, uint64_t allocated, uint64_t freed) {
+      const size_t magazine = magazineSize(index_);
+      std::lock_guard<std::mutex> lock(lock_);
+      allocated_ += allocated;
+      freed_ += freed;
+      // The objects of a partial magazine are collected until they fill a magazine
+      while (head != nullptr) {
+        FreeNode* next = head->next_;
+        head->next_ = loose_;
+        loose_ = head;
+        if (++looseCount_ == magazine) {
+          magazines_.push_back(loose_);
+          loose_ = nullptr;
+          looseCount_ = 0;
+        }
+        head = next;
+      }
+    }
+
+    size_t index_ = 0;                  //!< The size class
+    std::mutex lock_;                   //!< Serializes the depot
+    std::vector<FreeNode*> magazines_;  //!< Full magazines
+    FreeNode* loose_ = nullptr;         //!< The objects of the partial magazines
+    size_t looseCount_ = 0;             //!< The number of loose objects
+    uint64_t allocated_ = 0;            //!< The allocations of the exited threads
+    uint64_t freed_ = 0;                //!< The frees of the exited threads
+    uint64_t reserved_ = 0;             //!< The number of carved objects
+  };
+
+  //! The depots are never destroyed, threads may exit after the static destructors
+  static Depot& depot(size_t index) {
+    static Depot* depots = []() {
+      Depot* depots = new Depot[kNumClasses];
+      for (size_t i = 0; i < kNumClasses; ++i) {
+        depots[i].index_ = i;
+      }
+      return depots;
+    }();
+    return depots[index];
+  }
+};
+
+/*@}*/
+
+}  // namespace amd
+
+#endif /*SLABALLOCATOR_HPP_*/
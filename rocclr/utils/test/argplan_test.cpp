@@ -0,0 +1,247 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include <utils/argplan.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+// Unit test and microbenchmark for amd::ArgPlan, the fix-up plan of the kernel arguments.
+// Runs without a GPU.
+
+static int failures_ = 0;
+static volatile uint8_t sink_ = 0;
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #cond);        \
+      ++failures_;                                                     \
+    }                                                                  \
+  } while (0)
+
+struct Arg {
+  uint32_t offset_;
+  uint32_t size_;
+  amd::ArgPlan::Kind kind_;
+};
+
+//! Lays out the arguments with the natural alignment, as the kernel ABI
+static std::vector<Arg> layout(const std::vector<std::pair<uint32_t, amd::ArgPlan::Kind>>& args,
+                               uint32_t* size) {
+  std::vector<Arg> result;
+  uint32_t offset = 0;
+  for (const auto& arg : args) {
+    uint32_t align = 1;
+    while ((align < 16) && (arg.first % (align * 2) == 0)) {
+      align *= 2;
+    }
+    offset = (offset + align - 1) / align * align;
+    result.push_back({offset, arg.first, arg.second});
+    offset += arg.first;
+  }
+  *size = (offset + 15) / 16 * 16;
+  return result;
+}
+
+static amd::ArgPlan buildPlan(const std::vector<Arg>& args) {
+  amd::ArgPlan plan;
+  // The descriptor order doesn't matter
+  for (size_t i = args.size(); i-- > 0;) {
+    plan.add(static_cast<uint32_t>(i), args[i].offset_, args[i].size_, args[i].kind_);
+  }
+  plan.finalize();
+  return plan;
+}
+
+//! The per descriptor loop of KernelParameters::set()
+static void copyLoop(const std::vector<Arg>& args, address dst, void* const* values) {
+  for (size_t i = 0; i < args.size(); ++i) {
+    const Arg& arg = args[i];
+    if (arg.kind_ != amd::ArgPlan::Scalar) {
+      continue;
+    }
+    switch (arg.size_) {
+      case sizeof(uint32_t):
+        *reinterpret_cast<uint32_t*>(dst + arg.offset_) =
+            *static_cast<const uint32_t*>(values[i]);
+        break;
+      case sizeof(uint64_t):
+        *reinterpret_cast<uint64_t*>(dst + arg.offset_) =
+            *static_cast<const uint64_t*>(values[i]);
+        break;
+      default:
+        ::memcpy(dst + arg.offset_, values[i], arg.size_);
+        break;
+    }
+  }
+}
+
+//! Compares the plan with the loop, the plan must not write the slots
+static void checkPlan(const std::vector<Arg>& args, uint32_t size, std::mt19937& rng) {
+  amd::ArgPlan plan = buildPlan(args);
+  std::vector<uint8_t> block(size);
+  for (auto& byte : block) {
+    byte = static_cast<uint8_t>(rng());
+  }
+  std::vector<void*> values;
+  for (const auto& arg : args) {
+    values.push_back(block.data() + arg.offset_);
+  }
+  std::vector<uint8_t> expected(size, 0xCD);
+  copyLoop(args, expected.data(), values.data());
+  std::vector<uint8_t> fields(size, 0xCD);
+  plan.copyFields(fields.data(), values.data());
+  std::vector<uint8_t> ranges(size, 0xCD);
+  plan.copyRanges(ranges.data(), block.data());
+
+  bool match = true;
+  for (const auto& arg : args) {
+    for (uint32_t i = arg.offset_; i < arg.offset_ + arg.size_; ++i) {
+      // Padding may be copied by the ranges, the arguments must match
+      match &= (fields[i] == expected[i]) && (ranges[i] == expected[i]);
+    }
+  }
+  CHECK(match);
+  CHECK(fields == expected);
+  CHECK(plan.fields().size() + plan.slots().size() == args.size());
+}
+
+static void testMerge() {
+  using amd::ArgPlan;
+  uint32_t size = 0;
+  std::vector<std::pair<uint32_t, ArgPlan::Kind>> scalars(64, {4, ArgPlan::Scalar});
+  ArgPlan plan = buildPlan(layout(scalars, &size));
+  CHECK(plan.ranges().size() == 1);
+  CHECK(plan.ranges()[0].offset_ == 0 && plan.ranges()[0].size_ == 256);
+  CHECK(plan.slots().empty());
+
+  // A pointer splits the range
+  scalars[10].first = 8;
+  scalars[10].second = ArgPlan::Pointer;
+  plan = buildPlan(layout(scalars, &size));
+  CHECK(plan.ranges().size() == 2);
+  CHECK(plan.slots().size() == 1 && plan.slots()[0].index_ == 10);
+  CHECK(plan.slots()[0].offset_ == 40);
+
+  // The padding of the alignment is merged, a larger gap isn't
+  std::vector<Arg> args = {{0, 1, ArgPlan::Scalar}, {8, 8, ArgPlan::Scalar},
+                           {64, 4, ArgPlan::Scalar}, {68, 4, ArgPlan::Local}};
+  plan = buildPlan(args);
+  CHECK(plan.ranges().size() == 2);
+  CHECK(plan.ranges()[0].offset_ == 0 && plan.ranges()[0].size_ == 16);
+  CHECK(plan.ranges()[1].offset_ == 64 && plan.ranges()[1].size_ == 4);
+  CHECK(plan.slots().size() == 1 && plan.slots()[0].kind_ == ArgPlan::Local);
+
+  // Empty arguments don't create ranges
+  args = {{0, 0, ArgPlan::Scalar}};
+  plan = buildPlan(args);
+  CHECK(plan.ranges().empty());
+}
+
+static void testRandom() {
+  using amd::ArgPlan;
+  std::mt19937 rng(7);
+  const uint32_t sizes[] = {1, 2, 4, 8, 12, 16, 24, 64};
+  for (int iter = 0; iter < 2000; ++iter) {
+    std::vector<std::pair<uint32_t, ArgPlan::Kind>> desc;
+    size_t count = rng() % 80;
+    for (size_t i = 0; i < count; ++i) {
+      uint32_t kind = rng() % 8;
+      if (kind == 0) {
+        desc.push_back({8, ArgPlan::Pointer});
+      } else if (kind == 1) {
+        desc.push_back({4, ArgPlan::Local});
+      } else if (kind == 2) {
+        desc.push_back({8, ArgPlan::Sampler});
+      } else {
+        desc.push_back({sizes[rng() % 8], ArgPlan::Scalar});
+      }
+    }
+    uint32_t size = 0;
+    std::vector<Arg> args = layout(desc, &size);
+    checkPlan(args, size, rng);
+  }
+}
+
+static void benchmark() {
+  using amd::ArgPlan;
+  struct Shape {
+    const char* name_;
+    std::vector<std::pair<uint32_t, ArgPlan::Kind>> args_;
+  };
+  std::vector<Shape> shapes(5);
+  shapes[0].name_ = "4 pointers";
+  shapes[0].args_.assign(4, {8, ArgPlan::Pointer});
+  shapes[1].name_ = "64 scalars";
+  shapes[1].args_.assign(64, {4, ArgPlan::Scalar});
+  shapes[2].name_ = "56 scalars, 8 pointers";
+  for (int i = 0; i < 64; ++i) {
+    shapes[2].args_.push_back((i % 8 == 0) ? std::make_pair(8u, ArgPlan::Pointer)
+                                           : std::make_pair(4u, ArgPlan::Scalar));
+  }
+  shapes[3].name_ = "8 structs of 64 bytes";
+  shapes[3].args_.assign(8, {64, ArgPlan::Scalar});
+  shapes[4].name_ = "128 mixed scalars";
+  for (int i = 0; i < 128; ++i) {
+    shapes[4].args_.push_back({(i % 3 == 0) ? 8u : (i % 3 == 1) ? 4u : 2u, ArgPlan::Scalar});
+  }
+
+  printf("%-24s %12s %12s %12s\n", "signature", "loop (ns)", "fields (ns)", "ranges (ns)");
+  constexpr int kIterations = 1000000;
+  for (const auto& shape : shapes) {
+    uint32_t size = 0;
+    std::vector<Arg> args = layout(shape.args_, &size);
+    ArgPlan plan = buildPlan(args);
+    std::vector<uint8_t> block(size, 1);
+    std::vector<uint8_t> dst(size);
+    std::vector<void*> values;
+    for (const auto& arg : args) {
+      values.push_back(block.data() + arg.offset_);
+    }
+    auto measure = [&](auto&& copy) {
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < kIterations; ++i) {
+        copy();
+        // Keep the copies
+        sink_ = sink_ + dst[i % size];
+      }
+      std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+      return elapsed.count() / kIterations;
+    };
+    double loop = measure([&]() { copyLoop(args, dst.data(), values.data()); });
+    double fields = measure([&]() { plan.copyFields(dst.data(), values.data()); });
+    double ranges = measure([&]() { plan.copyRanges(dst.data(), block.data()); });
+    printf("%-24s %12.1f %12.1f %12.1f\n", shape.name_, loop, fields, ranges);
+  }
+}
+
+int main(int argc, char** argv) {
+  testMerge();
+  testRandom();
+  if (argc > 1 && std::string(argv[1]) == "--bench") {
+    benchmark();
+  }
+  printf("%s\n", (failures_ == 0) ? "PASSED" : "FAILED");
+  return (failures_ == 0) ? 0 : 1;
+}
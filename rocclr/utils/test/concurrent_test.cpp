@@ -0,0 +1,225 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include <utils/concurrent.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+// Stress test and microbenchmark for amd::ConcurrentLinkedQueue and its node allocator,
+// runs without a GPU.
+
+// Same as Os::alignedMalloc and Os::alignedFree
+void* amd::AlignedMemory::allocate(size_t size, size_t alignment) {
+  void* ptr = nullptr;
+  return (posix_memalign(&ptr, alignment, size) == 0) ? ptr : nullptr;
+}
+
+void amd::AlignedMemory::deallocate(void* ptr) { free(ptr); }
+
+static int failures_ = 0;
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #cond);        \
+      ++failures_;                                                     \
+    }                                                                  \
+  } while (0)
+
+typedef amd::details::MagazineAllocator<16, 32> Allocator;
+
+//! The queue carries pointers, an item encodes the producer and the sequence number
+static void* item(size_t producer, size_t seq) {
+  return reinterpret_cast<void*>(((seq + 1) << 8) | producer);
+}
+static size_t producerOf(void* value) { return reinterpret_cast<uintptr_t>(value) & 0xff; }
+static size_t seqOf(void* value) { return (reinterpret_cast<uintptr_t>(value) >> 8) - 1; }
+
+static void testAllocator() {
+  std::vector<void*> nodes;
+  std::unordered_set<void*> unique;
+  for (size_t i = 0; i < 10 * Allocator::kMagazineSize + 3; ++i) {
+    void* node = Allocator::allocate();
+    CHECK((reinterpret_cast<uintptr_t>(node) % 32) == 0);
+    CHECK(unique.insert(node).second);
+    memset(node, 0xAB, 16);
+    nodes.push_back(node);
+  }
+  for (void* node : nodes) {
+    Allocator::deallocate(node);
+  }
+  // The freed nodes are reused
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    void* node = Allocator::allocate();
+    CHECK(unique.count(node) == 1);
+    nodes[i] = node;
+  }
+  // Frees on another thread, which exits and returns the nodes to the depot
+  std::thread([&]() {
+    for (void* node : nodes) {
+      Allocator::deallocate(node);
+    }
+  }).join();
+  size_t reused = 0;
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    nodes[i] = Allocator::allocate();
+    reused += unique.count(nodes[i]);
+  }
+  CHECK(reused >= nodes.size() - Allocator::kMagazineSize);
+  for (void* node : nodes) {
+    Allocator::deallocate(node);
+  }
+}
+
+//! Producers enqueue sequences, consumers check every item arrives once and in order
+static void stress(size_t producers, size_t consumers, size_t items) {
+  amd::ConcurrentLinkedQueue<void*> queue;
+  std::atomic<size_t> received(0);
+  std::vector<std::vector<uint8_t>> seen(producers, std::vector<uint8_t>(items, 0));
+  std::atomic<int> errors(0);
+  std::vector<std::thread> threads;
+  for (size_t c = 0; c < consumers; ++c) {
+    threads.emplace_back([&]() {
+      std::vector<size_t> next(producers, 0);
+      while (received.load(std::memory_order_relaxed) < producers * items) {
+        void* value = queue.dequeue();
+        if (value == nullptr) {
+          std::this_thread::yield();
+          continue;
+        }
+        size_t p = producerOf(value);
+        size_t seq = seqOf(value);
+        if ((p >= producers) || (seq >= items) || (seq < next[p]) || (seen[p][seq] != 0)) {
+          ++errors;
+        } else {
+          seen[p][seq] = 1;
+          next[p] = seq + 1;
+        }
+        received.fetch_add(1, std::memory_order_relaxed);
+      }
+    });
+  }
+  for (size_t p = 0; p < producers; ++p) {
+    threads.emplace_back([&, p]() {
+      for (size_t i = 0; i < items; ++i) {
+        queue.enqueue(item(p, i));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  CHECK(errors == 0);
+  CHECK(queue.empty());
+  size_t count = 0;
+  for (const auto& producer : seen) {
+    count += std::count(producer.begin(), producer.end(), 1);
+  }
+  CHECK(count == producers * items);
+}
+
+static void testQueue() {
+  amd::ConcurrentLinkedQueue<void*> queue;
+  CHECK(queue.empty() && (queue.dequeue() == nullptr));
+  for (size_t i = 0; i < 1000; ++i) {
+    queue.enqueue(item(0, i));
+  }
+  for (size_t i = 0; i < 1000; ++i) {
+    CHECK(seqOf(queue.dequeue()) == i);
+  }
+  CHECK(queue.empty());
+
+  stress(1, 1, 200000);
+  stress(4, 1, 100000);
+  stress(4, 4, 50000);
+  // Short lived producer threads return their magazines at the exit
+  for (int i = 0; i < 50; ++i) {
+    stress(3, 2, 1000);
+  }
+}
+
+static double rate(size_t ops, const std::function<void()>& run) {
+  auto start = std::chrono::steady_clock::now();
+  run();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return ops / elapsed.count() / 1e6;
+}
+
+static void benchmark() {
+  const size_t kOps = 4000000;
+  const size_t kBatch = 256;
+  printf("%8s %20s %20s\n", "threads", "malloc (Mops/s)", "magazines (Mops/s)");
+  for (size_t threads : {1, 2, 4, 8}) {
+    auto run = [&](const std::function<void*()>& alloc, const std::function<void(void*)>& free) {
+      std::vector<std::thread> workers;
+      for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&]() {
+          std::vector<void*> nodes(kBatch);
+          for (size_t i = 0; i < kOps / threads; i += kBatch) {
+            for (auto& node : nodes) {
+              node = alloc();
+            }
+            for (auto node : nodes) {
+              free(node);
+            }
+          }
+        });
+      }
+      for (auto& worker : workers) {
+        worker.join();
+      }
+    };
+    double aligned = rate(kOps, [&]() {
+      run([]() { return amd::AlignedMemory::allocate(16, 32); },
+          [](void* node) { amd::AlignedMemory::deallocate(node); });
+    });
+    double magazines = rate(kOps, [&]() {
+      run([]() { return Allocator::allocate(); }, [](void* node) { Allocator::deallocate(node); });
+    });
+    printf("%8zu %20.1f %20.1f\n", threads, aligned, magazines);
+  }
+
+  printf("%10s %20s\n", "producers", "queue (Mops/s)");
+  for (size_t producers : {1, 2, 4, 8}) {
+    const size_t items = kOps / producers;
+    double queue = rate(producers * items, [&]() { stress(producers, 1, items); });
+    printf("%10zu %20.1f\n", producers, queue);
+  }
+}
+
+int main(int argc, char** argv) {
+  testAllocator();
+  testQueue();
+  if (argc > 1 && std::string(argv[1]) == "--bench") {
+    benchmark();
+  }
+  printf("%s\n", (failures_ == 0) ? "PASSED" : "FAILED");
+  return (failures_ == 0) ? 0 : 1;
+}
@@ -0,0 +1,153 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include <utils/filecache.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Unit test and microbenchmark for amd::ContentKey and amd::evictCacheFiles, the key and the
+// eviction of the persistent hiprtc compilation cache. Runs without a GPU.
+
+static int failures_ = 0;
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #cond);        \
+      ++failures_;                                                     \
+    }                                                                  \
+  } while (0)
+
+static std::string key(const std::vector<std::string>& fields) {
+  amd::ContentKey key;
+  for (const auto& field : fields) {
+    key.add(field);
+  }
+  return key.str();
+}
+
+static void testKey() {
+  // The key names the files of the cache, so it must not change between the releases
+  amd::ContentKey known;
+  known.add(std::string("hiprtc"));
+  known.add(uint64_t{42});
+  CHECK(known.str() == "c36c50e216987a8e663dc8bb6f449584");
+  CHECK(amd::ContentKey().str() == "9ca066f1a4ab2eeacd9729efc13f9168");
+
+  const std::string str = known.str();
+  CHECK(str.size() == 32);
+  CHECK(str.find_first_not_of("0123456789abcdef") == std::string::npos);
+  CHECK(std::stoull(str.substr(0, 16), nullptr, 16) == known.value());
+
+  // Deterministic, and every field, its order and its boundaries change the key
+  CHECK(key({"-O3", "kernel"}) == key({"-O3", "kernel"}));
+  CHECK(key({"-O3", "kernel"}) != key({"-O2", "kernel"}));
+  CHECK(key({"-O3", "kernel"}) != key({"kernel", "-O3"}));
+  CHECK(key({"ab", "c"}) != key({"a", "bc"}));
+  CHECK(key({"abc"}) != key({"abc", ""}));
+  CHECK(key({""}) != amd::ContentKey().str());
+  // The fields of all lengths around the word size
+  std::string text(40, 'x');
+  for (size_t size = 1; size < text.size(); ++size) {
+    std::string changed = text.substr(0, size);
+    changed.back() = 'y';
+    CHECK(key({text.substr(0, size)}) != key({changed}));
+    CHECK(key({text.substr(0, size)}) != key({text.substr(0, size + 1)}));
+  }
+}
+
+static void testEvictOrder() {
+  std::vector<amd::CacheFile> files = {
+      {"c", 300, 30}, {"a", 100, 10}, {"e", 500, 50}, {"b", 200, 20}, {"d", 400, 40}};
+  std::vector<std::string> removed;
+  // 1500 bytes in a cache of 1200 are trimmed to 1050, the oldest files go first
+  uint64_t size = amd::evictCacheFiles(&files, 1200, [&](const amd::CacheFile& file) {
+    removed.push_back(file.path_);
+    return true;
+  });
+  CHECK((removed == std::vector<std::string>{"a", "b", "c"}));
+  CHECK(size == 900);
+}
+
+static void testEvictLimit() {
+  std::vector<amd::CacheFile> files = {{"a", 100, 1}, {"b", 100, 2}, {"c", 100, 3}};
+  size_t calls = 0;
+  auto remove = [&](const amd::CacheFile&) {
+    ++calls;
+    return true;
+  };
+  // A cache within the limit isn't trimmed
+  CHECK(amd::evictCacheFiles(&files, 300, remove) == 300);
+  CHECK(calls == 0);
+  // The cache is trimmed below 7/8 of the limit, so the next store doesn't evict again
+  CHECK(amd::evictCacheFiles(&files, 280, remove) == 200);
+  CHECK(calls == 1);
+  // Evicts everything for a limit of 0
+  calls = 0;
+  CHECK(amd::evictCacheFiles(&files, 0, remove) == 0);
+  CHECK(calls == 3);
+}
+
+static void testEvictFailure() {
+  // A file, which another process uses or removed, is skipped
+  std::vector<amd::CacheFile> files = {{"a", 100, 1}, {"b", 100, 2}, {"c", 100, 3},
+                                       {"d", 100, 4}};
+  std::vector<std::string> removed;
+  uint64_t size = amd::evictCacheFiles(&files, 300, [&](const amd::CacheFile& file) {
+    if (file.path_ == "a") {
+      return false;
+    }
+    removed.push_back(file.path_);
+    return true;
+  });
+  CHECK((removed == std::vector<std::string>{"b", "c"}));
+  CHECK(size == 200);
+}
+
+static void benchmark() {
+  std::string source(64 * Ki, 'k');
+  constexpr size_t kKeys = 2000;
+  uint64_t sum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < kKeys; ++i) {
+    amd::ContentKey key;
+    key.add(source);
+    key.add(uint64_t{i});
+    sum += key.value();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  printf("ContentKey: %.2f GB/s (%llx)\n", kKeys * source.size() / elapsed.count() / 1e9,
+         static_cast<unsigned long long>(sum));
+}
+
+int main(int argc, char** argv) {
+  testKey();
+  testEvictOrder();
+  testEvictLimit();
+  testEvictFailure();
+  if (argc > 1 && std::string(argv[1]) == "--bench") {
+    benchmark();
+  }
+  printf("%s\n", (failures_ == 0) ? "PASSED" : "FAILED");
+  return (failures_ == 0) ? 0 : 1;
+}
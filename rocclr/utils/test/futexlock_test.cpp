@@ -0,0 +1,269 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include <utils/futexlock.hpp>
+#include <utils/lockprofiler.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Unit test and contention benchmark for amd::FutexLock and amd::LockProfiler, runs without
+// a GPU.
+
+static int failures_ = 0;
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #cond);        \
+      ++failures_;                                                     \
+    }                                                                  \
+  } while (0)
+
+#if defined(__linux__)
+
+//! Increments a plain counter under the lock from several threads
+template <typename Lock> static uint64_t countUnder(Lock& lock, size_t threads, size_t iterations) {
+  uint64_t counter = 0;
+  std::vector<std::thread> workers;
+  for (size_t t = 0; t < threads; ++t) {
+    workers.emplace_back([&]() {
+      for (size_t i = 0; i < iterations; ++i) {
+        lock.lock();
+        ++counter;
+        lock.unlock();
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  return counter;
+}
+
+static void testExclusion() {
+  for (bool recursive : {false, true}) {
+    amd::FutexLock lock(recursive);
+    CHECK(countUnder(lock, 4, 50000) == 200000);
+    CHECK(!lock.isLocked());
+  }
+}
+
+static void testRecursion() {
+  amd::FutexLock lock(true);
+  lock.lock();
+  lock.lock();
+  CHECK(lock.tryLock());
+  lock.unlock();
+  lock.unlock();
+  // Still owned, another thread can't take it
+  bool acquired = true;
+  std::thread([&]() { acquired = lock.tryLock(); }).join();
+  CHECK(!acquired);
+  lock.unlock();
+  CHECK(!lock.isLocked());
+  std::thread([&]() {
+    acquired = lock.tryLock();
+    lock.unlock();
+  }).join();
+  CHECK(acquired);
+
+  amd::FutexLock plain(false);
+  CHECK(plain.tryLock());
+  CHECK(!plain.tryLock());
+  plain.unlock();
+}
+
+static void testWait() {
+  // A producer/consumer hand-off of every item, the consumer waits under a recursive lock
+  amd::FutexLock lock(true);
+  constexpr uint64_t kItems = 20000;
+  uint64_t pending = 0;
+  uint64_t consumed = 0;
+  std::thread consumer([&]() {
+    lock.lock();
+    lock.lock();
+    while (consumed < kItems) {
+      while (pending == 0) {
+        lock.wait();
+      }
+      consumed += pending;
+      pending = 0;
+      lock.notify();
+    }
+    lock.unlock();
+    lock.unlock();
+  });
+  for (uint64_t i = 0; i < kItems; ++i) {
+    lock.lock();
+    while (pending != 0) {
+      lock.wait();
+    }
+    pending = 1;
+    lock.notify();
+    lock.unlock();
+  }
+  consumer.join();
+  CHECK(consumed == kItems);
+
+  // notifyAll() wakes every waiter
+  amd::FutexLock group(false);
+  bool go = false;
+  std::atomic<int> woken(0);
+  std::vector<std::thread> waiters;
+  for (int i = 0; i < 4; ++i) {
+    waiters.emplace_back([&]() {
+      group.lock();
+      while (!go) {
+        group.wait();
+      }
+      group.unlock();
+      ++woken;
+    });
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  group.lock();
+  go = true;
+  group.notifyAll();
+  group.unlock();
+  for (auto& waiter : waiters) {
+    waiter.join();
+  }
+  CHECK(woken == 4);
+}
+
+#endif  // __linux__
+
+static void testProfiler() {
+  amd::LockProfiler::reset();
+  int lockA = 0;
+  int lockB = 0;
+  static const char* kFile = "file.cpp";
+  std::vector<std::thread> workers;
+  for (int t = 0; t < 3; ++t) {
+    workers.emplace_back([&]() {
+      for (int i = 0; i < 100; ++i) {
+        amd::LockProfiler::record(&lockA, kFile, 10, (i % 10 == 0) ? 1000 : 0);
+        amd::LockProfiler::record(&lockB, kFile, 20, 0);
+      }
+    });
+  }
+  // A live thread and the retired ones are merged
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  amd::LockProfiler::record(&lockA, kFile, 10, 5000);
+  amd::LockProfiler::Profile profile = amd::LockProfiler::collect();
+  CHECK(profile.size() == 2);
+  if (profile.size() == 2) {
+    CHECK(profile[0].first.lock_ == &lockA && profile[0].first.line_ == 10);
+    CHECK(profile[0].second.acquisitions_ == 301);
+    CHECK(profile[0].second.contended_ == 31);
+    CHECK(profile[0].second.waitNs_ == 35000);
+    CHECK(profile[0].second.maxWaitNs_ == 5000);
+    CHECK(profile[1].first.lock_ == &lockB);
+    CHECK(profile[1].second.acquisitions_ == 300);
+    CHECK(profile[1].second.contended_ == 0);
+  }
+  amd::LockProfiler::reset();
+  CHECK(amd::LockProfiler::collect().empty());
+}
+
+static int exitLock = 0;
+
+struct LateLock {
+  ~LateLock() {
+    if (active_) {
+      amd::LockProfiler::record(&exitLock, nullptr, 0, 100);
+    }
+  }
+  bool active_ = false;
+};
+
+static void testThreadExit() {
+  amd::LockProfiler::reset();
+  std::thread([]() {
+    // Constructed before the table of the thread, so it's destroyed after its exit hook
+    static thread_local LateLock late;
+    late.active_ = true;
+    amd::LockProfiler::record(&exitLock, nullptr, 0, 0);
+  }).join();
+  amd::LockProfiler::Profile profile = amd::LockProfiler::collect();
+  CHECK(profile.size() == 1);
+  if (profile.size() == 1) {
+    CHECK(profile[0].second.acquisitions_ == 2);
+    CHECK(profile[0].second.contended_ == 1);
+    CHECK(profile[0].second.waitNs_ == 100);
+  }
+  amd::LockProfiler::reset();
+}
+
+static void benchmark() {
+#if defined(__linux__)
+  auto measure = [](const std::function<void()>& run) {
+    auto start = std::chrono::steady_clock::now();
+    run();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+  };
+  constexpr size_t kIterations = 1000000;
+  printf("%8s %16s %16s %16s\n", "threads", "std::mutex (ns)", "futex (ns)", "recursive (ns)");
+  for (size_t threads : {1, 2, 4, 8}) {
+    const size_t iterations = kIterations / threads;
+    std::mutex mutex;
+    amd::FutexLock futex(false);
+    amd::FutexLock recursive(true);
+    double m = measure([&]() { countUnder(mutex, threads, iterations); });
+    double f = measure([&]() { countUnder(futex, threads, iterations); });
+    double r = measure([&]() { countUnder(recursive, threads, iterations); });
+    printf("%8zu %16.1f %16.1f %16.1f\n", threads, m * 1e9 / kIterations, f * 1e9 / kIterations,
+           r * 1e9 / kIterations);
+  }
+#endif
+  // The cost of a profiled acquisition
+  int lock = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < 1000000; ++i) {
+    amd::LockProfiler::record(&lock, __FILE__, __LINE__, 0);
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  printf("LockProfiler::record %.1f ns\n", elapsed.count() * 1e9 / 1000000);
+}
+
+int main(int argc, char** argv) {
+#if defined(__linux__)
+  testExclusion();
+  testRecursion();
+  testWait();
+#endif
+  testProfiler();
+  testThreadExit();
+  if (argc > 1 && std::string(argv[1]) == "--bench") {
+    benchmark();
+  }
+  printf("%s\n", (failures_ == 0) ? "PASSED" : "FAILED");
+  return (failures_ == 0) ? 0 : 1;
+}
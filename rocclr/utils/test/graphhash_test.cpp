@@ -0,0 +1,206 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include <utils/graphhash.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+// Unit test and benchmark for amd::GraphHash and amd::GraphSignature, the topology check
+// of hipGraphExecUpdate. Runs without a GPU.
+
+static int failures_ = 0;
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #cond);        \
+      ++failures_;                                                     \
+    }                                                                  \
+  } while (0)
+
+struct TestGraph {
+  std::vector<uint64_t> kinds_;
+  std::vector<std::vector<size_t>> deps_;
+};
+
+//! A layered DAG in a topological order, every node depends on a few recent nodes
+static TestGraph randomGraph(size_t n, uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  TestGraph graph;
+  graph.kinds_.resize(n);
+  graph.deps_.resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    graph.kinds_[i] = rng() % 4;
+    for (size_t k = 0; k < 3 && i > 0; ++k) {
+      size_t dep = (i > 16) ? i - 1 - rng() % 16 : rng() % i;
+      if (std::find(graph.deps_[i].begin(), graph.deps_[i].end(), dep) == graph.deps_[i].end()) {
+        graph.deps_[i].push_back(dep);
+      }
+    }
+  }
+  return graph;
+}
+
+static void sign(const TestGraph& graph, amd::GraphSignature* signature) {
+  signature->reset(graph.kinds_.size());
+  for (size_t i = 0; i < graph.kinds_.size(); ++i) {
+    amd::GraphHash hash;
+    hash.add(graph.kinds_[i]);
+    signature->setNode(i, hash.value());
+    for (size_t dep : graph.deps_[i]) {
+      signature->addDependency(i, dep);
+    }
+  }
+  signature->finalize();
+}
+
+static void testHash() {
+  amd::GraphHash empty;
+  CHECK(empty.value() != 0);
+
+  // Equal inputs give equal values, independent of the split of the bytes
+  const char text[] = "hipGraphExecUpdate structural hash";
+  amd::GraphHash a, b;
+  a.add(text, sizeof(text));
+  b.add(text, 8);
+  b.add(text + 8, sizeof(text) - 8);
+  CHECK(a.value() == b.value());
+
+  // Any changed byte or length changes the value
+  for (size_t i = 0; i < sizeof(text); ++i) {
+    char copy[sizeof(text)];
+    memcpy(copy, text, sizeof(text));
+    copy[i] ^= 1;
+    amd::GraphHash c;
+    c.add(copy, sizeof(copy));
+    CHECK(c.value() != a.value());
+  }
+  amd::GraphHash shorter;
+  shorter.add(text, sizeof(text) - 1);
+  CHECK(shorter.value() != a.value());
+
+  uint32_t zero32 = 0;
+  uint64_t zero64 = 0;
+  amd::GraphHash z32, z64;
+  z32.add(zero32);
+  z64.add(zero64);
+  CHECK(z32.value() != z64.value());
+}
+
+static void testSignature() {
+  TestGraph graph = randomGraph(500, 1);
+  amd::GraphSignature original, same;
+  sign(graph, &original);
+  sign(graph, &same);
+  CHECK(original.mismatch(same) == original.size());
+  CHECK(original.hash() == same.hash());
+
+  // The order of the dependencies doesn't matter
+  TestGraph reordered = graph;
+  for (auto& deps : reordered.deps_) {
+    std::reverse(deps.begin(), deps.end());
+  }
+  amd::GraphSignature reorderedSig;
+  sign(reordered, &reorderedSig);
+  CHECK(original.mismatch(reorderedSig) == original.size());
+
+  // A changed kind is found at its position
+  TestGraph kind = graph;
+  kind.kinds_[123] ^= 8;
+  amd::GraphSignature kindSig;
+  sign(kind, &kindSig);
+  CHECK(original.mismatch(kindSig) == 123);
+  CHECK(original.description(123) != kindSig.description(123));
+  CHECK(original.hash() != kindSig.hash());
+
+  // A moved edge with the same number of dependencies is a topology change
+  TestGraph moved = graph;
+  size_t node = 321;
+  size_t dep = moved.deps_[node][0];
+  size_t other = (dep == node - 1) ? node - 2 : node - 1;
+  if (std::find(moved.deps_[node].begin(), moved.deps_[node].end(), other) ==
+      moved.deps_[node].end()) {
+    moved.deps_[node][0] = other;
+    amd::GraphSignature movedSig;
+    sign(moved, &movedSig);
+    CHECK(original.mismatch(movedSig) == node);
+    CHECK(original.description(node) == movedSig.description(node));
+  }
+
+  // A removed edge
+  TestGraph removed = graph;
+  removed.deps_[400].pop_back();
+  amd::GraphSignature removedSig;
+  sign(removed, &removedSig);
+  CHECK(original.mismatch(removedSig) == 400);
+
+  // A different number of nodes reports the first position past the common prefix
+  TestGraph longer = graph;
+  longer.kinds_.push_back(0);
+  longer.deps_.push_back({0});
+  amd::GraphSignature longerSig;
+  sign(longer, &longerSig);
+  CHECK(original.mismatch(longerSig) == original.size());
+  CHECK(longerSig.mismatch(original) == original.size());
+  CHECK(original.hash() != longerSig.hash());
+
+  amd::GraphSignature emptySig;
+  emptySig.finalize();
+  CHECK(emptySig.mismatch(emptySig) == 0);
+}
+
+static void benchmark() {
+  printf("%8s %16s %16s\n", "nodes", "sign (us)", "compare (us)");
+  for (size_t n : {1000, 5000, 20000}) {
+    TestGraph graph = randomGraph(n, 7);
+    amd::GraphSignature reference, signature;
+    sign(graph, &reference);
+    const int iterations = 20;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+      sign(graph, &signature);
+    }
+    auto mid = std::chrono::steady_clock::now();
+    size_t mismatch = 0;
+    for (int i = 0; i < iterations; ++i) {
+      mismatch += reference.mismatch(signature);
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::chrono::duration<double, std::micro> signTime = mid - start;
+    std::chrono::duration<double, std::micro> compareTime = end - mid;
+    CHECK(mismatch == n * iterations);
+    printf("%8zu %16.1f %16.1f\n", n, signTime.count() / iterations,
+           compareTime.count() / iterations);
+  }
+}
+
+int main(int argc, char** argv) {
+  testHash();
+  testSignature();
+  if (argc > 1 && std::string(argv[1]) == "--bench") {
+    benchmark();
+  }
+  printf("%s\n", (failures_ == 0) ? "PASSED" : "FAILED");
+  return (failures_ == 0) ? 0 : 1;
+}
@@ -0,0 +1,416 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include <utils/graphoptimizer.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+// Unit test and benchmark for amd::GraphOptimizer, the instantiation passes of HIP graphs.
+// Synthetic DAGs are checked for the preserved ordering of the remaining nodes. Runs without
+// a GPU.
+
+typedef amd::GraphOptimizer Optimizer;
+typedef Optimizer::Kind Kind;
+
+static int failures_ = 0;
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #cond);        \
+      ++failures_;                                                     \
+    }                                                                  \
+  } while (0)
+
+static Optimizer::Node memsetNode(uintptr_t dst, size_t size, uint64_t value = 0,
+                                  uint32_t elementSize = 1) {
+  Optimizer::Node node;
+  node.kind_ = Kind::Memset;
+  node.dst_ = dst;
+  node.size_ = size;
+  node.value_ = value;
+  node.elementSize_ = elementSize;
+  node.dstRegion_ = reinterpret_cast<const void*>(dst & ~uintptr_t(0xFFFF));
+  return node;
+}
+
+static Optimizer::Node memcpyNode(uintptr_t dst, uintptr_t src, size_t size) {
+  Optimizer::Node node;
+  node.kind_ = Kind::Memcpy;
+  node.dst_ = dst;
+  node.src_ = src;
+  node.size_ = size;
+  node.dstRegion_ = reinterpret_cast<const void*>(dst & ~uintptr_t(0xFFFF));
+  node.srcRegion_ = reinterpret_cast<const void*>(src & ~uintptr_t(0xFFFF));
+  return node;
+}
+
+static Optimizer::Node eventNode(Kind kind, uintptr_t event) {
+  Optimizer::Node node;
+  node.kind_ = kind;
+  node.event_ = reinterpret_cast<const void*>(event);
+  return node;
+}
+
+static size_t countEdges(const Optimizer& optimizer) {
+  size_t edges = 0;
+  for (size_t i = 0; i < optimizer.size(); ++i) {
+    if (!optimizer.removed(i)) {
+      edges += optimizer.successors(i).size();
+    }
+  }
+  return edges;
+}
+
+//! The transitive closure of the edges, closure[i][j] is true if j is reachable from i
+static std::vector<std::vector<bool>> closure(
+    size_t n, const std::vector<std::pair<size_t, size_t>>& edges) {
+  std::vector<std::vector<bool>> reach(n, std::vector<bool>(n, false));
+  for (const auto& edge : edges) {
+    reach[edge.first][edge.second] = true;
+  }
+  for (size_t k = 0; k < n; ++k) {
+    for (size_t i = 0; i < n; ++i) {
+      if (reach[i][k]) {
+        for (size_t j = 0; j < n; ++j) {
+          if (reach[k][j]) {
+            reach[i][j] = true;
+          }
+        }
+      }
+    }
+  }
+  return reach;
+}
+
+static std::vector<std::pair<size_t, size_t>> remainingEdges(const Optimizer& optimizer) {
+  std::vector<std::pair<size_t, size_t>> edges;
+  for (size_t i = 0; i < optimizer.size(); ++i) {
+    if (!optimizer.removed(i)) {
+      for (auto s : optimizer.successors(i)) {
+        CHECK(!optimizer.removed(s));
+        edges.emplace_back(i, s);
+      }
+    }
+  }
+  return edges;
+}
+
+static void testReduction() {
+  // 0 -> 1 -> 2 -> 3 with the shortcuts 0 -> 2, 0 -> 3 and 1 -> 3
+  Optimizer optimizer(4);
+  optimizer.addEdge(0, 3);
+  optimizer.addEdge(0, 1);
+  optimizer.addEdge(1, 3);
+  optimizer.addEdge(0, 2);
+  optimizer.addEdge(1, 2);
+  optimizer.addEdge(2, 3);
+  optimizer.addEdge(2, 3);  // A duplicate edge is ignored
+  Optimizer::Stats stats;
+  CHECK(optimizer.optimize(Optimizer::TransitiveReduction, &stats));
+  CHECK(stats.edges_ == 6);
+  CHECK(stats.edgesRemoved_ == 3);
+  CHECK(countEdges(optimizer) == 3);
+  CHECK(optimizer.successors(0).size() == 1 && optimizer.successors(0)[0] == 1);
+  CHECK(optimizer.successors(1).size() == 1 && optimizer.successors(1)[0] == 2);
+
+  // A cycle isn't optimized
+  Optimizer cycle(3);
+  cycle.addEdge(0, 1);
+  cycle.addEdge(1, 2);
+  cycle.addEdge(2, 0);
+  cycle.addEdge(0, 2);
+  CHECK(!cycle.optimize(Optimizer::AllPasses, &stats));
+  CHECK(countEdges(cycle) == 4);
+}
+
+static void testEmptyNodes() {
+  // 0 -> E1 -> 2, the empty node on a chain goes away
+  Optimizer chain(3);
+  chain.node(1).kind_ = Kind::Empty;
+  chain.addEdge(0, 1);
+  chain.addEdge(1, 2);
+  Optimizer::Stats stats;
+  CHECK(chain.optimize(Optimizer::EmptyNodes, &stats));
+  CHECK(stats.emptyNodesRemoved_ == 1);
+  CHECK(chain.removed(1));
+  CHECK(chain.successors(0).size() == 1 && chain.successors(0)[0] == 2);
+
+  // A join of 3 x 3 nodes stays, a 2 x 2 join is replaced by 4 edges
+  for (size_t width : {2, 3}) {
+    Optimizer join(2 * width + 1);
+    const size_t empty = 2 * width;
+    join.node(empty).kind_ = Kind::Empty;
+    for (size_t i = 0; i < width; ++i) {
+      join.addEdge(i, empty);
+      join.addEdge(empty, width + i);
+    }
+    CHECK(join.optimize(Optimizer::EmptyNodes, &stats));
+    CHECK(join.removed(empty) == (width == 2));
+    CHECK(countEdges(join) == ((width == 2) ? 4 : 6));
+  }
+
+  // An isolated empty node and an empty root
+  Optimizer roots(3);
+  roots.node(0).kind_ = Kind::Empty;
+  roots.node(1).kind_ = Kind::Empty;
+  roots.addEdge(1, 2);
+  CHECK(roots.optimize(Optimizer::EmptyNodes, &stats));
+  CHECK(roots.removed(0) && roots.removed(1) && !roots.removed(2));
+  CHECK(countEdges(roots) == 0);
+}
+
+static void testCoalescing() {
+  constexpr uintptr_t kBuffer = 0x100000;
+  Optimizer::Stats stats;
+  {
+    // A chain of 4 contiguous memsets in a random order of the ranges
+    Optimizer optimizer(6);
+    optimizer.node(1) = memsetNode(kBuffer + 256, 256, 7);
+    optimizer.node(2) = memsetNode(kBuffer + 0, 256, 7);
+    optimizer.node(3) = memsetNode(kBuffer + 512, 128, 7);
+    optimizer.node(4) = memsetNode(kBuffer + 640, 64, 7);
+    for (size_t i = 0; i < 5; ++i) {
+      optimizer.addEdge(i, i + 1);
+    }
+    CHECK(optimizer.optimize(Optimizer::Coalescing, &stats));
+    CHECK(stats.memsetsCoalesced_ == 3);
+    CHECK(!optimizer.removed(1));
+    CHECK(optimizer.mergedInto(4) == 1 && optimizer.mergedInto(2) == 1);
+    CHECK(optimizer.mergedInto(1) == Optimizer::kNone);
+    CHECK(optimizer.node(1).dst_ == kBuffer && optimizer.node(1).size_ == 704);
+    CHECK(optimizer.successors(0).size() == 1 && optimizer.successors(0)[0] == 1);
+    CHECK(optimizer.successors(1).size() == 1 && optimizer.successors(1)[0] == 5);
+  }
+  {
+    // Siblings: 3 memsets between 0 and 4, the middle one has another value
+    Optimizer optimizer(6);
+    optimizer.node(1) = memsetNode(kBuffer + 0, 256, 1, 4);
+    optimizer.node(2) = memsetNode(kBuffer + 256, 256, 2, 4);
+    optimizer.node(3) = memsetNode(kBuffer + 512, 256, 1, 4);
+    optimizer.node(5) = memsetNode(kBuffer + 768, 256, 1, 4);  // Not a sibling
+    for (size_t i = 1; i <= 3; ++i) {
+      optimizer.addEdge(0, i);
+      optimizer.addEdge(i, 4);
+    }
+    optimizer.addEdge(4, 5);
+    CHECK(optimizer.optimize(Optimizer::Coalescing, &stats));
+    CHECK(stats.memsetsCoalesced_ == 0);
+
+    // Contiguous siblings merge, a different element size doesn't
+    Optimizer siblings(5);
+    siblings.node(1) = memsetNode(kBuffer + 0, 256, 1, 4);
+    siblings.node(2) = memsetNode(kBuffer + 256, 256, 1, 4);
+    siblings.node(3) = memsetNode(kBuffer + 512, 256, 1, 2);
+    for (size_t i = 1; i <= 3; ++i) {
+      siblings.addEdge(0, i);
+      siblings.addEdge(i, 4);
+    }
+    CHECK(siblings.optimize(Optimizer::Coalescing, &stats));
+    CHECK(stats.memsetsCoalesced_ == 1);
+    CHECK(siblings.mergedInto(2) == 1 && !siblings.removed(3));
+    CHECK(siblings.node(1).size_ == 512);
+    CHECK(siblings.successors(0).size() == 2);
+    CHECK(siblings.predecessors(4).size() == 2);
+  }
+  {
+    // Copies: contiguous on both sides, a gap in the source, another allocation and an overlap
+    Optimizer optimizer(8);
+    optimizer.node(0) = memcpyNode(kBuffer + 0, 4 * kBuffer + 0, 128);
+    optimizer.node(1) = memcpyNode(kBuffer + 128, 4 * kBuffer + 128, 128);
+    optimizer.node(2) = memcpyNode(kBuffer + 256, 4 * kBuffer + 512, 128);
+    optimizer.node(3) = memcpyNode(kBuffer + 0x10000, 4 * kBuffer + 0x10000, 128);
+    optimizer.node(4) = memcpyNode(kBuffer + 0x10000 - 128, 4 * kBuffer + 0x10000 - 128, 128);
+    optimizer.node(4).dstRegion_ = optimizer.node(3).dstRegion_;
+    optimizer.node(5) = memcpyNode(2 * kBuffer + 64, 2 * kBuffer, 64);
+    optimizer.node(6) = memcpyNode(2 * kBuffer + 128, 2 * kBuffer + 64, 64);
+    for (size_t i = 0; i < 7; ++i) {
+      optimizer.addEdge(i, i + 1);
+    }
+    CHECK(optimizer.optimize(Optimizer::Coalescing, &stats));
+    CHECK(stats.memcpysCoalesced_ == 1);
+    CHECK(optimizer.mergedInto(1) == 0 && optimizer.node(0).size_ == 256);
+    CHECK(!optimizer.removed(2) && !optimizer.removed(3) && !optimizer.removed(4));
+    CHECK(!optimizer.removed(5) && !optimizer.removed(6));
+  }
+}
+
+static void testEventNodes() {
+  // 0: record A -> 1 -> 2: wait A, redundant
+  // 3: record B, 4: wait B unordered
+  // 5: wait C without a record
+  // 6: record D -> 8: wait D, 7: record D unordered
+  Optimizer optimizer(9);
+  optimizer.node(0) = eventNode(Kind::EventRecord, 0xA);
+  optimizer.node(2) = eventNode(Kind::EventWait, 0xA);
+  optimizer.node(3) = eventNode(Kind::EventRecord, 0xB);
+  optimizer.node(4) = eventNode(Kind::EventWait, 0xB);
+  optimizer.node(5) = eventNode(Kind::EventWait, 0xC);
+  optimizer.node(6) = eventNode(Kind::EventRecord, 0xD);
+  optimizer.node(7) = eventNode(Kind::EventRecord, 0xD);
+  optimizer.node(8) = eventNode(Kind::EventWait, 0xD);
+  optimizer.addEdge(0, 1);
+  optimizer.addEdge(1, 2);
+  optimizer.addEdge(6, 8);
+  Optimizer::Stats stats;
+  CHECK(optimizer.optimize(Optimizer::EventNodes, &stats));
+  CHECK(stats.eventNodesRemoved_ == 1);
+  CHECK(optimizer.removed(2));
+  CHECK(!optimizer.removed(0) && !optimizer.removed(4) && !optimizer.removed(5));
+  CHECK(!optimizer.removed(8));
+}
+
+//! All passes on random DAGs keep the order between the remaining nodes
+static void testRandom() {
+  std::mt19937_64 rng(2025);
+  for (int iteration = 0; iteration < 200; ++iteration) {
+    const size_t n = 2 + rng() % 40;
+    const double density = 0.02 + (rng() % 100) / 400.0;
+    Optimizer optimizer(n);
+    std::vector<std::pair<size_t, size_t>> edges;
+    for (size_t i = 0; i < n; ++i) {
+      switch (rng() % 6) {
+        case 0:
+          optimizer.node(i).kind_ = Kind::Empty;
+          break;
+        case 1:
+          optimizer.node(i) = memsetNode(0x100000 + (rng() % 4) * 64, 64);
+          break;
+        case 2:
+          optimizer.node(i) = eventNode(Kind::EventWait, 1 + rng() % 2);
+          break;
+        case 3:
+          optimizer.node(i) = eventNode(Kind::EventRecord, 1 + rng() % 2);
+          break;
+        default:
+          break;
+      }
+      for (size_t j = i + 1; j < n; ++j) {
+        if (std::uniform_real_distribution<double>(0, 1)(rng) < density) {
+          optimizer.addEdge(i, j);
+          edges.emplace_back(i, j);
+        }
+      }
+    }
+    const std::vector<Optimizer::Node> nodes = [&]() {
+      std::vector<Optimizer::Node> copy;
+      for (size_t i = 0; i < n; ++i) {
+        copy.push_back(optimizer.node(i));
+      }
+      return copy;
+    }();
+    Optimizer::Stats stats;
+    CHECK(optimizer.optimize(Optimizer::AllPasses, &stats));
+    auto before = closure(n, edges);
+    auto remaining = remainingEdges(optimizer);
+    auto after = closure(n, remaining);
+    // The node a merged node was absorbed by stands for it
+    auto target = [&](size_t i) {
+      size_t merged = optimizer.mergedInto(i);
+      return (merged == Optimizer::kNone) ? i : merged;
+    };
+    for (size_t i = 0; i < n; ++i) {
+      for (size_t j = 0; j < n; ++j) {
+        const bool kept = !optimizer.removed(i) && !optimizer.removed(j);
+        if (kept && (nodes[i].kind_ != Kind::Empty) && (nodes[j].kind_ != Kind::Empty)) {
+          CHECK(before[i][j] == after[i][j]);
+        }
+        // The ordering of a merged node carries over to the absorbing node
+        if ((optimizer.mergedInto(i) != Optimizer::kNone) && (target(i) != j) && before[j][i] &&
+            !optimizer.removed(j) && (nodes[j].kind_ != Kind::Empty)) {
+          CHECK(after[j][target(i)]);
+        }
+        if ((optimizer.mergedInto(i) != Optimizer::kNone) && (target(i) != j) && before[i][j] &&
+            !optimizer.removed(j) && (nodes[j].kind_ != Kind::Empty)) {
+          CHECK(after[target(i)][j]);
+        }
+      }
+    }
+    // No remaining edge is implied by another path
+    for (const auto& edge : remaining) {
+      for (auto s : optimizer.successors(edge.first)) {
+        CHECK((s == edge.second) || !after[s][edge.second]);
+      }
+    }
+    // A removed wait had all records of its event before it
+    for (size_t i = 0; i < n; ++i) {
+      if ((nodes[i].kind_ == Kind::EventWait) && optimizer.removed(i)) {
+        bool hasRecord = false;
+        for (size_t r = 0; r < n; ++r) {
+          if ((nodes[r].kind_ == Kind::EventRecord) && (nodes[r].event_ == nodes[i].event_)) {
+            hasRecord = true;
+            CHECK(before[r][i]);
+          }
+        }
+        CHECK(hasRecord);
+      }
+    }
+    if (failures_ != 0) {
+      printf("  iteration %d, %zu nodes\n", iteration, n);
+      return;
+    }
+  }
+}
+
+static void benchmark() {
+  std::mt19937_64 rng(7);
+  printf("%8s %8s %10s %10s %10s %12s\n", "nodes", "edges", "removed", "empty", "merged",
+         "time (ms)");
+  for (size_t n : {1000, 4000, 8000}) {
+    Optimizer optimizer(n);
+    size_t edges = 0;
+    for (size_t i = 0; i < n; ++i) {
+      if (rng() % 8 == 0) {
+        optimizer.node(i).kind_ = Kind::Empty;
+      } else if (rng() % 8 == 0) {
+        optimizer.node(i) = memsetNode(0x100000 + i * 64, 64);
+      }
+      // Layers of a captured graph, each node depends on a few recent nodes
+      for (size_t k = 0; k < 4 && i > 0; ++k) {
+        size_t from = (i > 16) ? i - 1 - rng() % 16 : rng() % i;
+        optimizer.addEdge(from, i);
+        ++edges;
+      }
+    }
+    auto start = std::chrono::steady_clock::now();
+    Optimizer::Stats stats;
+    optimizer.optimize(Optimizer::AllPasses, &stats);
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    printf("%8zu %8zu %10zu %10zu %10zu %12.2f\n", n, stats.edges_, stats.edgesRemoved_,
+           stats.emptyNodesRemoved_, stats.memsetsCoalesced_, elapsed.count());
+  }
+}
+
+int main(int argc, char** argv) {
+  testReduction();
+  testEmptyNodes();
+  testCoalescing();
+  testEventNodes();
+  testRandom();
+  if (argc > 1 && std::string(argv[1]) == "--bench") {
+    benchmark();
+  }
+  printf("%s\n", (failures_ == 0) ? "PASSED" : "FAILED");
+  return (failures_ == 0) ? 0 : 1;
+}
@@ -0,0 +1,213 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include <utils/handletable.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+// Unit test and microbenchmark for amd::ConcurrentHandleTable, runs without a GPU.
+
+struct Object {
+  uint64_t payload_[4];
+};
+
+static int failures_ = 0;
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #cond);        \
+      ++failures_;                                                     \
+    }                                                                  \
+  } while (0)
+
+//! The reference implementation, same as the original per device stream sets
+class DeviceSets {
+ public:
+  explicit DeviceSets(size_t devices) : devices_(devices) {}
+  void insert(size_t device, const Object* obj) {
+    std::unique_lock lock(devices_[device].lock_);
+    devices_[device].set_.insert(obj);
+  }
+  bool contains(const Object* obj) {
+    for (auto& device : devices_) {
+      std::shared_lock lock(device.lock_);
+      if (device.set_.find(obj) != device.set_.end()) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  struct Device {
+    std::shared_mutex lock_;
+    std::unordered_set<const Object*> set_;
+  };
+  std::vector<Device> devices_;
+};
+
+static void testBasic() {
+  amd::ConcurrentHandleTable<Object> table;
+  Object a = {}, b = {}, c = {};
+  CHECK(!table.contains(&a));
+  CHECK(!table.contains(nullptr));
+  CHECK(!table.contains(reinterpret_cast<void*>(1)));
+  table.insert(&a);
+  table.insert(&b);
+  table.insert(&a);
+  CHECK(table.size() == 2);
+  CHECK(table.contains(&a) && table.contains(&b) && !table.contains(&c));
+  table.erase(&a);
+  table.erase(&c);
+  CHECK(table.size() == 1);
+  CHECK(!table.contains(&a) && table.contains(&b));
+  // Keys inside an object aren't handles
+  CHECK(!table.contains(reinterpret_cast<uint8_t*>(&b) + 8));
+  table.insert(&a);
+  CHECK(table.contains(&a));
+}
+
+static void testRandom() {
+  // Create and destroy churn, the table is rebuilt and recycled many times
+  std::mt19937_64 rng(1234);
+  amd::ConcurrentHandleTable<Object> table;
+  std::vector<Object> objects(5000);
+  std::vector<bool> live(objects.size(), false);
+  size_t count = 0;
+  for (int iter = 0; iter < 500000; ++iter) {
+    // Grow to a few thousand handles, then shrink to a few
+    size_t range = (iter / 100000 % 2 == 0) ? objects.size() : 16;
+    size_t i = rng() % range;
+    if (live[i]) {
+      table.erase(&objects[i]);
+      --count;
+    } else {
+      table.insert(&objects[i]);
+      ++count;
+    }
+    live[i] = !live[i];
+    size_t j = rng() % objects.size();
+    CHECK(table.contains(&objects[j]) == live[j]);
+  }
+  CHECK(table.size() == count);
+  for (size_t i = 0; i < objects.size(); ++i) {
+    CHECK(table.contains(&objects[i]) == live[i]);
+  }
+}
+
+static void testConcurrent() {
+  // Readers must always find the stable objects and never the destroyed ones while a
+  // writer churns the others
+  amd::ConcurrentHandleTable<Object> table;
+  std::mutex lock;
+  std::vector<Object> objects(2048);
+  std::vector<Object> never(64);
+  for (size_t i = 0; i < objects.size(); i += 2) {
+    table.insert(&objects[i]);
+  }
+  std::atomic<bool> done{false};
+  std::vector<std::thread> readers;
+  for (uint t = 0; t < 4; ++t) {
+    readers.emplace_back([&, t]() {
+      std::mt19937_64 rng(t);
+      while (!done.load(std::memory_order_relaxed)) {
+        CHECK(table.contains(&objects[(rng() % (objects.size() / 2)) * 2]));
+        CHECK(!table.contains(&never[rng() % never.size()]));
+      }
+    });
+  }
+  std::mt19937_64 rng(42);
+  for (int iter = 0; iter < 200000; ++iter) {
+    Object* obj = &objects[(rng() % (objects.size() / 2)) * 2 + 1];
+    std::lock_guard<std::mutex> guard(lock);
+    table.insert(obj);
+    table.erase(obj);
+  }
+  done = true;
+  for (auto& r : readers) {
+    r.join();
+  }
+}
+
+template <typename Lookup> static double runBench(uint threads, size_t lookups, Lookup lookup) {
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  for (uint t = 0; t < threads; ++t) {
+    workers.emplace_back([&, t]() {
+      size_t hits = 0;
+      for (size_t i = 0; i < lookups; ++i) {
+        hits += lookup(i * 7 + t) ? 1 : 0;
+      }
+      if (hits != lookups) {
+        ++failures_;
+      }
+    });
+  }
+  for (auto& w : workers) {
+    w.join();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return (threads * lookups) / elapsed.count() / 1e6;
+}
+
+static void benchmark() {
+  // 8 devices with 64 streams each, the lookups hit streams of the last device
+  const size_t devices = 8;
+  const size_t streams = 64;
+  std::vector<Object> objects(devices * streams);
+  DeviceSets sets(devices);
+  amd::ConcurrentHandleTable<Object> table;
+  for (size_t i = 0; i < objects.size(); ++i) {
+    sets.insert(i / streams, &objects[i]);
+    table.insert(&objects[i]);
+  }
+  const Object* last = &objects[(devices - 1) * streams];
+  const size_t lookups = 2000000;
+  printf("%8s %16s %16s\n", "threads", "sets (Mlookup/s)", "table (Mlookup/s)");
+  for (uint threads = 1; threads <= std::thread::hardware_concurrency() && threads <= 32;
+       threads *= 2) {
+    double setRate =
+        runBench(threads, lookups / 4, [&](size_t i) { return sets.contains(last + i % streams); });
+    double tableRate =
+        runBench(threads, lookups, [&](size_t i) { return table.contains(last + i % streams); });
+    printf("%8u %16.1f %16.1f\n", threads, setRate, tableRate);
+  }
+}
+
+int main(int argc, char** argv) {
+  testBasic();
+  testRandom();
+  testConcurrent();
+  if (argc > 1 && std::string(argv[1]) == "--bench") {
+    benchmark();
+  }
+  printf("%s\n", (failures_ == 0) ? "PASSED" : "FAILED");
+  return (failures_ == 0) ? 0 : 1;
+}
@@ -0,0 +1,189 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include <utils/hashpool.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+// Unit test and benchmark for amd::HashPool, the pool of the instantiated HIP graphs.
+// Runs without a GPU.
+
+static int failures_ = 0;
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #cond);        \
+      ++failures_;                                                     \
+    }                                                                  \
+  } while (0)
+
+static void testTake() {
+  amd::HashPool<int> pool(1000);
+  std::vector<int> removed;
+  int value = 0;
+  CHECK(!pool.take(1, 0, &value));
+  CHECK(pool.stats().misses_ == 1);
+
+  CHECK(pool.insert(1, 10, 100, 1, &removed));
+  CHECK(pool.insert(1, 20, 100, 2, &removed));
+  CHECK(pool.insert(2, 10, 100, 3, &removed));
+  CHECK(pool.size() == 300);
+  CHECK(pool.count() == 3);
+
+  // The tag is preferred
+  CHECK(pool.take(1, 10, &value) && value == 1);
+  CHECK(pool.stats().exactHits_ == 1);
+  // Otherwise the most recent value of the key
+  CHECK(pool.insert(1, 30, 100, 4, &removed));
+  CHECK(pool.take(1, 99, &value) && value == 4);
+  CHECK(pool.take(1, 99, &value) && value == 2);
+  CHECK(!pool.take(1, 20, &value));
+  CHECK(pool.take(2, 0, &value) && value == 3);
+  CHECK(pool.size() == 0);
+  CHECK(pool.count() == 0);
+  CHECK(pool.stats().hits_ == 4);
+  CHECK(removed.empty());
+}
+
+static void testBudget() {
+  amd::HashPool<int> pool(1000);
+  std::vector<int> removed;
+  // Too large values stay with the caller
+  CHECK(!pool.insert(1, 0, 1001, 1, &removed));
+  CHECK(pool.count() == 0);
+
+  for (int i = 0; i < 10; ++i) {
+    CHECK(pool.insert(i % 3, i, 100, i, &removed));
+  }
+  CHECK(removed.empty());
+  CHECK(pool.size() == 1000);
+  // The oldest values are evicted first
+  CHECK(pool.insert(7, 0, 250, 10, &removed));
+  CHECK((removed == std::vector<int>{0, 1, 2}));
+  CHECK(pool.size() == 950);
+  CHECK(pool.stats().evictions_ == 3);
+  int value = 0;
+  CHECK(pool.take(0, 3, &value) && value == 3);
+
+  removed.clear();
+  pool.clear(&removed);
+  std::sort(removed.begin(), removed.end());
+  CHECK((removed == std::vector<int>{4, 5, 6, 7, 8, 9, 10}));
+  CHECK(pool.size() == 0);
+  CHECK(!pool.take(1, 4, &value));
+}
+
+static void testRandom() {
+  // Compares with a reference vector of the values in the insertion order
+  struct Ref {
+    uint64_t key_;
+    uint64_t tag_;
+    size_t size_;
+    int value_;
+  };
+  std::mt19937_64 rng(11);
+  const size_t budget = 5000;
+  amd::HashPool<int> pool(budget);
+  std::vector<Ref> ref;
+  size_t refSize = 0;
+  for (int i = 0; i < 20000; ++i) {
+    uint64_t key = rng() % 16;
+    uint64_t tag = rng() % 4;
+    if (rng() % 2) {
+      size_t size = 1 + rng() % 400;
+      std::vector<int> removed;
+      CHECK(pool.insert(key, tag, size, i, &removed));
+      ref.push_back({key, tag, size, i});
+      refSize += size;
+      std::vector<int> expected;
+      while (refSize > budget) {
+        expected.push_back(ref.front().value_);
+        refSize -= ref.front().size_;
+        ref.erase(ref.begin());
+      }
+      CHECK(removed == expected);
+    } else {
+      int expected = -1;
+      size_t pick = ref.size();
+      for (size_t j = ref.size(); j-- > 0;) {
+        if (ref[j].key_ == key) {
+          if (pick == ref.size()) {
+            pick = j;
+          }
+          if (ref[j].tag_ == tag) {
+            pick = j;
+            break;
+          }
+        }
+      }
+      if (pick != ref.size()) {
+        expected = ref[pick].value_;
+        refSize -= ref[pick].size_;
+        ref.erase(ref.begin() + pick);
+      }
+      int value = -1;
+      bool found = pool.take(key, tag, &value);
+      CHECK(found == (expected != -1));
+      CHECK(value == expected);
+    }
+    CHECK(pool.size() == refSize);
+    if (failures_ != 0) {
+      printf("  iteration %d\n", i);
+      return;
+    }
+  }
+}
+
+static void benchmark() {
+  const int iterations = 1000000;
+  amd::HashPool<int> pool(SIZE_MAX);
+  std::vector<int> removed;
+  std::mt19937_64 rng(3);
+  for (int i = 0; i < 1000; ++i) {
+    pool.insert(rng() % 256, 0, 1, i, &removed);
+  }
+  auto start = std::chrono::steady_clock::now();
+  int value = 0;
+  for (int i = 0; i < iterations; ++i) {
+    uint64_t key = rng() % 256;
+    if (pool.take(key, i % 4, &value)) {
+      pool.insert(key, i % 4, 1, value, &removed);
+    }
+  }
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  printf("take and insert: %.1f ns\n", elapsed.count() / iterations);
+}
+
+int main(int argc, char** argv) {
+  testTake();
+  testBudget();
+  testRandom();
+  if (argc > 1 && std::string(argv[1]) == "--bench") {
+    benchmark();
+  }
+  printf("%s\n", (failures_ == 0) ? "PASSED" : "FAILED");
+  return (failures_ == 0) ? 0 : 1;
+}
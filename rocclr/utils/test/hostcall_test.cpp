@@ -0,0 +1,275 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include <device/devhcbuffer.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Unit test and microbenchmark for the hostcall buffer protocol, runs without a GPU.
+// Producer threads play the waves of a kernel and service threads play the hostcall
+// listener threads, each one serving a shard of the buffers.
+
+static int failures_ = 0;
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #cond);        \
+      ++failures_;                                                     \
+    }                                                                  \
+  } while (0)
+
+//! The stacks of the buffer, same offsets as amd::HostcallBuffer
+struct BufferView {
+  amd::PacketHeader* headers_;
+  amd::Payload* payloads_;
+  void* doorbell_;
+  uint64_t free_stack_;
+  std::atomic<uint64_t> ready_stack_;
+  uint64_t index_mask_;
+};
+
+//! A wave on the device, the same steps as the device library
+class Wave {
+ public:
+  Wave(amd::HostcallBuffer* buffer, std::atomic<uint64_t>* doorbell)
+      : buffer_(buffer), view_(reinterpret_cast<BufferView*>(buffer)), doorbell_(doorbell) {}
+
+  //! Submits one packet and waits for the response
+  void call(uint32_t service, uint64_t activemask, uint64_t* args, uint64_t* results) {
+    uint64_t ptr = popFree();
+    amd::PacketHeader* header = buffer_->getHeader(ptr);
+    amd::Payload* payload = buffer_->getPayload(ptr);
+    header->service_ = service;
+    header->activemask_ = activemask;
+    for (uint32_t wi = 0; wi < 64; ++wi) {
+      if (activemask & (1ull << wi)) {
+        payload->slots[wi][0] = args[wi];
+      }
+    }
+    header->control_.store(1, std::memory_order_relaxed);
+    pushReady(ptr);
+    doorbell_->fetch_add(1, std::memory_order_release);
+    while (header->control_.load(std::memory_order_acquire) & 1) {
+      std::this_thread::yield();
+    }
+    for (uint32_t wi = 0; wi < 64; ++wi) {
+      if (activemask & (1ull << wi)) {
+        results[wi] = payload->slots[wi][0];
+      }
+    }
+    returnFree(ptr);
+  }
+
+ private:
+  uint64_t popFree() {
+    uint64_t top = __atomic_load_n(&view_->free_stack_, __ATOMIC_ACQUIRE);
+    while (true) {
+      if (top == 0) {
+        std::this_thread::yield();
+        top = __atomic_load_n(&view_->free_stack_, __ATOMIC_ACQUIRE);
+        continue;
+      }
+      uint64_t next = buffer_->getHeader(top)->next_;
+      if (__atomic_compare_exchange_n(&view_->free_stack_, &top, next, false, __ATOMIC_ACQUIRE,
+                                      __ATOMIC_ACQUIRE)) {
+        return top;
+      }
+    }
+  }
+
+  void pushReady(uint64_t ptr) {
+    amd::PacketHeader* header = buffer_->getHeader(ptr);
+    uint64_t top = view_->ready_stack_.load(std::memory_order_relaxed);
+    do {
+      header->next_ = top;
+    } while (!view_->ready_stack_.compare_exchange_weak(top, ptr, std::memory_order_release,
+                                                        std::memory_order_relaxed));
+  }
+
+  void returnFree(uint64_t ptr) {
+    // A new tag on every reuse of the packet avoids the ABA problem
+    ptr += view_->index_mask_ + 1;
+    amd::PacketHeader* header = buffer_->getHeader(ptr);
+    uint64_t top = __atomic_load_n(&view_->free_stack_, __ATOMIC_RELAXED);
+    do {
+      header->next_ = top;
+    } while (!__atomic_compare_exchange_n(&view_->free_stack_, &top, ptr, true, __ATOMIC_RELEASE,
+                                          __ATOMIC_RELAXED));
+  }
+
+  amd::HostcallBuffer* buffer_;
+  BufferView* view_;
+  std::atomic<uint64_t>* doorbell_;
+};
+
+struct Setup {
+  uint32_t buffers_;      //!< The number of buffers (device queues)
+  uint32_t waves_;        //!< The number of waves per buffer
+  uint32_t calls_;        //!< The number of calls per wave
+  uint32_t threads_;      //!< The number of service threads
+  uint32_t maxBatches_;   //!< The max number of ready stacks per wakeup
+};
+
+//! Runs the waves against the service threads, returns the calls per second
+static double run(const Setup& setup) {
+  constexpr uint32_t kNumPackets = 64;
+  std::vector<std::unique_ptr<uint64_t[]>> storage;
+  std::vector<amd::HostcallBuffer*> buffers;
+  for (uint32_t i = 0; i < setup.buffers_; ++i) {
+    size_t size = amd::HostcallBuffer::getBufferSize(kNumPackets);
+    storage.emplace_back(new uint64_t[(size + 7) / 8]());
+    buffers.push_back(reinterpret_cast<amd::HostcallBuffer*>(storage.back().get()));
+    buffers.back()->initialize(kNumPackets);
+  }
+  std::atomic<uint64_t> doorbell{0};
+  std::atomic<bool> done{false};
+  std::atomic<uint64_t> served{0};
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> services;
+  for (uint32_t t = 0; t < setup.threads_; ++t) {
+    services.emplace_back([&, t]() {
+      uint64_t seen = 0;
+      uint64_t count = 0;
+      while (true) {
+        uint64_t value = doorbell.load(std::memory_order_acquire);
+        if (value == seen) {
+          if (done.load(std::memory_order_acquire)) {
+            break;
+          }
+          std::this_thread::yield();
+          continue;
+        }
+        seen = value;
+        for (uint32_t i = t; i < buffers.size(); i += setup.threads_) {
+          count += buffers[i]->drainPackets(
+              [](uint32_t service, uint64_t activemask, amd::Payload* payload) {
+                while (activemask) {
+                  uint32_t wi = amd::leastBitSet(activemask);
+                  activemask ^= 1ull << wi;
+                  payload->slots[wi][0] = payload->slots[wi][0] * 3 + service;
+                }
+              },
+              setup.maxBatches_);
+        }
+      }
+      served += count;
+    });
+  }
+
+  std::vector<std::thread> waves;
+  std::atomic<uint64_t> calls{0};
+  for (uint32_t b = 0; b < setup.buffers_; ++b) {
+    for (uint32_t w = 0; w < setup.waves_; ++w) {
+      waves.emplace_back([&, b, w]() {
+        std::mt19937_64 rng(b * 1000 + w);
+        Wave wave(buffers[b], &doorbell);
+        uint64_t args[64];
+        uint64_t results[64];
+        for (uint32_t c = 0; c < setup.calls_; ++c) {
+          uint64_t activemask = rng() | 1;
+          uint32_t service = 1 + c % 3;
+          for (uint32_t wi = 0; wi < 64; ++wi) {
+            args[wi] = rng();
+          }
+          wave.call(service, activemask, args, results);
+          bool match = true;
+          for (uint32_t wi = 0; wi < 64; ++wi) {
+            if (activemask & (1ull << wi)) {
+              match &= (results[wi] == args[wi] * 3 + service);
+            }
+          }
+          CHECK(match);
+        }
+        calls += setup.calls_;
+      });
+    }
+  }
+  for (auto& w : waves) {
+    w.join();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  done = true;
+  for (auto& s : services) {
+    s.join();
+  }
+  CHECK(served == calls);
+  // All packets must be back on the free stacks
+  for (auto buffer : buffers) {
+    auto view = reinterpret_cast<BufferView*>(buffer);
+    uint32_t free = 0;
+    for (uint64_t ptr = view->free_stack_; ptr != 0; ptr = buffer->getHeader(ptr)->next_) {
+      ++free;
+      if (free > kNumPackets) {
+        break;
+      }
+    }
+    CHECK(free == kNumPackets);
+    CHECK(view->ready_stack_ == 0);
+  }
+  return calls / elapsed.count();
+}
+
+static void testLayout() {
+  CHECK(offsetof(BufferView, ready_stack_) == 32);
+  CHECK(sizeof(BufferView) <= sizeof(amd::HostcallBuffer));
+  CHECK(amd::HostcallBuffer::getIndexMask(100) == 127);
+  CHECK(amd::HostcallBuffer::getBufferSize(64) >= 64 * (sizeof(amd::Payload) +
+                                                          sizeof(amd::PacketHeader)));
+}
+
+static void testProtocol() {
+  for (uint32_t threads : {1, 2, 3}) {
+    for (uint32_t batches : {1, 8}) {
+      run({4, 6, 500, threads, batches});
+    }
+  }
+  // More waves than packets, the waves wait for free packets
+  run({1, 80, 100, 1, 8});
+}
+
+static void benchmark() {
+  printf("%8s %8s %8s %8s %16s\n", "buffers", "waves", "threads", "batches", "calls/s");
+  for (uint32_t buffers : {1, 8}) {
+    for (uint32_t threads : {1, 2, 4}) {
+      for (uint32_t batches : {1, 8}) {
+        Setup setup{buffers, 8, 20000 / buffers, threads, batches};
+        printf("%8u %8u %8u %8u %16.0f\n", buffers, setup.waves_, threads, batches, run(setup));
+      }
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  testLayout();
+  testProtocol();
+  if (argc > 1 && std::string(argv[1]) == "--bench") {
+    benchmark();
+  }
+  printf("%s\n", (failures_ == 0) ? "PASSED" : "FAILED");
+  return (failures_ == 0) ? 0 : 1;
+}
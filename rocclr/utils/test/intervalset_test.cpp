@@ -0,0 +1,244 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include <utils/intervalset.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+// Unit test and benchmark for amd::IntervalSet and the memory dependency tracking
+// built on top of it in roc::VirtualGPU::MemoryDependency. Runs without a GPU.
+
+static int failures_ = 0;
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #cond);        \
+      ++failures_;                                                     \
+    }                                                                  \
+  } while (0)
+
+struct Access {
+  uint64_t start_;
+  uint64_t end_;
+  bool readOnly_;
+};
+
+//! The original linear scan tracker
+class LinearTracker {
+ public:
+  explicit LinearTracker(size_t max) : max_(max) {}
+
+  void newKernel() { end_ = states_.size(); }
+
+  //! Returns true if the access required a barrier
+  bool validate(const Access& cur) {
+    bool flush = false;
+    for (size_t j = 0; j < end_; ++j) {
+      const Access& busy = states_[j];
+      if ((((cur.start_ >= busy.start_) && (cur.start_ < busy.end_)) ||
+           ((cur.end_ > busy.start_) && (cur.end_ <= busy.end_)) ||
+           ((cur.start_ <= busy.start_) && (cur.end_ >= busy.end_))) &&
+          (!busy.readOnly_ || !cur.readOnly_)) {
+        flush = true;
+        break;
+      }
+    }
+    if (max_ <= states_.size()) {
+      flush = true;
+    }
+    if (flush) {
+      states_.erase(states_.begin(), states_.begin() + end_);
+      end_ = 0;
+      if (states_.size() >= max_) {
+        max_ <<= 1;
+      }
+    }
+    states_.push_back(cur);
+    return flush;
+  }
+
+ private:
+  std::vector<Access> states_;
+  size_t end_ = 0;
+  size_t max_;
+};
+
+//! Same logic as roc::VirtualGPU::MemoryDependency
+class IntervalTracker {
+ public:
+  explicit IntervalTracker(size_t max) : max_(max) {}
+
+  void newKernel() {
+    for (const auto& state : kernel_) {
+      busy_.insert(state.start_, state.end_, state.readOnly_);
+    }
+    kernel_.clear();
+  }
+
+  bool validate(const Access& cur) {
+    bool flush = (max_ <= num_) || busy_.conflicts(cur.start_, cur.end_, cur.readOnly_);
+    if (flush) {
+      busy_.clear();
+      if (kernel_.size() >= max_) {
+        max_ <<= 1;
+      }
+      num_ = kernel_.size();
+    }
+    kernel_.push_back(cur);
+    num_++;
+    return flush;
+  }
+
+ private:
+  amd::AccessIntervalSet busy_;
+  std::vector<Access> kernel_;
+  size_t num_ = 0;
+  size_t max_;
+};
+
+static void testIntervalSet() {
+  amd::IntervalSet set;
+  set.insert(100, 200);
+  set.insert(300, 400);
+  CHECK(set.size() == 2);
+  CHECK(set.overlaps(150, 160));
+  CHECK(set.overlaps(50, 101));
+  CHECK(set.overlaps(199, 300));
+  CHECK(!set.overlaps(200, 300));
+  CHECK(!set.overlaps(0, 100));
+  CHECK(!set.overlaps(400, 500));
+  CHECK(set.overlaps(0, 1000));
+  CHECK(!set.overlaps(150, 150));
+
+  // Touching intervals are coalesced
+  set.insert(200, 300);
+  CHECK(set.size() == 1);
+  CHECK(set.overlaps(250, 251));
+  // A covering interval swallows everything
+  set.insert(500, 600);
+  set.insert(700, 800);
+  set.insert(50, 1000);
+  CHECK(set.size() == 1);
+  CHECK(set.overlaps(999, 2000));
+  CHECK(!set.overlaps(1000, 2000));
+  set.clear();
+  CHECK(set.empty());
+  CHECK(!set.overlaps(0, ~0ull));
+
+  amd::AccessIntervalSet access;
+  access.insert(0, 100, true);
+  access.insert(200, 300, false);
+  CHECK(!access.conflicts(50, 60, true));   // Read after read
+  CHECK(access.conflicts(50, 60, false));   // Write after read
+  CHECK(access.conflicts(250, 260, true));  // Read after write
+  CHECK(!access.conflicts(100, 200, false));
+}
+
+static std::vector<std::vector<Access>> makeKernels(size_t numKernels, size_t numArgs,
+                                                    size_t numBuffers, uint seed) {
+  std::mt19937_64 rng(seed);
+  std::vector<Access> buffers(numBuffers);
+  uint64_t base = 0x100000000ull;
+  for (auto& buf : buffers) {
+    buf.start_ = base;
+    buf.end_ = base + 4096 * (1 + rng() % 64);
+    base = buf.end_ + 4096 * (rng() % 2);
+  }
+  std::vector<std::vector<Access>> kernels(numKernels);
+  for (auto& args : kernels) {
+    for (size_t i = 0; i < numArgs; ++i) {
+      Access arg = buffers[rng() % buffers.size()];
+      if (rng() % 8 == 0) {
+        // Sub-buffer view
+        uint64_t size = arg.end_ - arg.start_;
+        arg.start_ += (rng() % size) & ~0xffull;
+        arg.end_ = std::min(arg.end_, arg.start_ + 256 * (1 + rng() % 32));
+      }
+      arg.readOnly_ = (rng() % 4) != 0;
+      args.push_back(arg);
+    }
+  }
+  return kernels;
+}
+
+static void testTrackers() {
+  // The interval tracker must request exactly the same barriers as the linear scan
+  for (uint seed = 0; seed < 20; ++seed) {
+    for (size_t numArgs : {1, 4, 32, 300}) {
+      auto kernels = makeKernels(200, numArgs, 64 + seed * 32, seed);
+      LinearTracker linear(256);
+      IntervalTracker interval(256);
+      for (const auto& args : kernels) {
+        linear.newKernel();
+        interval.newKernel();
+        for (const auto& arg : args) {
+          CHECK(linear.validate(arg) == interval.validate(arg));
+        }
+      }
+    }
+  }
+}
+
+template <typename Tracker>
+static double runBench(const std::vector<std::vector<Access>>& kernels, size_t max,
+                       size_t* flushes) {
+  Tracker tracker(max);
+  *flushes = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (const auto& args : kernels) {
+    tracker.newKernel();
+    for (const auto& arg : args) {
+      *flushes += tracker.validate(arg) ? 1 : 0;
+    }
+  }
+  std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / kernels.size();
+}
+
+static void benchmark() {
+  printf("%6s %8s %16s %16s %10s\n", "args", "limit", "linear (us/krn)", "interval (us/krn)",
+         "barriers");
+  for (size_t numArgs : {8, 64, 256}) {
+    for (size_t max : {256, 4096}) {
+      auto kernels = makeKernels(2000, numArgs, 100000, 7);
+      size_t linearFlushes = 0;
+      size_t intervalFlushes = 0;
+      double linear = runBench<LinearTracker>(kernels, max, &linearFlushes);
+      double interval = runBench<IntervalTracker>(kernels, max, &intervalFlushes);
+      CHECK(linearFlushes == intervalFlushes);
+      printf("%6zu %8zu %16.2f %16.2f %10zu\n", numArgs, max, linear, interval, intervalFlushes);
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  testIntervalSet();
+  testTrackers();
+  if (argc > 1 && std::string(argv[1]) == "--bench") {
+    benchmark();
+  }
+  printf("%s\n", (failures_ == 0) ? "PASSED" : "FAILED");
+  return (failures_ == 0) ? 0 : 1;
+}
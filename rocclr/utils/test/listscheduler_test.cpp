@@ -0,0 +1,229 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include <utils/listscheduler.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+// Unit test and benchmark for amd::ListScheduler, the critical path scheduler of HIP graphs.
+// Synthetic DAGs are compared against the depth-first round-robin assignment of
+// hip::Graph::ScheduleNodes. Runs without a GPU.
+
+static int failures_ = 0;
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #cond);        \
+      ++failures_;                                                     \
+    }                                                                  \
+  } while (0)
+
+constexpr double kSignalCost = 5.0;
+
+struct Dag {
+  std::vector<double> cost_;
+  std::vector<std::vector<size_t>> edges_;
+
+  amd::ListScheduler scheduler() const {
+    amd::ListScheduler scheduler(cost_.size());
+    for (size_t i = 0; i < cost_.size(); ++i) {
+      scheduler.setCost(i, cost_[i]);
+      for (auto edge : edges_[i]) {
+        scheduler.addEdge(i, edge);
+      }
+    }
+    return scheduler;
+  }
+};
+
+//! Same logic as hip::Graph::ScheduleOneNode()
+static void depthFirst(const Dag& dag, size_t node, uint32_t queue, uint32_t maxQueues,
+                       std::vector<int>* assigned) {
+  if ((*assigned)[node] == -1) {
+    (*assigned)[node] = queue;
+    for (auto edge : dag.edges_[node]) {
+      depthFirst(dag, edge, queue, maxQueues, assigned);
+      queue = (queue + 1) % maxQueues;
+    }
+  }
+}
+
+//! Same logic as hip::Graph::ScheduleNodes() with the depth-first scheduler
+static std::vector<uint32_t> roundRobin(const Dag& dag, uint32_t maxQueues) {
+  std::vector<int> assigned(dag.cost_.size(), -1);
+  uint32_t queue = 0;
+  for (size_t i = 0; i < dag.cost_.size(); ++i) {
+    if (assigned[i] == -1) {
+      depthFirst(dag, i, queue, maxQueues, &assigned);
+      queue = (queue + 1) % maxQueues;
+    }
+  }
+  return std::vector<uint32_t>(assigned.begin(), assigned.end());
+}
+
+static void testChains() {
+  // Two long independent chains and several short roots. The depth-first walk places both
+  // long chains on queue 0, the list scheduler must split them
+  Dag dag;
+  auto addChain = [&](size_t length, double cost) {
+    for (size_t i = 0; i < length; ++i) {
+      dag.cost_.push_back(cost);
+      dag.edges_.push_back({});
+      if (i > 0) {
+        dag.edges_[dag.cost_.size() - 2].push_back(dag.cost_.size() - 1);
+      }
+    }
+  };
+  addChain(10, 100);
+  for (int i = 0; i < 3; ++i) {
+    addChain(1, 1);
+  }
+  addChain(10, 100);
+  auto scheduler = dag.scheduler();
+  amd::ListScheduler::Result result;
+  CHECK(scheduler.schedule(4, kSignalCost, &result));
+  CHECK(result.queue_[0] != result.queue_[13]);
+  // Chains stay on one queue without signals
+  CHECK(result.crossEdges_ == 0);
+  CHECK(result.makespan_ < 1000 + 2 * kSignalCost);
+  CHECK(scheduler.evaluate(roundRobin(dag, 4), kSignalCost) >= 2000);
+
+  // A single queue runs everything serially
+  CHECK(scheduler.schedule(1, kSignalCost, &result));
+  CHECK(result.numQueues_ == 1);
+  CHECK(result.makespan_ == 2003);
+
+  // A serial chain never goes to another queue
+  Dag chain;
+  for (size_t i = 0; i < 5; ++i) {
+    chain.cost_.push_back(10);
+    chain.edges_.push_back({});
+    if (i > 0) {
+      chain.edges_[i - 1].push_back(i);
+    }
+  }
+  CHECK(chain.scheduler().schedule(4, kSignalCost, &result));
+  CHECK(result.numQueues_ == 1);
+
+  // Cycles are rejected
+  amd::ListScheduler cycle(2);
+  cycle.addEdge(0, 1);
+  cycle.addEdge(1, 0);
+  CHECK(!cycle.schedule(4, kSignalCost, &result));
+}
+
+static Dag makeDag(size_t numNodes, size_t maxFanIn, uint seed) {
+  std::mt19937_64 rng(seed);
+  Dag dag;
+  dag.cost_.resize(numNodes);
+  dag.edges_.resize(numNodes);
+  for (size_t i = 0; i < numNodes; ++i) {
+    // Mostly short kernels and copies with a few long ones
+    dag.cost_[i] = (rng() % 8 == 0) ? 50 + rng() % 500 : 2 + rng() % 20;
+    if (i > 0) {
+      size_t fanIn = rng() % (maxFanIn + 1);
+      for (size_t j = 0; j < fanIn; ++j) {
+        // Prefer recent nodes to produce long chains
+        size_t window = std::min<size_t>(i, 16);
+        size_t pred = i - 1 - rng() % window;
+        if (std::find(dag.edges_[pred].begin(), dag.edges_[pred].end(), i) ==
+            dag.edges_[pred].end()) {
+          dag.edges_[pred].push_back(i);
+        }
+      }
+    }
+  }
+  return dag;
+}
+
+static void testRandom() {
+  double listTotal = 0;
+  double robinTotal = 0;
+  for (uint seed = 0; seed < 200; ++seed) {
+    Dag dag = makeDag(20 + seed % 100, 1 + seed % 3, seed);
+    auto scheduler = dag.scheduler();
+    for (uint32_t queues : {1u, 2u, 4u, 8u}) {
+      amd::ListScheduler::Result result;
+      CHECK(scheduler.schedule(queues, kSignalCost, &result));
+      CHECK(result.numQueues_ <= queues);
+      size_t crossEdges = 0;
+      for (size_t i = 0; i < dag.cost_.size(); ++i) {
+        CHECK(result.queue_[i] < result.numQueues_);
+        for (auto edge : dag.edges_[i]) {
+          crossEdges += (result.queue_[i] != result.queue_[edge]) ? 1 : 0;
+        }
+      }
+      CHECK(crossEdges == result.crossEdges_);
+      CHECK(result.makespan_ >= scheduler.criticalPath() - 1e-6);
+      CHECK(result.makespan_ ==
+            scheduler.evaluate(result.queue_, kSignalCost, nullptr, &result.order_));
+      listTotal += result.makespan_;
+      robinTotal += scheduler.evaluate(roundRobin(dag, queues), kSignalCost);
+    }
+  }
+  CHECK(listTotal < robinTotal);
+}
+
+static void benchmark() {
+  printf("%6s %6s %14s %14s %10s %10s %12s\n", "nodes", "queues", "depth-first",
+         "crit-path", "signals", "signals", "sched (us)");
+  for (size_t numNodes : {16, 64, 256, 1024}) {
+    for (uint32_t queues : {2u, 4u, 8u}) {
+      double robin = 0;
+      double list = 0;
+      size_t robinSignals = 0;
+      size_t listSignals = 0;
+      double time = 0;
+      constexpr uint kDags = 20;
+      for (uint seed = 0; seed < kDags; ++seed) {
+        Dag dag = makeDag(numNodes, 2, seed);
+        auto scheduler = dag.scheduler();
+        size_t signals = 0;
+        robin += scheduler.evaluate(roundRobin(dag, queues), kSignalCost, &signals);
+        robinSignals += signals;
+        amd::ListScheduler::Result result;
+        auto start = std::chrono::steady_clock::now();
+        scheduler.schedule(queues, kSignalCost, &result);
+        std::chrono::duration<double, std::micro> elapsed =
+            std::chrono::steady_clock::now() - start;
+        time += elapsed.count();
+        list += result.makespan_;
+        listSignals += result.crossEdges_;
+      }
+      printf("%6zu %6u %14.1f %14.1f %10zu %10zu %12.1f\n", numNodes, queues, robin / kDags,
+             list / kDags, robinSignals / kDags, listSignals / kDags, time / kDags);
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  testChains();
+  testRandom();
+  if (argc > 1 && std::string(argv[1]) == "--bench") {
+    benchmark();
+  }
+  printf("%s\n", (failures_ == 0) ? "PASSED" : "FAILED");
+  return (failures_ == 0) ? 0 : 1;
+}
@@ -0,0 +1,244 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include <utils/logbuffer.hpp>
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Unit test and benchmark for amd::LogRecord and amd::LogRing, the per-thread buffers of
+// the AMD_LOG_ASYNC mode in debug.cpp. Runs without a GPU.
+
+static int failures_ = 0;
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #cond);        \
+      ++failures_;                                                     \
+    }                                                                  \
+  } while (0)
+
+static bool capture(amd::LogRecord* record, const char* format, ...) {
+  va_list ap;
+  va_start(ap, format);
+  bool captured = record->capture(format, ap);
+  va_end(ap);
+  return captured;
+}
+
+//! Captures the message or formats it synchronously, like the asynchronous logger
+static std::string captureOrFormat(amd::LogRecord* record, const char* format, ...) {
+  char message[4096];
+  va_list ap;
+  va_start(ap, format);
+  if (record->capture(format, ap)) {
+    record->format(message, sizeof(message));
+  } else {
+    vsnprintf(message, sizeof(message), format, ap);
+  }
+  va_end(ap);
+  return message;
+}
+
+static std::string expected(const char* format, ...) {
+  char message[4096];
+  va_list ap;
+  va_start(ap, format);
+  vsnprintf(message, sizeof(message), format, ap);
+  va_end(ap);
+  return message;
+}
+
+//! The deferred formatting must match vsnprintf() at the capture time
+#define CHECK_FORMAT(fmt, ...)                                         \
+  do {                                                                 \
+    amd::LogRecord record;                                             \
+    capture(&record, fmt, ##__VA_ARGS__);                              \
+    char message[4096];                                                \
+    record.format(message, sizeof(message));                           \
+    CHECK(expected(fmt, ##__VA_ARGS__) == message);                    \
+  } while (0)
+
+static void testFormat() {
+  CHECK_FORMAT("no arguments");
+  CHECK_FORMAT("100%% done");
+  CHECK_FORMAT("%d %i %u %x %X %o", -5, 7, 3000000000u, 0xbeefu, 0xcafeu, 8u);
+  CHECK_FORMAT("%hhd %hhu %hd %hx", 300, 300, 70000, 70000);
+  CHECK_FORMAT("%ld %lu %lld %llx %zu %zx %td %jd", -1L, 2UL, -3LL, ~0ULL, sizeof(int),
+               static_cast<size_t>(0x1234), static_cast<ptrdiff_t>(-9),
+               static_cast<intmax_t>(42));
+  CHECK_FORMAT("[%5d] [%-5d] [%05d] [%+d] [% d] [%#x] [%#o]", 1, 2, 3, 4, 5, 6u, 7u);
+  CHECK_FORMAT("[%*d] [%-*d] [%.*f] [%*.*s]", 6, 1, 6, 2, 3, 3.14159, 8, 3, "abcdef");
+  CHECK_FORMAT("%f %.2f %e %g %G %a %10.3Lf", 1.5, 2.345, 1e-10, 123456789.0, 1e-5, 0.5,
+               static_cast<long double>(2.5));
+  CHECK_FORMAT("%c%c %s %-10s| %.3s %s", 'o', 'k', "string", "left", "truncated",
+               static_cast<const char*>(nullptr));
+  CHECK_FORMAT("ptr %p null %p", reinterpret_cast<void*>(0x7f001000), nullptr);
+  CHECK_FORMAT("%s: Returned %s : %s", "hipMalloc", "hipSuccess", "ptr: 0x7f0000001000");
+  CHECK_FORMAT("trailing %");
+
+  // Too many arguments are formatted at the capture time
+  CHECK_FORMAT("%d %d %d %d %d %d %d %d %d %d %d %d %d %d", 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11,
+               12, 13, 14);
+  // Wide strings aren't captured
+  CHECK_FORMAT("%ls", L"wide");
+
+  // The arguments are copied, the caller may reuse the storage
+  amd::LogRecord record;
+  char name[16] = "kernel";
+  capture(&record, "%s", name);
+  name[0] = 'K';
+  char message[64];
+  record.format(message, sizeof(message));
+  CHECK(std::string(message) == "kernel");
+
+  // Long strings are formatted at the capture time
+  std::string longString(1000, 'x');
+  CHECK(capture(&record, "short %.10s", longString.c_str()));
+  CHECK(captureOrFormat(&record, "short %.10s", longString.c_str()) == "short xxxxxxxxxx");
+  // The messages longer than the arena aren't captured, so they are never truncated
+  CHECK(!capture(&record, "long %s tail %d", longString.c_str(), 5));
+  CHECK(captureOrFormat(&record, "long %s tail %d", longString.c_str(), 5) ==
+        "long " + longString + " tail 5");
+  std::string longFormat(amd::LogRecord::kArenaSize, 'f');
+  CHECK(!capture(&record, longFormat.c_str()));
+  CHECK(captureOrFormat(&record, longFormat.c_str()) == longFormat);
+
+  // Truncation follows snprintf()
+  capture(&record, "%s %d", "0123456789", 12345);
+  size_t length = record.format(message, 8);
+  CHECK(length == 16);
+  CHECK(std::string(message) == "0123456");
+}
+
+static void testRing() {
+  amd::LogRing ring(4);
+  for (int i = 0; i < 6; ++i) {
+    amd::LogRecord* record = ring.reserve();
+    if (record != nullptr) {
+      capture(record, "message %d", i);
+      ring.commit();
+    }
+  }
+  // Drops the messages above the capacity
+  CHECK(ring.available() == 4);
+  CHECK(ring.dropped() == 2);
+  char message[64];
+  ring.peek(3).format(message, sizeof(message));
+  CHECK(std::string(message) == "message 3");
+  ring.pop(2);
+  CHECK(ring.available() == 2);
+  CHECK(ring.reserve() != nullptr);
+
+  // Single producer and consumer, every message arrives in order or is counted as dropped
+  constexpr int kMessages = 200000;
+  amd::LogRing shared(64);
+  std::thread producer([&]() {
+    for (int i = 0; i < kMessages; ++i) {
+      amd::LogRecord* record = shared.reserve();
+      if (record != nullptr) {
+        record->timeUs_ = i;
+        capture(record, "%d %s", i, "payload");
+        shared.commit();
+      }
+    }
+  });
+  size_t received = 0;
+  int64_t last = -1;
+  bool ordered = true;
+  bool correct = true;
+  while (received + shared.dropped() < kMessages) {
+    size_t count = shared.available();
+    for (size_t i = 0; i < count; ++i) {
+      const amd::LogRecord& record = shared.peek(i);
+      ordered &= static_cast<int64_t>(record.timeUs_) > last;
+      last = record.timeUs_;
+      record.format(message, sizeof(message));
+      correct &= std::to_string(last) + " payload" == message;
+    }
+    shared.pop(count);
+    received += count;
+  }
+  producer.join();
+  CHECK(ordered);
+  CHECK(correct);
+  CHECK(received + shared.dropped() == kMessages);
+}
+
+static void benchmark() {
+  constexpr int kMessages = 200000;
+  const char* format = "%s ( %p, %zu, %d ) : %s";
+  void* ptr = reinterpret_cast<void*>(0x7f0012340000);
+  char message[4096];
+
+  // The synchronous path formats in the calling thread
+  auto start = std::chrono::steady_clock::now();
+  size_t total = 0;
+  for (int i = 0; i < kMessages; ++i) {
+    std::stringstream pidtid;
+    pidtid << "[pid:" << 1234 << " tid: 0x" << std::hex << std::this_thread::get_id() << "]";
+    total += snprintf(message, sizeof(message), format, "hipMemcpyAsync", ptr,
+                      static_cast<size_t>(i), 3, "hipSuccess") + pidtid.str().size();
+  }
+  std::chrono::duration<double, std::nano> sync = std::chrono::steady_clock::now() - start;
+
+  // The asynchronous path only captures the arguments
+  amd::LogRing ring(1024);
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kMessages; ++i) {
+    amd::LogRecord* record = ring.reserve();
+    if (record == nullptr) {
+      ring.pop(ring.available());
+      record = ring.reserve();
+    }
+    capture(record, format, "hipMemcpyAsync", ptr, static_cast<size_t>(i), 3, "hipSuccess");
+    ring.commit();
+  }
+  std::chrono::duration<double, std::nano> async = std::chrono::steady_clock::now() - start;
+
+  // Writer side cost, paid in the background thread
+  const amd::LogRecord& record = ring.peek(0);
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kMessages; ++i) {
+    total += record.format(message, sizeof(message));
+  }
+  std::chrono::duration<double, std::nano> writer = std::chrono::steady_clock::now() - start;
+
+  printf("%20s %20s %20s\n", "sync (ns/msg)", "capture (ns/msg)", "writer (ns/msg)");
+  printf("%20.1f %20.1f %20.1f\n", sync.count() / kMessages, async.count() / kMessages,
+         writer.count() / kMessages);
+  CHECK(total > 0);
+}
+
+int main(int argc, char** argv) {
+  testFormat();
+  testRing();
+  if (argc > 1 && std::string(argv[1]) == "--bench") {
+    benchmark();
+  }
+  printf("%s\n", (failures_ == 0) ? "PASSED" : "FAILED");
+  return (failures_ == 0) ? 0 : 1;
+}
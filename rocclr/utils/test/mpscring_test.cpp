@@ -0,0 +1,298 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include <utils/mpscring.hpp>
+#include <utils/concurrent.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Unit test and latency benchmark for amd::MpscRing and amd::Parker, runs without a GPU.
+
+// Same as Os::alignedMalloc and Os::alignedFree
+void* amd::AlignedMemory::allocate(size_t size, size_t alignment) {
+  void* ptr = nullptr;
+  return (posix_memalign(&ptr, alignment, size) == 0) ? ptr : nullptr;
+}
+
+void amd::AlignedMemory::deallocate(void* ptr) { free(ptr); }
+
+static int failures_ = 0;
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #cond);        \
+      ++failures_;                                                     \
+    }                                                                  \
+  } while (0)
+
+typedef std::chrono::steady_clock Clock;
+
+static uint64_t now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             Clock::now().time_since_epoch()).count();
+}
+
+static void testRing() {
+  amd::MpscRing<uint32_t> ring(5);
+  CHECK(ring.capacity() == 8);
+  CHECK(ring.empty());
+  uint32_t values[16];
+  CHECK(ring.dequeue(values, 16) == 0);
+  for (uint32_t lap = 0; lap < 3; ++lap) {
+    for (uint32_t i = 0; i < 8; ++i) {
+      CHECK(ring.tryEnqueue(lap * 8 + i));
+    }
+    CHECK(!ring.tryEnqueue(100));
+    CHECK(!ring.empty());
+    CHECK(ring.dequeue(values, 3) == 3);
+    CHECK((values[0] == lap * 8) && (values[2] == lap * 8 + 2));
+    CHECK(ring.dequeue(values, 16) == 5);
+    CHECK(values[4] == lap * 8 + 7);
+    CHECK(ring.empty());
+  }
+}
+
+//! Producers append through the ring with the same protocol as HostQueue::append()
+static void stress(size_t producers, size_t capacity, size_t items) {
+  amd::MpscRing<uint64_t> ring(capacity);
+  amd::Parker parker;
+  std::atomic<bool> done(false);
+  std::vector<std::thread> threads;
+  for (size_t p = 0; p < producers; ++p) {
+    threads.emplace_back([&, p]() {
+      for (size_t i = 0; i < items; ++i) {
+        while (!ring.tryEnqueue((i << 8) | p)) {
+          parker.unpark();
+          std::this_thread::yield();
+        }
+        parker.unpark();
+        if ((i % 1024) == 0) {
+          // Let the consumer park
+          std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+      }
+    });
+  }
+  std::vector<size_t> next(producers, 0);
+  size_t received = 0;
+  bool ordered = true;
+  uint64_t batch[32];
+  while (received < producers * items) {
+    size_t count = ring.dequeue(batch, 32);
+    if (count == 0) {
+      parker.park([&]() { return !ring.empty(); });
+      continue;
+    }
+    for (size_t i = 0; i < count; ++i) {
+      size_t p = batch[i] & 0xff;
+      ordered &= (p < producers) && ((batch[i] >> 8) == next[p]);
+      next[p] = (batch[i] >> 8) + 1;
+    }
+    received += count;
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  CHECK(ordered);
+  CHECK(ring.empty());
+}
+
+static void testStress() {
+  stress(1, 1024, 100000);
+  stress(4, 1024, 50000);
+  // A small ring exercises the back pressure
+  stress(4, 4, 20000);
+}
+
+static void testWakeup() {
+  // Ping-pong, every message wakes the other side, a lost wakeup hangs the test
+  amd::Parker ping, pong;
+  std::atomic<uint32_t> toConsumer(0), toProducer(0);
+  const uint32_t kRounds = 20000;
+  std::thread consumer([&]() {
+    for (uint32_t i = 1; i <= kRounds; ++i) {
+      ping.park([&]() { return toConsumer.load(std::memory_order_acquire) >= i; });
+      toProducer.store(i, std::memory_order_release);
+      pong.unpark();
+    }
+  });
+  for (uint32_t i = 1; i <= kRounds; ++i) {
+    toConsumer.store(i, std::memory_order_release);
+    ping.unpark();
+    pong.park([&]() { return toProducer.load(std::memory_order_acquire) >= i; });
+  }
+  consumer.join();
+  CHECK(toProducer == kRounds);
+}
+
+//! The original HostQueue channel, a linked queue and a lock with notify for every append
+class MonitorChannel {
+ public:
+  void append(void* value) {
+    queue_.enqueue(value);
+    std::lock_guard<std::mutex> lock(lock_);
+    cv_.notify_one();
+  }
+  template <typename Process> void loop(Process process) {
+    while (true) {
+      void* value = queue_.dequeue();
+      if (value == nullptr) {
+        std::unique_lock<std::mutex> lock(lock_);
+        while ((value = queue_.dequeue()) == nullptr) {
+          if (done_) {
+            return;
+          }
+          cv_.wait(lock);
+        }
+      }
+      process(value);
+    }
+  }
+  void stop() {
+    std::lock_guard<std::mutex> lock(lock_);
+    done_ = true;
+    cv_.notify_one();
+  }
+
+ private:
+  amd::ConcurrentLinkedQueue<void*> queue_;
+  std::mutex lock_;
+  std::condition_variable cv_;
+  bool done_ = false;
+};
+
+//! The ring channel, same as HostQueue with DEBUG_CLR_HOST_QUEUE_RING_SIZE
+class RingChannel {
+ public:
+  RingChannel() : ring_(1024), done_(false) {}
+  void append(void* value) {
+    while (!ring_.tryEnqueue(value)) {
+      parker_.unpark();
+      std::this_thread::yield();
+    }
+    parker_.unpark();
+  }
+  template <typename Process> void loop(Process process) {
+    void* batch[32];
+    while (true) {
+      size_t count = ring_.dequeue(batch, 32);
+      if (count == 0) {
+        if (done_) {
+          return;
+        }
+        parker_.park([&]() { return !ring_.empty() || done_; });
+        continue;
+      }
+      for (size_t i = 0; i < count; ++i) {
+        process(batch[i]);
+      }
+    }
+  }
+  void stop() {
+    done_ = true;
+    parker_.unpark();
+  }
+  uint64_t wakeups() const { return parker_.wakeups(); }
+
+ private:
+  amd::MpscRing<void*> ring_;
+  amd::Parker parker_;
+  std::atomic<bool> done_;
+};
+
+//! Measures the latency from append() to the command loop, with bursts and idle gaps
+template <typename Channel> static void latency(const char* name, size_t producers,
+                                                size_t burst, uint32_t gapUs) {
+  const size_t kItems = 20000;
+  Channel channel;
+  std::vector<uint64_t> sent(producers * kItems);
+  std::vector<uint64_t> latencies;
+  latencies.reserve(sent.size());
+  std::atomic<uint64_t> appendTime(0);
+  std::thread consumer([&]() {
+    channel.loop([&](void* value) {
+      size_t index = reinterpret_cast<uintptr_t>(value) - 1;
+      latencies.push_back(now() - sent[index]);
+    });
+  });
+  std::vector<std::thread> threads;
+  for (size_t p = 0; p < producers; ++p) {
+    threads.emplace_back([&, p]() {
+      uint64_t time = 0;
+      for (size_t i = 0; i < kItems; ++i) {
+        size_t index = p * kItems + i;
+        uint64_t start = now();
+        sent[index] = start;
+        channel.append(reinterpret_cast<void*>(index + 1));
+        time += now() - start;
+        if (((i + 1) % burst) == 0) {
+          std::this_thread::sleep_for(std::chrono::microseconds(gapUs));
+        }
+      }
+      appendTime += time;
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  while (latencies.size() < sent.size()) {
+    std::this_thread::yield();
+  }
+  channel.stop();
+  consumer.join();
+  std::sort(latencies.begin(), latencies.end());
+  printf("%8s %10zu %6zu %8u %12.0f %10.1f %10.1f %10.1f\n", name, producers, burst, gapUs,
+         static_cast<double>(appendTime) / sent.size(), latencies[latencies.size() / 2] / 1e3,
+         latencies[latencies.size() * 99 / 100] / 1e3, latencies.back() / 1e3);
+}
+
+static void benchmark() {
+  printf("%8s %10s %6s %8s %12s %10s %10s %10s\n", "channel", "producers", "burst", "gap (us)",
+         "append (ns)", "p50 (us)", "p99 (us)", "max (us)");
+  for (size_t producers : {1, 4}) {
+    for (size_t burst : {1, 16}) {
+      for (uint32_t gap : {0u, 20u, 200u}) {
+        latency<MonitorChannel>("monitor", producers, burst, gap);
+        latency<RingChannel>("ring", producers, burst, gap);
+      }
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  testRing();
+  testStress();
+  testWakeup();
+  if (argc > 1 && std::string(argv[1]) == "--bench") {
+    benchmark();
+  }
+  printf("%s\n", (failures_ == 0) ? "PASSED" : "FAILED");
+  return (failures_ == 0) ? 0 : 1;
+}
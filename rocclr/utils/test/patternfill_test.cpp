@@ -0,0 +1,205 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include <utils/patternfill.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(ATI_ARCH_X86) && !defined(_MSC_VER)
+#include <cpuid.h>
+#endif
+
+// Unit test and microbenchmark for amd::PatternFill, runs without a GPU.
+
+static int failures_ = 0;
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #cond);        \
+      ++failures_;                                                     \
+    }                                                                  \
+  } while (0)
+
+//! The reference implementation, same as the original SvmBuffer::memFill
+static void memFillLoop(void* dst, const void* src, size_t srcSize, size_t times) {
+  address dstAddress = reinterpret_cast<address>(dst);
+  const_address srcAddress = reinterpret_cast<const_address>(src);
+  for (size_t i = 0; i < times; i++) {
+    ::memcpy(dstAddress + i * srcSize, srcAddress, srcSize);
+  }
+}
+
+//! Same as Os::cpuid and Os::xgetbv
+static amd::PatternFill::Isa hostIsa() {
+#if defined(ATI_ARCH_X86) && !defined(_MSC_VER)
+  auto cpuid = [](int regs[4], int info) {
+    unsigned int r[4];
+    __cpuid_count(info, 0, r[0], r[1], r[2], r[3]);
+    for (int i = 0; i < 4; ++i) {
+      regs[i] = static_cast<int>(r[i]);
+    }
+  };
+  auto xgetbv = [](uint32_t ecx) {
+    uint32_t eax, edx;
+    __asm__ __volatile__(".byte 0x0f,0x01,0xd0" : "=a"(eax), "=d"(edx) : "c"(ecx));
+    return (static_cast<uint64_t>(edx) << 32) | eax;
+  };
+  return amd::PatternFill::detect(cpuid, xgetbv);
+#else
+  return amd::PatternFill::Generic;
+#endif
+}
+
+//! Fills a guarded destination at every misalignment and compares with the reference
+static void checkFill(const amd::PatternFill::Options& options, size_t patternSize,
+                      size_t count, std::mt19937_64& rng) {
+  constexpr size_t kGuard = 128;
+  const size_t size = patternSize * count;
+  std::vector<uint8_t> pattern(patternSize);
+  for (auto& byte : pattern) {
+    byte = static_cast<uint8_t>(rng());
+  }
+  std::vector<uint8_t> expected(size);
+  memFillLoop(expected.data(), pattern.data(), patternSize, count);
+  std::vector<uint8_t> buffer(size + 2 * kGuard + amd::PatternFill::kVectorAlign);
+  for (size_t misalign = 0; misalign < amd::PatternFill::kVectorAlign;
+       misalign += (size > 4096) ? 13 : 1) {
+    memset(buffer.data(), 0xCD, buffer.size());
+    uint8_t* dst = buffer.data() + kGuard + misalign;
+    amd::PatternFill::fill(dst, pattern.data(), patternSize, count, options);
+    bool match = (memcmp(dst, expected.data(), size) == 0);
+    bool guards = true;
+    for (uint8_t* p = buffer.data(); p < dst; ++p) {
+      guards &= (*p == 0xCD);
+    }
+    for (uint8_t* p = dst + size; p < buffer.data() + buffer.size(); ++p) {
+      guards &= (*p == 0xCD);
+    }
+    CHECK(match);
+    CHECK(guards);
+    if (!match || !guards) {
+      printf("  isa %s, pattern %zu, count %zu, misalignment %zu\n",
+             amd::PatternFill::name(options.isa), patternSize, count, misalign);
+      return;
+    }
+  }
+}
+
+static void testFill() {
+  std::mt19937_64 rng(1234);
+  const amd::PatternFill::Isa maxIsa = hostIsa();
+  printf("Host ISA %s\n", amd::PatternFill::name(maxIsa));
+  std::vector<size_t> patternSizes;
+  for (size_t size = 1; size <= 16; ++size) {
+    patternSizes.push_back(size);
+  }
+  for (size_t size : {24, 31, 48, 64, 100, 127, 128, 129, 200}) {
+    patternSizes.push_back(size);
+  }
+  const size_t counts[] = {0, 1, 2, 3, 7, 33, 65, 257, 1000, 4099};
+  for (uint32_t isa = amd::PatternFill::Generic; isa <= maxIsa; ++isa) {
+    for (bool nonTemporal : {false, true}) {
+      amd::PatternFill::Options options;
+      options.isa = static_cast<amd::PatternFill::Isa>(isa);
+      options.nonTemporalSize = nonTemporal ? 0 : SIZE_MAX;
+      for (size_t patternSize : patternSizes) {
+        for (size_t count : counts) {
+          checkFill(options, patternSize, count, rng);
+        }
+      }
+    }
+  }
+}
+
+static void testThreads() {
+  // Small thread sizes split the fill at line boundaries, the chunks must keep the phase
+  std::mt19937_64 rng(42);
+  for (uint32_t isa = amd::PatternFill::Generic; isa <= hostIsa(); ++isa) {
+    amd::PatternFill::Options options;
+    options.isa = static_cast<amd::PatternFill::Isa>(isa);
+    options.threads = 5;
+    options.threadSize = 1000;
+    for (size_t patternSize : {1, 3, 12, 16, 100, 128}) {
+      for (size_t count : {100, 999, 12345}) {
+        checkFill(options, patternSize, count, rng);
+      }
+    }
+  }
+}
+
+static double bandwidth(size_t size, size_t iterations, const std::function<void()>& fill) {
+  fill();
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i) {
+    fill();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return (static_cast<double>(size) * iterations) / elapsed.count() / 1e9;
+}
+
+static void benchmark() {
+  const amd::PatternFill::Isa isa = hostIsa();
+  printf("%10s %8s %14s %14s %14s %14s\n", "size", "pattern", "loop (GB/s)", "fill (GB/s)",
+         "stream (GB/s)", "4 thr (GB/s)");
+  for (size_t size : {size_t(64 * Ki), size_t(4 * Mi), size_t(256 * Mi)}) {
+    std::vector<uint8_t> buffer(size + 64);
+    uint8_t* dst = buffer.data() + 64 - reinterpret_cast<uintptr_t>(buffer.data()) % 64;
+    size_t iterations = std::max<size_t>(2, (1 * Gi) / size);
+    for (size_t patternSize : {1, 4, 16}) {
+      const uint8_t pattern[16] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+      const size_t count = size / patternSize;
+      amd::PatternFill::Options cached;
+      cached.isa = isa;
+      amd::PatternFill::Options stream = cached;
+      stream.nonTemporalSize = 0;
+      amd::PatternFill::Options threaded = stream;
+      threaded.threads = 4;
+      threaded.threadSize = 16 * Mi;
+      double loop = bandwidth(size, iterations,
+                              [&]() { memFillLoop(dst, pattern, patternSize, count); });
+      double fill = bandwidth(size, iterations, [&]() {
+        amd::PatternFill::fill(dst, pattern, patternSize, count, cached);
+      });
+      double nt = bandwidth(size, iterations, [&]() {
+        amd::PatternFill::fill(dst, pattern, patternSize, count, stream);
+      });
+      double thr = bandwidth(size, iterations, [&]() {
+        amd::PatternFill::fill(dst, pattern, patternSize, count, threaded);
+      });
+      printf("%10zu %8zu %14.2f %14.2f %14.2f %14.2f\n", size, patternSize, loop, fill, nt, thr);
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  testFill();
+  testThreads();
+  if (argc > 1 && std::string(argv[1]) == "--bench") {
+    benchmark();
+  }
+  printf("%s\n", (failures_ == 0) ? "PASSED" : "FAILED");
+  return (failures_ == 0) ? 0 : 1;
+}
@@ -0,0 +1,347 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include <utils/printfplan.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Unit test and benchmark for amd::PrintfPlan, the cached format strings of the device
+// printf messages in devhcprintf.cpp. The output is compared with the former segment by
+// segment implementation. Runs without a GPU.
+
+static int failures_ = 0;
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #cond);        \
+      ++failures_;                                                     \
+    }                                                                  \
+  } while (0)
+
+//! A printf message as the device writes it, the format string and the arguments
+struct Message {
+  std::vector<uint64_t> data_;
+
+  explicit Message(const char* fmt) { str(fmt); }
+
+  Message& u(uint64_t value) {
+    data_.push_back(value);
+    return *this;
+  }
+  Message& d(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    data_.push_back(bits);
+    return *this;
+  }
+  Message& str(const char* value) {
+    size_t size = strlen(value) + 1;
+    size_t offset = data_.size();
+    data_.resize(offset + (size + 7) / 8, 0);
+    memcpy(&data_[offset], value, size);
+    return *this;
+  }
+  const uint64_t* begin() const { return data_.data(); }
+  const uint64_t* end() const { return data_.data() + data_.size(); }
+};
+
+// ================================================================================================
+// The former implementation of format() in devhcprintf.cpp, printing into a string
+static void legacyPrintf(std::string* out, int* outCount, const char* fmt, ...) {
+  char buf[4096];
+  va_list args;
+  va_start(args, fmt);
+  int retval = vsnprintf(buf, sizeof(buf), fmt, args);
+  va_end(args);
+  if (retval >= 0) {
+    out->append(buf, std::min<size_t>(retval, sizeof(buf) - 1));
+  }
+  *outCount = retval < 0 ? retval : *outCount + retval;
+}
+
+template <typename... Args>
+static const uint64_t* legacyArgument(std::string* out, int* outCount, const std::string& spec,
+                                      const uint64_t* ptr, const uint64_t* end, Args... args) {
+  switch (spec.back()) {
+    case 'd': case 'i': case 'o': case 'u': case 'x': case 'X': case 'c':
+      legacyPrintf(out, outCount, spec.c_str(), args..., ptr[0]);
+      return ptr + 1;
+    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A': {
+      double d;
+      memcpy(&d, ptr, 8);
+      legacyPrintf(out, outCount, spec.c_str(), args..., d);
+      return ptr + 1;
+    }
+    case 's': {
+      auto old = *outCount;
+      legacyPrintf(out, outCount, spec.c_str(), args..., reinterpret_cast<const char*>(ptr));
+      return ptr + (*outCount - old + 1 + 7) / 8;
+    }
+    case 'p':
+      legacyPrintf(out, outCount, spec.c_str(), args..., reinterpret_cast<void*>(*ptr));
+      return ptr + 1;
+    case 'n':
+      return ptr + 1;
+  }
+  return end;
+}
+
+static int legacyFormat(std::string* out, const uint64_t* begin, const uint64_t* end) {
+  const char convSpecifiers[] = "diouxXfFeEgGaAcspn";
+  auto ptr = begin;
+  const std::string fmt(reinterpret_cast<const char*>(ptr));
+  ptr += (fmt.length() + 7 + 1) / 8;
+  int outCount = 0;
+  size_t point = 0;
+  while (true) {
+    auto mark = point;
+    point = fmt.find('%', point);
+    if (point == std::string::npos) {
+      legacyPrintf(out, &outCount, "%s", &fmt[mark]);
+      return outCount;
+    }
+    legacyPrintf(out, &outCount, "%.*s", (int)(point - mark), &fmt[mark]);
+    mark = point;
+    ++point;
+    if (fmt[point] == '%') {
+      legacyPrintf(out, &outCount, "%%");
+      ++point;
+      continue;
+    }
+    if (ptr == end) {
+      return outCount;
+    }
+    point = fmt.find_first_of(convSpecifiers, point);
+    if (point == std::string::npos) {
+      return outCount;
+    }
+    ++point;
+    const std::string spec(fmt, mark, point - mark);
+    int stars = std::count(spec.begin(), spec.end(), '*');
+    if (stars == 0) {
+      ptr = legacyArgument(out, &outCount, spec, ptr, end);
+    } else if (stars == 1) {
+      ptr = (end - ptr < 2) ? end : legacyArgument(out, &outCount, spec, ptr + 1, end,
+                                                   static_cast<int>(ptr[0]));
+    } else if (stars == 2) {
+      ptr = (end - ptr < 3) ? end : legacyArgument(out, &outCount, spec, ptr + 2, end,
+                                                   static_cast<int>(ptr[0]),
+                                                   static_cast<int>(ptr[1]));
+    } else {
+      ptr = end;
+    }
+  }
+}
+
+// ================================================================================================
+static std::string planFormat(const Message& message, int* count) {
+  amd::PrintfBuffer buffer;
+  auto begin = message.begin();
+  const auto& plan = amd::PrintfPlan::get(reinterpret_cast<const char*>(begin));
+  *count = plan.format(&buffer, std::min(begin + plan.formatWords(), message.end()),
+                       message.end());
+  return std::string(buffer.data(), buffer.size());
+}
+
+static void compare(const Message& message) {
+  std::string expected;
+  int expectedCount = legacyFormat(&expected, message.begin(), message.end());
+  int count = 0;
+  std::string output = planFormat(message, &count);
+  if (output != expected || count != expectedCount) {
+    printf("FAILED \"%s\": \"%s\" (%d) != \"%s\" (%d)\n",
+           reinterpret_cast<const char*>(message.begin()), output.c_str(), count,
+           expected.c_str(), expectedCount);
+    ++failures_;
+  }
+}
+
+static void testSpecifiers() {
+  // Integers
+  for (const char* spec : {"%d", "%i", "%o", "%u", "%x", "%X", "%c", "%5d", "%-5d|", "%+d",
+                           "% d", "%05d", "%#x", "%#o", "%.3d", "%8.3x", "%hhd", "%hd", "%ld",
+                           "%lld", "%jd", "%zd", "%td", "%hhu", "%lu", "%llx", "%llX"}) {
+    for (uint64_t value : {0ull, 1ull, 65ull, 0xFFull, 0x7FFFFFFFull, 0xFFFFFFFFull,
+                           0x123456789ABCDEFull, ~0ull}) {
+      compare(Message(spec).u(value));
+    }
+  }
+  // Floating point
+  for (const char* spec : {"%f", "%F", "%e", "%E", "%g", "%G", "%a", "%A", "%10.3f", "%-12e|",
+                           "%+.0f", "%#g", "%08.2f", "%lf", "%.15g"}) {
+    for (double value : {0.0, -0.0, 1.0, -1.5, 3.14159265358979, 1e300, -1e-300,
+                         static_cast<double>(INFINITY), static_cast<double>(NAN)}) {
+      compare(Message(spec).d(value));
+    }
+  }
+  // Strings, pointers and %n
+  compare(Message("%s").str("hello"));
+  compare(Message("[%10s]").str("right"));
+  compare(Message("[%-10s]").str("left"));
+  compare(Message("%s and %s").str("").str("a string longer than eight bytes"));
+  compare(Message("%p").u(0));
+  compare(Message("%p").u(0x7fff12345678ull));
+  compare(Message("%n%d").u(0).u(7));
+  compare(Message("%d%n|%d").u(1).u(0).u(2));
+  // Width and precision arguments
+  compare(Message("[%*d]").u(6).u(42));
+  compare(Message("[%-*d]").u(6).u(42));
+  compare(Message("[%.*f]").u(2).d(2.71828));
+  compare(Message("[%*.*f]").u(10).u(3).d(2.71828));
+  compare(Message("[%*s]").u(8).str("abc"));
+  // Literals
+  compare(Message(""));
+  compare(Message("no specifiers\n"));
+  compare(Message("100%% %d%%\n").u(5));
+  compare(Message("%%%%%d").u(5));
+  compare(Message("mixed %d %s %f %c %x %p tail\n")
+              .u(-3ull).str("str").d(0.5).u('z').u(0xbeef).u(0x1000));
+}
+
+static void testMalformed() {
+  // Missing arguments stop the output before the specifier
+  compare(Message("%d %d %d"));
+  compare(Message("%d %d %d").u(1));
+  compare(Message("a %*d b %d").u(5));
+  compare(Message("a %*.*d b").u(5).u(2));
+  // No conversion specifier
+  compare(Message("trailing %").u(1));
+  compare(Message("unterminated %5").u(1));
+  compare(Message("%5 %d").u(1));
+  // More than two stars consume everything
+  compare(Message("%***d after %d").u(1).u(2).u(3).u(4).u(5));
+  // Unterminated string argument
+  int count = 0;
+  Message message("%s|%d");
+  message.u(0x4141414141414141ull);
+  CHECK(planFormat(message, &count) == "|");
+  CHECK(count == 1);
+}
+
+static void testStrings() {
+  // The device copies the whole string, the precision doesn't change the next argument
+  int count = 0;
+  CHECK(planFormat(Message("%.2s %d").str("abcdefghijklmnop").u(42), &count) == "ab 42");
+  CHECK(count == 5);
+  CHECK(planFormat(Message("%20.3s|%d").str("abcdefghij").u(7), &count) ==
+        "                 abc|7");
+  CHECK(planFormat(Message("%s%s%s").str("1234567").str("12345678").str("x"), &count) ==
+        "123456712345678x");
+  CHECK(count == 16);
+}
+
+static void testCache() {
+  std::string copy1 = "cached %d\n";
+  std::string copy2 = copy1;
+  const auto* plan = &amd::PrintfPlan::get(copy1.c_str());
+  CHECK(plan == &amd::PrintfPlan::get(copy2.c_str()));
+  CHECK(plan->numSpecs() == 1);
+  CHECK(plan->formatWords() == 2);
+  CHECK(amd::PrintfPlan::get("1234567").formatWords() == 1);
+  CHECK(amd::PrintfPlan::get("12345678").formatWords() == 2);
+  CHECK(amd::PrintfPlan::get("%d %s %% %*.*f").numSpecs() == 3);
+  CHECK(amd::PrintfPlan::get("%d %").numSpecs() == 1);
+
+  // The cache is bounded
+  for (size_t i = 0; i < 2 * amd::PrintfPlan::kMaxPlans; ++i) {
+    std::string fmt = "plan " + std::to_string(i) + " %d\n";
+    compare(Message(fmt.c_str()).u(i));
+  }
+
+  // A large message grows the buffer
+  std::string big(10000, 'x');
+  int count = 0;
+  CHECK(planFormat(Message("%s%d").str(big.c_str()).u(1), &count) == big + "1");
+  CHECK(count == 10001);
+}
+
+static void benchmark() {
+  constexpr int kMessages = 200000;
+  Message message("thread %d: value=%f index=%5u name=%s\n");
+  message.u(12345).d(0.125).u(77).str("kernel");
+  FILE* null = fopen("/dev/null", "w");
+  if (null == nullptr) {
+    return;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kMessages; ++i) {
+    // Same as the former format(), a fprintf() call per segment
+    const char* fmt = reinterpret_cast<const char*>(message.begin());
+    std::string str(fmt);
+    size_t point = 0;
+    const uint64_t* ptr = message.begin() + (str.size() + 8) / 8;
+    while (true) {
+      size_t mark = point;
+      point = str.find('%', point);
+      if (point == std::string::npos) {
+        fprintf(null, "%s", &str[mark]);
+        break;
+      }
+      fprintf(null, "%.*s", (int)(point - mark), &str[mark]);
+      size_t conv = str.find_first_of("diouxXfFeEgGaAcspn", point + 1);
+      std::string spec(str, point, conv + 1 - point);
+      if (spec.back() == 'f') {
+        double d;
+        memcpy(&d, ptr++, sizeof(d));
+        fprintf(null, spec.c_str(), d);
+      } else if (spec.back() == 's') {
+        fprintf(null, spec.c_str(), reinterpret_cast<const char*>(ptr));
+        ptr += (strlen(reinterpret_cast<const char*>(ptr)) + 8) / 8;
+      } else {
+        fprintf(null, spec.c_str(), *ptr++);
+      }
+      point = conv + 1;
+    }
+  }
+  std::chrono::duration<double, std::nano> legacy = std::chrono::steady_clock::now() - start;
+
+  amd::PrintfBuffer buffer;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kMessages; ++i) {
+    const auto& plan = amd::PrintfPlan::get(reinterpret_cast<const char*>(message.begin()));
+    buffer.clear();
+    plan.format(&buffer, message.begin() + plan.formatWords(), message.end());
+    fwrite(buffer.data(), 1, buffer.size(), null);
+  }
+  std::chrono::duration<double, std::nano> planned = std::chrono::steady_clock::now() - start;
+  fclose(null);
+
+  printf("%-28s %10.1f ns/msg\n", "segment fprintf", legacy.count() / kMessages);
+  printf("%-28s %10.1f ns/msg\n", "cached plan + one fwrite", planned.count() / kMessages);
+}
+
+int main(int argc, char** argv) {
+  testSpecifiers();
+  testMalformed();
+  testStrings();
+  testCache();
+  if (argc > 1 && std::string(argv[1]) == "--bench") {
+    benchmark();
+  }
+  printf("%s\n", (failures_ == 0) ? "PASSED" : "FAILED");
+  return (failures_ == 0) ? 0 : 1;
+}
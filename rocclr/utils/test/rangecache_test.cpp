@@ -0,0 +1,301 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include <utils/rangecache.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+// Unit test and microbenchmark for amd::RangeCache, runs without a GPU.
+
+static int failures_ = 0;
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #cond);        \
+      ++failures_;                                                     \
+    }                                                                  \
+  } while (0)
+
+static constexpr size_t kPage = 4096;
+
+static const void* ptr(uintptr_t address) { return reinterpret_cast<const void*>(address); }
+
+//! The reference implementation, a linear scan with the same semantics
+class Reference {
+ public:
+  explicit Reference(size_t budget) : budget_(budget), size_(0), time_(0) {}
+
+  bool find(uintptr_t start, size_t size, int* value, uintptr_t* base) {
+    uintptr_t first = start / kPage * kPage;
+    uintptr_t last = (start + size + kPage - 1) / kPage * kPage;
+    // Overlapping ranges may both contain the request, the cache picks the last start
+    Range* found = nullptr;
+    for (auto& range : ranges_) {
+      if ((range.first_ <= first) && (range.last_ >= last) &&
+          ((found == nullptr) || (range.first_ > found->first_))) {
+        found = &range;
+      }
+    }
+    if (found == nullptr) {
+      return false;
+    }
+    found->time_ = ++time_;
+    *value = found->value_;
+    *base = found->first_;
+    return true;
+  }
+
+  bool insert(uintptr_t start, size_t size, int value, std::vector<int>* removed) {
+    uintptr_t first = start / kPage * kPage;
+    uintptr_t last = (start + size + kPage - 1) / kPage * kPage;
+    if (last - first > budget_) {
+      return false;
+    }
+    for (const auto& range : ranges_) {
+      if ((range.first_ <= first) && (range.last_ >= last)) {
+        return false;
+      }
+    }
+    remove([&](const Range& r) { return (r.first_ >= first) && (r.last_ <= last); }, removed);
+    ranges_.push_back({first, last, value, ++time_});
+    size_ += last - first;
+    while (size_ > budget_) {
+      auto lru = std::min_element(ranges_.begin(), ranges_.end(),
+                                  [](const Range& a, const Range& b) { return a.time_ < b.time_; });
+      uint64_t time = lru->time_;
+      remove([&](const Range& r) { return r.time_ == time; }, removed);
+    }
+    return true;
+  }
+
+  void invalidate(uintptr_t start, size_t size, std::vector<int>* removed) {
+    remove([&](const Range& r) { return (r.first_ < start + size) && (r.last_ > start); },
+           removed);
+  }
+
+  size_t size() const { return size_; }
+  size_t count() const { return ranges_.size(); }
+
+ private:
+  struct Range {
+    uintptr_t first_;
+    uintptr_t last_;
+    int value_;
+    uint64_t time_;
+  };
+
+  template <typename Pred> void remove(Pred pred, std::vector<int>* removed) {
+    for (auto it = ranges_.begin(); it != ranges_.end();) {
+      if (pred(*it)) {
+        removed->push_back(it->value_);
+        size_ -= it->last_ - it->first_;
+        it = ranges_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  size_t budget_;
+  size_t size_;
+  uint64_t time_;
+  std::vector<Range> ranges_;
+};
+
+static void testBasic() {
+  amd::RangeCache<int> cache(32 * kPage, kPage);
+  std::vector<int> removed;
+  int value = 0;
+  uintptr_t base = 0;
+
+  CHECK(!cache.find(ptr(0x10000), 100, &value, &base));
+  CHECK(cache.insert(ptr(0x10010), 2 * kPage, 1, &removed));
+  CHECK(cache.size() == 3 * kPage);
+  // Any sub-range of the pages hits
+  CHECK(cache.find(ptr(0x10000), 1, &value, &base) && (value == 1) && (base == 0x10000));
+  CHECK(cache.find(ptr(0x12fff), 1, &value, &base) && (value == 1));
+  CHECK(cache.find(ptr(0x11000), kPage, &value, &base) && (value == 1));
+  CHECK(!cache.find(ptr(0x12fff), 2, &value, &base));
+  CHECK(!cache.find(ptr(0xffff), 2, &value, &base));
+  // A covered range isn't inserted
+  CHECK(!cache.insert(ptr(0x11000), kPage, 2, &removed));
+  // A larger range replaces the contained ones
+  CHECK(cache.insert(ptr(0x20000), kPage, 3, &removed));
+  CHECK(cache.insert(ptr(0x10000), 0x11000, 4, &removed));
+  CHECK((removed.size() == 2) && (removed[0] == 1) && (removed[1] == 3));
+  CHECK((cache.count() == 1) && (cache.size() == 0x11000));
+  // Above the budget
+  CHECK(!cache.insert(ptr(0x100000), 33 * kPage, 5, &removed));
+  // Invalidation of the overlapping ranges
+  removed.clear();
+  CHECK(cache.insert(ptr(0x40000), kPage, 6, &removed));
+  cache.invalidate(ptr(0x20ff0), 0x10, &removed);
+  CHECK((removed.size() == 1) && (removed[0] == 4));
+  CHECK(cache.find(ptr(0x40000), kPage, &value, &base) && (value == 6));
+  cache.clear(&removed);
+  CHECK((removed.size() == 2) && (cache.count() == 0) && (cache.size() == 0));
+  CHECK(cache.stats().invalidations_ == 1);
+  CHECK(cache.stats().evictions_ == 2);
+}
+
+static void testLru() {
+  amd::RangeCache<int> cache(4 * kPage, kPage);
+  std::vector<int> removed;
+  int value = 0;
+  uintptr_t base = 0;
+  for (int i = 0; i < 4; ++i) {
+    CHECK(cache.insert(ptr(0x100000 + i * 0x10000), kPage, i, &removed));
+  }
+  // Touch the oldest one, the next insert evicts the second
+  CHECK(cache.find(ptr(0x100000), kPage, &value, &base) && (value == 0));
+  CHECK(cache.insert(ptr(0x200000), kPage, 4, &removed));
+  CHECK((removed.size() == 1) && (removed[0] == 1));
+  CHECK(cache.insert(ptr(0x300000), 3 * kPage, 5, &removed));
+  CHECK((removed.size() == 4) && (removed[1] == 2) && (removed[2] == 3) && (removed[3] == 0));
+  CHECK((cache.count() == 2) && (cache.size() == 4 * kPage));
+}
+
+static void testRandom() {
+  std::mt19937_64 rng(7);
+  for (size_t budget : {size_t(8 * kPage), size_t(64 * kPage)}) {
+    amd::RangeCache<int> cache(budget, kPage);
+    Reference reference(budget);
+    std::vector<int> removed, expected;
+    for (int i = 0; i < 200000; ++i) {
+      uintptr_t start = 0x100000 + rng() % (128 * kPage);
+      size_t size = 1 + rng() % (12 * kPage);
+      switch (rng() % 8) {
+        case 0: {
+          removed.clear();
+          expected.clear();
+          cache.invalidate(ptr(start), size, &removed);
+          reference.invalidate(start, size, &expected);
+          std::sort(removed.begin(), removed.end());
+          std::sort(expected.begin(), expected.end());
+          CHECK(removed == expected);
+          break;
+        }
+        case 1:
+        case 2: {
+          removed.clear();
+          expected.clear();
+          bool inserted = cache.insert(ptr(start), size, i, &removed);
+          CHECK(inserted == reference.insert(start, size, i, &expected));
+          std::sort(removed.begin(), removed.end());
+          std::sort(expected.begin(), expected.end());
+          CHECK(removed == expected);
+          break;
+        }
+        default: {
+          int value = -1, expectedValue = -1;
+          uintptr_t base = 0, expectedBase = 0;
+          bool hit = cache.find(ptr(start), size, &value, &base);
+          CHECK(hit == reference.find(start, size, &expectedValue, &expectedBase));
+          CHECK((value == expectedValue) && (base == expectedBase));
+          break;
+        }
+      }
+      CHECK((cache.size() == reference.size()) && (cache.count() == reference.count()));
+      CHECK(cache.size() <= budget);
+      if (failures_ != 0) {
+        printf("  budget %zu, iteration %d\n", budget, i);
+        return;
+      }
+    }
+  }
+}
+
+//! The original per queue list, 8 buffers with an exact base match
+class ExactList {
+ public:
+  bool find(uintptr_t start, size_t size) {
+    for (const auto& entry : entries_) {
+      if ((entry.first == start) && (size <= entry.second)) {
+        return true;
+      }
+    }
+    return false;
+  }
+  void insert(uintptr_t start, size_t size) {
+    if (entries_.size() > 7) {
+      entries_.erase(entries_.begin());
+    }
+    entries_.push_back({start, size});
+  }
+
+ private:
+  std::vector<std::pair<uintptr_t, size_t>> entries_;
+};
+
+static void benchmark() {
+  // Whole and sub-range copies of a set of rotating 1MB buffers
+  printf("%8s %16s %16s %12s\n", "buffers", "list hits (%)", "cache hits (%)", "ns/copy");
+  for (size_t buffers : {4, 8, 16, 64}) {
+    std::mt19937_64 rng(1);
+    ExactList list;
+    amd::RangeCache<int> cache(256 * Mi, kPage);
+    std::vector<int> removed;
+    const size_t kCopies = 1000000;
+    size_t listHits = 0;
+    double elapsed = 0;
+    for (size_t i = 0; i < kCopies; ++i) {
+      uintptr_t start = 0x10000000 + (i % buffers) * 2 * Mi;
+      size_t size = Mi;
+      if (rng() % 4 != 0) {
+        start += (rng() % 16) * 64 * Ki + 256;
+        size = 32 * Ki;
+      }
+      uintptr_t first = start / kPage * kPage;
+      size_t pinSize = (start + size + kPage - 1) / kPage * kPage - first;
+      if (list.find(first, pinSize)) {
+        ++listHits;
+      } else {
+        list.insert(first, pinSize);
+      }
+      auto begin = std::chrono::steady_clock::now();
+      int value;
+      uintptr_t base;
+      if (!cache.find(ptr(start), size, &value, &base)) {
+        cache.insert(ptr(start), size, 0, &removed);
+      }
+      std::chrono::duration<double, std::nano> time = std::chrono::steady_clock::now() - begin;
+      elapsed += time.count();
+    }
+    printf("%8zu %16.1f %16.1f %12.1f\n", buffers, 100.0 * listHits / kCopies,
+           100.0 * cache.stats().hits_ / kCopies, elapsed / kCopies);
+  }
+}
+
+int main(int argc, char** argv) {
+  testBasic();
+  testLru();
+  testRandom();
+  if (argc > 1 && std::string(argv[1]) == "--bench") {
+    benchmark();
+  }
+  printf("%s\n", (failures_ == 0) ? "PASSED" : "FAILED");
+  return (failures_ == 0) ? 0 : 1;
+}
@@ -0,0 +1,300 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include <utils/rangeindex.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+// Unit test and microbenchmark for amd::ConcurrentRangeIndex, runs without a GPU.
+
+struct Object {
+  uintptr_t base_;
+  size_t size_;
+};
+
+static int failures_ = 0;
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #cond);        \
+      ++failures_;                                                     \
+    }                                                                  \
+  } while (0)
+
+//! The reference implementation, same as the original MemObjMap lookup
+class LockedMap {
+ public:
+  void insert(Object* obj) {
+    std::unique_lock lock(lock_);
+    insertLocked(obj);
+  }
+  void erase(uintptr_t base) {
+    std::unique_lock lock(lock_);
+    eraseLocked(base);
+  }
+  void insertLocked(Object* obj) { map_.insert({obj->base_, obj}); }
+  void eraseLocked(uintptr_t base) { map_.erase(base); }
+  Object* find(uintptr_t key) {
+    std::shared_lock lock(lock_);
+    return findLocked(key);
+  }
+  Object* findLocked(uintptr_t key) {
+    auto it = map_.upper_bound(key);
+    if (it == map_.begin()) {
+      return nullptr;
+    }
+    --it;
+    return (key < it->first + it->second->size_) ? it->second : nullptr;
+  }
+  std::shared_mutex lock_;
+
+ private:
+  std::map<uintptr_t, Object*> map_;
+};
+
+//! Same layering as MemObjMap: the lock-free index in front of the locked map
+class IndexedMap {
+ public:
+  void insert(Object* obj) {
+    std::unique_lock lock(map_.lock_);
+    index_.insert(reinterpret_cast<void*>(obj->base_), obj->size_, obj);
+    map_.insertLocked(obj);
+  }
+  void erase(uintptr_t base) {
+    std::unique_lock lock(map_.lock_);
+    index_.erase(reinterpret_cast<void*>(base));
+    map_.eraseLocked(base);
+  }
+  Object* find(uintptr_t key) {
+    Object* obj = nullptr;
+    switch (index_.find(reinterpret_cast<void*>(key), &obj)) {
+      case amd::ConcurrentRangeIndex<Object>::Lookup::Hit:
+        return obj;
+      case amd::ConcurrentRangeIndex<Object>::Lookup::Miss:
+        return nullptr;
+      default:
+        return map_.find(key);
+    }
+  }
+  //! Reference lookup, bypassing the index
+  Object* findReference(uintptr_t key) { return map_.find(key); }
+
+ private:
+  amd::ConcurrentRangeIndex<Object> index_;
+  LockedMap map_;
+};
+
+static void testBasic() {
+  amd::ConcurrentRangeIndex<Object> index;
+  Object a{0x10000000, 256 * Mi};   // Large, aligned
+  Object b{0x7f0000001100, 0x100};  // Small, unaligned
+  Object c{0x7f0000001200, 0x80};   // Shares a granule with b
+  index.insert(reinterpret_cast<void*>(a.base_), a.size_, &a);
+  index.insert(reinterpret_cast<void*>(b.base_), b.size_, &b);
+
+  Object* obj = nullptr;
+  size_t offset = 0;
+  using Lookup = amd::ConcurrentRangeIndex<Object>::Lookup;
+  CHECK(index.find(reinterpret_cast<void*>(a.base_ + 12345), &obj, &offset) == Lookup::Hit);
+  CHECK(obj == &a && offset == 12345);
+  CHECK(index.find(reinterpret_cast<void*>(a.base_ + a.size_ - 1), &obj) == Lookup::Hit);
+  CHECK(index.find(reinterpret_cast<void*>(a.base_ + a.size_), &obj) == Lookup::Miss);
+  CHECK(index.find(reinterpret_cast<void*>(0x1000), &obj) == Lookup::Miss);
+  CHECK(index.find(reinterpret_cast<void*>(b.base_ + 0x10), &obj, &offset) == Lookup::Hit);
+  CHECK(obj == &b && offset == 0x10);
+
+  // c shares b's granule, the index must defer to the caller
+  index.insert(reinterpret_cast<void*>(c.base_), c.size_, &c);
+  CHECK(index.find(reinterpret_cast<void*>(c.base_), &obj) == Lookup::Unknown);
+
+  // Removing b makes the granule exclusive to c again
+  index.erase(reinterpret_cast<void*>(b.base_));
+  CHECK(index.find(reinterpret_cast<void*>(c.base_ + 1), &obj) == Lookup::Hit);
+  CHECK(obj == &c);
+
+  // Cached hits must not survive removal
+  CHECK(index.find(reinterpret_cast<void*>(a.base_), &obj) == Lookup::Hit);
+  index.erase(reinterpret_cast<void*>(a.base_));
+  CHECK(index.find(reinterpret_cast<void*>(a.base_), &obj) == Lookup::Miss);
+
+  // Keys above the indexed VA space go to the slow path
+  CHECK(index.find(reinterpret_cast<void*>(~uintptr_t(0)), &obj) == Lookup::Unknown);
+}
+
+static void testPrune() {
+  // Small ranges spread over the VA space need a child node per level, which are reused
+  amd::ConcurrentRangeIndex<Object> index;
+  Object a{0x10000000, 0x1100};  // Stays in the index
+  index.insert(reinterpret_cast<void*>(a.base_), a.size_, &a);
+  const size_t nodes = index.numNodes();
+  std::vector<Object> objects(1000);
+  for (size_t i = 0; i < objects.size(); ++i) {
+    objects[i] = {(i + 1) * Gi + 0x1100, 0x10000};
+  }
+  Object* obj = nullptr;
+  using Lookup = amd::ConcurrentRangeIndex<Object>::Lookup;
+  for (int iter = 0; iter < 3; ++iter) {
+    for (auto& object : objects) {
+      index.insert(reinterpret_cast<void*>(object.base_), object.size_, &object);
+      CHECK(index.find(reinterpret_cast<void*>(object.base_ + 0x100), &obj) == Lookup::Hit);
+      index.erase(reinterpret_cast<void*>(object.base_));
+      CHECK(index.find(reinterpret_cast<void*>(object.base_ + 0x100), &obj) == Lookup::Miss);
+    }
+  }
+  CHECK(index.numNodes() <= nodes + 2);
+  CHECK(index.find(reinterpret_cast<void*>(a.base_ + 0x1000), &obj) == Lookup::Hit);
+  CHECK(obj == &a);
+  index.erase(reinterpret_cast<void*>(a.base_));
+  CHECK(index.find(reinterpret_cast<void*>(a.base_), &obj) == Lookup::Miss);
+}
+
+static void testRandom() {
+  std::mt19937_64 rng(1234);
+  IndexedMap map;
+  std::vector<Object> objects(20000);
+  std::vector<bool> live(objects.size(), false);
+  uintptr_t base = 0x100000000;
+  for (auto& obj : objects) {
+    // Mix of sub-page and multi-MB allocations with random gaps
+    obj.size_ = (rng() % 4 == 0) ? (rng() % (64 * Mi)) + 1 : (rng() % 8192) + 1;
+    obj.base_ = base + (rng() % 3) * 64;
+    base = obj.base_ + obj.size_ + (rng() % 16384);
+  }
+  for (int iter = 0; iter < 200000; ++iter) {
+    size_t i = rng() % objects.size();
+    if (live[i]) {
+      map.erase(objects[i].base_);
+    } else {
+      map.insert(&objects[i]);
+    }
+    live[i] = !live[i];
+    uintptr_t key = 0x100000000 + rng() % (base - 0x100000000);
+    CHECK(map.find(key) == map.findReference(key));
+    size_t j = rng() % objects.size();
+    key = objects[j].base_ + rng() % objects[j].size_;
+    CHECK(map.find(key) == (live[j] ? &objects[j] : nullptr));
+  }
+}
+
+static void testConcurrent() {
+  // Readers must always find the stable objects while a writer churns the others
+  IndexedMap map;
+  std::vector<Object> objects(4096);
+  uintptr_t base = 0x200000000;
+  for (auto& obj : objects) {
+    obj.size_ = 3 * Ki + (base % 7) * 512;
+    obj.base_ = base;
+    base += obj.size_ + 100;
+  }
+  for (size_t i = 0; i < objects.size(); i += 2) {
+    map.insert(&objects[i]);
+  }
+  std::atomic<bool> done{false};
+  std::vector<std::thread> readers;
+  for (uint t = 0; t < 4; ++t) {
+    readers.emplace_back([&, t]() {
+      std::mt19937_64 rng(t);
+      while (!done.load(std::memory_order_relaxed)) {
+        const Object& obj = objects[(rng() % (objects.size() / 2)) * 2];
+        CHECK(map.find(obj.base_ + rng() % obj.size_) == &obj);
+      }
+    });
+  }
+  std::mt19937_64 rng(42);
+  for (int iter = 0; iter < 100000; ++iter) {
+    Object& obj = objects[(rng() % (objects.size() / 2)) * 2 + 1];
+    map.insert(&obj);
+    map.erase(obj.base_);
+  }
+  done = true;
+  for (auto& r : readers) {
+    r.join();
+  }
+}
+
+template <typename Map> static double runBench(Map& map, const std::vector<Object>& objects,
+                                               uint threads, size_t lookups) {
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  for (uint t = 0; t < threads; ++t) {
+    workers.emplace_back([&, t]() {
+      std::mt19937_64 rng(t);
+      size_t hits = 0;
+      for (size_t i = 0; i < lookups; ++i) {
+        // Kernels tend to reuse the same few buffers
+        const Object& obj = objects[(i % 16 == 0) ? rng() % objects.size() : (i / 16) % 8];
+        hits += (map.find(obj.base_ + (i % obj.size_)) != nullptr);
+      }
+      if (hits != lookups) {
+        ++failures_;
+      }
+    });
+  }
+  for (auto& w : workers) {
+    w.join();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return (threads * lookups) / elapsed.count() / 1e6;
+}
+
+static void benchmark() {
+  std::vector<Object> objects(50000);
+  uintptr_t base = 0x100000000;
+  for (size_t i = 0; i < objects.size(); ++i) {
+    objects[i].size_ = (i % 10 == 0) ? 32 * Mi : 64 * Ki;
+    objects[i].base_ = base;
+    base += objects[i].size_ + 2 * Mi;
+  }
+  LockedMap locked;
+  IndexedMap indexed;
+  for (auto& obj : objects) {
+    locked.insert(&obj);
+    indexed.insert(&obj);
+  }
+  const size_t lookups = 2000000;
+  printf("%8s %16s %16s\n", "threads", "map (Mlookup/s)", "index (Mlookup/s)");
+  for (uint threads = 1; threads <= std::thread::hardware_concurrency() && threads <= 32;
+       threads *= 2) {
+    double mapRate = runBench(locked, objects, threads, lookups);
+    double indexRate = runBench(indexed, objects, threads, lookups);
+    printf("%8u %16.1f %16.1f\n", threads, mapRate, indexRate);
+  }
+}
+
+int main(int argc, char** argv) {
+  testBasic();
+  testPrune();
+  testRandom();
+  testConcurrent();
+  if (argc > 1 && std::string(argv[1]) == "--bench") {
+    benchmark();
+  }
+  printf("%s\n", (failures_ == 0) ? "PASSED" : "FAILED");
+  return (failures_ == 0) ? 0 : 1;
+}
@@ -0,0 +1,299 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include <utils/recordbuffer.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Unit test and microbenchmark for amd::RecordBuffer, runs without a GPU.
+
+static int failures_ = 0;
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #cond);        \
+      ++failures_;                                                     \
+    }                                                                  \
+  } while (0)
+
+//! A synthetic command record, the name refers to the extra data of the chunk
+struct Record {
+  uint32_t thread_;
+  uint32_t sequence_;
+  uint64_t begin_;
+  uint64_t end_;
+  const char* name_;
+};
+
+//! Collects the delivered records, checks the order per thread and the names
+class Collector {
+ public:
+  explicit Collector(uint32_t threads) : next_(threads, 0) {}
+
+  void deliver(const Record* records, size_t count) {
+    std::lock_guard<std::mutex> lock(lock_);
+    for (size_t i = 0; i < count; ++i) {
+      const Record& record = records[i];
+      if (record.thread_ >= next_.size()) {
+        ++errors_;
+        continue;
+      }
+      // The records of a thread arrive in order, dropped ones leave gaps
+      if (record.sequence_ < next_[record.thread_]) {
+        ++errors_;
+      }
+      next_[record.thread_] = record.sequence_ + 1;
+      if (std::string(record.name_) != name(record.thread_, record.sequence_)) {
+        ++errors_;
+      }
+      ++count_;
+    }
+    ++batches_;
+  }
+
+  static std::string name(uint32_t thread, uint32_t sequence) {
+    return "kernel_" + std::to_string(thread) + "_" + std::to_string(sequence % 97);
+  }
+
+  std::mutex lock_;
+  std::vector<uint32_t> next_;
+  uint64_t count_ = 0;
+  uint64_t batches_ = 0;
+  uint64_t errors_ = 0;
+};
+
+static bool appendRecord(amd::RecordBuffer<Record>& buffer, uint32_t thread, uint32_t sequence) {
+  std::string name = Collector::name(thread, sequence);
+  return buffer.append(name.size() + 1, [&](Record* record, char* extra) {
+    memcpy(extra, name.c_str(), name.size() + 1);
+    *record = {thread, sequence, sequence * 10ull, sequence * 10ull + 5, extra};
+  });
+}
+
+static void testSingleThread() {
+  Collector collector(1);
+  amd::RecordBuffer<Record>::Options options;
+  options.chunkRecords_ = 16;
+  options.chunkBytes_ = 256;
+  options.maxChunks_ = 4;
+  {
+    amd::RecordBuffer<Record> buffer(options, [&](const Record* records, size_t count) {
+      collector.deliver(records, count);
+    });
+    for (uint32_t i = 0; i < 1000; ++i) {
+      CHECK(appendRecord(buffer, 0, i));
+    }
+    buffer.flush();
+    auto stats = buffer.stats();
+    CHECK(stats.delivered_ == 1000);
+    CHECK(stats.dropped_ == 0);
+    CHECK(stats.chunks_ <= options.maxChunks_);
+    // The full chunks were recycled on the producer
+    CHECK(stats.stalls_ > 0);
+    // A record larger than the extra data of a chunk is dropped
+    CHECK(!buffer.append(options.chunkBytes_ + 1, [](Record*, char*) {}));
+    CHECK(buffer.stats().dropped_ == 1);
+    CHECK(appendRecord(buffer, 0, 1000));
+  }
+  // The destructor delivers the rest
+  CHECK(collector.count_ == 1001);
+  CHECK(collector.errors_ == 0);
+}
+
+static void testThreads(uint32_t flushMs) {
+  constexpr uint32_t kThreads = 8;
+  constexpr uint32_t kRecords = 20000;
+  Collector collector(kThreads);
+  amd::RecordBuffer<Record>::Options options;
+  options.chunkRecords_ = 64;
+  options.chunkBytes_ = 2048;
+  options.maxChunks_ = 2 * kThreads;
+  options.flushMs_ = flushMs;
+  uint64_t appended = 0;
+  amd::RecordBuffer<Record>::Stats stats;
+  {
+    amd::RecordBuffer<Record> buffer(options, [&](const Record* records, size_t count) {
+      collector.deliver(records, count);
+    });
+    std::vector<std::thread> threads;
+    std::vector<uint64_t> counts(kThreads, 0);
+    for (uint32_t t = 0; t < kThreads; ++t) {
+      threads.emplace_back([&, t]() {
+        for (uint32_t i = 0; i < kRecords; ++i) {
+          counts[t] += appendRecord(buffer, t, i) ? 1 : 0;
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    for (uint64_t count : counts) {
+      appended += count;
+    }
+    buffer.flush();
+    stats = buffer.stats();
+  }
+  CHECK(stats.delivered_ == appended);
+  CHECK(stats.delivered_ + stats.dropped_ == uint64_t(kThreads) * kRecords);
+  CHECK(stats.chunks_ <= options.maxChunks_);
+  CHECK(collector.count_ == appended);
+  CHECK(collector.batches_ == stats.batches_);
+  CHECK(collector.errors_ == 0);
+}
+
+static void testTimer() {
+  // The delivery thread hands over a partial chunk without a flush
+  Collector collector(1);
+  amd::RecordBuffer<Record>::Options options;
+  options.flushMs_ = 1;
+  amd::RecordBuffer<Record> buffer(options, [&](const Record* records, size_t count) {
+    collector.deliver(records, count);
+  });
+  for (uint32_t i = 0; i < 10; ++i) {
+    CHECK(appendRecord(buffer, 0, i));
+  }
+  auto start = std::chrono::steady_clock::now();
+  while ((buffer.stats().delivered_ < 10) &&
+         (std::chrono::steady_clock::now() - start < std::chrono::seconds(10))) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  CHECK(buffer.stats().delivered_ == 10);
+  CHECK(collector.errors_ == 0);
+}
+
+static void testDrop() {
+  // Two threads keep the only chunks, so the third one drops after the inline flush
+  Collector collector(3);
+  amd::RecordBuffer<Record>::Options options;
+  options.chunkRecords_ = 4;
+  options.maxChunks_ = 2;
+  amd::RecordBuffer<Record> buffer(options, [&](const Record* records, size_t count) {
+    collector.deliver(records, count);
+  });
+  std::mutex lock;
+  std::condition_variable cv;
+  uint32_t started = 0;
+  bool done = false;
+  std::vector<std::thread> owners;
+  for (uint32_t t = 0; t < 2; ++t) {
+    owners.emplace_back([&, t]() {
+      CHECK(appendRecord(buffer, t, 0));
+      std::unique_lock<std::mutex> guard(lock);
+      ++started;
+      cv.notify_all();
+      cv.wait(guard, [&]() { return done; });
+    });
+  }
+  {
+    std::unique_lock<std::mutex> guard(lock);
+    cv.wait(guard, [&]() { return started == 2; });
+  }
+  std::thread([&]() { CHECK(!appendRecord(buffer, 2, 0)); }).join();
+  auto stats = buffer.stats();
+  CHECK(stats.dropped_ == 1);
+  CHECK(stats.stalls_ == 1);
+  CHECK(stats.delivered_ == 2);
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    done = true;
+  }
+  cv.notify_all();
+  for (auto& owner : owners) {
+    owner.join();
+  }
+  // The exited threads retired their chunks
+  std::thread([&]() { CHECK(appendRecord(buffer, 2, 1)); }).join();
+  buffer.flush();
+  stats = buffer.stats();
+  CHECK(stats.delivered_ == 3);
+  CHECK(stats.dropped_ == 1);
+  CHECK(collector.errors_ == 0);
+}
+
+static void benchmark() {
+  constexpr uint32_t kRecords = 1000000;
+  printf("%8s %16s %16s %10s\n", "threads", "direct (ns/rec)", "buffer (ns/rec)", "batches");
+  for (uint32_t threads : {1, 2, 4, 8}) {
+    // The direct mode calls the profiler under its lock for every record
+    std::mutex profiler;
+    uint64_t sum = 0;
+    auto run = [&](const std::function<void(uint32_t, uint32_t)>& report) {
+      auto start = std::chrono::steady_clock::now();
+      std::vector<std::thread> workers;
+      for (uint32_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+          for (uint32_t i = 0; i < kRecords; ++i) {
+            report(t, i);
+          }
+        });
+      }
+      for (auto& worker : workers) {
+        worker.join();
+      }
+      std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+      return elapsed.count() / kRecords;
+    };
+    double direct = run([&](uint32_t t, uint32_t i) {
+      Record record = {t, i, i, i + 1ull, "kernel"};
+      std::lock_guard<std::mutex> lock(profiler);
+      sum += record.end_ - record.begin_;
+    });
+    amd::RecordBuffer<Record>::Options options;
+    options.maxChunks_ = 4 * threads;
+    options.flushMs_ = 1;
+    amd::RecordBuffer<Record> buffer(options, [&](const Record* records, size_t count) {
+      std::lock_guard<std::mutex> lock(profiler);
+      for (size_t i = 0; i < count; ++i) {
+        sum += records[i].end_ - records[i].begin_;
+      }
+    });
+    double buffered = run([&](uint32_t t, uint32_t i) {
+      buffer.append(sizeof("kernel"), [&](Record* record, char* extra) {
+        memcpy(extra, "kernel", sizeof("kernel"));
+        *record = {t, i, i, i + 1ull, extra};
+      });
+    });
+    buffer.flush();
+    printf("%8u %16.1f %16.1f %10llu\n", threads, direct, buffered,
+           static_cast<unsigned long long>(buffer.stats().batches_));
+  }
+}
+
+int main(int argc, char** argv) {
+  testSingleThread();
+  testThreads(0);
+  testThreads(1);
+  testTimer();
+  testDrop();
+  if (argc > 1 && std::string(argv[1]) == "--bench") {
+    benchmark();
+  }
+  printf("%s\n", (failures_ == 0) ? "PASSED" : "FAILED");
+  return (failures_ == 0) ? 0 : 1;
+}
@@ -0,0 +1,138 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include <utils/sizeclasses.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+// Unit test and microbenchmark for amd::SizeClasses, the size classes of the stream ordered
+// memory pool suballocator. Runs without a GPU.
+
+static int failures_ = 0;
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #cond);        \
+      ++failures_;                                                     \
+    }                                                                  \
+  } while (0)
+
+constexpr size_t kMinSize = 256;
+constexpr size_t kSlabSize = 2 * Mi;
+
+static void testEmpty() {
+  amd::SizeClasses classes;
+  classes.init(kMinSize, 0, kSlabSize);
+  CHECK(classes.count() == 0);
+  CHECK(!classes.contains(1));
+  classes.init(kMinSize, kMinSize - 1, kSlabSize);
+  CHECK(!classes.contains(1));
+}
+
+static void testClasses() {
+  amd::SizeClasses classes;
+  classes.init(kMinSize, 1 * Mi, kSlabSize);
+  CHECK(classes.count() > 0);
+  CHECK(classes.size(0) == kMinSize);
+  CHECK(classes.size(classes.count() - 1) == 1 * Mi);
+  for (uint32_t i = 0; i < classes.count(); ++i) {
+    // The blocks keep the alignment of the minimal size
+    CHECK(classes.size(i) % kMinSize == 0);
+    CHECK((i == 0) || (classes.size(i - 1) < classes.size(i)));
+  }
+  // At most 4 classes per power of two
+  for (size_t pow2 = kMinSize; pow2 < 1 * Mi; pow2 <<= 1) {
+    uint32_t count = classes.classOf(2 * pow2) - classes.classOf(pow2);
+    CHECK(count <= amd::SizeClasses::kClassesPerPow2);
+  }
+}
+
+static void testClassOf() {
+  amd::SizeClasses classes;
+  classes.init(kMinSize, 64 * Ki, kSlabSize);
+  CHECK(classes.contains(1));
+  CHECK(classes.contains(64 * Ki));
+  CHECK(!classes.contains(64 * Ki + 1));
+  CHECK(classes.classOf(1) == 0);
+  CHECK(classes.size(classes.classOf(kMinSize)) == kMinSize);
+  CHECK(classes.size(classes.classOf(kMinSize + 1)) == 2 * kMinSize);
+  CHECK(classes.size(classes.classOf(5000)) == 5 * Ki);
+  CHECK(classes.size(classes.classOf(5 * Ki + 1)) == 6 * Ki);
+  for (size_t size = 1; size <= 64 * Ki; ++size) {
+    const uint32_t index = classes.classOf(size);
+    // The smallest class which fits
+    CHECK(classes.size(index) >= size);
+    CHECK((index == 0) || (classes.size(index - 1) < size));
+    // The rounding is below 25% once the classes are finer than the minimal size
+    CHECK((size <= 4 * kMinSize) || (classes.size(index) - size < size / 4 + 1));
+  }
+}
+
+static void testSlabs() {
+  amd::SizeClasses classes;
+  classes.init(kMinSize, 1 * Mi, kSlabSize);
+  for (uint32_t i = 0; i < classes.count(); ++i) {
+    const size_t slab = classes.slabSize(i);
+    const size_t block = classes.size(i);
+    CHECK(slab >= kSlabSize);
+    CHECK(slab / block >= amd::SizeClasses::kMinBlocksPerSlab);
+    // The blocks are carved back to back, every block of an aligned slab stays aligned
+    for (size_t offset = 0; offset + block <= slab; offset += block) {
+      CHECK(offset % kMinSize == 0);
+    }
+  }
+  CHECK(classes.slabSize(classes.count() - 1) == 8 * Mi);
+}
+
+static void benchmark() {
+  amd::SizeClasses classes;
+  classes.init(kMinSize, 1 * Mi, kSlabSize);
+  std::mt19937_64 rng(1);
+  std::vector<size_t> sizes(4096);
+  for (auto& size : sizes) {
+    size = 1 + rng() % (64 * Ki);
+  }
+  constexpr size_t kLookups = 10000000;
+  uint64_t sum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < kLookups; ++i) {
+    sum += classes.classOf(sizes[i % sizes.size()]);
+  }
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  printf("classOf: %.1f ns per lookup (%llu)\n", elapsed.count() / kLookups,
+         static_cast<unsigned long long>(sum));
+}
+
+int main(int argc, char** argv) {
+  testEmpty();
+  testClasses();
+  testClassOf();
+  testSlabs();
+  if (argc > 1 && std::string(argv[1]) == "--bench") {
+    benchmark();
+  }
+  printf("%s\n", (failures_ == 0) ? "PASSED" : "FAILED");
+  return (failures_ == 0) ? 0 : 1;
+}
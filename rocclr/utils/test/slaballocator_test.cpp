@@ -0,0 +1,279 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include <utils/slaballocator.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Unit test and microbenchmark for amd::SlabAllocator, runs without a GPU.
+
+// Same as Os::alignedMalloc and Os::alignedFree
+void* amd::AlignedMemory::allocate(size_t size, size_t alignment) {
+  void* ptr = nullptr;
+  return (posix_memalign(&ptr, alignment, size) == 0) ? ptr : nullptr;
+}
+
+void amd::AlignedMemory::deallocate(void* ptr) { free(ptr); }
+
+static int failures_ = 0;
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #cond);        \
+      ++failures_;                                                     \
+    }                                                                  \
+  } while (0)
+
+typedef amd::SlabAllocator Slab;
+
+//! The number of live objects of all classes
+static int64_t live() {
+  Slab::Stats stats[Slab::kNumClasses];
+  Slab::stats(stats);
+  int64_t count = 0;
+  for (const auto& stat : stats) {
+    count += static_cast<int64_t>(stat.allocated_ - stat.freed_);
+  }
+  return count;
+}
+
+static void testClasses() {
+  for (size_t size = 1; size <= Slab::kMaxSize; ++size) {
+    const size_t index = Slab::classOf(size);
+    CHECK(index < Slab::kNumClasses);
+    CHECK(Slab::classSize(index) >= size);
+    CHECK((index == 0) || (Slab::classSize(index - 1) < size));
+    CHECK(Slab::classSize(index) % Slab::kAlign == 0);
+  }
+  CHECK(Slab::classSize(Slab::kNumClasses - 1) == Slab::kMaxSize);
+}
+
+static void testSingleThread() {
+  const int64_t base = live();
+  std::vector<std::pair<uint8_t*, size_t>> objects;
+  for (size_t i = 0; i < 5000; ++i) {
+    size_t size = 8 + (i * 37) % (Slab::kMaxSize + 512);
+    auto ptr = static_cast<uint8_t*>(Slab::allocate(size));
+    CHECK(reinterpret_cast<uintptr_t>(ptr) % ((size > Slab::kMaxSize) ? 16 : Slab::kAlign) == 0);
+    memset(ptr, static_cast<int>(i), size);
+    objects.push_back({ptr, size});
+  }
+  // The objects don't overlap
+  bool intact = true;
+  for (size_t i = 0; i < objects.size(); ++i) {
+    for (size_t j = 0; j < objects[i].second; ++j) {
+      intact &= (objects[i].first[j] == static_cast<uint8_t>(i));
+    }
+  }
+  CHECK(intact);
+  const int64_t small = std::count_if(objects.begin(), objects.end(), [](const auto& object) {
+    return object.second <= Slab::kMaxSize;
+  });
+  CHECK(live() - base == small);
+  for (auto& object : objects) {
+    Slab::deallocate(object.first, object.second);
+  }
+  CHECK(live() == base);
+  Slab::deallocate(nullptr, 64);
+}
+
+static void testCrossThread() {
+  // The producers allocate, the consumer frees, the objects circulate through the depots
+  constexpr size_t kProducers = 4;
+  constexpr size_t kObjects = 100000;
+  const int64_t base = live();
+  std::mutex lock;
+  std::condition_variable cv;
+  std::deque<std::pair<uint64_t*, size_t>> queue;
+  std::thread consumer([&]() {
+    size_t freed = 0;
+    bool intact = true;
+    while (freed < kProducers * kObjects) {
+      std::unique_lock<std::mutex> guard(lock);
+      cv.wait(guard, [&]() { return !queue.empty(); });
+      auto object = queue.front();
+      queue.pop_front();
+      guard.unlock();
+      cv.notify_all();
+      intact &= (object.first[0] == object.second);
+      Slab::deallocate(object.first, object.second);
+      ++freed;
+    }
+    CHECK(intact);
+  });
+  std::vector<std::thread> producers;
+  for (size_t p = 0; p < kProducers; ++p) {
+    producers.emplace_back([&, p]() {
+      for (size_t i = 0; i < kObjects; ++i) {
+        const size_t size = 64 + ((i + p) % 8) * 100;
+        auto ptr = static_cast<uint64_t*>(Slab::allocate(size));
+        ptr[0] = size;
+        // The queue is bounded, so the objects are reused
+        std::unique_lock<std::mutex> guard(lock);
+        cv.wait(guard, [&]() { return queue.size() < 1000; });
+        queue.push_back({ptr, size});
+        cv.notify_all();
+      }
+    });
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  consumer.join();
+  // The exited threads handed their counters and objects to the depots
+  CHECK(live() == base);
+  Slab::Stats stats[Slab::kNumClasses];
+  Slab::stats(stats);
+  uint64_t reserved = 0;
+  for (const auto& stat : stats) {
+    reserved += stat.reserved_;
+  }
+  // The objects are reused, so far fewer were carved than allocated
+  CHECK(reserved < kProducers * kObjects / 4);
+}
+
+static void testLeak() {
+  const int64_t base = live();
+  void* leaked = nullptr;
+  std::thread([&]() { leaked = Slab::allocate(200); }).join();
+  CHECK(live() - base == 1);
+  Slab::Stats stats[Slab::kNumClasses];
+  Slab::stats(stats);
+  const auto& stat = stats[Slab::classOf(200)];
+  CHECK(stat.size_ == 256);
+  CHECK(stat.allocated_ - stat.freed_ >= 1);
+  Slab::deallocate(leaked, 200);
+  CHECK(live() == base);
+}
+
+//! Frees an object and allocates another one in a thread exit destructor
+struct LateRelease {
+  ~LateRelease() {
+    if (object_ != nullptr) {
+      Slab::deallocate(object_, 300);
+      Slab::deallocate(Slab::allocate(300), 300);
+    }
+  }
+  void* object_ = nullptr;
+};
+
+static void testThreadExit() {
+  const int64_t base = live();
+  std::thread([]() {
+    // Constructed before the caches of the thread, so it's destroyed after their exit hook
+    static thread_local LateRelease late;
+    late.object_ = Slab::allocate(300);
+  }).join();
+  CHECK(live() == base);
+}
+
+static double run(size_t threads, const std::function<void*(size_t)>& alloc,
+                  const std::function<void(void*, size_t)>& dealloc) {
+  // A command is created on the submitting thread and destroyed on the completion thread
+  constexpr size_t kObjects = 500000;
+  constexpr size_t kBatch = 256;
+  std::mutex lock;
+  std::condition_variable cv;
+  std::vector<std::vector<std::pair<void*, size_t>>> batches;
+  size_t producers = threads;
+  auto start = std::chrono::steady_clock::now();
+  std::thread consumer([&]() {
+    while (true) {
+      std::unique_lock<std::mutex> guard(lock);
+      cv.wait(guard, [&]() { return !batches.empty() || (producers == 0); });
+      if (batches.empty()) {
+        break;
+      }
+      auto batch = std::move(batches.back());
+      batches.pop_back();
+      guard.unlock();
+      for (auto& object : batch) {
+        dealloc(object.first, object.second);
+      }
+    }
+  });
+  std::vector<std::thread> workers;
+  for (size_t t = 0; t < threads; ++t) {
+    workers.emplace_back([&, t]() {
+      std::vector<std::pair<void*, size_t>> batch;
+      for (size_t i = 0; i < kObjects; ++i) {
+        const size_t size = 200 + (i % 4) * 150;
+        void* ptr = alloc(size);
+        static_cast<uint8_t*>(ptr)[0] = static_cast<uint8_t>(i);
+        batch.push_back({ptr, size});
+        // The submitting thread also frees its short lived objects
+        if (i % 4 == 0) {
+          dealloc(batch.back().first, batch.back().second);
+          batch.pop_back();
+        }
+        if (batch.size() == kBatch) {
+          std::lock_guard<std::mutex> guard(lock);
+          batches.push_back(std::move(batch));
+          batch.clear();
+          cv.notify_one();
+        }
+      }
+      std::lock_guard<std::mutex> guard(lock);
+      batches.push_back(std::move(batch));
+      --producers;
+      cv.notify_one();
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  consumer.join();
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / (threads * kObjects);
+}
+
+static void benchmark() {
+  printf("%8s %16s %16s\n", "threads", "malloc (ns/obj)", "slab (ns/obj)");
+  for (size_t threads : {1, 2, 4, 8}) {
+    double heap = run(threads, [](size_t size) { return ::operator new(size); },
+                      [](void* ptr, size_t) { ::operator delete(ptr); });
+    double slab = run(threads, Slab::allocate, Slab::deallocate);
+    printf("%8zu %16.1f %16.1f\n", threads, heap, slab);
+  }
+}
+
+int main(int argc, char** argv) {
+  testClasses();
+  testSingleThread();
+  testCrossThread();
+  testLeak();
+  testThreadExit();
+  if (argc > 1 && std::string(argv[1]) == "--bench") {
+    benchmark();
+  }
+  printf("%s\n", (failures_ == 0) ? "PASSED" : "FAILED");
+  return (failures_ == 0) ? 0 : 1;
+}
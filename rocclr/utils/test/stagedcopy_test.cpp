@@ -0,0 +1,265 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include <device/devstagedcopy.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Unit test and microbenchmark for amd::StagedCopy, runs without a GPU.
+// The mock engine runs the DMA of the staged chunks on a host thread.
+
+static int failures_ = 0;
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #cond);        \
+      ++failures_;                                                     \
+    }                                                                  \
+  } while (0)
+
+//! A copy engine, which runs one DMA at a time with the given bandwidth
+class MockEngine : public amd::StagedCopyEngine {
+ public:
+  MockEngine(uint32_t slots, size_t slotSize, double bandwidth)
+      : slots_(slots), pending_(slots, 0), bandwidth_(bandwidth), thread_([this]() { run(); }) {
+    for (auto& slot : slots_) {
+      slot.resize(slotSize);
+    }
+  }
+
+  ~MockEngine() {
+    {
+      std::lock_guard<std::mutex> lock(lock_);
+      exit_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+  }
+
+  address acquire(uint32_t slot, size_t size) override {
+    CHECK(size <= slots_[slot].size());
+    wait(slot);
+    return slots_[slot].data();
+  }
+
+  bool submit(uint32_t slot, address staging, address device, size_t size,
+              bool hostToDev) override {
+    std::lock_guard<std::mutex> lock(lock_);
+    // The pipeline must not reuse a slot with a DMA in flight
+    CHECK(pending_[slot] <= done_);
+    CHECK(staging == slots_[slot].data());
+    if (fail_ != 0 && --fail_ == 0) {
+      return false;
+    }
+    Job job{++submitted_, hostToDev ? device : staging, hostToDev ? staging : device, size};
+    pending_[slot] = job.id_;
+    queue_.push_back(job);
+    uint32_t inFlight = 0;
+    for (auto id : pending_) {
+      inFlight += (id > done_) ? 1 : 0;
+    }
+    maxInFlight_ = std::max(maxInFlight_, inFlight);
+    cv_.notify_all();
+    return true;
+  }
+
+  bool wait(uint32_t slot) override {
+    std::unique_lock<std::mutex> lock(lock_);
+    if (pending_[slot] != 0 && firstWait_ == 0) {
+      firstWait_ = submitted_;
+    }
+    cv_.wait(lock, [&]() { return pending_[slot] <= done_; });
+    return true;
+  }
+
+  void failAt(uint32_t submit) { fail_ = submit; }
+  uint32_t maxInFlight() const { return maxInFlight_; }
+  //! The number of DMAs submitted before the first wait for a DMA
+  uint64_t firstWait() const { return firstWait_; }
+  bool idle() {
+    std::lock_guard<std::mutex> lock(lock_);
+    return done_ == submitted_;
+  }
+
+ private:
+  struct Job {
+    uint64_t id_;
+    address dst_;
+    const_address src_;
+    size_t size_;
+  };
+
+  void run() {
+    std::unique_lock<std::mutex> lock(lock_);
+    while (true) {
+      cv_.wait(lock, [&]() { return exit_ || !queue_.empty(); });
+      if (queue_.empty()) {
+        return;
+      }
+      Job job = queue_.front();
+      queue_.pop_front();
+      lock.unlock();
+      auto start = std::chrono::steady_clock::now();
+      memcpy(job.dst_, job.src_, job.size_);
+      if (bandwidth_ > 0) {
+        auto duration = std::chrono::duration<double>(job.size_ / bandwidth_);
+        while (std::chrono::steady_clock::now() - start < duration) {
+          std::this_thread::yield();
+        }
+      }
+      lock.lock();
+      done_ = job.id_;
+      cv_.notify_all();
+    }
+  }
+
+  std::vector<std::vector<uint8_t>> slots_;
+  std::vector<uint64_t> pending_;  //!< The last DMA of every slot
+  double bandwidth_;               //!< Bytes per second, 0 for the memcpy speed
+  std::mutex lock_;
+  std::condition_variable cv_;
+  std::deque<Job> queue_;
+  uint64_t submitted_ = 0;
+  uint64_t done_ = 0;
+  uint32_t maxInFlight_ = 0;
+  uint64_t firstWait_ = 0;
+  uint32_t fail_ = 0;
+  bool exit_ = false;
+  std::thread thread_;
+};
+
+static void testCopy() {
+  std::mt19937_64 rng(1234);
+  for (uint32_t slots : {1, 2, 3, 4}) {
+    for (size_t chunkSize : {size_t(4096), size_t(1000), size_t(65536 + 7)}) {
+      for (uint32_t threads : {1, 3}) {
+        for (size_t size : {size_t(0), size_t(1), size_t(999), size_t(4096), size_t(12345),
+                            size_t(300001)}) {
+          amd::StagedCopy::Options options;
+          options.slots = slots;
+          options.chunkSize = chunkSize;
+          options.threads = threads;
+          options.threadSize = 256;
+          std::vector<uint8_t> host(size);
+          std::vector<uint8_t> device(size);
+          std::vector<uint8_t> back(size + 1, 0xCD);
+          for (auto& byte : host) {
+            byte = static_cast<uint8_t>(rng());
+          }
+          const size_t chunks = (size + chunkSize - 1) / chunkSize;
+          {
+            MockEngine engine(slots, chunkSize, 0);
+            CHECK(amd::StagedCopy::copyToDevice(engine, host.data(), device.data(), size,
+                                                options));
+            for (uint32_t slot = 0; slot < slots; ++slot) {
+              engine.wait(slot);
+            }
+            CHECK(device == host);
+            CHECK(engine.maxInFlight() <= std::min<size_t>(slots, chunks));
+          }
+          {
+            MockEngine engine(slots, chunkSize, 0);
+            CHECK(amd::StagedCopy::copyToHost(engine, device.data(), back.data(), size,
+                                              options));
+            CHECK(memcmp(back.data(), host.data(), size) == 0);
+            CHECK(back[size] == 0xCD);
+            // The pipeline is filled before the first chunk is copied out, the engine may
+            // finish a DMA before the next submit, so it's checked at the first wait
+            CHECK(engine.firstWait() == std::min<size_t>(slots, chunks));
+            CHECK(engine.idle());
+          }
+        }
+      }
+    }
+  }
+}
+
+static void testFailure() {
+  // A failed DMA stops the copy, no DMA may be left in flight
+  std::vector<uint8_t> host(100000, 1);
+  std::vector<uint8_t> device(host.size());
+  for (uint32_t fail : {1, 2, 5}) {
+    amd::StagedCopy::Options options;
+    options.slots = 3;
+    options.chunkSize = 4096;
+    MockEngine engine(options.slots, options.chunkSize, 0);
+    engine.failAt(fail);
+    CHECK(!amd::StagedCopy::copyToHost(engine, device.data(), host.data(), host.size(),
+                                       options));
+    CHECK(engine.idle());
+    MockEngine engine2(options.slots, options.chunkSize, 0);
+    engine2.failAt(fail);
+    CHECK(!amd::StagedCopy::copyToDevice(engine2, host.data(), device.data(), host.size(),
+                                         options));
+  }
+}
+
+static void benchmark() {
+  // The DMA runs at 10 GB/s, the CPU copy at the memcpy speed
+  const size_t size = 256 * Mi;
+  std::vector<uint8_t> host(size, 1);
+  std::vector<uint8_t> device(size, 2);
+  printf("%10s %6s %8s %16s %16s\n", "chunk", "slots", "threads", "H2D (GB/s)", "D2H (GB/s)");
+  for (size_t chunkSize : {size_t(1 * Mi), size_t(16 * Mi)}) {
+    for (uint32_t slots : {1, 2, 3}) {
+      for (uint32_t threads : {1, 4}) {
+        amd::StagedCopy::Options options;
+        options.slots = slots;
+        options.chunkSize = chunkSize;
+        options.threads = threads;
+        double rate[2];
+        for (int dir = 0; dir < 2; ++dir) {
+          MockEngine engine(slots, chunkSize, 10e9);
+          auto start = std::chrono::steady_clock::now();
+          if (dir == 0) {
+            amd::StagedCopy::copyToDevice(engine, host.data(), device.data(), size, options);
+            for (uint32_t slot = 0; slot < slots; ++slot) {
+              engine.wait(slot);
+            }
+          } else {
+            amd::StagedCopy::copyToHost(engine, device.data(), host.data(), size, options);
+          }
+          std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+          rate[dir] = size / elapsed.count() / 1e9;
+        }
+        printf("%10zu %6u %8u %16.2f %16.2f\n", chunkSize, slots, threads, rate[0], rate[1]);
+      }
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  testCopy();
+  testFailure();
+  if (argc > 1 && std::string(argv[1]) == "--bench") {
+    benchmark();
+  }
+  printf("%s\n", (failures_ == 0) ? "PASSED" : "FAILED");
+  return (failures_ == 0) ? 0 : 1;
+}
@@ -0,0 +1,261 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+#include <utils/tracewriter.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Unit test and microbenchmark for amd::TraceWriter, runs without a GPU.
+
+static int failures_ = 0;
+
+#define CHECK(cond)                                                    \
+  do {                                                                 \
+    if (!(cond)) {                                                     \
+      printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #cond);        \
+      ++failures_;                                                     \
+    }                                                                  \
+  } while (0)
+
+//! A minimal JSON syntax check of the trace
+class JsonParser {
+ public:
+  explicit JsonParser(const std::string& text) : text_(text), pos_(0) {}
+
+  bool valid() {
+    bool ok = value();
+    space();
+    return ok && (pos_ == text_.size());
+  }
+
+ private:
+  void space() {
+    while ((pos_ < text_.size()) && isspace(static_cast<unsigned char>(text_[pos_]))) {
+      ++pos_;
+    }
+  }
+  bool eat(char c) {
+    space();
+    if ((pos_ < text_.size()) && (text_[pos_] == c)) {
+      ++pos_;
+      return true;
+    }
+    return false;
+  }
+  bool string() {
+    if (!eat('"')) {
+      return false;
+    }
+    while (pos_ < text_.size()) {
+      char c = text_[pos_++];
+      if (c == '"') {
+        return true;
+      }
+      if (static_cast<unsigned char>(c) < 0x20) {
+        return false;
+      }
+      if (c == '\\') {
+        ++pos_;
+      }
+    }
+    return false;
+  }
+  bool value() {
+    space();
+    if (pos_ >= text_.size()) {
+      return false;
+    }
+    char c = text_[pos_];
+    if (c == '"') {
+      return string();
+    }
+    if ((c == '{') || (c == '[')) {
+      const char close = (c == '{') ? '}' : ']';
+      ++pos_;
+      if (eat(close)) {
+        return true;
+      }
+      do {
+        if ((c == '{') && (!string() || !eat(':'))) {
+          return false;
+        }
+        if (!value()) {
+          return false;
+        }
+      } while (eat(','));
+      return eat(close);
+    }
+    size_t start = pos_;
+    while ((pos_ < text_.size()) && (strchr("+-.0123456789eE", text_[pos_]) != nullptr)) {
+      ++pos_;
+    }
+    return pos_ > start;
+  }
+
+  const std::string& text_;
+  size_t pos_;
+};
+
+static std::string readAll(FILE* file) {
+  std::string text;
+  rewind(file);
+  char buf[4096];
+  size_t size;
+  while ((size = fread(buf, 1, sizeof(buf), file)) != 0) {
+    text.append(buf, size);
+  }
+  return text;
+}
+
+static size_t countOf(const std::string& text, const std::string& pattern) {
+  size_t count = 0;
+  for (size_t pos = text.find(pattern); pos != std::string::npos;
+       pos = text.find(pattern, pos + pattern.size())) {
+    ++count;
+  }
+  return count;
+}
+
+static void testEmpty() {
+  FILE* file = tmpfile();
+  {
+    amd::TraceWriter writer(file, amd::TraceWriter::Options());
+  }
+  std::string text = readAll(file);
+  CHECK(JsonParser(text).valid());
+  fclose(file);
+}
+
+static void testThreads() {
+  constexpr uint32_t kThreads = 4;
+  constexpr uint32_t kCalls = 5000;
+  FILE* file = tmpfile();
+  amd::TraceWriter::Options options;
+  options.pid_ = 1234;
+  options.chunkEvents_ = 256;
+  options.flushMs_ = 1;
+  amd::TraceWriter writer(file, options);
+  std::vector<std::thread> threads;
+  for (uint32_t t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (uint32_t i = 0; i < kCalls; ++i) {
+        const uint64_t begin = (uint64_t(t) * kCalls + i) * 1000;
+        const uint64_t correlation = uint64_t(t) * kCalls + i + 1;
+        writer.api("hipLaunchKernel", 100 + t, begin, begin + 500, correlation);
+        // The name of the kernel is not a static string
+        std::string name = "kernel<\"" + std::to_string(i % 7) + "\\\">\t";
+        writer.command(name.c_str(), true, "kernel", t % 2, t, begin + 600, begin + 900,
+                       correlation, 0);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  writer.command("CopyHostToDevice", false, "copy", 0, 0, 10, 20, 0, 4096);
+  writer.close();
+  // The events after close() are ignored
+  writer.api("hipFree", 1, 30, 40, 0);
+  writer.close();
+  std::string text = readAll(file);
+  CHECK(JsonParser(text).valid());
+  auto stats = writer.stats();
+  CHECK(stats.dropped_ == 0);
+  CHECK(countOf(text, "\"ph\":\"X\"") == 2 * kThreads * kCalls + 1);
+  CHECK(countOf(text, "\"ph\":\"s\"") == kThreads * kCalls);
+  CHECK(countOf(text, "\"ph\":\"f\"") == kThreads * kCalls);
+  CHECK(countOf(text, "\"thread_name\"") == kThreads);
+  CHECK(countOf(text, "\"name\":\"kernel<\\\"3\\\\\\\">\\u0009\"") > 0);
+  CHECK(countOf(text, "\"bytes\":4096") == 1);
+  CHECK(countOf(text, "hipFree") == 0);
+  CHECK(countOf(text, "\"pid\":1234") == countOf(text, "\"pid\":"));
+  fclose(file);
+}
+
+static void testDrop() {
+  // Two threads keep the only chunks, the third one drops
+  FILE* file = tmpfile();
+  amd::TraceWriter::Options options;
+  options.chunkEvents_ = 4;
+  options.maxChunks_ = 2;
+  options.flushMs_ = 0;
+  amd::TraceWriter writer(file, options);
+  std::thread([&]() { writer.api("hipMalloc", 1, 0, 10, 0); }).join();
+  std::thread([&]() { writer.api("hipMalloc", 2, 0, 10, 0); }).join();
+  std::thread([&]() {
+    for (int i = 0; i < 4; ++i) {
+      writer.api("hipMalloc", 3, 0, 10, 0);
+    }
+  }).join();
+  writer.close();
+  std::string text = readAll(file);
+  CHECK(JsonParser(text).valid());
+  auto stats = writer.stats();
+  CHECK(stats.events_ + stats.dropped_ == 6);
+  CHECK(countOf(text, "\"ph\":\"X\"") == stats.events_);
+  fclose(file);
+}
+
+static void benchmark() {
+  constexpr uint32_t kEvents = 1000000;
+  printf("%8s %12s %14s %10s\n", "threads", "ns/event", "write (MB/s)", "dropped");
+  for (uint32_t threads : {1, 2, 4}) {
+    FILE* file = tmpfile();
+    amd::TraceWriter::Options options;
+    options.maxChunks_ = 16 * threads;
+    amd::TraceWriter writer(file, options);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (uint32_t t = 0; t < threads; ++t) {
+      workers.emplace_back([&, t]() {
+        for (uint32_t i = 0; i < kEvents; ++i) {
+          writer.command("_Z6kernelPfS_i", true, "kernel", 0, t, i * 1000ull, i * 1000ull + 500,
+                         i + 1, 0);
+        }
+      });
+    }
+    for (auto& worker : workers) {
+      worker.join();
+    }
+    std::chrono::duration<double, std::nano> append = std::chrono::steady_clock::now() - start;
+    writer.close();
+    std::chrono::duration<double> total = std::chrono::steady_clock::now() - start;
+    fseek(file, 0, SEEK_END);
+    const double size = static_cast<double>(ftell(file));
+    printf("%8u %12.1f %14.1f %10llu\n", threads, append.count() / kEvents,
+           size / total.count() / 1e6, static_cast<unsigned long long>(writer.stats().dropped_));
+    fclose(file);
+  }
+}
+
+int main(int argc, char** argv) {
+  testEmpty();
+  testThreads();
+  testDrop();
+  if (argc > 1 && std::string(argv[1]) == "--bench") {
+    benchmark();
+  }
+  printf("%s\n", (failures_ == 0) ? "PASSED" : "FAILED");
+  return (failures_ == 0) ? 0 : 1;
+}
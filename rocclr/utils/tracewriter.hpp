@@ -0,0 +1,295 @@
+/* Copyright (c) 2025 Advanced Micro Devices, Inc.
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE. */
+
+
+#ifndef TRACEWRITER_HPP_
+#define TRACEWRITER_HPP_
+
+#include "top.hpp"
+#include "utils/recordbuffer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+//! \addtogroup Utils
+
+namespace amd { /*@{*/
+
+/*! \brief Writes API spans and commands as a Chrome trace-event JSON file.
+ *
+ * The events are buffered per thread in a RecordBuffer and formatted on its delivery
+ * thread, so the memory is bounded by the chunks and the events, which don't find a
+ * chunk, are dropped. The file is a JSON array of complete ("X") events, which stays
+ * loadable in chrome://tracing and Perfetto even if close() is never called.
+ * The API spans are on the tracks of the host threads, the commands on a track per
+ * device queue. A flow arrow connects an API span with the commands of the same
+ * correlation id.
+ */
+class TraceWriter {
+ public:
+  struct Options {
+    uint32_t pid_ = 0;             //!< The process id of the events
+    uint32_t chunkEvents_ = 4096;  //!< The number of events per chunk
+    uint32_t maxChunks_ = 64;      //!< The max number of chunks of all threads
+    uint32_t flushMs_ = 100;       //!< The write interval, 0 writes full chunks only
+  };
+
+  struct Stats {
+    uint64_t events_;   //!< The number of written events
+    uint64_t dropped_;  //!< The number of dropped events
+  };
+
+  //! The tracks of the device queues start here, above the host thread ids
+  static constexpr uint32_t kQueueTrack = 0x40000000;
+
+  //! Starts the trace in \a file, which stays open after close()
+  TraceWriter(FILE* file, const Options& options)
+      : file_(file), pid_(options.pid_), events_(0), closed_(false) {
+    fputs("[\n", file_);
+    RecordBuffer<Event>::Options bufferOptions;
+    bufferOptions.chunkRecords_ = options.chunkEvents_;
+    bufferOptions.chunkBytes_ = std::max<uint32_t>(options.chunkEvents_ * 64, 2 * kMaxName);
+    bufferOptions.maxChunks_ = options.maxChunks_;
+    bufferOptions.flushMs_ = options.flushMs_;
+    buffer_.reset(new RecordBuffer<Event>(
+        bufferOptions, [this](const Event* events, size_t count) { write(events, count); }));
+  }
+
+  ~TraceWriter() { close(); }
+
+  //! Adds an API call of the host thread \a tid, \a name must be a static string
+  void api(const char* name, uint32_t tid, uint64_t beginNs, uint64_t endNs,
+           uint64_t correlationId) {
+    buffer_->append(0, [&](Event* event, char*) {
+      *event = {Event::Api, tid, 0, name, nullptr, beginNs, endNs, correlationId, 0};
+    });
+  }
+
+  /*! \brief Adds a command of a device queue.
+   *
+   * \a category must be a static string. The name is copied into the buffer if
+   * \a copyName is true, otherwise it must be a static string as well.
+   */
+  void command(const char* name, bool copyName, const char* category, uint32_t device,
+               uint32_t queue, uint64_t beginNs, uint64_t endNs, uint64_t correlationId,
+               uint64_t bytes) {
+    // Very long names are truncated to fit into the chunk
+    const size_t size = copyName ? strnlen(name, kMaxName) + 1 : 0;
+    buffer_->append(size, [&](Event* event, char* copy) {
+      *event = {Event::Command, queue, device, name, category, beginNs, endNs, correlationId,
+                bytes};
+      if (copyName) {
+        memcpy(copy, name, size - 1);
+        copy[size - 1] = '\0';
+        event->name_ = copy;
+      }
+    });
+  }
+
+  //! Writes the buffered events
+  void flush() { buffer_->flush(); }
+
+  //! Writes the remaining events and ends the trace, later events are ignored
+  void close() {
+    if (closed_.load(std::memory_order_acquire)) {
+      return;
+    }
+    buffer_->stop();
+    buffer_->flush();
+    std::lock_guard<std::mutex> lock(writeLock_);
+    auto stats = buffer_->stats();
+    if (stats.dropped_ != 0) {
+      char line[256];
+      snprintf(line, sizeof(line),
+               "%s{\"name\":\"dropped events\",\"ph\":\"i\",\"s\":\"g\",\"pid\":%u,\"tid\":0,"
+               "\"ts\":0,\"args\":{\"count\":%" PRIu64 "}}",
+               (events_ != 0) ? ",\n" : "", pid_, stats.dropped_);
+      out_ += line;
+    }
+    out_ += "\n]\n";
+    fwrite(out_.data(), 1, out_.size(), file_);
+    fflush(file_);
+    out_.clear();
+    closed_.store(true, std::memory_order_release);
+  }
+
+  Stats stats() const {
+    auto stats = buffer_->stats();
+    return {stats.delivered_, stats.dropped_};
+  }
+
+ private:
+  static constexpr size_t kMaxName = 4096;  //!< The max length of a copied name
+  static constexpr size_t kWriteSize = 64 * 1024;  //!< The size of a file write
+
+  struct Event {
+    enum Kind : uint32_t { Api, Command };
+    Kind kind_;
+    uint32_t tid_;              //!< The host thread id or the device queue
+    uint32_t device_;           //!< The device of a command
+    const char* name_;          //!< The name of the API or the command
+    const char* category_;      //!< The category of a command
+    uint64_t begin_;            //!< The begin timestamp in ns
+    uint64_t end_;              //!< The end timestamp in ns
+    uint64_t correlationId_;    //!< 0 without a correlation
+    uint64_t bytes_;            //!< The size of a copy
+  };
+
+  //! Appends the JSON string of \a str
+  void quote(const char* str) {
+    out_ += '"';
+    for (const char* c = str; *c != '\0'; ++c) {
+      if ((*c == '"') || (*c == '\\')) {
+        out_ += '\\';
+        out_ += *c;
+      } else if (static_cast<unsigned char>(*c) < 0x20) {
+        char escape[8];
+        snprintf(escape, sizeof(escape), "\\u%04x", *c);
+        out_ += escape;
+      } else {
+        out_ += *c;
+      }
+    }
+    out_ += '"';
+  }
+
+  void number(uint64_t value) {
+    char digits[20];
+    size_t count = 0;
+    do {
+      digits[count++] = static_cast<char>('0' + value % 10);
+      value /= 10;
+    } while (value != 0);
+    while (count != 0) {
+      out_ += digits[--count];
+    }
+  }
+
+  //! Appends the nanoseconds as microseconds with 3 decimals
+  void micros(uint64_t ns) {
+    number(ns / 1000);
+    const uint32_t fraction = static_cast<uint32_t>(ns % 1000);
+    out_ += '.';
+    out_ += static_cast<char>('0' + fraction / 100);
+    out_ += static_cast<char>('0' + fraction / 10 % 10);
+    out_ += static_cast<char>('0' + fraction % 10);
+  }
+
+  //! Starts the next event of the array
+  void next() {
+    if (events_++ != 0) {
+      out_ += ",\n";
+    }
+  }
+
+  //! Formats a batch of events on the delivery thread
+  void write(const Event* events, size_t count) {
+    // A producer can flush inline, while close() ends the trace
+    std::lock_guard<std::mutex> lock(writeLock_);
+    if (closed_.load(std::memory_order_relaxed)) {
+      return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+      const Event& event = events[i];
+      uint32_t tid = event.tid_;
+      if (event.kind_ == Event::Command) {
+        tid = kQueueTrack | (event.device_ << 16) | (event.tid_ & 0xFFFF);
+        if (tracks_.insert(tid).second) {
+          char line[256];
+          next();
+          snprintf(line, sizeof(line),
+                   "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,"
+                   "\"args\":{\"name\":\"GPU %u queue %u\"}}",
+                   pid_, tid, event.device_, event.tid_);
+          out_ += line;
+        }
+      }
+      next();
+      out_ += "{\"name\":";
+      quote(event.name_);
+      out_ += ",\"cat\":\"";
+      out_ += (event.kind_ == Event::Api) ? "api" : event.category_;
+      out_ += "\",\"ph\":\"X\",\"pid\":";
+      number(pid_);
+      out_ += ",\"tid\":";
+      number(tid);
+      out_ += ",\"ts\":";
+      micros(event.begin_);
+      out_ += ",\"dur\":";
+      micros((event.end_ > event.begin_) ? (event.end_ - event.begin_) : 0);
+      out_ += ",\"args\":{\"correlation_id\":";
+      number(event.correlationId_);
+      if (event.kind_ == Event::Command) {
+        out_ += ",\"device\":";
+        number(event.device_);
+        out_ += ",\"queue\":";
+        number(event.tid_);
+        out_ += ",\"bytes\":";
+        number(event.bytes_);
+      }
+      out_ += "}}";
+      if (event.correlationId_ != 0) {
+        // The flow starts in the API span and ends at the enclosing command
+        next();
+        out_ += (event.kind_ == Event::Api)
+            ? "{\"name\":\"launch\",\"cat\":\"flow\",\"ph\":\"s\",\"id\":"
+            : "{\"name\":\"launch\",\"cat\":\"flow\",\"ph\":\"f\",\"bp\":\"e\",\"id\":";
+        number(event.correlationId_);
+        out_ += ",\"pid\":";
+        number(pid_);
+        out_ += ",\"tid\":";
+        number(tid);
+        out_ += ",\"ts\":";
+        micros(event.begin_);
+        out_ += '}';
+      }
+      if (out_.size() >= kWriteSize) {
+        fwrite(out_.data(), 1, out_.size(), file_);
+        out_.clear();
+      }
+    }
+    fwrite(out_.data(), 1, out_.size(), file_);
+    out_.clear();
+  }
+
+  FILE* file_;                               //!< The trace file
+  const uint32_t pid_;                       //!< The process id of the events
+  std::mutex writeLock_;                     //!< Serializes the writes with close()
+  std::string out_;                          //!< The formatted events
+  std::unordered_set<uint32_t> tracks_;      //!< The named queue tracks
+  uint64_t events_;                          //!< The number of written JSON objects
+  std::atomic<bool> closed_;                 //!< The trace is complete
+  //! The events of the threads, destroyed first, since its delivery uses the writer
+  std::unique_ptr<RecordBuffer<Event>> buffer_;
+};
+
+/*@}*/
+
+}  // namespace amd
+
+#endif /*TRACEWRITER_HPP_*/